@@ -4,6 +4,22 @@
 using namespace wi::ecs;
 using namespace wi::scene;
 
+// Compressed animation datas can't be edited, they are decompressed first
+//	returns false if the data can't be edited
+static bool DecompressForEditing(Scene& scene, AnimationDataComponent* animation_data)
+{
+	if (!animation_data->IsCompressed())
+		return true;
+	const AnimationDataComponent* time_track_data = scene.animation_datas.GetComponent(animation_data->time_track);
+	if (time_track_data == nullptr)
+	{
+		wi::backlog::post("The time track of a compressed animation data was not found, it can't be edited.", wi::backlog::LogLevel::Warning);
+		return false;
+	}
+	animation_data->Decompress(*time_track_data);
+	return true;
+}
+
 void AnimationWindow::Create(EditorComponent* _editor)
 {
 	editor = _editor;
@@ -53,6 +69,17 @@ void AnimationWindow::Create(EditorComponent* _editor)
 				AnimationComponent::AnimationSampler& sampler = animation->samplers[channel.samplerIndex];
 				sampler.mode = (AnimationComponent::AnimationSampler::Mode)args.userdata;
 
+				if (sampler.mode != AnimationComponent::AnimationSampler::Mode::LINEAR)
+				{
+					// Compressed animation datas only support linear sampling:
+					AnimationDataComponent* animationdata = editor->GetCurrentScene().animation_datas.GetComponent(sampler.data);
+					if (animationdata != nullptr && !DecompressForEditing(editor->GetCurrentScene(), animationdata))
+					{
+						sampler.mode = AnimationComponent::AnimationSampler::Mode::LINEAR;
+						continue;
+					}
+				}
+
 				if (sampler.mode == AnimationComponent::AnimationSampler::Mode::CUBICSPLINE)
 				{
 					const AnimationDataComponent* animationdata = editor->GetCurrentScene().animation_datas.GetComponent(sampler.data);
@@ -310,7 +337,7 @@ void AnimationWindow::Create(EditorComponent* _editor)
 				{
 					auto& sam = animation->samplers[channel.samplerIndex];
 					AnimationDataComponent* animation_data = scene.animation_datas.GetComponent(sam.data);
-					if (animation_data != nullptr)
+					if (animation_data != nullptr && DecompressForEditing(scene, animation_data) && !animation_data->keyframe_times.empty())
 					{
 						// Search for leftmost keyframe:
 						int keyFirst = 0;
@@ -327,6 +354,7 @@ void AnimationWindow::Create(EditorComponent* _editor)
 
 						// Duplicate first frame to current position:
 						animation_data->keyframe_times.push_back(current_time);
+						animation_data->SetKeyframeInfoDirty();
 
 						const AnimationComponent::AnimationChannel::PathDataType path_data_type = channel.GetPathDataType();
 
@@ -505,9 +533,10 @@ void AnimationWindow::Create(EditorComponent* _editor)
 						auto& channel = animation->channels[channelIndex];
 
 						AnimationDataComponent* animation_data = scene.animation_datas.GetComponent(animation->samplers[channel.samplerIndex].data);
-						if (animation_data != nullptr)
+						if (animation_data != nullptr && DecompressForEditing(scene, animation_data))
 						{
 							animation_data->keyframe_times.push_back(current_time);
+							animation_data->SetKeyframeInfoDirty();
 
 							switch (channel.path)
 							{
@@ -915,9 +944,10 @@ void AnimationWindow::Create(EditorComponent* _editor)
 				const AnimationComponent::AnimationSampler& sam = animation->samplers[channel.samplerIndex];
 				AnimationDataComponent* animation_data = scene.animation_datas.GetComponent(sam.data);
 
-				if (animation_data != nullptr && animation_data->keyframe_times.size() > timeIndex)
+				if (animation_data != nullptr && timeIndex != 0xFFFFFFFF && DecompressForEditing(scene, animation_data) && animation_data->keyframe_times.size() > timeIndex)
 				{
 					// specific keyframe deletion:
+					animation_data->SetKeyframeInfoDirty();
 					const AnimationComponent::AnimationChannel::PathDataType path_data_type = channel.GetPathDataType();
 
 					switch (path_data_type)
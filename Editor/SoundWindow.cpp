@@ -297,9 +297,9 @@ void WaveGraph::Render(const wi::Canvas& canvas, wi::graphics::CommandList cmd)
 	XMFLOAT4 base_color = font.params.color;
 	base_color.w = 1;
 
-	if (sound == nullptr || !sound->soundResource.IsValid())
+	if (sound == nullptr || !sound->soundResource.IsValid() || wi::audio::IsStreaming(&sound->soundResource.GetSound()))
 	{
-		// Vertices for straight line:
+		// Vertices for straight line (streaming sounds don't have decoded samples):
 		Vertex vert;
 		vert.color = base_color;
 		for (uint32_t i = 0; i < vertexCount; ++i)
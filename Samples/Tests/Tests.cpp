@@ -27,6 +27,22 @@ enum TEST_TYPE
 	INVERSEKINEMATICSTEST,
 	INSTANCESTEST,
 	CONTAINERPERF,
+	JOBSYSTEMBENCHMARK,
+	OBJECTUPDATEBENCHMARK,
+	BVHBENCHMARK,
+	FRUSTUMCULLINGBENCHMARK,
+	OCCLUSIONCULLINGBENCHMARK,
+	PHYSICSJOBSYSTEMBENCHMARK,
+	AUDIOSTREAMINGBENCHMARK,
+	BLOCKCOMPRESSIONBENCHMARK,
+	DERIVEDDATACACHEBENCHMARK,
+	BATCHLOADINGBENCHMARK,
+	FONTATLASBENCHMARK,
+	ANIMATIONBENCHMARK,
+	ANIMATIONCOMPRESSIONBENCHMARK,
+	SCENEQUERYBENCHMARK,
+	SKINNEDQUERYBENCHMARK,
+	CHARACTERSYSTEMSBENCHMARK,
 };
 
 // Controller Test UI Data, info down below will be using Xbox Controller as reference
@@ -161,6 +177,22 @@ void TestsRenderer::Load()
 	testSelector.AddItem("Inverse Kinematics", INVERSEKINEMATICSTEST);
 	testSelector.AddItem("65k Instances", INSTANCESTEST);
 	testSelector.AddItem("Container perf", CONTAINERPERF);
+	testSelector.AddItem("Job System Benchmark", JOBSYSTEMBENCHMARK);
+	testSelector.AddItem("Object Update Benchmark", OBJECTUPDATEBENCHMARK);
+	testSelector.AddItem("BVH Benchmark", BVHBENCHMARK);
+	testSelector.AddItem("Frustum Culling Benchmark", FRUSTUMCULLINGBENCHMARK);
+	testSelector.AddItem("Occlusion Culling Benchmark", OCCLUSIONCULLINGBENCHMARK);
+	testSelector.AddItem("Physics Job System Benchmark", PHYSICSJOBSYSTEMBENCHMARK);
+	testSelector.AddItem("Audio Streaming Benchmark", AUDIOSTREAMINGBENCHMARK);
+	testSelector.AddItem("Block Compression Benchmark", BLOCKCOMPRESSIONBENCHMARK);
+	testSelector.AddItem("Derived Data Cache Benchmark", DERIVEDDATACACHEBENCHMARK);
+	testSelector.AddItem("Batch Loading Benchmark", BATCHLOADINGBENCHMARK);
+	testSelector.AddItem("Font Atlas Benchmark", FONTATLASBENCHMARK);
+	testSelector.AddItem("Animation Benchmark", ANIMATIONBENCHMARK);
+	testSelector.AddItem("Animation Compression Benchmark", ANIMATIONCOMPRESSIONBENCHMARK);
+	testSelector.AddItem("Scene Query Benchmark", SCENEQUERYBENCHMARK);
+	testSelector.AddItem("Skinned Query Benchmark", SKINNEDQUERYBENCHMARK);
+	testSelector.AddItem("Character Systems Benchmark", CHARACTERSYSTEMSBENCHMARK);
 	testSelector.SetMaxVisibleItemCount(10);
 	testSelector.OnSelect([=](wi::gui::EventArgs args) {
 
@@ -421,6 +453,58 @@ void TestsRenderer::Load()
 			ContainerTest();
 			break;
 
+		case JOBSYSTEMBENCHMARK:
+			RunJobSystemBenchmark();
+			break;
+
+		case OBJECTUPDATEBENCHMARK:
+			RunObjectUpdateBenchmark();
+			break;
+
+		case BVHBENCHMARK:
+			RunBVHBenchmark();
+			break;
+
+		case FRUSTUMCULLINGBENCHMARK:
+			RunFrustumCullingBenchmark();
+			break;
+		case OCCLUSIONCULLINGBENCHMARK:
+			RunOcclusionCullingBenchmark();
+			break;
+		case PHYSICSJOBSYSTEMBENCHMARK:
+			RunPhysicsJobSystemBenchmark();
+			break;
+		case AUDIOSTREAMINGBENCHMARK:
+			RunAudioStreamingBenchmark();
+			break;
+		case BLOCKCOMPRESSIONBENCHMARK:
+			RunBlockCompressionBenchmark();
+			break;
+		case DERIVEDDATACACHEBENCHMARK:
+			RunDerivedDataCacheBenchmark();
+			break;
+		case BATCHLOADINGBENCHMARK:
+			RunBatchLoadingBenchmark();
+			break;
+		case FONTATLASBENCHMARK:
+			RunFontAtlasBenchmark();
+			break;
+		case ANIMATIONBENCHMARK:
+			RunAnimationBenchmark();
+			break;
+		case ANIMATIONCOMPRESSIONBENCHMARK:
+			RunAnimationCompressionBenchmark();
+			break;
+		case SCENEQUERYBENCHMARK:
+			RunSceneQueryBenchmark();
+			break;
+		case SKINNEDQUERYBENCHMARK:
+			RunSkinnedQueryBenchmark();
+			break;
+		case CHARACTERSYSTEMSBENCHMARK:
+			RunCharacterSystemsBenchmark();
+			break;
+
 		default:
 			assert(0);
 			break;
@@ -699,6 +783,1493 @@ void TestsRenderer::RunJobSystemTest()
 	font.params.size = 24;
 	this->AddFont(&font);
 }
+void TestsRenderer::RunJobSystemBenchmark()
+{
+	wi::Timer timer;
+
+	// This measures the scheduling overhead of the job system with tiny jobs, with both the locking queues and the work stealing scheduler
+	//	The thread count is varied by using the different priorities, which have different amount of worker threads
+	const uint32_t jobCount = 100000;
+	const uint32_t groupSizes[] = { 1, 8, 64, 512 };
+	const uint32_t latencyIterations = 1000;
+	const wi::jobsystem::Priority priorities[] = { wi::jobsystem::Priority::High, wi::jobsystem::Priority::Low, wi::jobsystem::Priority::Streaming };
+	const char* priority_names[] = { "High", "Low", "Streaming" };
+	const bool work_stealing_before = wi::jobsystem::IsWorkStealingEnabled();
+
+	std::string ss;
+	ss += "Job System benchmark, " + std::to_string(jobCount) + " empty jobs per Dispatch():\n";
+	ss += "You can find out more in Tests.cpp, RunJobSystemBenchmark() function.\n";
+
+	for (int work_stealing = 0; work_stealing < 2; ++work_stealing)
+	{
+		wi::jobsystem::SetWorkStealingEnabled(work_stealing != 0);
+		ss += work_stealing ? "\nWork stealing scheduler:\n" : "\nLocking queue scheduler:\n";
+
+		for (int prio = 0; prio < arraysize(priorities); ++prio)
+		{
+			wi::jobsystem::context ctx;
+			ctx.priority = priorities[prio];
+			const uint32_t threadCount = wi::jobsystem::GetThreadCount(ctx.priority);
+			ss += std::string(priority_names[prio]) + " priority (" + std::to_string(threadCount) + " threads):";
+
+			for (uint32_t groupSize : groupSizes)
+			{
+				timer.record();
+				wi::jobsystem::Dispatch(ctx, jobCount, groupSize, [](wi::jobsystem::JobArgs args) {});
+				wi::jobsystem::Wait(ctx);
+				const double seconds = timer.elapsed_seconds();
+				ss += "  [groupSize " + std::to_string(groupSize) + "] " + std::to_string(int(double(jobCount) / seconds / 1000000.0)) + "M jobs/s";
+			}
+
+			// Wait() latency: the round trip of scheduling one group for every thread and waiting for them
+			timer.record();
+			for (uint32_t i = 0; i < latencyIterations; ++i)
+			{
+				wi::jobsystem::Dispatch(ctx, threadCount, 1, [](wi::jobsystem::JobArgs args) {});
+				wi::jobsystem::Wait(ctx);
+			}
+			const double latency = timer.elapsed_milliseconds() * 1000.0 / double(latencyIterations);
+			ss += "  Wait() latency: " + std::to_string(latency) + " us\n";
+		}
+	}
+
+	wi::jobsystem::SetWorkStealingEnabled(work_stealing_before);
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunObjectUpdateBenchmark()
+{
+	wi::Timer timer;
+
+	// This creates a separate scene with a lot of objects sharing one mesh, and a camera that sees a part of them,
+	//	then measures the object update system and the linear frustum culling with the AABB structures (array of structures)
+	//	and with the object bounds streams (structure of arrays, the culling tests 4 objects at once with SIMD)
+	const uint32_t objectCount = 100000;
+	const uint32_t iterations = 20;
+
+	Scene scene;
+	Entity cube = scene.Entity_CreateCube("cube");
+	for (uint32_t i = 0; i < objectCount; ++i)
+	{
+		Entity entity = CreateEntity();
+		scene.layers.Create(entity);
+		TransformComponent& transform = scene.transforms.Create(entity);
+		transform.Translate(XMFLOAT3(float(i % 100) * 3, float((i / 100) % 100) * 3, float(i / 10000) * 3));
+		ObjectComponent& object = scene.objects.Create(entity);
+		object.meshID = cube;
+	}
+
+	timer.record();
+	scene.Update(0); // creates GPU buffers, first transform update
+	std::string ss;
+	ss += "Object update benchmark, " + std::to_string(objectCount) + " objects, average of " + std::to_string(iterations) + " updates:\n";
+	ss += "You can find out more in Tests.cpp, RunObjectUpdateBenchmark() function.\n\n";
+	ss += "First scene update: " + std::to_string(timer.elapsed_milliseconds()) + " ms\n";
+
+	CameraComponent camera;
+	camera.CreatePerspective(1920, 1080, 0.1f, 200);
+	TransformComponent camera_transform;
+	camera_transform.RotateRollPitchYaw(XMFLOAT3(0.3f, XM_PIDIV4, 0));
+	camera_transform.Translate(XMFLOAT3(-10, 40, -10));
+	camera_transform.UpdateTransform();
+	camera.TransformCamera(camera_transform);
+	camera.UpdateCamera();
+
+	// The object bounds streams are used by the linear culling:
+	const bool hierarchical_culling = wi::renderer::GetHierarchicalCullingEnabled();
+	wi::renderer::SetHierarchicalCullingEnabled(false);
+
+	double update_results[2] = {};
+	double culling_results[2] = {};
+	wi::vector<uint32_t> visible_objects[2];
+	const char* names[] = { "Array of structures", "Structure of arrays" };
+	for (int soa = 0; soa < 2; ++soa)
+	{
+		scene.object_streams_enabled = soa != 0;
+
+		wi::jobsystem::context ctx;
+		scene.RunObjectUpdateSystem(ctx); // warm up, this also allocates the streams
+		wi::jobsystem::Wait(ctx);
+
+		for (uint32_t i = 0; i < iterations; ++i)
+		{
+			timer.record();
+			scene.RunObjectUpdateSystem(ctx);
+			wi::jobsystem::Wait(ctx);
+			update_results[soa] += timer.elapsed_milliseconds();
+
+			wi::renderer::Visibility vis;
+			vis.scene = &scene;
+			vis.camera = &camera;
+			vis.flags = wi::renderer::Visibility::ALLOW_OBJECTS;
+			timer.record();
+			wi::renderer::UpdateVisibility(vis);
+			culling_results[soa] += timer.elapsed_milliseconds();
+
+			visible_objects[soa] = vis.visibleObjects;
+		}
+		update_results[soa] /= double(iterations);
+		culling_results[soa] /= double(iterations);
+		std::sort(visible_objects[soa].begin(), visible_objects[soa].end()); // the order of the linear culling depends on the job scheduling
+		ss += std::string(names[soa]) + ": object update: " + std::to_string(update_results[soa]) + " ms, linear culling: " + std::to_string(culling_results[soa]) + " ms, visible objects: " + std::to_string(visible_objects[soa].size()) + "\n";
+	}
+	scene.object_streams_enabled = false;
+	wi::renderer::SetHierarchicalCullingEnabled(hierarchical_culling);
+	ss += "Object update speedup: " + std::to_string(update_results[0] / std::max(0.0001, update_results[1])) + "x, linear culling speedup: " + std::to_string(culling_results[0] / std::max(0.0001, culling_results[1])) + "x\n";
+	ss += visible_objects[0] == visible_objects[1] ? "The results are the same\n" : "ERROR: results mismatch!\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunBVHBenchmark()
+{
+	wi::Timer timer;
+
+	// This builds wi::BVH from random AABBs with the midpoint and the SAH builders,
+	//	then traces the same random rays with the binary tree traversal and the 4-wide SIMD traversal
+	const uint32_t aabbCounts[] = { 10000, 100000, 1000000 };
+	const uint32_t rayCount = 100000;
+
+	std::string ss;
+	ss += "BVH benchmark, " + std::to_string(rayCount) + " random rays against random AABBs:\n";
+	ss += "You can find out more in Tests.cpp, RunBVHBenchmark() function.\n\n";
+
+	wi::random::RNG rng(42);
+	for (uint32_t aabbCount : aabbCounts)
+	{
+		wi::vector<wi::primitive::AABB> aabbs(aabbCount);
+		for (auto& aabb : aabbs)
+		{
+			const XMFLOAT3 center = XMFLOAT3(rng.next_float(-100, 100), rng.next_float(-20, 20), rng.next_float(-100, 100));
+			const float size = rng.next_float(0.1f, 2.0f);
+			aabb = wi::primitive::AABB(XMFLOAT3(center.x - size, center.y - size, center.z - size), XMFLOAT3(center.x + size, center.y + size, center.z + size));
+		}
+		wi::vector<wi::primitive::Ray> rays;
+		rays.reserve(rayCount);
+		for (uint32_t i = 0; i < rayCount; ++i)
+		{
+			const XMFLOAT3 origin = XMFLOAT3(rng.next_float(-100, 100), rng.next_float(-20, 20), rng.next_float(-100, 100));
+			const XMFLOAT3 direction = XMFLOAT3(rng.next_float(-1, 1), rng.next_float(-1, 1), rng.next_float(-1, 1));
+			rays.emplace_back(XMLoadFloat3(&origin), XMVector3Normalize(XMLoadFloat3(&direction)), 0.0f, 100.0f);
+		}
+
+		wi::BVH bvh_midpoint;
+		timer.record();
+		bvh_midpoint.Build(aabbs.data(), aabbCount, wi::BVH::BUILD_MODE::MIDPOINT);
+		const double build_midpoint = timer.elapsed_milliseconds();
+
+		wi::BVH bvh_sah;
+		timer.record();
+		bvh_sah.Build(aabbs.data(), aabbCount, wi::BVH::BUILD_MODE::SAH);
+		const double build_sah = timer.elapsed_milliseconds();
+
+		uint32_t hits[2] = {};
+		double rays_per_second[2] = {};
+		for (int wide = 0; wide < 2; ++wide)
+		{
+			timer.record();
+			for (auto& ray : rays)
+			{
+				auto callback = [&](uint32_t index) {
+					if (aabbs[index].intersects(ray))
+					{
+						hits[wide]++;
+					}
+				};
+				if (wide)
+				{
+					bvh_sah.Intersects(ray, 0, callback); // 4-wide SIMD traversal
+				}
+				else
+				{
+					bvh_midpoint.Intersects<wi::primitive::Ray>(ray, 0, callback); // binary traversal
+				}
+			}
+			rays_per_second[wide] = double(rayCount) / std::max(0.0001, timer.elapsed_seconds());
+		}
+
+		ss += std::to_string(aabbCount) + " AABBs:\n";
+		ss += "\tMidpoint build: " + std::to_string(build_midpoint) + " ms, SAH build: " + std::to_string(build_sah) + " ms\n";
+		ss += "\tMidpoint binary traversal: " + std::to_string(uint64_t(rays_per_second[0])) + " rays/s\n";
+		ss += "\tSAH 4-wide traversal: " + std::to_string(uint64_t(rays_per_second[1])) + " rays/s\n";
+		ss += "\tSpeedup: " + std::to_string(rays_per_second[1] / std::max(0.0001, rays_per_second[0])) + "x";
+		ss += hits[0] == hits[1] ? "\n" : " (ERROR: hit count mismatch!)\n";
+	}
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunFrustumCullingBenchmark()
+{
+	wi::Timer timer;
+
+	// This creates a separate scene with a large grid of objects and a camera that sees only a corner of it,
+	//	then measures wi::renderer::UpdateVisibility() with linear and hierarchical (object BVH) frustum culling
+	const uint32_t objectCount = 500000;
+	const uint32_t iterations = 20;
+
+	Scene scene;
+	Entity cube = scene.Entity_CreateCube("cube");
+	for (uint32_t i = 0; i < objectCount; ++i)
+	{
+		Entity entity = CreateEntity();
+		scene.layers.Create(entity);
+		TransformComponent& transform = scene.transforms.Create(entity);
+		transform.Translate(XMFLOAT3(float(i % 100) * 4, float((i / 100) % 50) * 4, float(i / 5000) * 4));
+		ObjectComponent& object = scene.objects.Create(entity);
+		object.meshID = cube;
+	}
+
+	scene.Update(0); // starts building the object BVH in the background
+	wi::jobsystem::Wait(scene.object_bvh_workload);
+	scene.Update(0); // takes the finished object BVH
+
+	CameraComponent camera;
+	camera.CreatePerspective(1920, 1080, 0.1f, 300);
+	TransformComponent camera_transform;
+	camera_transform.RotateRollPitchYaw(XMFLOAT3(0.3f, XM_PIDIV4, 0));
+	camera_transform.Translate(XMFLOAT3(-10, 60, -10));
+	camera_transform.UpdateTransform();
+	camera.TransformCamera(camera_transform);
+	camera.UpdateCamera();
+
+	std::string ss;
+	ss += "Frustum culling benchmark, " + std::to_string(objectCount) + " objects, average of " + std::to_string(iterations) + " culling passes:\n";
+	ss += "You can find out more in Tests.cpp, RunFrustumCullingBenchmark() function.\n\n";
+	ss += "Object BVH valid: " + std::string(scene.IsObjectBVHValid() ? "yes" : "no") + "\n";
+
+	const bool hierarchical_culling = wi::renderer::GetHierarchicalCullingEnabled();
+	double results[2] = {};
+	const char* names[] = { "Linear culling", "Hierarchical culling" };
+	for (int hierarchical = 0; hierarchical < 2; ++hierarchical)
+	{
+		wi::renderer::SetHierarchicalCullingEnabled(hierarchical != 0);
+		uint32_t visible = 0;
+		timer.record();
+		for (uint32_t i = 0; i < iterations; ++i)
+		{
+			wi::renderer::Visibility vis;
+			vis.scene = &scene;
+			vis.camera = &camera;
+			vis.flags = wi::renderer::Visibility::ALLOW_OBJECTS;
+			wi::renderer::UpdateVisibility(vis);
+			visible = vis.object_counter.load();
+		}
+		results[hierarchical] = timer.elapsed_milliseconds() / double(iterations);
+		ss += std::string(names[hierarchical]) + ": " + std::to_string(results[hierarchical]) + " ms, visible objects: " + std::to_string(visible) + "\n";
+	}
+	wi::renderer::SetHierarchicalCullingEnabled(hierarchical_culling);
+	ss += "Speedup: " + std::to_string(results[0] / std::max(0.0001, results[1])) + "x\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunOcclusionCullingBenchmark()
+{
+	wi::Timer timer;
+
+	// This creates a separate scene of a dense city block: a grid of buildings with small props on the streets,
+	//	and a camera at street level looking along a street. wi::renderer::UpdateVisibility() is measured
+	//	with frustum culling only and with CPU software occlusion culling.
+	const uint32_t blocks = 32;
+	const uint32_t propsPerBlock = 24;
+	const float blockSize = 20;
+	const float streetWidth = 8;
+	const uint32_t iterations = 20;
+
+	Scene scene;
+	Entity cube = scene.Entity_CreateCube("cube");
+	wi::random::RNG rng(42);
+	auto add_box = [&](const XMFLOAT3& position, const XMFLOAT3& halfExtents) {
+		Entity entity = CreateEntity();
+		scene.layers.Create(entity);
+		TransformComponent& transform = scene.transforms.Create(entity);
+		transform.Scale(halfExtents);
+		transform.Translate(position);
+		ObjectComponent& object = scene.objects.Create(entity);
+		object.meshID = cube;
+	};
+	for (uint32_t z = 0; z < blocks; ++z)
+	{
+		for (uint32_t x = 0; x < blocks; ++x)
+		{
+			const float cx = x * (blockSize + streetWidth);
+			const float cz = z * (blockSize + streetWidth);
+			const float height = rng.next_float(8, 40);
+			add_box(XMFLOAT3(cx, height, cz), XMFLOAT3(blockSize * 0.5f, height, blockSize * 0.5f));
+			for (uint32_t i = 0; i < propsPerBlock; ++i)
+			{
+				// props along the streets around the block:
+				const float along = rng.next_float(-0.5f, 0.5f) * blockSize;
+				const float side = (blockSize + streetWidth * 0.5f) * 0.5f * (i % 2 == 0 ? 1 : -1);
+				const XMFLOAT3 position = (i / 2) % 2 == 0 ? XMFLOAT3(cx + along, 0.5f, cz + side) : XMFLOAT3(cx + side, 0.5f, cz + along);
+				add_box(position, XMFLOAT3(0.5f, rng.next_float(0.3f, 1.5f), 0.5f));
+			}
+		}
+	}
+
+	scene.Update(0);
+	wi::jobsystem::Wait(scene.object_bvh_workload);
+	scene.Update(0);
+
+	CameraComponent camera;
+	camera.CreatePerspective(1920, 1080, 0.1f, 1000);
+	TransformComponent camera_transform;
+	camera_transform.RotateRollPitchYaw(XMFLOAT3(0, XM_PIDIV4 * 0.3f, 0));
+	camera_transform.Translate(XMFLOAT3((blockSize + streetWidth) * 0.5f, 2, -streetWidth));
+	camera_transform.UpdateTransform();
+	camera.TransformCamera(camera_transform);
+	camera.UpdateCamera();
+
+	std::string ss;
+	ss += "Occlusion culling benchmark, dense city block of " + std::to_string(scene.objects.GetCount()) + " objects, average of " + std::to_string(iterations) + " culling passes:\n";
+	ss += "You can find out more in Tests.cpp, RunOcclusionCullingBenchmark() function.\n\n";
+
+	const bool software_occlusion = wi::renderer::GetSoftwareOcclusionCullingEnabled();
+	double results[2] = {};
+	const char* names[] = { "Frustum culling", "Software occlusion culling" };
+	for (int occlusion = 0; occlusion < 2; ++occlusion)
+	{
+		wi::renderer::SetSoftwareOcclusionCullingEnabled(occlusion != 0);
+		wi::vector<uint32_t> reference;
+		bool deterministic = true;
+		uint32_t occluders = 0;
+		uint32_t triangles = 0;
+		timer.record();
+		for (uint32_t i = 0; i < iterations; ++i)
+		{
+			wi::renderer::Visibility vis;
+			vis.scene = &scene;
+			vis.camera = &camera;
+			vis.flags = wi::renderer::Visibility::ALLOW_OBJECTS | wi::renderer::Visibility::ALLOW_SOFTWARE_OCCLUSION_CULLING;
+			wi::renderer::UpdateVisibility(vis);
+			std::sort(vis.visibleObjects.begin(), vis.visibleObjects.end());
+			if (i == 0)
+			{
+				reference = vis.visibleObjects;
+			}
+			deterministic &= reference == vis.visibleObjects;
+			occluders = vis.occlusion_buffer.GetOccluderCount();
+			triangles = vis.occlusion_buffer.GetTriangleCount();
+		}
+		results[occlusion] = timer.elapsed_milliseconds() / double(iterations);
+		ss += std::string(names[occlusion]) + ": " + std::to_string(results[occlusion]) + " ms, visible objects: " + std::to_string(reference.size());
+		if (occlusion)
+		{
+			ss += ", occluders: " + std::to_string(occluders) + ", rasterized triangles: " + std::to_string(triangles) + ", deterministic: " + std::string(deterministic ? "yes" : "no");
+		}
+		ss += "\n";
+	}
+	wi::renderer::SetSoftwareOcclusionCullingEnabled(software_occlusion);
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunPhysicsJobSystemBenchmark()
+{
+	wi::Timer timer;
+
+	// This creates separate scenes of many stacked boxes falling onto a static ground box,
+	//	and measures the physics simulation steps when running the physics jobs on the engine's job system
+	//	and on the separate physics thread pool.
+	const uint32_t columns = 16;
+	const uint32_t stackHeight = 40;
+	const uint32_t steps = 60;
+	const float timestep = 1.0f / wi::physics::GetFrameRate();
+
+	std::string ss;
+	ss += "Physics job system benchmark, " + std::to_string(columns * columns * stackHeight) + " stacked rigid bodies, average of " + std::to_string(steps) + " simulation steps:\n";
+	ss += "You can find out more in Tests.cpp, RunPhysicsJobSystemBenchmark() function.\n\n";
+
+	const bool shared_job_system = wi::physics::IsSharedJobSystemEnabled();
+	double results[2] = {};
+	const char* names[] = { "Physics thread pool", "Engine job system" };
+	for (int shared = 0; shared < 2; ++shared)
+	{
+		wi::physics::SetSharedJobSystemEnabled(shared != 0);
+
+		Scene scene;
+		Entity cube = scene.Entity_CreateCube("cube");
+		auto add_box = [&](const XMFLOAT3& position, const XMFLOAT3& halfExtents, float mass) {
+			Entity entity = CreateEntity();
+			scene.layers.Create(entity);
+			TransformComponent& transform = scene.transforms.Create(entity);
+			transform.Scale(halfExtents);
+			transform.Translate(position);
+			ObjectComponent& object = scene.objects.Create(entity);
+			object.meshID = cube;
+			RigidBodyPhysicsComponent& rigidbody = scene.rigidbodies.Create(entity);
+			rigidbody.shape = RigidBodyPhysicsComponent::BOX;
+			rigidbody.box.halfextents = halfExtents;
+			rigidbody.mass = mass;
+		};
+		add_box(XMFLOAT3(0, -1, 0), XMFLOAT3(columns * 2.0f, 1, columns * 2.0f), 0);
+		for (uint32_t z = 0; z < columns; ++z)
+		{
+			for (uint32_t x = 0; x < columns; ++x)
+			{
+				for (uint32_t y = 0; y < stackHeight; ++y)
+				{
+					add_box(XMFLOAT3(x * 3.0f - columns * 1.5f, 0.5f + y * 1.01f, z * 3.0f - columns * 1.5f), XMFLOAT3(0.5f, 0.5f, 0.5f), 1);
+				}
+			}
+		}
+		scene.Update(0);
+
+		wi::jobsystem::context ctx;
+		wi::physics::RunPhysicsUpdateSystem(ctx, scene, timestep); // creates the physics bodies and warms up
+		wi::jobsystem::Wait(ctx);
+
+		timer.record();
+		for (uint32_t i = 0; i < steps; ++i)
+		{
+			wi::physics::RunPhysicsUpdateSystem(ctx, scene, timestep);
+			wi::jobsystem::Wait(ctx);
+		}
+		results[shared] = timer.elapsed_milliseconds() / double(steps);
+		ss += std::string(names[shared]) + ": " + std::to_string(results[shared]) + " ms per step\n";
+	}
+	wi::physics::SetSharedJobSystemEnabled(shared_job_system);
+
+	ss += "\nSpeedup with engine job system: " + std::to_string(results[0] / results[1]) + "x\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunAudioStreamingBenchmark()
+{
+	wi::Timer timer;
+
+	// This loads a sound fully decoded and as a streaming sound, then decodes minutes of looped playback of the streaming sound
+	//	with the null audio output, which doesn't need audio hardware. Replace the file with a long OGG or MP3 music track to measure compressed formats.
+	const std::string filename = CONTENT_DIR "models/water.wav";
+	const float playback_seconds = 300;
+
+	std::string ss;
+	ss += "Audio streaming benchmark, " + filename + ":\n";
+	ss += "You can find out more in Tests.cpp, RunAudioStreamingBenchmark() function.\n\n";
+
+	wi::vector<uint8_t> filedata;
+	if (!wi::helper::FileRead(filename, filedata))
+	{
+		ss += "Failed to read the sound file!\n";
+	}
+	else
+	{
+		wi::audio::Sound sound;
+		timer.record();
+		const bool decoded = wi::audio::CreateSound(filedata.data(), filedata.size(), &sound);
+		const double decode_time = timer.elapsed_milliseconds();
+		if (decoded)
+		{
+			ss += "Full decode on load: " + std::to_string(decode_time) + " ms\n";
+		}
+		else
+		{
+			ss += "Full decode on load: not available (no audio device)\n";
+		}
+
+		wi::audio::Sound sound_streaming;
+		timer.record();
+		const bool streaming = wi::audio::CreateSoundStreaming(filedata.data(), filedata.size(), &sound_streaming);
+		const double streaming_time = timer.elapsed_milliseconds();
+
+		wi::audio::SoundInstance params;
+		params.SetLooped(true);
+		wi::audio::NullOutput output;
+		if (streaming && wi::audio::CreateNullOutput(&sound_streaming, &params, &output))
+		{
+			const wi::audio::SampleInfo info = wi::audio::GetSampleInfo(&sound_streaming);
+			ss += "Streaming load: " + std::to_string(streaming_time) + " ms, " + std::to_string(info.channel_count) + " channels, " + std::to_string(info.sample_rate) + " Hz\n";
+
+			const size_t frame_count = size_t(playback_seconds * info.sample_rate);
+			const size_t chunk_frames = 4096;
+			wi::vector<short> samples(chunk_frames * info.channel_count);
+			timer.record();
+			size_t rendered = 0;
+			while (rendered < frame_count)
+			{
+				const size_t count = wi::audio::RenderNullOutput(&output, samples.data(), std::min(chunk_frames, frame_count - rendered));
+				if (count == 0)
+					break;
+				rendered += count;
+			}
+			const double render_time = timer.elapsed_milliseconds();
+			const double rendered_seconds = double(wi::audio::GetTotalSamplesPlayed(&output)) / double(info.sample_rate);
+			ss += "Streaming decode of " + std::to_string(rendered_seconds) + " seconds of looped playback: " + std::to_string(render_time) + " ms (" + std::to_string(rendered_seconds * 1000.0 / std::max(0.001, render_time)) + "x realtime)\n";
+		}
+		else
+		{
+			ss += "Streaming load failed!\n";
+		}
+	}
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunBlockCompressionBenchmark()
+{
+	wi::Timer timer;
+
+	// This compresses a procedural image with the CPU block compressor into every supported format,
+	//	then decompresses it to measure the error, and finally compresses a full mip chain like texture cooking does
+	const uint32_t width = 2048;
+	const uint32_t height = 2048;
+	wi::vector<wi::Color> image(width * height);
+	wi::random::RNG rng;
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			// smooth gradients with some noise and hard edges, similar to a typical albedo texture:
+			const float fx = float(x) / float(width);
+			const float fy = float(y) / float(height);
+			const bool tile = ((x / 64) + (y / 64)) % 2 == 0;
+			const float noise = rng.next_float() * 0.1f;
+			image[x + y * width] = wi::Color::fromFloat4(XMFLOAT4(
+				wi::math::saturate(fx * 0.8f + noise),
+				wi::math::saturate(fy * 0.6f + (tile ? 0.3f : 0.0f) + noise),
+				wi::math::saturate(0.5f + 0.5f * std::sin(fx * 20) * std::cos(fy * 20) + noise),
+				tile ? 1.0f : wi::math::saturate(fx + fy)
+			));
+		}
+	}
+
+	std::string ss;
+	ss += "CPU block compression benchmark, " + std::to_string(width) + "x" + std::to_string(height) + " image, " + std::to_string(wi::jobsystem::GetThreadCount()) + " threads:\n";
+	ss += "You can find out more in Tests.cpp, RunBlockCompressionBenchmark() function.\n\n";
+
+	struct FormatInfo
+	{
+		wi::graphics::Format format;
+		const char* name;
+		uint32_t channel_count; // number of channels that the format stores from the image
+	};
+	const FormatInfo formats[] = {
+		{ wi::graphics::Format::BC1_UNORM, "BC1", 3 },
+		{ wi::graphics::Format::BC3_UNORM, "BC3", 4 },
+		{ wi::graphics::Format::BC4_UNORM, "BC4", 1 },
+		{ wi::graphics::Format::BC5_UNORM, "BC5", 2 },
+		{ wi::graphics::Format::BC7_UNORM, "BC7", 4 },
+	};
+	wi::vector<uint8_t> compressed;
+	wi::vector<wi::Color> decompressed(width * height);
+	for (const FormatInfo& info : formats)
+	{
+		timer.record();
+		wi::blockcompression::Compress(image.data(), width, height, info.format, compressed);
+		const double time = timer.elapsed_milliseconds();
+
+		wi::blockcompression::Decompress(compressed.data(), width, height, info.format, decompressed.data());
+		double error = 0;
+		for (size_t i = 0; i < image.size(); ++i)
+		{
+			for (uint32_t c = 0; c < info.channel_count; ++c)
+			{
+				const int difference = int((image[i].rgba >> (c * 8)) & 0xFF) - int((decompressed[i].rgba >> (c * 8)) & 0xFF);
+				error += double(difference * difference);
+			}
+		}
+		const double rmse = std::sqrt(error / double(image.size() * info.channel_count));
+		ss += std::string(info.name) + ": " + std::to_string(time) + " ms, " + std::to_string(double(width * height) / 1000.0 / std::max(0.001, time)) + " MPix/s, RMSE: " + std::to_string(rmse) + "\n";
+	}
+
+	wi::graphics::TextureDesc desc;
+	desc.width = width;
+	desc.height = height;
+	desc.format = wi::graphics::Format::BC3_UNORM;
+	timer.record();
+	wi::blockcompression::CompressMipChain(image.data(), desc, compressed);
+	const double mipchain_time = timer.elapsed_milliseconds();
+	ss += "\nBC3 with " + std::to_string(desc.mip_levels) + " mip levels: " + std::to_string(mipchain_time) + " ms, " + std::to_string(compressed.size() / 1024) + " KB\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunDerivedDataCacheBenchmark()
+{
+	wi::Timer timer;
+
+	// This loads the Sponza textures three times: without the derived data cache, with an empty cache (cold start) and with the filled cache (warm start)
+	//	Normal maps are imported with normal map block compression, the other textures with default block compression, and the logo is not compressed
+	struct Asset
+	{
+		std::string filename;
+		wi::resourcemanager::Flags flags;
+	};
+	wi::vector<Asset> assets;
+	assets.push_back({ CONTENT_DIR "logo_small.png", wi::resourcemanager::Flags::NONE });
+	wi::helper::GetFileNamesInDirectory(CONTENT_DIR "models/Sponza/textures/", [&](std::string filename) {
+		wi::resourcemanager::Flags flags = wi::resourcemanager::Flags::IMPORT_BLOCK_COMPRESSED;
+		if (filename.find("_ddn") != std::string::npos || filename.find("_NRM") != std::string::npos)
+		{
+			flags |= wi::resourcemanager::Flags::IMPORT_NORMALMAP;
+		}
+		assets.push_back({ filename, flags });
+	}, "png");
+
+	size_t total_size = 0;
+	for (auto& asset : assets)
+	{
+		total_size += wi::helper::FileSize(asset.filename);
+	}
+
+	auto load_assets = [&]() {
+		wi::resourcemanager::Clear();
+		wi::resourcemanager::ResetDerivedDataCacheStats();
+		wi::vector<wi::Resource> resources;
+		resources.reserve(assets.size());
+		timer.record();
+		for (auto& asset : assets)
+		{
+			resources.push_back(wi::resourcemanager::Load(asset.filename, asset.flags));
+		}
+		const double time = timer.elapsed_milliseconds();
+		resources.clear();
+		wi::resourcemanager::Clear();
+		return time;
+	};
+
+	const std::string directory = wi::helper::GetTempDirectoryPath() + "/wi_derived_data_benchmark/";
+	wi::helper::GetFileNamesInDirectory(directory, [](std::string filename) {
+		wi::helper::FileRemove(filename);
+	}, "wicache");
+
+	wi::resourcemanager::SetDerivedDataCacheDirectory("");
+	const double uncached_time = load_assets();
+
+	wi::resourcemanager::SetDerivedDataCacheDirectory(directory);
+	const double cold_time = load_assets();
+	const wi::resourcemanager::DerivedDataCacheStats cold_stats = wi::resourcemanager::GetDerivedDataCacheStats();
+
+	const double warm_time = load_assets();
+	const wi::resourcemanager::DerivedDataCacheStats warm_stats = wi::resourcemanager::GetDerivedDataCacheStats();
+
+	wi::resourcemanager::SetDerivedDataCacheDirectory("");
+
+	std::string ss;
+	ss += "Derived data cache benchmark, " + std::to_string(assets.size()) + " images, " + std::to_string(total_size / 1024 / 1024) + " MB source files:\n";
+	ss += "You can find out more in Tests.cpp, RunDerivedDataCacheBenchmark() function.\n\n";
+	ss += "Cache directory: " + directory + "\n\n";
+	ss += "No cache: " + std::to_string(uncached_time) + " ms (block compression on GPU)\n";
+	ss += "Cold start: " + std::to_string(cold_time) + " ms, hits: " + std::to_string(cold_stats.hits) + ", misses: " + std::to_string(cold_stats.misses) + ", written: " + std::to_string(cold_stats.bytes_written / 1024 / 1024) + " MB\n";
+	ss += "Warm start: " + std::to_string(warm_time) + " ms, hits: " + std::to_string(warm_stats.hits) + ", misses: " + std::to_string(warm_stats.misses) + ", read: " + std::to_string(warm_stats.bytes_read / 1024 / 1024) + " MB\n";
+	ss += "Warm start speedup: " + std::to_string(uncached_time / std::max(0.001, warm_time)) + "x compared to no cache\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunBatchLoadingBenchmark()
+{
+	wi::Timer timer;
+
+	// This loads the Sponza textures one by one with Load(), then all at once with LoadBatch()
+	//	The name list contains every texture twice, to show that LoadBatch() loads repeated names only once
+	wi::vector<std::string> names;
+	wi::helper::GetFileNamesInDirectory(CONTENT_DIR "models/Sponza/textures/", [&](std::string filename) {
+		names.push_back(filename);
+	}, "png");
+	const size_t unique_count = names.size();
+	names.insert(names.end(), names.begin(), names.end());
+
+	wi::resourcemanager::Clear();
+	wi::vector<wi::Resource> resources;
+	timer.record();
+	for (auto& name : names)
+	{
+		resources.push_back(wi::resourcemanager::Load(name));
+	}
+	const double serial_time = timer.elapsed_milliseconds();
+	resources.clear();
+	wi::resourcemanager::Clear();
+
+	timer.record();
+	wi::vector<wi::resourcemanager::LoadHandle> handles = wi::resourcemanager::LoadBatch(names);
+	const double submit_time = timer.elapsed_milliseconds();
+	wi::resourcemanager::Wait(handles);
+	const double batch_time = timer.elapsed_milliseconds();
+	size_t loaded_count = 0;
+	for (auto& handle : handles)
+	{
+		if (handle.Get().IsValid())
+		{
+			loaded_count++;
+		}
+	}
+	handles.clear();
+	wi::resourcemanager::Clear();
+
+	std::string ss;
+	ss += "Batch loading benchmark, " + std::to_string(names.size()) + " names, " + std::to_string(unique_count) + " unique images, " + std::to_string(wi::jobsystem::GetThreadCount(wi::jobsystem::Priority::Low)) + " low priority threads:\n";
+	ss += "You can find out more in Tests.cpp, RunBatchLoadingBenchmark() function.\n\n";
+	ss += "Load() one by one: " + std::to_string(serial_time) + " ms\n";
+	ss += "LoadBatch(): " + std::to_string(batch_time) + " ms (submit: " + std::to_string(submit_time) + " ms), loaded: " + std::to_string(loaded_count) + "\n";
+	ss += "Speedup: " + std::to_string(serial_time / std::max(0.001, batch_time)) + "x\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunFontAtlasBenchmark()
+{
+	wi::Timer timer;
+
+	// Text that contains Latin-1, Greek and Cyrillic characters:
+	std::wstring text;
+	for (wchar_t code = 0x21; code <= 0xFF; ++code)
+	{
+		text += code;
+	}
+	for (wchar_t code = 0x391; code <= 0x3C9; ++code)
+	{
+		text += code;
+	}
+	for (wchar_t code = 0x400; code <= 0x4FF; ++code)
+	{
+		text += code;
+	}
+
+	// The text is measured at many sizes, this requests glyphs for the atlas, which are rendered by UpdateAtlas()
+	//	SDF glyphs are shared by every size, so only the first size needs new glyphs
+	//	Bitmap glyphs are rendered for every size separately
+	const int sizes[] = { 10, 12, 14, 16, 18, 20, 24, 28, 32, 40, 48, 56, 64, 72, 96, 128 };
+	const float upscaling = GetDPIScaling();
+	wi::font::Params params;
+	params.style = 0; // default font: Liberation Sans
+
+	auto measure = [&](int size_begin, int size_end) {
+		for (int i = size_begin; i < size_end; ++i)
+		{
+			params.size = sizes[i];
+			wi::font::TextWidth(text, params);
+		}
+		timer.record();
+		wi::font::UpdateAtlas(upscaling);
+		return timer.elapsed_milliseconds();
+	};
+	const int size_count = int(arraysize(sizes));
+
+	params.enableSDFRendering();
+	const double sdf_first_time = measure(0, 1);
+	const double sdf_other_time = measure(1, size_count);
+	const uint32_t sdf_atlas_size = wi::font::GetAtlas()->desc.width;
+
+	params.disableSDFRendering();
+	const double bitmap_first_time = measure(0, 1);
+	const double bitmap_other_time = measure(1, size_count);
+	const uint32_t bitmap_atlas_size = wi::font::GetAtlas()->desc.width;
+
+	std::string ss;
+	ss += "Font atlas benchmark, " + std::to_string(text.length()) + " characters, " + std::to_string(size_count) + " sizes (" + std::to_string(sizes[0]) + " - " + std::to_string(sizes[size_count - 1]) + "):\n";
+	ss += "You can find out more in Tests.cpp, RunFontAtlasBenchmark() function.\n";
+	ss += "Glyphs that were already in the atlas (for example from previous runs) are not rendered again.\n\n";
+	ss += "SDF, first size: " + std::to_string(sdf_first_time) + " ms\n";
+	ss += "SDF, other sizes: " + std::to_string(sdf_other_time) + " ms (shared glyphs)\n";
+	ss += "Atlas size after SDF glyphs: " + std::to_string(sdf_atlas_size) + " x " + std::to_string(sdf_atlas_size) + "\n\n";
+	ss += "Bitmap, first size: " + std::to_string(bitmap_first_time) + " ms\n";
+	ss += "Bitmap, other sizes: " + std::to_string(bitmap_other_time) + " ms\n";
+	ss += "Atlas size after bitmap glyphs: " + std::to_string(bitmap_atlas_size) + " x " + std::to_string(bitmap_atlas_size) + "\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+// Creates characters for the animation benchmarks that play the same clip, every bone of a character has one channel for every path
+//	datas : the animation datas of the clip, for bone b and path p it is datas[b * paths.size() + p]
+//	returns the animation entity of the first character
+static Entity CreateAnimationBenchmarkCharacters(Scene& scene, uint32_t characterCount, uint32_t boneCount, const wi::vector<AnimationComponent::AnimationChannel::Path>& paths, const wi::vector<Entity>& datas, float end)
+{
+	Entity first = INVALID_ENTITY;
+	for (uint32_t i = 0; i < characterCount; ++i)
+	{
+		Entity entity = CreateEntity();
+		scene.names.Create(entity) = "character";
+		AnimationComponent& animation = scene.animations.Create(entity);
+		animation.end = end;
+		animation.Play(); // animations that are not playing are not scheduled by scene.Update()
+		for (uint32_t b = 0; b < boneCount; ++b)
+		{
+			Entity bone = CreateEntity();
+			scene.transforms.Create(bone);
+
+			for (size_t p = 0; p < paths.size(); ++p)
+			{
+				AnimationComponent::AnimationChannel& channel = animation.channels.emplace_back();
+				channel.target = bone;
+				channel.path = paths[p];
+				channel.samplerIndex = (int)animation.samplers.size();
+
+				AnimationComponent::AnimationSampler& sampler = animation.samplers.emplace_back();
+				sampler.data = datas[b * paths.size() + p];
+				sampler.mode = AnimationComponent::AnimationSampler::Mode::LINEAR;
+			}
+		}
+		if (first == INVALID_ENTITY)
+		{
+			first = entity;
+		}
+	}
+	scene.Update(0); // builds the animation queues
+	return first;
+}
+// Updates the animation system after stepping every animation forward by one frame, or after seeking every animation to a random time
+//	returns the average time of an update in milliseconds
+static double MeasureAnimationUpdates(Scene& scene, uint32_t iterations, bool seek)
+{
+	wi::Timer timer;
+	wi::random::RNG rng;
+	for (uint32_t i = 0; i < iterations; ++i)
+	{
+		for (size_t a = 0; a < scene.animations.GetCount(); ++a)
+		{
+			AnimationComponent& animation = scene.animations[a];
+			if (seek)
+			{
+				animation.timer = rng.next_float() * animation.end;
+			}
+			else
+			{
+				animation.timer = std::fmod(animation.timer + 1.0f / 60.0f, animation.end);
+			}
+		}
+		wi::jobsystem::context ctx;
+		scene.RunAnimationUpdateSystem(ctx);
+		wi::jobsystem::Wait(ctx);
+	}
+	return timer.elapsed_milliseconds() / double(iterations);
+}
+void TestsRenderer::RunAnimationBenchmark()
+{
+	// This creates a separate scene with characters that play the same long clip (like motion capture), every channel animates the rotation of a transform
+	//	The animation system is measured with playback in order (keyframe cursors) and with random seeking (binary search)
+	const uint32_t characterCount = 200;
+	const uint32_t channelCount = 64;
+	const uint32_t keyframeCount = 6000; // 100 seconds at 60 FPS
+	const float keyframeRate = 60;
+	const uint32_t iterations = 60;
+
+	Scene scene;
+	wi::vector<Entity> datas;
+	for (uint32_t c = 0; c < channelCount; ++c)
+	{
+		Entity entity = CreateEntity();
+		AnimationDataComponent& animationdata = scene.animation_datas.Create(entity);
+		animationdata.keyframe_times.resize(keyframeCount);
+		animationdata.keyframe_data.resize(keyframeCount * 4);
+		for (uint32_t k = 0; k < keyframeCount; ++k)
+		{
+			animationdata.keyframe_times[k] = float(k) / keyframeRate;
+			XMFLOAT4 rotation;
+			XMStoreFloat4(&rotation, XMQuaternionRotationRollPitchYaw(std::sin(k * 0.01f + c), std::cos(k * 0.02f + c), 0));
+			std::memcpy(&animationdata.keyframe_data[k * 4], &rotation, sizeof(rotation));
+		}
+		datas.push_back(entity);
+	}
+	CreateAnimationBenchmarkCharacters(scene, characterCount, channelCount, { AnimationComponent::AnimationChannel::Path::ROTATION }, datas, float(keyframeCount - 1) / keyframeRate);
+
+	const double channels_per_update = double(characterCount) * double(channelCount);
+	const double playback_time = MeasureAnimationUpdates(scene, iterations, false);
+	const double seek_time = MeasureAnimationUpdates(scene, iterations, true);
+
+	std::string ss;
+	ss += "Animation benchmark, " + std::to_string(characterCount) + " characters, " + std::to_string(channelCount) + " channels each, " + std::to_string(keyframeCount) + " keyframes per channel, average of " + std::to_string(iterations) + " updates:\n";
+	ss += "You can find out more in Tests.cpp, RunAnimationBenchmark() function.\n\n";
+	ss += "Playback in order: " + std::to_string(playback_time) + " ms, " + std::to_string(channels_per_update / std::max(0.0001, playback_time)) + " channels/ms\n";
+	ss += "Random seeking: " + std::to_string(seek_time) + " ms, " + std::to_string(channels_per_update / std::max(0.0001, seek_time)) + " channels/ms\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunAnimationCompressionBenchmark()
+{
+	wi::Timer timer;
+
+	// This creates a separate scene with characters that play the same smooth clip (like motion capture), every bone has a rotation and a translation channel
+	//	The clip is sampled from the raw floats first, then it is compressed and sampled again
+	const uint32_t characterCount = 200;
+	const uint32_t boneCount = 32;
+	const uint32_t keyframeCount = 6000; // 100 seconds at 60 FPS
+	const float keyframeRate = 60;
+	const uint32_t iterations = 60;
+	const uint32_t errorSamples = 100;
+
+	Scene scene;
+	wi::vector<Entity> datas; // rotation and translation data for every bone
+	for (uint32_t b = 0; b < boneCount; ++b)
+	{
+		Entity entity = CreateEntity();
+		AnimationDataComponent& rotation_data = scene.animation_datas.Create(entity);
+		datas.push_back(entity);
+		entity = CreateEntity();
+		AnimationDataComponent& translation_data = scene.animation_datas.Create(entity);
+		datas.push_back(entity);
+
+		rotation_data.keyframe_times.resize(keyframeCount);
+		rotation_data.keyframe_data.resize(keyframeCount * 4);
+		translation_data.keyframe_times.resize(keyframeCount);
+		translation_data.keyframe_data.resize(keyframeCount * 3);
+		for (uint32_t k = 0; k < keyframeCount; ++k)
+		{
+			const float time = float(k) / keyframeRate;
+			rotation_data.keyframe_times[k] = time;
+			translation_data.keyframe_times[k] = time;
+			XMFLOAT4 rotation;
+			XMStoreFloat4(&rotation, XMQuaternionRotationRollPitchYaw(std::sin(time * 1.3f + b) * 0.8f, std::cos(time * 0.7f + b) * 1.5f, std::sin(time * 2.1f) * 0.3f));
+			std::memcpy(&rotation_data.keyframe_data[k * 4], &rotation, sizeof(rotation));
+			const XMFLOAT3 translation = XMFLOAT3(std::sin(time * 0.5f + b) * 2, std::abs(std::sin(time * 3.0f)) * 0.2f, time * 0.01f);
+			std::memcpy(&translation_data.keyframe_data[k * 3], &translation, sizeof(translation));
+		}
+	}
+	// Every character uses the same animation datas, the first animation is used for compression:
+	const Entity clip = CreateAnimationBenchmarkCharacters(scene, characterCount, boneCount, { AnimationComponent::AnimationChannel::Path::ROTATION, AnimationComponent::AnimationChannel::Path::TRANSLATION }, datas, float(keyframeCount - 1) / keyframeRate);
+
+	auto memory_size = [&]() {
+		size_t size = 0;
+		for (size_t i = 0; i < scene.animation_datas.GetCount(); ++i)
+		{
+			size += scene.animation_datas[i].GetMemorySizeInBytes();
+		}
+		return size;
+	};
+	const double channels_per_update = double(characterCount) * double(boneCount * 2);
+	// Samples the pose of the first character at the same times for both representations:
+	const AnimationComponent& first_animation = *scene.animations.GetComponent(clip);
+	auto sample_pose = [&](wi::vector<XMFLOAT4>& rotations, wi::vector<XMFLOAT3>& translations) {
+		wi::random::RNG rng;
+		rotations.clear();
+		translations.clear();
+		for (uint32_t i = 0; i < errorSamples; ++i)
+		{
+			const float time = rng.next_float() * first_animation.end;
+			for (size_t a = 0; a < scene.animations.GetCount(); ++a)
+			{
+				scene.animations[a].timer = time;
+			}
+			wi::jobsystem::context ctx;
+			scene.RunAnimationUpdateSystem(ctx);
+			wi::jobsystem::Wait(ctx);
+			for (size_t c = 0; c < first_animation.channels.size(); c += 2)
+			{
+				const TransformComponent& transform = *scene.transforms.GetComponent(first_animation.channels[c].target);
+				rotations.push_back(transform.rotation_local);
+				translations.push_back(transform.translation_local);
+			}
+		}
+	};
+
+	const size_t raw_size = memory_size();
+	const double raw_time = MeasureAnimationUpdates(scene, iterations, false);
+	wi::vector<XMFLOAT4> raw_rotations;
+	wi::vector<XMFLOAT3> raw_translations;
+	sample_pose(raw_rotations, raw_translations);
+
+	timer.record();
+	scene.CompressAnimation(clip);
+	const double compression_time = timer.elapsed_milliseconds();
+
+	const size_t compressed_size = memory_size();
+	const double compressed_time = MeasureAnimationUpdates(scene, iterations, false);
+	wi::vector<XMFLOAT4> compressed_rotations;
+	wi::vector<XMFLOAT3> compressed_translations;
+	sample_pose(compressed_rotations, compressed_translations);
+
+	float rotation_error = 0;
+	float translation_error = 0;
+	for (size_t i = 0; i < raw_rotations.size(); ++i)
+	{
+		XMVECTOR A = XMLoadFloat4(&raw_rotations[i]);
+		XMVECTOR B = XMLoadFloat4(&compressed_rotations[i]);
+		if (XMVectorGetX(XMQuaternionDot(A, B)) < 0)
+		{
+			B = XMVectorNegate(B);
+		}
+		rotation_error = std::max(rotation_error, XMVectorGetX(XMVector4Length(A - B)));
+		translation_error = std::max(translation_error, XMVectorGetX(XMVector3Length(XMLoadFloat3(&raw_translations[i]) - XMLoadFloat3(&compressed_translations[i]))));
+	}
+
+	std::string ss;
+	ss += "Animation compression benchmark, " + std::to_string(characterCount) + " characters, " + std::to_string(boneCount) + " bones with rotation and translation channels, " + std::to_string(keyframeCount) + " keyframes per channel:\n";
+	ss += "You can find out more in Tests.cpp, RunAnimationCompressionBenchmark() function.\n\n";
+	ss += "Raw floats: " + std::to_string(raw_size / 1024) + " KB, " + std::to_string(channels_per_update / std::max(0.0001, raw_time)) + " channels/ms\n";
+	ss += "Compressed: " + std::to_string(compressed_size / 1024) + " KB, " + std::to_string(channels_per_update / std::max(0.0001, compressed_time)) + " channels/ms\n";
+	ss += "Compression ratio: " + std::to_string(double(raw_size) / double(std::max(size_t(1), compressed_size))) + " : 1, compression time: " + std::to_string(compression_time) + " ms\n";
+	ss += "Largest error of " + std::to_string(errorSamples) + " sampled poses: rotation (quaternion distance): " + std::to_string(rotation_error) + ", translation: " + std::to_string(translation_error) + "\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunSceneQueryBenchmark()
+{
+	wi::Timer timer;
+
+	// This creates a separate scene with a lot of cubes at random places, and measures the ray, sphere and capsule intersection queries
+	//	with the object BVH and with testing every object (the object BVH is turned off for that by marking it not valid)
+	const uint32_t objectCount = 100000;
+	const uint32_t queryCount = 1000;
+
+	Scene scene;
+	Entity cube = scene.Entity_CreateCube("cube");
+	wi::random::RNG rng(42);
+	for (uint32_t i = 0; i < objectCount; ++i)
+	{
+		Entity entity = CreateEntity();
+		scene.layers.Create(entity);
+		TransformComponent& transform = scene.transforms.Create(entity);
+		transform.Translate(XMFLOAT3(rng.next_float(-500, 500), rng.next_float(-20, 20), rng.next_float(-500, 500)));
+		transform.Scale(XMFLOAT3(rng.next_float(0.2f, 2), rng.next_float(0.2f, 2), rng.next_float(0.2f, 2)));
+		ObjectComponent& object = scene.objects.Create(entity);
+		object.meshID = cube;
+	}
+
+	scene.Update(0); // first transform update, starts the object BVH build
+	timer.record();
+	wi::jobsystem::Wait(scene.object_bvh_workload);
+	const double build_time = timer.elapsed_milliseconds();
+	scene.Update(0); // takes the built object BVH
+
+	wi::vector<wi::primitive::Ray> rays;
+	wi::vector<wi::primitive::Sphere> spheres;
+	wi::vector<wi::primitive::Capsule> capsules;
+	for (uint32_t i = 0; i < queryCount; ++i)
+	{
+		const XMFLOAT3 origin = XMFLOAT3(rng.next_float(-500, 500), rng.next_float(-20, 20), rng.next_float(-500, 500));
+		const XMFLOAT3 direction = XMFLOAT3(rng.next_float(-1, 1), rng.next_float(-0.1f, 0.1f), rng.next_float(-1, 1));
+		rays.emplace_back(XMLoadFloat3(&origin), XMVector3Normalize(XMLoadFloat3(&direction)), 0.0f, 200.0f);
+		spheres.emplace_back(origin, rng.next_float(0.5f, 5));
+		capsules.emplace_back(origin, XMFLOAT3(origin.x + rng.next_float(-5, 5), origin.y + rng.next_float(-5, 5), origin.z + rng.next_float(-5, 5)), rng.next_float(0.2f, 2));
+	}
+
+	const char* names[] = { "Rays", "Spheres", "Capsules" };
+	double queries_per_second[2][3] = {};
+	wi::vector<Entity> hit_entities[2];
+	const bool bvh_valid = scene.IsObjectBVHValid();
+	for (int bvh = 1; bvh >= 0; --bvh)
+	{
+		scene.object_bvh_valid = bvh != 0 && bvh_valid;
+		for (int type = 0; type < 3; ++type)
+		{
+			timer.record();
+			for (uint32_t i = 0; i < queryCount; ++i)
+			{
+				switch (type)
+				{
+				default:
+				case 0:
+					hit_entities[bvh].push_back(scene.Intersects(rays[i]).entity);
+					break;
+				case 1:
+					hit_entities[bvh].push_back(scene.Intersects(spheres[i]).entity);
+					break;
+				case 2:
+					hit_entities[bvh].push_back(scene.Intersects(capsules[i]).entity);
+					break;
+				}
+			}
+			queries_per_second[bvh][type] = double(queryCount) / std::max(0.0001, timer.elapsed_seconds());
+		}
+	}
+	scene.object_bvh_valid = bvh_valid;
+
+	std::string ss;
+	ss += "Scene query benchmark, " + std::to_string(objectCount) + " objects, " + std::to_string(queryCount) + " closest hit queries of each type:\n";
+	ss += "You can find out more in Tests.cpp, RunSceneQueryBenchmark() function.\n\n";
+	ss += "Object BVH build (background): " + std::to_string(build_time) + " ms";
+	ss += bvh_valid ? "\n" : " (ERROR: object BVH is not valid!)\n";
+	for (int type = 0; type < 3; ++type)
+	{
+		ss += std::string(names[type]) + ": object BVH: " + std::to_string(uint64_t(queries_per_second[1][type])) + " queries/s, all objects: " + std::to_string(uint64_t(queries_per_second[0][type])) + " queries/s, speedup: " + std::to_string(queries_per_second[1][type] / std::max(0.0001, queries_per_second[0][type])) + "x\n";
+	}
+	ss += hit_entities[0] == hit_entities[1] ? "The results are the same\n" : "ERROR: results mismatch!\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunSkinnedQueryBenchmark()
+{
+	wi::Timer timer;
+
+	// This creates a separate scene with instances of a skinned mesh (a bending strip of triangles), the bones are moved in every frame
+	//	The ray, sphere and capsule queries are measured without the skinned position cache (skinning vertices for every tested triangle, without mesh BVH)
+	//	and with the cache (skinning the whole mesh once per frame, and using the mesh BVH refitted to the skinned positions)
+	const uint32_t instanceCount = 16;
+	const uint32_t boneCount = 8;
+	const uint32_t gridWidth = 16;
+	const uint32_t gridHeight = 256;
+	const float boneLength = 1;
+	const uint32_t frameCount = 4;
+	const uint32_t queryCount = 100;
+
+	Scene scene;
+	Entity armatureEntity = CreateEntity();
+	scene.transforms.Create(armatureEntity);
+	ArmatureComponent& armature = scene.armatures.Create(armatureEntity);
+	for (uint32_t b = 0; b < boneCount; ++b)
+	{
+		Entity bone = CreateEntity();
+		TransformComponent& transform = scene.transforms.Create(bone);
+		transform.Translate(XMFLOAT3(0, b * boneLength, 0));
+		armature.boneCollection.push_back(bone);
+		XMFLOAT4X4& inverseBindMatrix = armature.inverseBindMatrices.emplace_back();
+		XMStoreFloat4x4(&inverseBindMatrix, XMMatrixTranslation(0, -(b * boneLength), 0));
+	}
+
+	Entity meshEntity = CreateEntity();
+	MeshComponent& mesh = scene.meshes.Create(meshEntity);
+	mesh.armatureID = armatureEntity;
+	for (uint32_t y = 0; y <= gridHeight; ++y)
+	{
+		for (uint32_t x = 0; x <= gridWidth; ++x)
+		{
+			const float height = float(y) / float(gridHeight) * (boneCount - 1) * boneLength;
+			mesh.vertex_positions.push_back(XMFLOAT3(float(x) / float(gridWidth) - 0.5f, height, std::sin(x * 0.5f) * 0.2f));
+			mesh.vertex_normals.push_back(XMFLOAT3(0, 0, -1));
+			const float bone = height / boneLength;
+			const uint32_t bone0 = std::min(uint32_t(bone), boneCount - 1);
+			const uint32_t bone1 = std::min(bone0 + 1, boneCount - 1);
+			const float weight1 = bone - float(bone0);
+			mesh.vertex_boneindices.push_back(XMUINT4(bone0, bone1, 0, 0));
+			mesh.vertex_boneweights.push_back(XMFLOAT4(1 - weight1, weight1, 0, 0));
+		}
+	}
+	for (uint32_t y = 0; y < gridHeight; ++y)
+	{
+		for (uint32_t x = 0; x < gridWidth; ++x)
+		{
+			const uint32_t i0 = y * (gridWidth + 1) + x;
+			const uint32_t i1 = i0 + 1;
+			const uint32_t i2 = i0 + gridWidth + 1;
+			const uint32_t i3 = i2 + 1;
+			mesh.indices.push_back(i0);
+			mesh.indices.push_back(i1);
+			mesh.indices.push_back(i3);
+			mesh.indices.push_back(i0);
+			mesh.indices.push_back(i3);
+			mesh.indices.push_back(i2);
+		}
+	}
+	MeshComponent::MeshSubset& subset = mesh.subsets.emplace_back();
+	subset.indexCount = (uint32_t)mesh.indices.size();
+	mesh.CreateRenderData();
+
+	for (uint32_t i = 0; i < instanceCount; ++i)
+	{
+		Entity entity = CreateEntity();
+		scene.layers.Create(entity);
+		TransformComponent& transform = scene.transforms.Create(entity);
+		transform.Translate(XMFLOAT3(float(i % 4) * 3, 0, float(i / 4) * 3));
+		ObjectComponent& object = scene.objects.Create(entity);
+		object.meshID = meshEntity;
+	}
+
+	wi::random::RNG rng(42);
+	wi::vector<wi::primitive::Ray> rays;
+	wi::vector<wi::primitive::Sphere> spheres;
+	wi::vector<wi::primitive::Capsule> capsules;
+	for (uint32_t i = 0; i < queryCount; ++i)
+	{
+		const XMFLOAT3 origin = XMFLOAT3(rng.next_float(-1, 10), rng.next_float(0, 7), rng.next_float(-1, 10));
+		const XMFLOAT3 direction = XMFLOAT3(rng.next_float(-1, 1), rng.next_float(-0.2f, 0.2f), rng.next_float(-1, 1));
+		rays.emplace_back(XMLoadFloat3(&origin), XMVector3Normalize(XMLoadFloat3(&direction)), 0.0f, 20.0f);
+		spheres.emplace_back(origin, rng.next_float(0.1f, 0.5f));
+		capsules.emplace_back(origin, XMFLOAT3(origin.x + rng.next_float(-1, 1), origin.y + rng.next_float(-1, 1), origin.z + rng.next_float(-1, 1)), rng.next_float(0.05f, 0.2f));
+	}
+
+	double query_time[2] = {};
+	wi::vector<Entity> hit_entities[2];
+	uint32_t hit_count = 0;
+	for (int cache = 0; cache < 2; ++cache)
+	{
+		// The uncached queries can't use the mesh BVH, because it is built from the bind pose
+		scene.skinned_position_cache_enabled = cache != 0;
+		mesh.SetBVHEnabled(cache != 0);
+		for (uint32_t frame = 0; frame < frameCount; ++frame)
+		{
+			for (uint32_t b = 0; b < boneCount; ++b)
+			{
+				TransformComponent& transform = *scene.transforms.GetComponent(armature.boneCollection[b]);
+				transform.ClearTransform();
+				transform.RotateRollPitchYaw(XMFLOAT3(std::sin(frame + b * 0.5f) * 0.3f, 0, std::cos(frame + b * 0.5f) * 0.3f));
+				transform.Translate(XMFLOAT3(0, b * boneLength, 0));
+			}
+			scene.Update(0);
+
+			timer.record();
+			for (uint32_t i = 0; i < queryCount; ++i)
+			{
+				hit_entities[cache].push_back(scene.Intersects(rays[i]).entity);
+				hit_entities[cache].push_back(scene.Intersects(spheres[i]).entity);
+				hit_entities[cache].push_back(scene.Intersects(capsules[i]).entity);
+			}
+			query_time[cache] += timer.elapsed_milliseconds();
+		}
+	}
+	for (Entity entity : hit_entities[1])
+	{
+		hit_count += entity != INVALID_ENTITY ? 1 : 0;
+	}
+
+	std::string ss;
+	ss += "Skinned query benchmark, " + std::to_string(instanceCount) + " instances of a skinned mesh with " + std::to_string(mesh.indices.size() / 3) + " triangles, " + std::to_string(frameCount) + " frames, " + std::to_string(queryCount) + " ray, sphere and capsule queries per frame:\n";
+	ss += "You can find out more in Tests.cpp, RunSkinnedQueryBenchmark() function.\n\n";
+	ss += "Without skinned position cache: " + std::to_string(query_time[0] / frameCount) + " ms per frame\n";
+	ss += "With skinned position cache: " + std::to_string(query_time[1] / frameCount) + " ms per frame, speedup: " + std::to_string(query_time[0] / std::max(0.0001, query_time[1])) + "x\n";
+	ss += "Hits: " + std::to_string(hit_count) + " / " + std::to_string(hit_entities[1].size()) + "\n";
+	ss += hit_entities[0] == hit_entities[1] ? "The results are the same\n" : "ERROR: results mismatch!\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunCharacterSystemsBenchmark()
+{
+	wi::Timer timer;
+
+	// This creates a separate scene with simple humanoid skeletons that have IK on the feet and hands (the hand chains share the chest bone),
+	//	and expression masters with morph target bindings (every mesh is shared by two masters), then measures the expression and procedural animation systems
+	//	with the batched processing and with the serial processing on a copy of the scene, and checks that the results are the same
+	const uint32_t characterCount = 200;
+	const uint32_t expressionCount = 16;
+	const uint32_t frameCount = 60;
+
+	Scene scene;
+	scene.dt = 1.0f / 60.0f;
+	wi::random::RNG rng(42);
+	auto create_bone = [&](Entity parent, const XMFLOAT3& position) {
+		Entity entity = CreateEntity();
+		TransformComponent& transform = scene.transforms.Create(entity);
+		transform.translation_local = position;
+		transform.RotateRollPitchYaw(XMFLOAT3(rng.next_float(-0.3f, 0.3f), rng.next_float(-0.3f, 0.3f), rng.next_float(-0.3f, 0.3f)));
+		if (parent != INVALID_ENTITY)
+		{
+			scene.hierarchy.Create(entity).parentID = parent;
+		}
+		return entity;
+	};
+	Entity meshEntity = INVALID_ENTITY;
+	for (uint32_t i = 0; i < characterCount; ++i)
+	{
+		Entity root = create_bone(INVALID_ENTITY, XMFLOAT3(i * 2.0f, 1, 0));
+		Entity spine = create_bone(root, XMFLOAT3(0, 0.3f, 0));
+		Entity chest = create_bone(spine, XMFLOAT3(0, 0.3f, 0));
+		HumanoidComponent& humanoid = scene.humanoids.Create(CreateEntity());
+		for (int side = 0; side < 2; ++side)
+		{
+			const float sign = side == 0 ? -1.0f : 1.0f;
+			Entity shoulder = create_bone(chest, XMFLOAT3(sign * 0.2f, 0.1f, 0));
+			Entity upper_arm = create_bone(shoulder, XMFLOAT3(sign * 0.1f, 0, 0));
+			Entity lower_arm = create_bone(upper_arm, XMFLOAT3(sign * 0.3f, 0, 0));
+			Entity hand = create_bone(lower_arm, XMFLOAT3(sign * 0.3f, 0, 0));
+			Entity upper_leg = create_bone(root, XMFLOAT3(sign * 0.1f, -0.1f, 0));
+			Entity lower_leg = create_bone(upper_leg, XMFLOAT3(0, -0.4f, 0.01f));
+			Entity foot = create_bone(lower_leg, XMFLOAT3(0, -0.4f, -0.01f));
+			humanoid.bones[size_t(side == 0 ? HumanoidComponent::HumanoidBone::LeftUpperLeg : HumanoidComponent::HumanoidBone::RightUpperLeg)] = upper_leg;
+			humanoid.bones[size_t(side == 0 ? HumanoidComponent::HumanoidBone::LeftLowerLeg : HumanoidComponent::HumanoidBone::RightLowerLeg)] = lower_leg;
+			humanoid.bones[size_t(side == 0 ? HumanoidComponent::HumanoidBone::LeftFoot : HumanoidComponent::HumanoidBone::RightFoot)] = foot;
+
+			InverseKinematicsComponent& foot_ik = scene.inverse_kinematics.Create(foot);
+			foot_ik.use_target_position = true;
+			foot_ik.target_position = XMFLOAT3(i * 2.0f + sign * 0.1f, 0.2f, 0.1f);
+			foot_ik.chain_length = 2;
+			foot_ik.iteration_count = 10;
+
+			InverseKinematicsComponent& hand_ik = scene.inverse_kinematics.Create(hand);
+			hand_ik.use_target_position = true;
+			hand_ik.target_position = XMFLOAT3(i * 2.0f + sign * 0.3f, 1.5f, 0.4f);
+			hand_ik.chain_length = 4;
+			hand_ik.iteration_count = 5;
+		}
+
+		if ((i % 2) == 0)
+		{
+			meshEntity = CreateEntity();
+			MeshComponent& mesh = scene.meshes.Create(meshEntity);
+			mesh.morph_targets.resize(expressionCount);
+		}
+		ExpressionComponent& expression_mastering = scene.expressions.Create(CreateEntity());
+		for (uint32_t e = 0; e < expressionCount; ++e)
+		{
+			ExpressionComponent::Expression& expression = expression_mastering.expressions.emplace_back();
+			ExpressionComponent::Expression::MorphTargetBinding& binding = expression.morph_target_bindings.emplace_back();
+			binding.meshID = meshEntity;
+			binding.index = (int)e;
+			binding.weight = 1;
+		}
+		expression_mastering.presets[(int)ExpressionComponent::Preset::Blink] = 0;
+		expression_mastering.presets[(int)ExpressionComponent::Preset::LookUp] = 1;
+		expression_mastering.presets[(int)ExpressionComponent::Preset::LookDown] = 2;
+		expression_mastering.presets[(int)ExpressionComponent::Preset::LookLeft] = 3;
+		expression_mastering.presets[(int)ExpressionComponent::Preset::LookRight] = 4;
+		expression_mastering.look_frequency = 0.5f;
+		expression_mastering.blink_frequency = 2;
+	}
+
+	// The reference scene has copies of the same components (with the same entities), and it processes every item in one batch in the serial order:
+	Scene reference;
+	reference.dt = scene.dt;
+	reference.character_systems_batching_enabled = false;
+	reference.transforms.Copy(scene.transforms);
+	reference.hierarchy.Copy(scene.hierarchy);
+	reference.humanoids.Copy(scene.humanoids);
+	reference.inverse_kinematics.Copy(scene.inverse_kinematics);
+	reference.meshes.Copy(scene.meshes);
+	reference.expressions.Copy(scene.expressions);
+
+	// The batched results must be exactly the same as the serial ones, they are compared after every frame:
+	auto is_same = [&]() {
+		for (size_t i = 0; i < scene.transforms.GetCount(); ++i)
+		{
+			const TransformComponent& a = scene.transforms[i];
+			const TransformComponent& b = reference.transforms[i];
+			if (std::memcmp(&a.scale_local, &b.scale_local, sizeof(a.scale_local)) != 0 ||
+				std::memcmp(&a.rotation_local, &b.rotation_local, sizeof(a.rotation_local)) != 0 ||
+				std::memcmp(&a.translation_local, &b.translation_local, sizeof(a.translation_local)) != 0 ||
+				std::memcmp(&a.world, &b.world, sizeof(a.world)) != 0)
+				return false;
+		}
+		for (size_t i = 0; i < scene.meshes.GetCount(); ++i)
+		{
+			const MeshComponent& a = scene.meshes[i];
+			const MeshComponent& b = reference.meshes[i];
+			for (size_t m = 0; m < a.morph_targets.size(); ++m)
+			{
+				if (std::memcmp(&a.morph_targets[m].weight, &b.morph_targets[m].weight, sizeof(float)) != 0)
+					return false;
+			}
+		}
+		return true;
+	};
+
+	double expression_time[2] = {}; // 0: serial, 1: batched
+	double procedural_time[2] = {};
+	bool same = true;
+	for (uint32_t frame = 0; frame < frameCount; ++frame)
+	{
+		for (int batched = 0; batched < 2; ++batched)
+		{
+			Scene& current = batched ? scene : reference;
+			wi::jobsystem::context ctx;
+			current.RunTransformUpdateSystem(ctx);
+			wi::jobsystem::Wait(ctx);
+			current.RunHierarchyUpdateSystem(ctx);
+			wi::jobsystem::Wait(ctx);
+
+			timer.record();
+			current.RunExpressionUpdateSystem(ctx);
+			wi::jobsystem::Wait(ctx);
+			expression_time[batched] += timer.elapsed_milliseconds();
+
+			timer.record();
+			current.RunProceduralAnimationUpdateSystem(ctx);
+			wi::jobsystem::Wait(ctx);
+			procedural_time[batched] += timer.elapsed_milliseconds();
+		}
+		same = same && is_same();
+	}
+
+	std::string ss;
+	ss += "Character systems benchmark, " + std::to_string(characterCount) + " characters with " + std::to_string(scene.inverse_kinematics.GetCount()) + " IK chains and " + std::to_string(expressionCount) + " expressions each, average of " + std::to_string(frameCount) + " frames:\n";
+	ss += "You can find out more in Tests.cpp, RunCharacterSystemsBenchmark() function.\n\n";
+	ss += "Expression system: batched: " + std::to_string(expression_time[1] / frameCount) + " ms, serial: " + std::to_string(expression_time[0] / frameCount) + " ms\n";
+	ss += "Procedural animation system (IK, look at, colliders, springs): batched: " + std::to_string(procedural_time[1] / frameCount) + " ms, serial: " + std::to_string(procedural_time[0] / frameCount) + " ms\n";
+	ss += same ? "The results are the same\n" : "ERROR: results mismatch!\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
 void TestsRenderer::RunFontTest()
 {
 	static wi::SpriteFont font;
@@ -11,6 +11,22 @@ public:
 	void ResizeLayout() override;
 
 	void RunJobSystemTest();
+	void RunJobSystemBenchmark();
+	void RunObjectUpdateBenchmark();
+	void RunBVHBenchmark();
+	void RunFrustumCullingBenchmark();
+	void RunOcclusionCullingBenchmark();
+	void RunPhysicsJobSystemBenchmark();
+	void RunAudioStreamingBenchmark();
+	void RunBlockCompressionBenchmark();
+	void RunDerivedDataCacheBenchmark();
+	void RunBatchLoadingBenchmark();
+	void RunFontAtlasBenchmark();
+	void RunAnimationBenchmark();
+	void RunAnimationCompressionBenchmark();
+	void RunSceneQueryBenchmark();
+	void RunSkinnedQueryBenchmark();
+	void RunCharacterSystemsBenchmark();
 	void RunFontTest();
 	void RunSpriteTest();
 	void RunNetworkTest();
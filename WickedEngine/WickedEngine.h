@@ -55,6 +55,8 @@
 #include "wiRectPacker.h"
 #include "wiProfiler.h"
 #include "wiOcean.h"
+#include "wiOcclusionBuffer.h"
+#include "wiBlockCompression.h"
 #include "wiFFTGenerator.h"
 #include "wiArguments.h"
 #include "wiGPUBVH.h"
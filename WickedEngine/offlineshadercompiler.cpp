@@ -405,7 +405,8 @@ int main(int argc, char* argv[])
 	*out << "\tmetal : \t\tCompile shaders to Apple Metal format (using dxcompiler and metal shader converter)\n";
 	*out << "\thlsl6_xs : \t\tCompile shaders to hlsl6 Xbox Series native (dx12) format (requires Xbox SDK)\n";
 	*out << "\tps5 : \t\t\tCompile shaders to PlayStation 5 native format (requires PlayStation 5 SDK)\n";
-	*out << "\trebuild : \t\tAll shaders will be rebuilt, regardless if they are outdated or not\n";
+	*out << "\trebuild : \t\tAll shaders will be rebuilt, regardless if they are outdated or not (the shader cache is not used)\n";
+	*out << "\tnoshadercache : \tDisable the shared shader cache, outdated shaders will always be compiled\n";
 	*out << "\tdisable_optimization : \tShaders will be compiled without optimizations\n";
 	*out << "\tstrip_reflection : \tReflection will be stripped from shader binary to reduce file size\n";
 	*out << "\tshaderdump : \t\tShaders will be saved to wiShaderDump.h C++ header file (can be combined with \"rebuild\")\n";
@@ -462,6 +463,13 @@ int main(int argc, char* argv[])
 		*out << "rebuild ";
 	}
 
+	bool shadercache_enabled = !rebuild;
+	if (wi::arguments::HasArgument("noshadercache"))
+	{
+		shadercache_enabled = false;
+		*out << "noshadercache ";
+	}
+
 	if (wi::arguments::HasArgument("disable_optimization"))
 	{
 		compile_flags |= wi::shadercompiler::Flags::DISABLE_OPTIMIZATION;
@@ -624,6 +632,13 @@ int main(int argc, char* argv[])
 	static std::string SHADERSOURCEPATH = wi::renderer::GetShaderSourcePath();
 	wi::helper::MakePathAbsolute(SHADERSOURCEPATH);
 
+	if (shadercache_enabled)
+	{
+		// The shader cache is in a user specific location, so it is shared by every branch and build tree
+		wi::shadercompiler::SetShaderCacheDirectory(wi::helper::GetCacheDirectoryPath() + "/WickedEngine/shadercache/");
+		*out << "[Wicked Engine Offline Shader Compiler] Shader cache: " << wi::shadercompiler::GetShaderCacheDirectory() << "\n";
+	}
+
 	*out << "[Wicked Engine Offline Shader Compiler] Searching for outdated shaders...\n";
 	wi::Timer timer;
 	static int errors = 0;
@@ -728,7 +743,7 @@ int main(int argc, char* argv[])
 						{
 							std::cerr << output.error_message << "\n";
 						}
-						*out << "shader compiled: " << shaderbinaryfilename << "\n";
+						*out << (output.cache_hit ? "shader from cache: " : "shader compiled: ") << shaderbinaryfilename << " (" << std::fixed << std::setprecision(1) << output.compile_time << " ms)" << std::defaultfloat << "\n";
 						if (shaderdump_enabled)
 						{
 							results[shaderbinaryfilename] = output;
@@ -751,6 +766,18 @@ int main(int argc, char* argv[])
 
 	*out << "[Wicked Engine Offline Shader Compiler] Finished in " << std::setprecision(4) << timer.elapsed_seconds() << " seconds with " << errors << " errors\n";
 
+	if (shadercache_enabled)
+	{
+		const wi::shadercompiler::ShaderCacheStats stats = wi::shadercompiler::GetShaderCacheStats();
+		const uint32_t total = stats.hits + stats.misses;
+		*out << "[Wicked Engine Offline Shader Compiler] Shader cache: " << stats.hits << " hits, " << stats.misses << " misses";
+		if (total > 0)
+		{
+			*out << " (hit rate: " << std::setprecision(3) << (100.0 * stats.hits / total) << "%)";
+		}
+		*out << "\n";
+	}
+
 	if (shaderdump_enabled)
 	{
 		*out << "[Wicked Engine Offline Shader Compiler] Creating ShaderDump...\n";
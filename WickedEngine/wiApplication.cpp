@@ -55,6 +55,11 @@ namespace wi
 
 		alwaysactive = wi::arguments::HasArgument("alwaysactive");
 
+		if (wi::arguments::HasArgument("jobstealing"))
+		{
+			wi::jobsystem::SetWorkStealingEnabled(true);
+		}
+
 		// Note: lua is always initialized immediately on main thread by wi::initializer, so this is safe to do:
 		assert(wi::initializer::IsInitializeFinished(wi::initializer::INITIALIZED_SYSTEM_LUA));
 		Luna<wi::lua::Application_BindLua>::push_global(wi::lua::GetLuaState(), "main", this);
@@ -1,6 +1,7 @@
 #include "wiArchive.h"
 #include "wiHelper.h"
 #include "wiTextureHelper.h"
+#include "wiJobSystem.h"
 
 #include "Utility/stb_image.h"
 
@@ -11,11 +12,23 @@
 // - Thumbnail data [optional] (offset = sizeof(Header), size = header.properties.bits.thumbnail_data_size)
 //		- JPEG compressed image if header.properties.bits.thumbnail_data_size > 0
 // - Data [optionally compressed] (offset = sizeof(Header) + header.properties.bits.thumbnail_data_size, size = remaining)
+//
+// Chunked archive memory layout (header.properties.bits.chunked == 1):
+// - Header (offset = 0, size = uint64_t * 2)
+// - Thumbnail data [optional] (offset = sizeof(Header), size = header.properties.bits.thumbnail_data_size)
+// - uint64_t chunks_size
+// - uint64_t toc_size
+// - Chunks (size = chunks_size)
+//		- each chunk is optionally compressed independently
+// - Table of contents (size = toc_size)
+//		- uint64_t chunk_count
+//		- for each chunk: string name, uint64_t offset (relative to the start of chunks), uint64_t size, uint64_t uncompressed_size, bool compressed
+// - Data [optionally compressed] (size = remaining)
 
 namespace wi
 {
 	// this should always be only INCREMENTED and only if a new serialization is implemeted somewhere!
-	static constexpr uint64_t __archiveVersion = 93;
+	static constexpr uint64_t __archiveVersion = 94;
 	// this is the version number of which below the archive is not compatible with the current version
 	static constexpr uint64_t __archiveVersionBarrier = 22;
 
@@ -33,11 +46,39 @@ namespace wi
 			directory = wi::helper::GetDirectoryFromPath(fileName);
 			if (readMode)
 			{
-				if (wi::helper::FileRead(fileName, DATA))
+				if (wi::helper::FileRead(fileName, DATA, sizeof(Header)))
 				{
-					data_ptr = DATA.data();
-					data_ptr_size = DATA.size();
-					SetReadModeAndResetPos(true);
+					Header file_header;
+					if (DATA.size() == sizeof(Header))
+					{
+						std::memcpy(&file_header, DATA.data(), sizeof(Header));
+					}
+					if (file_header.version >= 94 && file_header.properties.bits.chunked)
+					{
+						// Chunked archive: read everything except the chunks, those will be read from the file on demand
+						const size_t chunks_offset = sizeof(Header) + file_header.properties.bits.thumbnail_data_size + sizeof(uint64_t) * 2;
+						wi::vector<uint8_t> remaining;
+						if (wi::helper::FileRead(fileName, DATA, chunks_offset) && DATA.size() == chunks_offset)
+						{
+							uint64_t chunks_size = 0;
+							std::memcpy(&chunks_size, DATA.data() + chunks_offset - sizeof(uint64_t) * 2, sizeof(uint64_t));
+							if (wi::helper::FileRead(fileName, remaining, ~0ull, chunks_offset + chunks_size))
+							{
+								DATA.resize(chunks_offset + remaining.size());
+								std::memcpy(DATA.data() + chunks_offset, remaining.data(), remaining.size());
+								data_ptr = DATA.data();
+								data_ptr_size = DATA.size();
+								chunks_from_file = true;
+								SetReadModeAndResetPos(true);
+							}
+						}
+					}
+					else if (wi::helper::FileRead(fileName, DATA))
+					{
+						data_ptr = DATA.data();
+						data_ptr_size = DATA.size();
+						SetReadModeAndResetPos(true);
+					}
 				}
 			}
 			else
@@ -47,7 +88,8 @@ namespace wi
 		}
 	}
 
-	Archive::Archive(const uint8_t* data, size_t size)
+	Archive::Archive(const uint8_t* data, size_t size, bool report_errors)
+		: report_errors(report_errors)
 	{
 		data_ptr = data;
 		data_ptr_size = size;
@@ -102,7 +144,72 @@ namespace wi
 				header.properties.bits.thumbnail_data_size = thumbnail_data_size;
 			}
 
-			if (header.properties.bits.compressed && !data_already_decompressed)
+			if (header.properties.bits.chunked && !data_already_decompressed)
+			{
+				// Read the table of contents, and retarget data stream to the (uncompressed) data part after it:
+				size_t data_offset = 0;
+				data_offset += sizeof(Header);
+				data_offset += header.properties.bits.thumbnail_data_size;
+				if (data_ptr_size >= data_offset + sizeof(uint64_t) * 2)
+				{
+					uint64_t chunks_size = 0;
+					uint64_t toc_size = 0;
+					(*this) >> chunks_size;
+					(*this) >> toc_size;
+					const size_t chunks_offset = pos;
+					if (!chunks_from_file)
+					{
+						// Memory mapped chunked archive, chunks can be read from memory:
+						chunk_source_ptr = data_ptr;
+						pos += chunks_size;
+					}
+					const size_t toc_offset = pos;
+
+					size_t chunk_count = 0;
+					(*this) >> chunk_count;
+					chunks.resize(chunk_count);
+					for (auto& chunk : chunks)
+					{
+						(*this) >> chunk.name;
+						(*this) >> chunk.offset;
+						(*this) >> chunk.size;
+						(*this) >> chunk.uncompressed_size;
+						(*this) >> chunk.compressed;
+						chunk.offset += chunks_offset;
+					}
+					chunk_write_data.clear();
+					pos = toc_offset + toc_size;
+
+					const uint8_t* main_data = data_ptr + pos;
+					size_t main_size = data_ptr_size - pos;
+					wi::vector<uint8_t> decompressed_part;
+					if (header.properties.bits.compressed && main_size > 0)
+					{
+						wi::helper::Decompress(main_data, main_size, decompressed_part);
+						main_data = decompressed_part.data();
+						main_size = decompressed_part.size();
+					}
+					wi::vector<uint8_t> final_data(data_offset + main_size);
+					size_t _offset = 0;
+					std::memcpy(final_data.data() + _offset, &header, sizeof(Header));
+					_offset += sizeof(Header);
+					if (header.properties.bits.thumbnail_data_size > 0)
+					{
+						std::memcpy(final_data.data() + _offset, get_thumbnail_data(), header.properties.bits.thumbnail_data_size);
+						_offset += header.properties.bits.thumbnail_data_size;
+					}
+					if (main_size > 0)
+					{
+						std::memcpy(final_data.data() + _offset, main_data, main_size);
+					}
+					std::swap(DATA, final_data); // archive DATA is replaced by the data part without the chunks
+					data_ptr = DATA.data();
+					data_ptr_size = DATA.size();
+					pos = data_offset;
+					data_already_decompressed = true; // indicate that next call to SetReadModeAndResetPos() doesn't need to process chunks again
+				}
+			}
+			else if (header.properties.bits.compressed && !data_already_decompressed)
 			{
 				// Decompress data part if required and retarget data stream to uncompressed:
 				size_t data_offset = 0;
@@ -132,6 +239,10 @@ namespace wi
 		}
 		else
 		{
+			chunks.clear();
+			chunk_write_data.clear();
+			chunk_source_ptr = nullptr;
+			chunks_from_file = false;
 			(*this) << header.version;
 			(*this) << header.properties.raw;
 			for (size_t i = 0; i < header.properties.bits.thumbnail_data_size; ++i)
@@ -149,14 +260,18 @@ namespace wi
 		}
 		DATA.clear();
 		data_ptr = nullptr;
+		chunks.clear();
+		chunk_write_data.clear();
+		chunk_source_ptr = nullptr;
+		chunks_from_file = false;
 	}
 
 	bool Archive::SaveFile(const std::string& fileName)
 	{
-		if (IsCompressionEnabled())
+		if (IsCompressionEnabled() || IsChunked())
 		{
 			wi::vector<uint8_t> final_data;
-			WriteCompressedData(final_data);
+			WriteFinalData(final_data);
 			return wi::helper::FileWrite(fileName, final_data.data(), final_data.size());
 		}
 		return wi::helper::FileWrite(fileName, data_ptr, pos);
@@ -164,10 +279,10 @@ namespace wi
 
 	bool Archive::SaveHeaderFile(const std::string& fileName, const std::string& dataName)
 	{
-		if (IsCompressionEnabled())
+		if (IsCompressionEnabled() || IsChunked())
 		{
 			wi::vector<uint8_t> final_data;
-			WriteCompressedData(final_data);
+			WriteFinalData(final_data);
 			return wi::helper::Bin2H(final_data.data(), final_data.size(), fileName, dataName.c_str());
 		}
 		return wi::helper::Bin2H(data_ptr, pos, fileName, dataName.c_str());
@@ -175,10 +290,10 @@ namespace wi
 
 	bool Archive::SaveCPPFile(const std::string& fileName, const std::string& dataName)
 	{
-		if (IsCompressionEnabled())
+		if (IsCompressionEnabled() || IsChunked())
 		{
 			wi::vector<uint8_t> final_data;
-			WriteCompressedData(final_data);
+			WriteFinalData(final_data);
 			return wi::helper::Bin2CPP(final_data.data(), final_data.size(), fileName, dataName.c_str());
 		}
 		return wi::helper::Bin2CPP(data_ptr, pos, fileName, dataName.c_str());
@@ -254,9 +369,9 @@ namespace wi
 
 	void Archive::WriteData(wi::vector<uint8_t>& dest) const
 	{
-		if (IsCompressionEnabled())
+		if (IsCompressionEnabled() || IsChunked())
 		{
-			WriteCompressedData(dest);
+			WriteFinalData(dest);
 		}
 		else
 		{
@@ -287,4 +402,228 @@ namespace wi
 		std::memcpy(final_data.data() + _offset, compressed_part.data(), compressed_part.size());
 	}
 
+	void Archive::WriteChunkedData(wi::vector<uint8_t>& final_data) const
+	{
+		Header _header = header;
+		_header.properties.bits.chunked = 1;
+		size_t data_offset = 0;
+		data_offset += sizeof(Header);
+		data_offset += _header.properties.bits.thumbnail_data_size;
+
+		// Compress chunks independently of each other:
+		wi::vector<Chunk> toc = chunks;
+		wi::vector<wi::vector<uint8_t>> compressed_chunks;
+		if (IsCompressionEnabled())
+		{
+			compressed_chunks.resize(chunks.size());
+			wi::jobsystem::context ctx;
+			wi::jobsystem::Dispatch(ctx, (uint32_t)chunks.size(), 1, [&](wi::jobsystem::JobArgs args) {
+				const wi::vector<uint8_t>& src = chunk_write_data[args.jobIndex];
+				wi::vector<uint8_t>& dst = compressed_chunks[args.jobIndex];
+				if (src.empty() || !wi::helper::Compress(src.data(), src.size(), dst, 9) || dst.size() >= src.size())
+				{
+					// Compression didn't help, store uncompressed:
+					dst.clear();
+				}
+			});
+			wi::jobsystem::Wait(ctx);
+		}
+		uint64_t chunks_size = 0;
+		for (size_t i = 0; i < toc.size(); ++i)
+		{
+			Chunk& chunk = toc[i];
+			chunk.offset = chunks_size;
+			chunk.compressed = !compressed_chunks.empty() && !compressed_chunks[i].empty();
+			chunk.size = chunk.compressed ? compressed_chunks[i].size() : chunk_write_data[i].size();
+			chunk.uncompressed_size = chunk_write_data[i].size();
+			chunks_size += chunk.size;
+		}
+
+		// Table of contents is written with an archive, excluding its header:
+		Archive toc_archive;
+		toc_archive << toc.size();
+		for (const Chunk& chunk : toc)
+		{
+			toc_archive << chunk.name;
+			toc_archive << chunk.offset;
+			toc_archive << chunk.size;
+			toc_archive << chunk.uncompressed_size;
+			toc_archive << chunk.compressed;
+		}
+		const uint8_t* toc_data = toc_archive.GetData() + sizeof(Header);
+		const uint64_t toc_size = toc_archive.GetPos() - sizeof(Header);
+
+		const uint8_t* main_data = data_ptr + data_offset;
+		size_t main_size = pos - data_offset;
+		wi::vector<uint8_t> compressed_part;
+		if (IsCompressionEnabled())
+		{
+			wi::helper::Compress(main_data, main_size, compressed_part, 9);
+			main_data = compressed_part.data();
+			main_size = compressed_part.size();
+		}
+
+		final_data.resize(data_offset + sizeof(uint64_t) * 2 + chunks_size + toc_size + main_size);
+		size_t _offset = 0;
+		std::memcpy(final_data.data() + _offset, &_header, sizeof(Header));
+		_offset += sizeof(Header);
+		if (_header.properties.bits.thumbnail_data_size > 0)
+		{
+			std::memcpy(final_data.data() + _offset, get_thumbnail_data(), _header.properties.bits.thumbnail_data_size);
+			_offset += _header.properties.bits.thumbnail_data_size;
+		}
+		std::memcpy(final_data.data() + _offset, &chunks_size, sizeof(chunks_size));
+		_offset += sizeof(chunks_size);
+		std::memcpy(final_data.data() + _offset, &toc_size, sizeof(toc_size));
+		_offset += sizeof(toc_size);
+		for (size_t i = 0; i < toc.size(); ++i)
+		{
+			const uint8_t* chunk_data = toc[i].compressed ? compressed_chunks[i].data() : chunk_write_data[i].data();
+			if (toc[i].size > 0)
+			{
+				std::memcpy(final_data.data() + _offset, chunk_data, toc[i].size);
+			}
+			_offset += toc[i].size;
+		}
+		std::memcpy(final_data.data() + _offset, toc_data, toc_size);
+		_offset += toc_size;
+		if (main_size > 0)
+		{
+			std::memcpy(final_data.data() + _offset, main_data, main_size);
+		}
+	}
+
+	void Archive::WriteFinalData(wi::vector<uint8_t>& final_data) const
+	{
+		if (IsChunked())
+		{
+			WriteChunkedData(final_data);
+		}
+		else
+		{
+			WriteCompressedData(final_data);
+		}
+	}
+
+	size_t Archive::WriteChunk(const std::string& name, const Archive& chunk)
+	{
+		size_t data_offset = 0;
+		data_offset += sizeof(Header);
+		data_offset += chunk.header.properties.bits.thumbnail_data_size;
+		assert(!chunk.IsReadMode());
+		assert(chunk.pos >= data_offset);
+		return WriteChunkData(name, chunk.data_ptr + data_offset, chunk.pos - data_offset);
+	}
+
+	size_t Archive::WriteChunkData(const std::string& name, const uint8_t* data, size_t size)
+	{
+		assert(!readMode);
+		assert(chunks.size() == chunk_write_data.size());
+
+		// The offset is computed for the case when the chunks will be written uncompressed, this can be used for streaming from the archive file:
+		uint64_t offset = sizeof(Header) + header.properties.bits.thumbnail_data_size + sizeof(uint64_t) * 2;
+		if (!chunks.empty())
+		{
+			offset = chunks.back().offset + chunks.back().uncompressed_size;
+		}
+
+		Chunk& chunk = chunks.emplace_back();
+		chunk.name = name;
+		chunk.offset = offset;
+		chunk.size = size;
+		chunk.uncompressed_size = size;
+		chunk.compressed = false;
+
+		wi::vector<uint8_t>& dst = chunk_write_data.emplace_back();
+		dst.resize(size);
+		if (size > 0)
+		{
+			std::memcpy(dst.data(), data, size);
+		}
+		return chunks.size() - 1;
+	}
+
+	size_t Archive::FindChunk(const std::string& name) const
+	{
+		for (size_t i = 0; i < chunks.size(); ++i)
+		{
+			if (chunks[i].name == name)
+				return i;
+		}
+		return ~0ull;
+	}
+
+	bool Archive::ReadChunk(size_t index, Archive& chunk) const
+	{
+		wi::vector<uint8_t> data;
+		if (!ReadChunkData(index, data))
+			return false;
+
+		chunk.Close();
+		Header chunk_header;
+		chunk_header.version = header.version;
+		chunk_header.properties.bits.compressed = chunks[index].compressed;
+		chunk.DATA.resize(sizeof(Header) + data.size());
+		std::memcpy(chunk.DATA.data(), &chunk_header, sizeof(Header));
+		if (!data.empty())
+		{
+			std::memcpy(chunk.DATA.data() + sizeof(Header), data.data(), data.size());
+		}
+		chunk.data_ptr = chunk.DATA.data();
+		chunk.data_ptr_size = chunk.DATA.size();
+		chunk.data_already_decompressed = true;
+		chunk.report_errors = report_errors;
+		chunk.fileName.clear(); // the chunk must never overwrite the source file
+		chunk.directory = directory; // but relative paths are resolved like in the source archive
+		chunk.SetReadModeAndResetPos(true);
+		return chunk.IsOpen();
+	}
+
+	bool Archive::ReadChunkData(size_t index, wi::vector<uint8_t>& data) const
+	{
+		if (index >= chunks.size())
+			return false;
+		const Chunk& chunk = chunks[index];
+
+		if (index < chunk_write_data.size())
+		{
+			// Chunk was written into this archive and it's still in memory:
+			data = chunk_write_data[index];
+			return true;
+		}
+
+		const uint8_t* src = nullptr;
+		wi::vector<uint8_t> filedata;
+		if (chunks_from_file)
+		{
+			if (!wi::helper::FileRead(fileName, filedata, chunk.size, chunk.offset) || filedata.size() != chunk.size)
+				return false;
+			if (!chunk.compressed)
+			{
+				std::swap(data, filedata);
+				return true;
+			}
+			src = filedata.data();
+		}
+		else if (chunk_source_ptr != nullptr)
+		{
+			src = chunk_source_ptr + chunk.offset;
+		}
+		else
+		{
+			return false;
+		}
+
+		if (chunk.compressed)
+		{
+			return wi::helper::Decompress(src, chunk.size, data) && data.size() == chunk.uncompressed_size;
+		}
+		data.resize(chunk.size);
+		if (chunk.size > 0)
+		{
+			std::memcpy(data.data(), src, chunk.size);
+		}
+		return true;
+	}
+
 }
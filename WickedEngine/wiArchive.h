@@ -13,6 +13,7 @@ namespace wi
 	//	It can be used to READ or WRITE data, but not both at the same time.
 	//	An archive that was created in WRITE mode can be changed to read mode and vica-versa
 	//	The data flow is always FIFO (first in, first out)
+	//	Additionally, separate chunks of data can be stored in the archive, which can be read in random order, independently of each other
 	class Archive
 	{
 	public:
@@ -25,13 +26,24 @@ namespace wi
 				{
 					uint64_t thumbnail_data_size : 32;
 					uint64_t compressed : 1;
-					uint64_t reserved : 31;
+					uint64_t chunked : 1;
+					uint64_t reserved : 30;
 				} bits;
 				uint64_t raw = 0;
 			} properties;
 		};
 		static_assert(sizeof(Header) == sizeof(uint64_t) * 2);
 
+		// Table of contents entry of a separately stored chunk of data
+		struct Chunk
+		{
+			std::string name;
+			uint64_t offset = 0; // offset of the chunk data from the beginning of the archive file (only valid if not compressed)
+			uint64_t size = 0; // size of the chunk data in the archive file (compressed size if compressed)
+			uint64_t uncompressed_size = 0;
+			bool compressed = false;
+		};
+
 	private:
 		Header header;
 		bool readMode = false; // archive can be either read or write mode, but not both
@@ -42,6 +54,11 @@ namespace wi
 		size_t data_ptr_size = 0;
 		bool data_already_decompressed = false;
 
+		wi::vector<Chunk> chunks; // table of contents of the separately stored chunks
+		wi::vector<wi::vector<uint8_t>> chunk_write_data; // uncompressed chunk data, when chunks were written into this archive
+		const uint8_t* chunk_source_ptr = nullptr; // memory mapped archive file, if chunks are not read from file
+		bool chunks_from_file = false; // chunk data is not in memory, it will be read from the file when requested
+
 		std::string fileName; // save to this file on closing if not empty
 		std::string directory; // the directory part from the fileName
 
@@ -49,6 +66,8 @@ namespace wi
 		constexpr const uint8_t* get_thumbnail_data() const { return data_ptr + sizeof(Header); }
 
 		void WriteCompressedData(wi::vector<uint8_t>& final_data) const;
+		void WriteChunkedData(wi::vector<uint8_t>& final_data) const;
+		void WriteFinalData(wi::vector<uint8_t>& final_data) const;
 
 		void CreateEmpty(); // creates new archive in write mode
 
@@ -63,7 +82,7 @@ namespace wi
 		//	If report_errors == false, an incompatible archive version fails silently (IsOpen() == false) instead of popping a message box
 		Archive(const std::string& fileName, bool readMode = true, bool report_errors = true);
 		// Creates a memory mapped archive in read mode
-		Archive(const uint8_t* data, size_t size);
+		Archive(const uint8_t* data, size_t size, bool report_errors = true);
 		~Archive() { Close(); }
 
 		Archive& operator=(const Archive&) = default;
@@ -108,6 +127,33 @@ namespace wi
 		//	Note that compressed archive will not work with streaming!
 		constexpr bool IsCompressionEnabled() const { return header.properties.bits.compressed; }
 
+		// Returns true if the archive contains separately stored chunks
+		bool IsChunked() const { return !chunks.empty(); }
+
+		// Write a separate chunk into the archive, it will be stored outside of the FIFO data stream
+		//	Chunks are compressed independently if compression is enabled, so they can also be decompressed independently
+		//	The chunk archive's data is copied, excluding its version and thumbnail
+		//	Returns the index of the chunk, which can be stored in the archive to be able to read it later with ReadChunk()
+		size_t WriteChunk(const std::string& name, const Archive& chunk);
+		// Write a separate chunk into the archive from raw data
+		//	Returns the index of the chunk, which can be stored in the archive to be able to read it later with ReadChunkData()
+		size_t WriteChunkData(const std::string& name, const uint8_t* data, size_t size);
+		// Returns the number of separately stored chunks
+		size_t GetChunkCount() const { return chunks.size(); }
+		// Returns the table of contents entry of a chunk
+		const Chunk& GetChunk(size_t index) const { return chunks[index]; }
+		// Returns the index of the first chunk with the specified name, or ~0ull if not found
+		size_t FindChunk(const std::string& name) const;
+		// Read the contents of a chunk into an archive in read mode, which has the same version as this archive
+		//	If the archive was opened from a file, only the requested chunk will be read from the file
+		//	This is thread safe, so multiple chunks can be read in parallel
+		//	Returns false if the chunk couldn't be read
+		bool ReadChunk(size_t index, Archive& chunk) const;
+		// Read the raw contents of a chunk that was written with WriteChunkData()
+		//	This is thread safe, so multiple chunks can be read in parallel
+		//	Returns false if the chunk couldn't be read
+		bool ReadChunkData(size_t index, wi::vector<uint8_t>& data) const;
+
 		// If Archive contains thumbnail image data, then creates a Texture from it:
 		wi::graphics::Texture CreateThumbnailTexture() const;
 
@@ -144,6 +190,24 @@ namespace wi
 			pos = jump_pos;
 		}
 
+		// This is like writing a vector<uint8_t>, but the data is given by pointer and size, it can be read with MapVector()
+		inline void WriteVector(const uint8_t* data, size_t size)
+		{
+			(*this) << size;
+			assert(!readMode);
+			const size_t _right = pos + size;
+			if (_right > DATA.size())
+			{
+				DATA.resize(_right * 2);
+				data_ptr = DATA.data();
+				data_ptr_size = DATA.size();
+			}
+			if (size > 0)
+			{
+				std::memcpy(DATA.data() + pos, data, size);
+			}
+			pos = _right;
+		}
 		// This is like reading a vector<uint8_t>, but instead of copying the data, it returns the memory mapped pointer and size
 		inline void MapVector(const uint8_t*& data, size_t& size)
 		{
@@ -296,6 +360,8 @@ namespace wi
 		{
 			// Here we will use the << operator so that non-specified types will have compile error!
 			//	Note: version and thumbnail data is skipped, only data is appended
+			//	Note: chunks are not appended
+			assert(!other.IsChunked());
 			const size_t start = sizeof(uint64_t) * 2; // version and thumbnail size
 			for (size_t i = start; i < other.pos; ++i)
 			{
@@ -7,7 +7,182 @@
 #define STB_VORBIS_HEADER_ONLY
 #include "Utility/stb_vorbis.c"
 
+#ifndef __SCE__
+#define MA_IMPLEMENTATION
+#define MA_NO_ENCODING
+#define MA_DR_FLAC_NO_NEON
+#define MA_API static
+#ifndef __APPLE__
+// miniaudio is only used for decoding when it's not the audio backend:
+#define MA_NO_DEVICE_IO
+#define MA_NO_ENGINE
+#define MA_NO_NODE_GRAPH
+#define MA_NO_RESOURCE_MANAGER
+#define MA_NO_GENERATION
+#endif // __APPLE__
+#include "Utility/miniaudio.h"
+#endif // __SCE__
+
 #include <sstream>
+#include <atomic>
+#include <mutex>
+
+#ifndef __SCE__
+namespace wi::audio
+{
+	// The file data of a streaming sound, it is decoded by the SoundStreamDecoder of every sound instance
+	struct SoundStream
+	{
+		wi::vector<uint8_t> filedata;
+		uint32_t channel_count = 0;
+		uint32_t sample_rate = 0;
+		uint64_t frame_count = 0; // number of samples per channel
+
+		bool IsValid() const { return !filedata.empty(); }
+
+		bool Create(const uint8_t* data, size_t size)
+		{
+			filedata.resize(size);
+			std::memcpy(filedata.data(), data, size);
+
+			ma_decoder decoder;
+			ma_decoder_config config = ma_decoder_config_init(ma_format_s16, 0, 0); // native channels and sample rate
+			if (ma_decoder_init_memory(filedata.data(), filedata.size(), &config, &decoder) != MA_SUCCESS)
+			{
+				filedata.clear();
+				return false;
+			}
+			channel_count = decoder.outputChannels;
+			sample_rate = decoder.outputSampleRate;
+			ma_uint64 length = 0;
+			if (ma_decoder_get_length_in_pcm_frames(&decoder, &length) != MA_SUCCESS || length == 0)
+			{
+				length = ~0ull; // unknown length, the decoder will find the end
+			}
+			frame_count = length;
+			ma_decoder_uninit(&decoder);
+			return channel_count > 0 && sample_rate > 0;
+		}
+	};
+
+	// Incremental decoder of a streaming sound for one sound instance
+	//	The audio backend keeps a ring of small buffers submitted for playback, and when a buffer finished playing,
+	//	the next part of the sound is decoded into it on the audio thread. The instance's begin, length and loop region are
+	//	handled here, so the backend only sees a continuous stream of samples.
+	struct SoundStreamDecoder
+	{
+		static constexpr uint32_t buffer_count = 4;
+		static constexpr uint32_t buffer_frames = 4096; // samples per channel in one buffer
+
+		ma_decoder decoder = {};
+		bool valid = false;
+		uint32_t channel_count = 0;
+		uint64_t begin = 0; // the frame range of the instance in the sound
+		uint64_t end = 0;
+		uint64_t loop_begin = 0; // the frame range of the loop region in the sound
+		uint64_t loop_end = 0;
+		uint64_t cursor = 0;
+		std::atomic<bool> looped{ false };
+		bool finished = false; // the last buffer of the stream was submitted
+		uint32_t next_buffer = 0;
+		uintptr_t generation = 1; // identifies the currently submitted buffers, it changes when they are discarded
+		wi::vector<short> buffers[buffer_count];
+		std::mutex locker; // decoding runs on the audio thread, restarting on the calling thread
+
+		~SoundStreamDecoder()
+		{
+			if (valid)
+			{
+				ma_decoder_uninit(&decoder);
+			}
+		}
+
+		bool Create(const SoundStream& stream, const SoundInstance& instance)
+		{
+			ma_decoder_config config = ma_decoder_config_init(ma_format_s16, 0, 0);
+			if (ma_decoder_init_memory(stream.filedata.data(), stream.filedata.size(), &config, &decoder) != MA_SUCCESS)
+				return false;
+			valid = true;
+			channel_count = stream.channel_count;
+			const double sample_rate = double(stream.sample_rate);
+			begin = std::min(stream.frame_count, uint64_t(std::max(0.0f, instance.begin) * sample_rate));
+			end = instance.length > 0 ? std::min(stream.frame_count, begin + uint64_t(instance.length * sample_rate)) : stream.frame_count;
+			loop_begin = std::min(end, begin + uint64_t(std::max(0.0f, instance.loop_begin) * sample_rate));
+			loop_end = instance.loop_length > 0 ? std::min(end, loop_begin + uint64_t(instance.loop_length * sample_rate)) : end;
+			looped.store(instance.IsLooped());
+			for (auto& buffer : buffers)
+			{
+				buffer.resize(buffer_frames * channel_count);
+			}
+			return Restart();
+		}
+
+		// Goes back to the beginning of the instance, the buffers that were submitted before become invalid
+		bool Restart()
+		{
+			finished = false;
+			next_buffer = 0;
+			generation++;
+			cursor = begin;
+			return ma_decoder_seek_to_pcm_frame(&decoder, begin) == MA_SUCCESS;
+		}
+
+		bool IsEnded() const
+		{
+			return !looped.load() && cursor >= end;
+		}
+
+		// Decodes up to frame_count samples per channel, returns the number of decoded samples per channel
+		//	It returns less than frame_count only when the end of the instance was reached
+		uint32_t Decode(short* output, uint32_t frame_count)
+		{
+			uint32_t decoded = 0;
+			while (decoded < frame_count)
+			{
+				const bool loop = looped.load() && loop_end > loop_begin;
+				const uint64_t stop = loop ? loop_end : end;
+				if (cursor >= stop)
+				{
+					if (!loop || ma_decoder_seek_to_pcm_frame(&decoder, loop_begin) != MA_SUCCESS)
+						break;
+					cursor = loop_begin;
+					continue;
+				}
+				ma_uint64 read = 0;
+				ma_decoder_read_pcm_frames(&decoder, output + decoded * channel_count, std::min(uint64_t(frame_count - decoded), stop - cursor), &read);
+				if (read == 0)
+				{
+					// The sound is shorter than its reported length:
+					end = cursor;
+					loop_end = std::min(loop_end, end);
+					loop_begin = std::min(loop_begin, loop_end);
+					continue;
+				}
+				cursor += read;
+				decoded += (uint32_t)read;
+			}
+			return decoded;
+		}
+
+		// Decodes the next buffer of the ring, returns the number of samples per channel in it
+		//	An empty stream end is returned as one sample of silence, so it can be submitted with the end of stream flag
+		uint32_t DecodeNextBuffer(short** data)
+		{
+			wi::vector<short>& buffer = buffers[next_buffer];
+			next_buffer = (next_buffer + 1) % buffer_count;
+			*data = buffer.data();
+			uint32_t frames = Decode(buffer.data(), buffer_frames);
+			finished = IsEnded();
+			if (frames == 0)
+			{
+				std::fill(buffer.begin(), buffer.begin() + channel_count, short(0));
+				frames = 1;
+			}
+			return frames;
+		}
+	};
+}
+#endif // __SCE__
 
 #ifdef _WIN32
 
@@ -212,6 +387,7 @@ namespace wi::audio
 		wi::allocator::shared_ptr<AudioInternal> audio;
 		WAVEFORMATEX wfx = {};
 		wi::vector<uint8_t> audioData;
+		SoundStream stream; // only for streaming sounds
 	};
 	struct SoundInstanceInternal final : public IXAudio2VoiceCallback
 	{
@@ -223,11 +399,34 @@ namespace wi::audio
 		wi::vector<float> channelAzimuths;
 		XAUDIO2_BUFFER buffer = {};
 		bool ended = true;
+		SoundStreamDecoder stream; // only for streaming sounds
 
 		~SoundInstanceInternal()
 		{
 			sourceVoice->Stop();
-			sourceVoice->DestroyVoice();
+			sourceVoice->DestroyVoice(); // this waits for the callbacks to finish
+		}
+
+		// Decodes and submits the next buffer of a streaming sound, stream.locker must be locked
+		void SubmitStreamBuffer()
+		{
+			if (stream.finished)
+				return;
+			short* data = nullptr;
+			const uint32_t frames = stream.DecodeNextBuffer(&data);
+			XAUDIO2_BUFFER streambuffer = {};
+			streambuffer.pAudioData = (const BYTE*)data;
+			streambuffer.AudioBytes = frames * stream.channel_count * sizeof(short);
+			streambuffer.pContext = (void*)stream.generation;
+			streambuffer.Flags = stream.finished ? XAUDIO2_END_OF_STREAM : 0;
+			xaudio_check(sourceVoice->SubmitSourceBuffer(&streambuffer));
+		}
+		void SubmitStreamBuffers()
+		{
+			for (uint32_t i = 0; i < SoundStreamDecoder::buffer_count; ++i)
+			{
+				SubmitStreamBuffer();
+			}
 		}
 
 		// Called just before this voice's processing pass begins.
@@ -257,6 +456,15 @@ namespace wi::audio
 		// The buffer can now be reused or destroyed.
 		STDMETHOD_(void, OnBufferEnd) (THIS_ void* pBufferContext)
 		{
+			if (stream.valid)
+			{
+				// Refill the finished buffer of a streaming sound, unless it was discarded:
+				std::scoped_lock lock(stream.locker);
+				if ((uintptr_t)pBufferContext == stream.generation)
+				{
+					SubmitStreamBuffer();
+				}
+			}
 		}
 
 		// Called when this voice has just reached the end position of a loop.
@@ -395,8 +603,17 @@ namespace wi::audio
 			int samples = stb_vorbis_decode_memory(data, (int)size, &channels, &sample_rate, &output);
 			if (samples < 0)
 			{
-				assert(0);
-				return false;
+				// Other decoder (MP3, FLAC):
+				ma_decoder_config config = ma_decoder_config_init(ma_format_s16, 0, 0);
+				ma_uint64 frame_count = 0;
+				if (ma_decode_memory(data, size, &config, &frame_count, (void**)&output) != MA_SUCCESS)
+				{
+					assert(0);
+					return false;
+				}
+				channels = (int)config.channels;
+				sample_rate = (int)config.sampleRate;
+				samples = (int)frame_count;
 			}
 
 			// WAVEFORMATEX: https://docs.microsoft.com/en-us/previous-versions/dd757713(v=vs.85)?redirectedfrom=MSDN
@@ -416,6 +633,43 @@ namespace wi::audio
 
 		return true;
 	}
+	bool CreateSoundStreaming(const std::string& filename, Sound* sound)
+	{
+		wi::vector<uint8_t> filedata;
+		bool success = wi::helper::FileRead(filename, filedata);
+		if (!success)
+		{
+			return false;
+		}
+		return CreateSoundStreaming(filedata.data(), filedata.size(), sound);
+	}
+	bool CreateSoundStreaming(const uint8_t* data, size_t size, Sound* sound)
+	{
+		// The audio device is not required, so streaming sounds can also be used with NullOutput
+		auto soundinternal = wi::allocator::make_shared<SoundInternal>();
+		soundinternal->audio = audio_internal;
+		if (!soundinternal->stream.Create(data, size))
+		{
+			assert(0);
+			return false;
+		}
+		soundinternal->wfx.wFormatTag = WAVE_FORMAT_PCM;
+		soundinternal->wfx.nChannels = (WORD)soundinternal->stream.channel_count;
+		soundinternal->wfx.nSamplesPerSec = (DWORD)soundinternal->stream.sample_rate;
+		soundinternal->wfx.wBitsPerSample = sizeof(short) * 8;
+		soundinternal->wfx.nBlockAlign = soundinternal->wfx.nChannels * sizeof(short);
+		soundinternal->wfx.nAvgBytesPerSec = soundinternal->wfx.nSamplesPerSec * soundinternal->wfx.nBlockAlign;
+		sound->internal_state = soundinternal;
+		return true;
+	}
+	bool IsStreaming(const Sound* sound)
+	{
+		return sound != nullptr && sound->IsValid() && to_internal(sound)->stream.IsValid();
+	}
+	static const SoundStream* get_stream(const Sound* sound)
+	{
+		return &to_internal(sound)->stream;
+	}
 	bool CreateSoundInstance(const Sound* sound, SoundInstance* instance)
 	{
 		if (audio_internal == nullptr || !audio_internal->IsValid())
@@ -456,6 +710,18 @@ namespace wi::audio
 			instanceinternal->channelAzimuths[i] = X3DAUDIO_2PI * float(i) / float(instanceinternal->channelAzimuths.size());
 		}
 
+		if (soundinternal->stream.IsValid())
+		{
+			if (!instanceinternal->stream.Create(soundinternal->stream, *instance))
+			{
+				assert(0);
+				return false;
+			}
+			std::scoped_lock lock(instanceinternal->stream.locker);
+			instanceinternal->SubmitStreamBuffers();
+			return true;
+		}
+
 		const uint32_t bytes_per_second = soundinternal->wfx.nSamplesPerSec * soundinternal->wfx.nChannels * sizeof(short);
 		instanceinternal->buffer.pAudioData = soundinternal->audioData.data();
 		instanceinternal->buffer.AudioBytes = (uint32_t)soundinternal->audioData.size();
@@ -513,6 +779,15 @@ namespace wi::audio
 		if (instance != nullptr && instance->IsValid())
 		{
 			auto instanceinternal = to_internal(instance);
+
+			std::unique_lock<std::mutex> stream_lock;
+			if (instanceinternal->stream.valid)
+			{
+				// The submitted buffers are discarded before they are flushed, so their OnBufferEnd callbacks don't refill them, and the stream restarts from the beginning:
+				stream_lock = std::unique_lock<std::mutex>(instanceinternal->stream.locker);
+				instanceinternal->stream.Restart();
+			}
+
 			xaudio_check(instanceinternal->sourceVoice->Stop()); // preserves cursor position
 
 			xaudio_check(instanceinternal->sourceVoice->FlushSourceBuffers()); // reset submitted audio buffer
@@ -522,7 +797,14 @@ namespace wi::audio
 				xaudio_check(instanceinternal->sourceVoice->SubmitSourceBuffer(&audio_internal->termination_mark)); // mark this as terminated, this resets XAUDIO2_VOICE_STATE::SamplesPlayed to zero
 
 			}
-			xaudio_check(instanceinternal->sourceVoice->SubmitSourceBuffer(&instanceinternal->buffer)); // resubmit
+			if (instanceinternal->stream.valid)
+			{
+				instanceinternal->SubmitStreamBuffers();
+			}
+			else
+			{
+				xaudio_check(instanceinternal->sourceVoice->SubmitSourceBuffer(&instanceinternal->buffer)); // resubmit
+			}
 
 		}
 	}
@@ -561,6 +843,11 @@ namespace wi::audio
 		if (instance != nullptr && instance->IsValid())
 		{
 			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->stream.valid)
+			{
+				instanceinternal->stream.looped.store(false); // the stream continues after the loop region with the next decoded buffer
+				return;
+			}
 			if (instanceinternal->buffer.LoopCount == 0)
 				return;
 			xaudio_check(instanceinternal->sourceVoice->ExitLoop());
@@ -590,8 +877,13 @@ namespace wi::audio
 			auto soundinternal = to_internal(sound);
 			info.channel_count = soundinternal->wfx.nChannels;
 			info.samples = (const short*)soundinternal->audioData.data();
-			info.sample_count = soundinternal->audioData.size() / (info.channel_count * sizeof(short));
+			info.sample_count = soundinternal->audioData.size() / sizeof(short);
 			info.sample_rate = soundinternal->wfx.nSamplesPerSec;
+			if (soundinternal->stream.IsValid())
+			{
+				info.samples = nullptr;
+				info.sample_count = soundinternal->stream.frame_count != ~0ull ? size_t(soundinternal->stream.frame_count * info.channel_count) : 0;
+			}
 		}
 		return info;
 	}
@@ -884,8 +1176,9 @@ namespace wi::audio
 		wi::allocator::shared_ptr<AudioInternal> audio;
 		FAudioWaveFormatEx wfx = {};
 		wi::vector<uint8_t> audioData;
+		SoundStream stream; // only for streaming sounds
 	};
-	struct SoundInstanceInternal{
+	struct SoundInstanceInternal : public FAudioVoiceCallback {
 		wi::allocator::shared_ptr<AudioInternal> audio;
 		wi::allocator::shared_ptr<SoundInternal> soundinternal;
 		FAudioSourceVoice* sourceVoice = nullptr;
@@ -894,10 +1187,52 @@ namespace wi::audio
 		wi::vector<float> channelAzimuths;
 		FAudioBuffer buffer = {};
 		bool ended = true;
-
+		SoundStreamDecoder stream; // only for streaming sounds
+
+		SoundInstanceInternal() : FAudioVoiceCallback() {
+			// The voice callbacks are only used by streaming sounds:
+			OnBufferEnd = [](FAudioVoiceCallback* callback, void* pBufferContext) {
+				SoundInstanceInternal* instanceinternal = static_cast<SoundInstanceInternal*>(callback);
+				// Refill the finished buffer of a streaming sound, unless it was discarded:
+				std::scoped_lock lock(instanceinternal->stream.locker);
+				if ((uintptr_t)pBufferContext == instanceinternal->stream.generation)
+				{
+					instanceinternal->SubmitStreamBuffer();
+				}
+			};
+			OnBufferStart = [](FAudioVoiceCallback* callback, void* pBufferContext) {
+				static_cast<SoundInstanceInternal*>(callback)->ended = false;
+			};
+			OnStreamEnd = [](FAudioVoiceCallback* callback) {
+				static_cast<SoundInstanceInternal*>(callback)->ended = true;
+			};
+		}
 		~SoundInstanceInternal(){
 			FAudioSourceVoice_Stop(sourceVoice, 0, FAUDIO_COMMIT_NOW);
-			FAudioVoice_DestroyVoice(sourceVoice);
+			FAudioVoice_DestroyVoice(sourceVoice); // this waits for the callbacks to finish
+		}
+
+		// Decodes and submits the next buffer of a streaming sound, stream.locker must be locked
+		void SubmitStreamBuffer()
+		{
+			if (stream.finished)
+				return;
+			short* data = nullptr;
+			const uint32_t frames = stream.DecodeNextBuffer(&data);
+			FAudioBuffer streambuffer = {};
+			streambuffer.pAudioData = (const uint8_t*)data;
+			streambuffer.AudioBytes = frames * stream.channel_count * sizeof(short);
+			streambuffer.pContext = (void*)stream.generation;
+			streambuffer.Flags = stream.finished ? FAUDIO_END_OF_STREAM : 0;
+			uint32_t res = FAudioSourceVoice_SubmitSourceBuffer(sourceVoice, &streambuffer, nullptr);
+			assert(res == 0);
+		}
+		void SubmitStreamBuffers()
+		{
+			for (uint32_t i = 0; i < SoundStreamDecoder::buffer_count; ++i)
+			{
+				SubmitStreamBuffer();
+			}
 		}
 	};
 
@@ -1022,8 +1357,17 @@ namespace wi::audio
 			int samples = stb_vorbis_decode_memory(data, (int)size, &channels, &sample_rate, &output);
 			if (samples < 0)
 			{
-				assert(0);
-				return false;
+				// Other decoder (MP3, FLAC):
+				ma_decoder_config config = ma_decoder_config_init(ma_format_s16, 0, 0);
+				ma_uint64 frame_count = 0;
+				if (ma_decode_memory(data, size, &config, &frame_count, (void**)&output) != MA_SUCCESS)
+				{
+					assert(0);
+					return false;
+				}
+				channels = (int)config.channels;
+				sample_rate = (int)config.sampleRate;
+				samples = (int)frame_count;
 			}
 
 			// WAVEFORMATEX: https://docs.microsoft.com/en-us/previous-versions/dd757713(v=vs.85)?redirectedfrom=MSDN
@@ -1043,6 +1387,43 @@ namespace wi::audio
 
 		return true;
 	}
+	bool CreateSoundStreaming(const std::string& filename, Sound* sound)
+	{
+		wi::vector<uint8_t> filedata;
+		bool success = wi::helper::FileRead(filename, filedata);
+		if (!success)
+		{
+			return false;
+		}
+		return CreateSoundStreaming(filedata.data(), filedata.size(), sound);
+	}
+	bool CreateSoundStreaming(const uint8_t* data, size_t size, Sound* sound)
+	{
+		// The audio device is not required, so streaming sounds can also be used with NullOutput
+		auto soundinternal = wi::allocator::make_shared<SoundInternal>();
+		soundinternal->audio = audio_internal;
+		if (!soundinternal->stream.Create(data, size))
+		{
+			assert(0);
+			return false;
+		}
+		soundinternal->wfx.wFormatTag = FAUDIO_FORMAT_PCM;
+		soundinternal->wfx.nChannels = (uint16_t)soundinternal->stream.channel_count;
+		soundinternal->wfx.nSamplesPerSec = soundinternal->stream.sample_rate;
+		soundinternal->wfx.wBitsPerSample = sizeof(short) * 8;
+		soundinternal->wfx.nBlockAlign = soundinternal->wfx.nChannels * sizeof(short);
+		soundinternal->wfx.nAvgBytesPerSec = soundinternal->wfx.nSamplesPerSec * soundinternal->wfx.nBlockAlign;
+		sound->internal_state = soundinternal;
+		return true;
+	}
+	bool IsStreaming(const Sound* sound)
+	{
+		return sound != nullptr && sound->IsValid() && to_internal(sound)->stream.IsValid();
+	}
+	static const SoundStream* get_stream(const Sound* sound)
+	{
+		return &to_internal(sound)->stream;
+	}
 	bool CreateSoundInstance(const Sound* sound, SoundInstance* instance)
 	{
 		if (audio_internal == nullptr || !audio_internal->IsValid())
@@ -1068,7 +1449,7 @@ namespace wi::audio
 		};
 		
 		res = FAudio_CreateSourceVoice(instanceinternal->audio->audioEngine, &instanceinternal->sourceVoice, &soundinternal->wfx,
-			0, FAUDIO_DEFAULT_FREQ_RATIO, NULL, &SFXSendList, NULL);
+			0, FAUDIO_DEFAULT_FREQ_RATIO, soundinternal->stream.IsValid() ? instanceinternal.get() : NULL, &SFXSendList, NULL);
 		if(res != 0){
 			assert(0);
 			return false;
@@ -1082,6 +1463,18 @@ namespace wi::audio
 			instanceinternal->channelAzimuths[i] = F3DAUDIO_2PI * float(i) / float(instanceinternal->channelAzimuths.size());
 		}
 
+		if (soundinternal->stream.IsValid())
+		{
+			if (!instanceinternal->stream.Create(soundinternal->stream, *instance))
+			{
+				assert(0);
+				return false;
+			}
+			std::scoped_lock lock(instanceinternal->stream.locker);
+			instanceinternal->SubmitStreamBuffers();
+			return true;
+		}
+
 		const uint32_t bytes_per_second = soundinternal->wfx.nSamplesPerSec * soundinternal->wfx.nChannels * sizeof(short);
 		instanceinternal->buffer.pAudioData = soundinternal->audioData.data();
 		instanceinternal->buffer.AudioBytes = (uint32_t)soundinternal->audioData.size();
@@ -1133,14 +1526,30 @@ namespace wi::audio
 	void Stop(SoundInstance* instance) {
 		if (instance != nullptr && instance->IsValid()){
 			auto instanceinternal = to_internal(instance);
+
+			std::unique_lock<std::mutex> stream_lock;
+			if (instanceinternal->stream.valid)
+			{
+				// The submitted buffers are discarded before they are flushed, so their OnBufferEnd callbacks don't refill them, and the stream restarts from the beginning:
+				stream_lock = std::unique_lock<std::mutex>(instanceinternal->stream.locker);
+				instanceinternal->stream.Restart();
+			}
+
 			uint32_t res = FAudioSourceVoice_Stop(instanceinternal->sourceVoice, 0, FAUDIO_COMMIT_NOW); // preserves cursor position
 			assert(res == 0);
 			res = FAudioSourceVoice_FlushSourceBuffers(instanceinternal->sourceVoice); // reset submitted audio buffer
 			assert(res == 0);
 			res = FAudioSourceVoice_SubmitSourceBuffer(instanceinternal->sourceVoice, &audio_internal->termination_mark, nullptr); // mark this as terminated, this resets XAUDIO2_VOICE_STATE::SamplesPlayed to zero
 			assert(res == 0);
-			res = FAudioSourceVoice_SubmitSourceBuffer(instanceinternal->sourceVoice, &(instanceinternal->buffer), nullptr);
-			assert(res == 0);
+			if (instanceinternal->stream.valid)
+			{
+				instanceinternal->SubmitStreamBuffers();
+			}
+			else
+			{
+				res = FAudioSourceVoice_SubmitSourceBuffer(instanceinternal->sourceVoice, &(instanceinternal->buffer), nullptr);
+				assert(res == 0);
+			}
 		}
 	}
 	void SetVolume(float volume, SoundInstance* instance) {
@@ -1168,6 +1577,11 @@ namespace wi::audio
 	void ExitLoop(SoundInstance* instance) {
 		if (instance != nullptr && instance->IsValid()){
 			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->stream.valid)
+			{
+				instanceinternal->stream.looped.store(false); // the stream continues after the loop region with the next decoded buffer
+				return;
+			}
 			if (instanceinternal->buffer.LoopCount == 0)
 				return;
 			uint32_t res = FAudioSourceVoice_ExitLoop(instanceinternal->sourceVoice, FAUDIO_COMMIT_NOW);
@@ -1200,6 +1614,11 @@ namespace wi::audio
 			info.sample_count = soundinternal->audioData.size() / sizeof(short);
 			info.sample_rate = soundinternal->wfx.nSamplesPerSec;
 			info.channel_count = soundinternal->wfx.nChannels;
+			if (soundinternal->stream.IsValid())
+			{
+				info.samples = nullptr;
+				info.sample_count = soundinternal->stream.frame_count != ~0ull ? size_t(soundinternal->stream.frame_count * info.channel_count) : 0;
+			}
 		}
 		return info;
 	}
@@ -1302,12 +1721,6 @@ namespace wi::audio
 }
 
 #elif defined(__APPLE__)
-#define MA_IMPLEMENTATION
-#define MA_NO_ENCODING
-#define MA_DR_FLAC_NO_NEON
-#define MA_API static
-
-#include "Utility/miniaudio.h"
 
 namespace wi::audio
 {
@@ -1412,6 +1825,24 @@ namespace wi::audio
 		);
 	}
 
+	// Streaming is not implemented with miniaudio yet, these sounds are fully decoded:
+	bool CreateSoundStreaming(const std::string& filename, Sound* sound)
+	{
+		return CreateSound(filename, sound);
+	}
+	bool CreateSoundStreaming(const uint8_t* data, size_t size, Sound* sound)
+	{
+		return CreateSound(data, size, sound);
+	}
+	bool IsStreaming(const Sound* sound)
+	{
+		return false;
+	}
+	static const SoundStream* get_stream(const Sound* sound)
+	{
+		return nullptr;
+	}
+
 	bool CreateSoundInstance(const Sound* sound, SoundInstance* instance)
 	{
 		auto info = (WrappedSampleInfo*)sound->internal_state.get();
@@ -1591,6 +2022,33 @@ namespace wi::audio
 	bool CreateSound(const uint8_t* data, size_t size, Sound* sound) { return false; }
 	bool CreateSoundInstance(const Sound* sound, SoundInstance* instance) { return false; }
 
+	// Streaming sounds can be created without audio backend to use them with NullOutput:
+	bool CreateSoundStreaming(const std::string& filename, Sound* sound)
+	{
+		wi::vector<uint8_t> filedata;
+		bool success = wi::helper::FileRead(filename, filedata);
+		if (!success)
+		{
+			return false;
+		}
+		return CreateSoundStreaming(filedata.data(), filedata.size(), sound);
+	}
+	bool CreateSoundStreaming(const uint8_t* data, size_t size, Sound* sound)
+	{
+		auto stream = wi::allocator::make_shared<SoundStream>();
+		if (!stream->Create(data, size))
+		{
+			return false;
+		}
+		sound->internal_state = stream;
+		return true;
+	}
+	bool IsStreaming(const Sound* sound) { return sound != nullptr && sound->IsValid(); }
+	static const SoundStream* get_stream(const Sound* sound)
+	{
+		return static_cast<const SoundStream*>(sound->internal_state.get());
+	}
+
 	void Play(SoundInstance* instance) {}
 	void Pause(SoundInstance* instance) {}
 	void Stop(SoundInstance* instance) {}
@@ -1599,7 +2057,17 @@ namespace wi::audio
 	void ExitLoop(SoundInstance* instance) {}
 	bool IsEnded(SoundInstance* instance) { return true; }
 
-	SampleInfo GetSampleInfo(const Sound* sound) { return {}; }
+	SampleInfo GetSampleInfo(const Sound* sound)
+	{
+		SampleInfo info = {};
+		if (sound != nullptr && sound->IsValid())
+		{
+			const SoundStream* stream = get_stream(sound);
+			info.sample_rate = (int)stream->sample_rate;
+			info.channel_count = stream->channel_count;
+		}
+		return info;
+	}
 	uint64_t GetTotalSamplesPlayed(const SoundInstance* instance) { return 0; }
 
 	void SetSubmixVolume(SUBMIX_TYPE type, float volume) {}
@@ -1611,3 +2079,64 @@ namespace wi::audio
 }
 
 #endif // _WIN32
+
+#ifndef __SCE__
+namespace wi::audio
+{
+	struct NullOutputInternal
+	{
+		wi::allocator::shared_ptr<void> sound; // keeps the file data alive
+		SoundStreamDecoder stream;
+		uint64_t samples_played = 0;
+	};
+
+	bool CreateNullOutput(const Sound* sound, const SoundInstance* instance, NullOutput* output)
+	{
+		if (sound == nullptr || !sound->IsValid() || instance == nullptr)
+			return false;
+		const SoundStream* stream = get_stream(sound);
+		if (stream == nullptr || !stream->IsValid())
+			return false;
+		auto internal_state = wi::allocator::make_shared<NullOutputInternal>();
+		internal_state->sound = sound->internal_state;
+		if (!internal_state->stream.Create(*stream, *instance))
+			return false;
+		output->internal_state = internal_state;
+		return true;
+	}
+	size_t RenderNullOutput(NullOutput* output, short* samples, size_t frame_count)
+	{
+		if (output == nullptr || !output->IsValid())
+			return 0;
+		NullOutputInternal* internal_state = static_cast<NullOutputInternal*>(output->internal_state.get());
+		SoundStreamDecoder& stream = internal_state->stream;
+		size_t rendered = 0;
+		while (rendered < frame_count)
+		{
+			// Decoded in the same buffer sized parts as the audio backends request it:
+			const uint32_t count = (uint32_t)std::min(frame_count - rendered, size_t(SoundStreamDecoder::buffer_frames));
+			const uint32_t decoded = stream.Decode(samples + rendered * stream.channel_count, count);
+			rendered += decoded;
+			if (decoded < count)
+				break;
+		}
+		internal_state->samples_played += rendered;
+		return rendered;
+	}
+	void ExitLoop(NullOutput* output)
+	{
+		if (output != nullptr && output->IsValid())
+		{
+			static_cast<NullOutputInternal*>(output->internal_state.get())->stream.looped.store(false);
+		}
+	}
+	uint64_t GetTotalSamplesPlayed(const NullOutput* output)
+	{
+		if (output != nullptr && output->IsValid())
+		{
+			return static_cast<const NullOutputInternal*>(output->internal_state.get())->samples_played;
+		}
+		return 0ull;
+	}
+}
+#endif // __SCE__
@@ -62,6 +62,13 @@ namespace wi::audio
 
 	bool CreateSound(const std::string& filename, Sound* sound);
 	bool CreateSound(const uint8_t* data, size_t size, Sound* sound);
+	// Create a streaming sound, which only keeps the file data in memory instead of all the decoded samples
+	//	Every playing sound instance decodes it incrementally into a few small buffers, so loading is fast and memory usage doesn't depend on the sound length.
+	//	This is recommended for long sounds, such as music. Supported formats: WAV, OGG (Vorbis), MP3, FLAC
+	//	GetSampleInfo() doesn't return samples for a streaming sound.
+	bool CreateSoundStreaming(const std::string& filename, Sound* sound);
+	bool CreateSoundStreaming(const uint8_t* data, size_t size, Sound* sound);
+	bool IsStreaming(const Sound* sound);
 	bool CreateSoundInstance(const Sound* sound, SoundInstance* instance);
 
 	void Play(SoundInstance* instance);
@@ -83,6 +90,23 @@ namespace wi::audio
 	// Returns the total number of samples that were played since the creation of the sound instance
 	uint64_t GetTotalSamplesPlayed(const SoundInstance* instance);
 
+	// NullOutput plays a streaming sound without an audio device, it can be used for testing and benchmarking without audio hardware
+	//	The sound is decoded in the same way as for a playing sound instance, including the instance's begin, length and loop region,
+	//	but the samples are written to memory by RenderNullOutput() instead of being sent to the audio device.
+	struct NullOutput
+	{
+		wi::allocator::shared_ptr<void> internal_state;
+		constexpr bool IsValid() const { return internal_state.IsValid(); }
+	};
+	// The sound must be a streaming sound, the instance parameters are used for playback, but the instance doesn't need to be created
+	bool CreateNullOutput(const Sound* sound, const SoundInstance* instance, NullOutput* output);
+	// Decodes the next samples into the samples array, which must be large enough for frame_count * channel_count samples
+	//	Returns the number of samples per channel that were written, it is less than frame_count when the playback ended
+	size_t RenderNullOutput(NullOutput* output, short* samples, size_t frame_count);
+	void ExitLoop(NullOutput* output);
+	// Returns the total number of samples that were rendered since the creation of the null output
+	uint64_t GetTotalSamplesPlayed(const NullOutput* output);
+
 	void SetSubmixVolume(SUBMIX_TYPE type, float volume);
 	float GetSubmixVolume(SUBMIX_TYPE type);
 
@@ -32,7 +32,12 @@ namespace wi::lua
 			Sound_BindLua* sound = Luna<Sound_BindLua>::lightcheck(L, 2);
 			if (sound != nullptr)
 			{
-				sound->soundResource = wi::resourcemanager::Load(wi::lua::SGetString(L, 1));
+				wi::resourcemanager::Flags flags = wi::resourcemanager::Flags::NONE;
+				if (argc > 2 && wi::lua::SGetBool(L, 3))
+				{
+					flags |= wi::resourcemanager::Flags::STREAMING;
+				}
+				sound->soundResource = wi::resourcemanager::Load(wi::lua::SGetString(L, 1), flags);
 				if (!sound->soundResource.IsValid())
 				{
 					wi::lua::SSetBool(L, false);
@@ -1,13 +1,24 @@
 #pragma once
 #include "CommonInclude.h"
 #include "wiPrimitive.h"
+#include "wiJobSystem.h"
+
+#include <atomic>
+#include <algorithm>
 
 namespace wi
 {
 	// Simple fast update BVH
 	//	https://jacco.ompf2.com/2022/04/13/how-to-build-a-bvh-part-1-basics/
+	//	The binary tree is used for building and refitting, and it is also collapsed into a 4-wide tree (nodes4)
+	//	that is used for SIMD ray and frustum traversal
 	struct BVH
 	{
+		enum class BUILD_MODE
+		{
+			MIDPOINT,	// fastest build, split at the middle of the longest axis
+			SAH,		// binned surface area heuristic, slower build but better trees for ray tracing, uses the job system for large inputs
+		};
 		struct Node
 		{
 			wi::primitive::AABB aabb;
@@ -16,21 +27,36 @@ namespace wi
 			uint32_t count = 0;
 			constexpr bool isLeaf() const { return count > 0; }
 		};
+		// 4-wide node in structure of arrays layout, the four child bounds can be tested at once with SIMD:
+		//	if count[i] > 0, then child[i] is a leaf offset into leaf_indices, otherwise child[i] is an index into nodes4
+		//	empty slots have inverted (invalid) bounds
+		struct alignas(16) Node4
+		{
+			float bmin[3][4];
+			float bmax[3][4];
+			uint32_t child[4];
+			uint32_t count[4];
+			uint32_t source[4]; // binary node index of each slot, used for refitting, ~0u for empty slots
+		};
 		wi::vector<Node> nodes;
 		wi::vector<uint32_t> leaf_indices;
 		uint32_t node_count = 0;
+		wi::vector<Node4> nodes4;
+		uint32_t node4_count = 0;
 
 		constexpr bool IsValid() const { return node_count > 0; }
 
 		// Completely rebuilds tree from scratch
-		void Build(const wi::primitive::AABB* aabbs, uint32_t aabb_count)
+		void Build(const wi::primitive::AABB* aabbs, uint32_t aabb_count, BUILD_MODE mode = BUILD_MODE::MIDPOINT)
 		{
 			node_count = 0;
+			node4_count = 0;
 
 			if (aabb_count == 0)
 			{
 				nodes.clear();
 				leaf_indices.clear();
+				nodes4.clear();
 				return;
 			}
 
@@ -45,10 +71,20 @@ namespace wi
 				node.aabb = wi::primitive::AABB::Merge(node.aabb, aabbs[i]);
 				leaf_indices[i] = i;
 			}
-			Subdivide(0, aabbs);
+
+			if (mode == BUILD_MODE::SAH)
+			{
+				BuildSAH(aabbs, aabb_count);
+			}
+			else
+			{
+				Subdivide(0, aabbs);
+			}
+
+			BuildWide();
 		}
 
-		// Updates the AABBs, but doesn't modify the tree structure (fast update mode) 
+		// Updates the AABBs, but doesn't modify the tree structure (fast update mode)
 		void Update(const wi::primitive::AABB* aabbs, uint32_t aabb_count)
 		{
 			if (node_count == 0)
@@ -58,9 +94,10 @@ namespace wi
 			if (aabb_count != (uint32_t)leaf_indices.size())
 				return;
 
-			for (uint32_t i = node_count - 1; i > 0; --i)
+			// children are always after their parent, so the reverse order refits bottom-up, including the root
+			for (uint32_t i = node_count; i > 0; --i)
 			{
-				Node& node = nodes[i];
+				Node& node = nodes[i - 1];
 				node.aabb = wi::primitive::AABB();
 				if (node.isLeaf())
 				{
@@ -75,6 +112,8 @@ namespace wi
 					node.aabb = wi::primitive::AABB::Merge(node.aabb, nodes[node.left + 1].aabb);
 				}
 			}
+
+			RefitWide();
 		}
 
 		// Intersect with a primitive shape and return the closest hit
@@ -104,6 +143,23 @@ namespace wi
 			}
 		}
 
+		// Ray intersection that uses the 4-wide tree with SIMD when starting from the root node
+		//	It reports the same leaves as the binary tree traversal, but possibly in a different order
+		void Intersects(
+			const wi::primitive::Ray& ray,
+			uint32_t nodeIndex,
+			const std::function<void(uint32_t index)>& callback
+		) const
+		{
+			if (nodeIndex != 0 || node4_count == 0)
+			{
+				Intersects<wi::primitive::Ray>(ray, nodeIndex, callback);
+				return;
+			}
+			const RayData raydata(ray);
+			IntersectsWide(raydata, 0, callback);
+		}
+
 		// Returning true from callback will immediately exit the whole search
 		template <typename T>
 		bool IntersectsFirst(
@@ -139,7 +195,296 @@ namespace wi
 			return false;
 		}
 
+		// Ray version of IntersectsFirst that uses the 4-wide tree with SIMD
+		bool IntersectsFirst(
+			const wi::primitive::Ray& ray,
+			const std::function<bool(uint32_t index)>& callback
+		) const
+		{
+			if (node4_count == 0)
+				return IntersectsFirst<wi::primitive::Ray>(ray, callback);
+			const RayData raydata(ray);
+			uint32_t stack[256];
+			uint32_t count = 0;
+			stack[count++] = 0; // push node 0
+			while (count > 0 && (count < (arraysize(stack) - 4)))
+			{
+				const Node4& node = nodes4[stack[--count]];
+				const uint32_t mask = IntersectsNode4(raydata, node);
+				for (uint32_t i = 0; i < 4; ++i)
+				{
+					if ((mask & (1u << i)) == 0)
+						continue;
+					if (node.count[i] > 0)
+					{
+						for (uint32_t j = 0; j < node.count[i]; ++j)
+						{
+							if (callback(leaf_indices[node.child[i] + j]))
+								return true;
+						}
+					}
+					else
+					{
+						stack[count++] = node.child[i];
+					}
+				}
+			}
+			return false;
+		}
+
+		// Frustum planes splatted into SIMD registers, for testing 4 boxes at once
+		struct FrustumData
+		{
+			XMVECTOR planes[6][4]; // [plane][x, y, z, w]
+			FrustumData(const wi::primitive::Frustum& frustum)
+			{
+				for (int p = 0; p < 6; ++p)
+				{
+					const XMVECTOR plane = XMLoadFloat4(&frustum.planes[p]);
+					planes[p][0] = XMVectorSplatX(plane);
+					planes[p][1] = XMVectorSplatY(plane);
+					planes[p][2] = XMVectorSplatZ(plane);
+					planes[p][3] = XMVectorSplatW(plane);
+				}
+			}
+		};
+
+		// Tests 4 boxes in structure of arrays layout against the frustum, each lane gives the same result as Frustum::CheckBoxFast()
+		//	returns the mask of boxes that are not outside (bit i is set if box i is visible)
+		//	inside_mask receives the mask of boxes that are completely inside the frustum
+		static uint32_t IntersectsFrustum4(const FrustumData& frustum, const XMVECTOR bmin[3], const XMVECTOR bmax[3], uint32_t& inside_mask)
+		{
+			const XMVECTOR zero = XMVectorZero();
+			XMVECTOR outside = XMVectorFalseInt();
+			XMVECTOR intersecting = XMVectorFalseInt();
+			for (int p = 0; p < 6; ++p)
+			{
+				// The corner furthest along the plane normal decides if the box is outside, the opposite corner decides if it's fully inside:
+				XMVECTOR dist_far = frustum.planes[p][3];
+				XMVECTOR dist_near = frustum.planes[p][3];
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					const XMVECTOR negative = XMVectorLess(frustum.planes[p][axis], zero);
+					dist_far = XMVectorMultiplyAdd(frustum.planes[p][axis], XMVectorSelect(bmax[axis], bmin[axis], negative), dist_far);
+					dist_near = XMVectorMultiplyAdd(frustum.planes[p][axis], XMVectorSelect(bmin[axis], bmax[axis], negative), dist_near);
+				}
+				outside = XMVectorOrInt(outside, XMVectorLess(dist_far, zero));
+				intersecting = XMVectorOrInt(intersecting, XMVectorLess(dist_near, zero));
+			}
+			XMVECTOR valid = XMVectorLessOrEqual(bmin[0], bmax[0]);
+			valid = XMVectorAndInt(valid, XMVectorLessOrEqual(bmin[1], bmax[1]));
+			valid = XMVectorAndInt(valid, XMVectorLessOrEqual(bmin[2], bmax[2]));
+			const XMVECTOR visible = XMVectorAndCInt(valid, outside);
+			inside_mask = MoveMask(XMVectorAndCInt(visible, intersecting));
+			return MoveMask(visible);
+		}
+
+		// Tests the four child bounds of a Node4 against the frustum, see IntersectsFrustum4()
+		static uint32_t IntersectsNode4(const FrustumData& frustum, const Node4& node, uint32_t& inside_mask)
+		{
+			XMVECTOR bmin[3];
+			XMVECTOR bmax[3];
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				bmin[axis] = XMLoadFloat4A((const XMFLOAT4A*)node.bmin[axis]);
+				bmax[axis] = XMLoadFloat4A((const XMFLOAT4A*)node.bmax[axis]);
+			}
+			return IntersectsFrustum4(frustum, bmin, bmax, inside_mask);
+		}
+
+		// Converts a SIMD comparison result to a 4-bit lane mask
+		static uint32_t MoveMask(const XMVECTOR& mask)
+		{
+#if defined(_XM_SSE_INTRINSICS_)
+			return (uint32_t)_mm_movemask_ps(mask);
+#else
+			uint32_t lanes[4];
+			XMStoreInt4(lanes, mask);
+			return (lanes[0] & 1u) | (lanes[1] & 2u) | (lanes[2] & 4u) | (lanes[3] & 8u);
+#endif // _XM_SSE_INTRINSICS_
+		}
+
 	private:
+		// Ray data splatted into SIMD registers, one lane for each child of a Node4
+		struct RayData
+		{
+			XMVECTOR origin[3];
+			XMVECTOR direction_inverse[3];
+			XMVECTOR TMin;
+			XMVECTOR TMax;
+			RayData(const wi::primitive::Ray& ray)
+			{
+				origin[0] = XMVectorReplicate(ray.origin.x);
+				origin[1] = XMVectorReplicate(ray.origin.y);
+				origin[2] = XMVectorReplicate(ray.origin.z);
+				direction_inverse[0] = XMVectorReplicate(ray.direction_inverse.x);
+				direction_inverse[1] = XMVectorReplicate(ray.direction_inverse.y);
+				direction_inverse[2] = XMVectorReplicate(ray.direction_inverse.z);
+				TMin = XMVectorReplicate(ray.TMin);
+				TMax = XMVectorReplicate(ray.TMax);
+			}
+		};
+
+		// Tests the ray against all four child bounds, returns the hit mask (bit i is set if child i is hit)
+		//	This matches AABB::intersects(const Ray&) lane by lane, including the origin inside box case
+		static uint32_t IntersectsNode4(const RayData& ray, const Node4& node)
+		{
+			XMVECTOR tmin = XMVectorReplicate(std::numeric_limits<float>::lowest());
+			XMVECTOR tmax = XMVectorReplicate(std::numeric_limits<float>::max());
+			XMVECTOR valid = XMVectorTrueInt();
+			XMVECTOR inside = XMVectorTrueInt();
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const XMVECTOR bmin = XMLoadFloat4A((const XMFLOAT4A*)node.bmin[axis]);
+				const XMVECTOR bmax = XMLoadFloat4A((const XMFLOAT4A*)node.bmax[axis]);
+				const XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(bmin, ray.origin[axis]), ray.direction_inverse[axis]);
+				const XMVECTOR t2 = XMVectorMultiply(XMVectorSubtract(bmax, ray.origin[axis]), ray.direction_inverse[axis]);
+				tmin = XMVectorMax(tmin, XMVectorMin(t1, t2));
+				tmax = XMVectorMin(tmax, XMVectorMax(t1, t2));
+				valid = XMVectorAndInt(valid, XMVectorLessOrEqual(bmin, bmax));
+				inside = XMVectorAndInt(inside, XMVectorAndInt(XMVectorGreaterOrEqual(ray.origin[axis], bmin), XMVectorLessOrEqual(ray.origin[axis], bmax)));
+			}
+			XMVECTOR hit = XMVectorLessOrEqual(tmin, tmax);
+			hit = XMVectorAndInt(hit, XMVectorLessOrEqual(tmin, ray.TMax));
+			hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(tmax, ray.TMin));
+			hit = XMVectorAndInt(XMVectorOrInt(hit, inside), valid);
+			return MoveMask(hit);
+		}
+
+		void IntersectsWide(const RayData& ray, uint32_t nodeIndex, const std::function<void(uint32_t index)>& callback) const
+		{
+			const Node4& node = nodes4[nodeIndex];
+			const uint32_t mask = IntersectsNode4(ray, node);
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				if ((mask & (1u << i)) == 0)
+					continue;
+				if (node.count[i] > 0)
+				{
+					for (uint32_t j = 0; j < node.count[i]; ++j)
+					{
+						callback(leaf_indices[node.child[i] + j]);
+					}
+				}
+				else
+				{
+					IntersectsWide(ray, node.child[i], callback);
+				}
+			}
+		}
+
+		static void SetNode4Slot(Node4& node4, uint32_t slot, const wi::primitive::AABB& aabb)
+		{
+			node4.bmin[0][slot] = aabb._min.x;
+			node4.bmin[1][slot] = aabb._min.y;
+			node4.bmin[2][slot] = aabb._min.z;
+			node4.bmax[0][slot] = aabb._max.x;
+			node4.bmax[1][slot] = aabb._max.y;
+			node4.bmax[2][slot] = aabb._max.z;
+		}
+
+		static float HalfSurfaceArea(const XMFLOAT3& bmin, const XMFLOAT3& bmax)
+		{
+			const float x = bmax.x - bmin.x;
+			const float y = bmax.y - bmin.y;
+			const float z = bmax.z - bmin.z;
+			return x * y + y * z + z * x;
+		}
+
+		// Collapses the binary tree into the 4-wide tree:
+		//	each 4-wide node takes the children of a binary node, then keeps opening the largest inner child until it has 4 slots
+		void BuildWide()
+		{
+			// Every 4-wide node is made from a different inner binary node (or the root), and at most half of the binary nodes are inner nodes:
+			nodes4.resize(node_count / 2 + 1);
+			node4_count = 0;
+			CollapseNode(0);
+			nodes4.resize(node4_count);
+		}
+		uint32_t CollapseNode(uint32_t nodeIndex)
+		{
+			uint32_t slots[4] = {};
+			uint32_t slot_count = 0;
+			const Node& node = nodes[nodeIndex];
+			if (node.isLeaf())
+			{
+				slots[slot_count++] = nodeIndex;
+			}
+			else
+			{
+				slots[slot_count++] = node.left;
+				slots[slot_count++] = node.left + 1;
+				while (slot_count < 4)
+				{
+					uint32_t largest = ~0u;
+					float largest_area = -1;
+					for (uint32_t i = 0; i < slot_count; ++i)
+					{
+						const Node& child = nodes[slots[i]];
+						if (child.isLeaf())
+							continue;
+						const float area = HalfSurfaceArea(child.aabb._min, child.aabb._max);
+						if (area > largest_area)
+						{
+							largest_area = area;
+							largest = i;
+						}
+					}
+					if (largest == ~0u)
+						break;
+					const uint32_t opened = nodes[slots[largest]].left;
+					slots[largest] = opened;
+					slots[slot_count++] = opened + 1;
+				}
+			}
+
+			const uint32_t node4Index = node4_count++;
+			Node4& node4 = nodes4[node4Index];
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				if (i < slot_count)
+				{
+					const Node& child = nodes[slots[i]];
+					SetNode4Slot(node4, i, child.aabb);
+					node4.source[i] = slots[i];
+					node4.count[i] = child.count;
+					node4.child[i] = child.isLeaf() ? child.offset : 0;
+				}
+				else
+				{
+					SetNode4Slot(node4, i, wi::primitive::AABB());
+					node4.source[i] = ~0u;
+					node4.count[i] = 0;
+					node4.child[i] = 0;
+				}
+			}
+			for (uint32_t i = 0; i < slot_count; ++i)
+			{
+				if (node4.count[i] == 0)
+				{
+					// nodes4 was allocated upfront, so the node4 reference is not invalidated by the recursion
+					node4.child[i] = CollapseNode(slots[i]);
+				}
+			}
+			return node4Index;
+		}
+
+		// Copies the refitted binary node bounds into the 4-wide tree
+		void RefitWide()
+		{
+			for (uint32_t i = 0; i < node4_count; ++i)
+			{
+				Node4& node4 = nodes4[i];
+				for (uint32_t j = 0; j < 4; ++j)
+				{
+					if (node4.source[j] != ~0u)
+					{
+						SetNode4Slot(node4, j, nodes[node4.source[j]].aabb);
+					}
+				}
+			}
+		}
+
 		void UpdateNodeBounds(uint32_t nodeIndex, const wi::primitive::AABB* leaf_aabb_data)
 		{
 			Node& node = nodes[nodeIndex];
@@ -206,5 +551,250 @@ namespace wi
 			Subdivide(left_child_index, leaf_aabb_data);
 			Subdivide(right_child_index, leaf_aabb_data);
 		}
+
+		// Binned SAH builder:
+		//	https://jacco.ompf2.com/2022/04/21/how-to-build-a-bvh-part-3-quick-builds/
+		static constexpr uint32_t sah_bin_count = 16;
+		static constexpr uint32_t sah_max_leaf_size = 4; // nodes with more primitives than this are always split
+		static constexpr uint32_t sah_parallel_threshold = 16384; // nodes with more primitives than this are binned and subdivided on the job system
+		static constexpr uint32_t sah_block_size = 4096; // primitives per job when binning in parallel
+
+		struct SAHBin
+		{
+			XMFLOAT3 bmin = XMFLOAT3(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+			XMFLOAT3 bmax = XMFLOAT3(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+			uint32_t count = 0;
+
+			void Grow(const XMFLOAT3& _min, const XMFLOAT3& _max)
+			{
+				bmin = XMFLOAT3(std::min(bmin.x, _min.x), std::min(bmin.y, _min.y), std::min(bmin.z, _min.z));
+				bmax = XMFLOAT3(std::max(bmax.x, _max.x), std::max(bmax.y, _max.y), std::max(bmax.z, _max.z));
+			}
+			void Merge(const SAHBin& other)
+			{
+				Grow(other.bmin, other.bmax);
+				count += other.count;
+			}
+		};
+		struct SAHBins
+		{
+			SAHBin centroid_bounds; // bounds of centroids, count is unused
+			SAHBin bins[3][sah_bin_count];
+		};
+		struct SAHBinning
+		{
+			XMFLOAT3 centroid_min;
+			XMFLOAT3 scale; // converts centroid offset to bin index, zero for axes that have no extent
+		};
+		struct SAHBuilder
+		{
+			const wi::primitive::AABB* aabbs = nullptr;
+			wi::vector<XMFLOAT3> centroids;
+			std::atomic<uint32_t> node_allocator{ 1 };
+			wi::jobsystem::context ctx;
+		};
+
+		static uint32_t SAHBinIndex(const SAHBinning& binning, const XMFLOAT3& centroid, int axis)
+		{
+			const float value = ((const float*)&centroid)[axis] - ((const float*)&binning.centroid_min)[axis];
+			const int bin = int(value * ((const float*)&binning.scale)[axis]);
+			return (uint32_t)clamp(bin, 0, int(sah_bin_count - 1));
+		}
+
+		// Processes the range of leaf_indices [begin, end) either for computing the centroid bounds (binning == nullptr) or for binning
+		void SAHBinRange(const SAHBuilder& builder, const SAHBinning* binning, uint32_t begin, uint32_t end, SAHBins& result) const
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const uint32_t index = leaf_indices[i];
+				const XMFLOAT3& centroid = builder.centroids[index];
+				if (binning == nullptr)
+				{
+					result.centroid_bounds.Grow(centroid, centroid);
+					continue;
+				}
+				const wi::primitive::AABB& aabb = builder.aabbs[index];
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					SAHBin& bin = result.bins[axis][SAHBinIndex(*binning, centroid, axis)];
+					bin.Grow(aabb._min, aabb._max);
+					bin.count++;
+				}
+			}
+		}
+		void SAHBinNode(const SAHBuilder& builder, const SAHBinning* binning, const Node& node, SAHBins& result) const
+		{
+			result = {};
+			if (node.count < sah_parallel_threshold)
+			{
+				SAHBinRange(builder, binning, node.offset, node.offset + node.count, result);
+				return;
+			}
+			// Large node: bin blocks of primitives in parallel, then merge the results
+			//	a separate context is used, because this can be called from within a job of builder.ctx
+			const uint32_t block_count = (node.count + sah_block_size - 1) / sah_block_size;
+			wi::vector<SAHBins> blocks(block_count);
+			wi::jobsystem::context ctx;
+			ctx.priority = builder.ctx.priority;
+			wi::jobsystem::Dispatch(ctx, block_count, 1, [&](wi::jobsystem::JobArgs args) {
+				const uint32_t begin = node.offset + args.jobIndex * sah_block_size;
+				const uint32_t end = std::min(begin + sah_block_size, node.offset + node.count);
+				SAHBinRange(builder, binning, begin, end, blocks[args.jobIndex]);
+			});
+			wi::jobsystem::Wait(ctx);
+			for (auto& block : blocks)
+			{
+				result.centroid_bounds.Merge(block.centroid_bounds);
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					for (uint32_t i = 0; i < sah_bin_count; ++i)
+					{
+						result.bins[axis][i].Merge(block.bins[axis][i]);
+					}
+				}
+			}
+		}
+
+		void BuildSAH(const wi::primitive::AABB* aabbs, uint32_t aabb_count)
+		{
+			SAHBuilder builder;
+			builder.aabbs = aabbs;
+			builder.centroids.resize(aabb_count);
+			wi::jobsystem::Dispatch(builder.ctx, aabb_count, sah_block_size, [&](wi::jobsystem::JobArgs args) {
+				builder.centroids[args.jobIndex] = aabbs[args.jobIndex].getCenter();
+			});
+			wi::jobsystem::Wait(builder.ctx);
+
+			SubdivideSAH(0, builder);
+			wi::jobsystem::Wait(builder.ctx);
+			node_count = builder.node_allocator.load();
+		}
+
+		void SubdivideSAH(uint32_t nodeIndex, SAHBuilder& builder)
+		{
+			// nodes was allocated upfront for the worst case, so the node reference stays valid while other jobs allocate nodes
+			Node& node = nodes[nodeIndex];
+			if (node.count <= 2)
+				return;
+
+			SAHBins bins;
+			SAHBinNode(builder, nullptr, node, bins);
+			const XMFLOAT3 cmin = bins.centroid_bounds.bmin;
+			const XMFLOAT3 cmax = bins.centroid_bounds.bmax;
+
+			SAHBinning binning;
+			binning.centroid_min = cmin;
+			bool degenerate = true;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const float extent = ((const float*)&cmax)[axis] - ((const float*)&cmin)[axis];
+				((float*)&binning.scale)[axis] = extent > 0 ? float(sah_bin_count) / extent : 0;
+				degenerate &= extent <= 0;
+			}
+
+			int best_axis = -1;
+			uint32_t best_split = 0;
+			float best_cost = std::numeric_limits<float>::max();
+			uint32_t left_count = 0;
+			SAHBin left_bounds;
+			SAHBin right_bounds;
+			if (!degenerate)
+			{
+				SAHBinNode(builder, &binning, node, bins);
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					if (((const float*)&binning.scale)[axis] == 0)
+						continue;
+					// sweep from both sides to get the cost of each split plane between the bins
+					SAHBin left_sweep[sah_bin_count - 1];
+					SAHBin right_sweep[sah_bin_count - 1];
+					SAHBin left;
+					SAHBin right;
+					for (uint32_t i = 0; i < sah_bin_count - 1; ++i)
+					{
+						left.Merge(bins.bins[axis][i]);
+						left_sweep[i] = left;
+						right.Merge(bins.bins[axis][sah_bin_count - 1 - i]);
+						right_sweep[sah_bin_count - 2 - i] = right;
+					}
+					for (uint32_t i = 0; i < sah_bin_count - 1; ++i)
+					{
+						const SAHBin& l = left_sweep[i];
+						const SAHBin& r = right_sweep[i];
+						if (l.count == 0 || r.count == 0)
+							continue;
+						const float cost = float(l.count) * HalfSurfaceArea(l.bmin, l.bmax) + float(r.count) * HalfSurfaceArea(r.bmin, r.bmax);
+						if (cost < best_cost)
+						{
+							best_cost = cost;
+							best_axis = axis;
+							best_split = i + 1;
+							left_count = l.count;
+							left_bounds = l;
+							right_bounds = r;
+						}
+					}
+				}
+			}
+
+			if (best_axis >= 0)
+			{
+				// Compare against not splitting, with the traversal cost of one extra node:
+				const float node_area = HalfSurfaceArea(node.aabb._min, node.aabb._max);
+				const float leaf_cost = float(node.count) * node_area;
+				if (node.count <= sah_max_leaf_size && node_area + best_cost >= leaf_cost)
+					return;
+
+				// in-place partition, it uses the same bin index calculation as the binning, so the left side will have left_count elements
+				auto begin = leaf_indices.begin() + node.offset;
+				std::partition(begin, begin + node.count, [&](uint32_t index) {
+					return SAHBinIndex(binning, builder.centroids[index], best_axis) < best_split;
+				});
+			}
+			else
+			{
+				// All centroids are at the same position, there is no good split, just halve the primitive list to keep leaves small
+				if (node.count <= sah_max_leaf_size)
+					return;
+				left_count = node.count / 2;
+			}
+
+			// create child nodes
+			const uint32_t left_child_index = builder.node_allocator.fetch_add(2);
+			const uint32_t right_child_index = left_child_index + 1;
+			node.left = left_child_index;
+			Node& left_child = nodes[left_child_index];
+			Node& right_child = nodes[right_child_index];
+			left_child = {};
+			left_child.offset = node.offset;
+			left_child.count = left_count;
+			right_child = {};
+			right_child.offset = node.offset + left_count;
+			right_child.count = node.count - left_count;
+			node.count = 0;
+			if (best_axis >= 0)
+			{
+				left_child.aabb = wi::primitive::AABB(left_bounds.bmin, left_bounds.bmax);
+				right_child.aabb = wi::primitive::AABB(right_bounds.bmin, right_bounds.bmax);
+			}
+			else
+			{
+				UpdateNodeBounds(left_child_index, builder.aabbs);
+				UpdateNodeBounds(right_child_index, builder.aabbs);
+			}
+
+			// recurse, large subtrees are built in parallel
+			if (left_child.count >= sah_parallel_threshold)
+			{
+				wi::jobsystem::Execute(builder.ctx, [this, &builder, left_child_index](wi::jobsystem::JobArgs args) {
+					SubdivideSAH(left_child_index, builder);
+				});
+			}
+			else
+			{
+				SubdivideSAH(left_child_index, builder);
+			}
+			SubdivideSAH(right_child_index, builder);
+		}
 	};
 }
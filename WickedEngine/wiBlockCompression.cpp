@@ -0,0 +1,784 @@
+#include "wiBlockCompression.h"
+#include "wiJobSystem.h"
+#include "wiMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace wi::graphics;
+
+namespace wi::blockcompression
+{
+	// 16 pixels of a 4x4 block in structure of arrays layout: one vector holds a row of 4 pixels, channel values are in [0, 255]
+	struct Block
+	{
+		XMVECTOR channels[4][4]; // [channel][row]
+	};
+
+	static void LoadBlock(const wi::Color* image, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, Block& block)
+	{
+		for (uint32_t row = 0; row < 4; ++row)
+		{
+			const uint32_t y = std::min(blockY * 4 + row, height - 1);
+			const wi::Color* src = image + size_t(y) * width;
+			XMMATRIX pixels;
+			for (uint32_t column = 0; column < 4; ++column)
+			{
+				const uint32_t x = std::min(blockX * 4 + column, width - 1);
+				pixels.r[column] = XMLoadUByte4((const XMUBYTE4*)&src[x]);
+			}
+			pixels = XMMatrixTranspose(pixels);
+			for (int channel = 0; channel < 4; ++channel)
+			{
+				block.channels[channel][row] = pixels.r[channel];
+			}
+		}
+	}
+
+	inline float Sum16(const XMVECTOR values[4])
+	{
+		return XMVectorGetX(XMVectorSum(XMVectorAdd(XMVectorAdd(values[0], values[1]), XMVectorAdd(values[2], values[3]))));
+	}
+	inline float HorizontalMin(XMVECTOR v)
+	{
+		v = XMVectorMin(v, XMVectorSwizzle<2, 3, 0, 1>(v));
+		v = XMVectorMin(v, XMVectorSwizzle<1, 0, 3, 2>(v));
+		return XMVectorGetX(v);
+	}
+	inline float HorizontalMax(XMVECTOR v)
+	{
+		v = XMVectorMax(v, XMVectorSwizzle<2, 3, 0, 1>(v));
+		v = XMVectorMax(v, XMVectorSwizzle<1, 0, 3, 2>(v));
+		return XMVectorGetX(v);
+	}
+
+	// Fits a line to the block colors along their principal axis, the endpoints are the extremes of the colors projected to the line
+	static void FitLine(const Block& block, int channel_count, float endpoint0[4], float endpoint1[4])
+	{
+		float mean[4] = {};
+		XMVECTOR centered[4][4];
+		for (int c = 0; c < channel_count; ++c)
+		{
+			mean[c] = Sum16(block.channels[c]) / 16.0f;
+			const XMVECTOR m = XMVectorReplicate(mean[c]);
+			for (int row = 0; row < 4; ++row)
+			{
+				centered[c][row] = XMVectorSubtract(block.channels[c][row], m);
+			}
+		}
+
+		float covariance[4][4] = {};
+		for (int i = 0; i < channel_count; ++i)
+		{
+			for (int j = i; j < channel_count; ++j)
+			{
+				XMVECTOR products[4];
+				for (int row = 0; row < 4; ++row)
+				{
+					products[row] = XMVectorMultiply(centered[i][row], centered[j][row]);
+				}
+				covariance[i][j] = covariance[j][i] = Sum16(products);
+			}
+		}
+
+		// Power iteration, starting from the covariance row of the channel with the largest variance:
+		int largest = 0;
+		for (int c = 1; c < channel_count; ++c)
+		{
+			if (covariance[c][c] > covariance[largest][largest])
+			{
+				largest = c;
+			}
+		}
+		float axis[4] = {};
+		for (int c = 0; c < channel_count; ++c)
+		{
+			axis[c] = covariance[largest][c];
+		}
+		for (int iteration = 0; iteration < 8; ++iteration)
+		{
+			float next[4] = {};
+			float length_sq = 0;
+			for (int i = 0; i < channel_count; ++i)
+			{
+				for (int j = 0; j < channel_count; ++j)
+				{
+					next[i] += covariance[i][j] * axis[j];
+				}
+				length_sq += next[i] * next[i];
+			}
+			if (length_sq < FLT_EPSILON)
+				break;
+			const float rcp_length = 1.0f / std::sqrt(length_sq);
+			for (int c = 0; c < channel_count; ++c)
+			{
+				axis[c] = next[c] * rcp_length;
+			}
+		}
+
+		XMVECTOR projected_min = XMVectorReplicate(FLT_MAX);
+		XMVECTOR projected_max = XMVectorReplicate(-FLT_MAX);
+		for (int row = 0; row < 4; ++row)
+		{
+			XMVECTOR projected = XMVectorZero();
+			for (int c = 0; c < channel_count; ++c)
+			{
+				projected = XMVectorMultiplyAdd(centered[c][row], XMVectorReplicate(axis[c]), projected);
+			}
+			projected_min = XMVectorMin(projected_min, projected);
+			projected_max = XMVectorMax(projected_max, projected);
+		}
+		const float tmin = HorizontalMin(projected_min);
+		const float tmax = HorizontalMax(projected_max);
+		for (int c = 0; c < channel_count; ++c)
+		{
+			endpoint0[c] = wi::math::Clamp(mean[c] + axis[c] * tmin, 0, 255);
+			endpoint1[c] = wi::math::Clamp(mean[c] + axis[c] * tmax, 0, 255);
+		}
+	}
+
+	// Finds the closest palette entry for every pixel, returns the sum of squared errors
+	//	channels: the block channels that are compared with the palette entries
+	static float SelectIndices(const XMVECTOR channels[][4], int channel_count, const float palette[][4], int palette_count, uint8_t indices[16])
+	{
+		float error = 0;
+		for (int row = 0; row < 4; ++row)
+		{
+			XMVECTOR best_distance = XMVectorReplicate(FLT_MAX);
+			XMVECTOR best_index = XMVectorZero();
+			for (int p = 0; p < palette_count; ++p)
+			{
+				XMVECTOR distance = XMVectorZero();
+				for (int c = 0; c < channel_count; ++c)
+				{
+					const XMVECTOR difference = XMVectorSubtract(channels[c][row], XMVectorReplicate(palette[p][c]));
+					distance = XMVectorMultiplyAdd(difference, difference, distance);
+				}
+				const XMVECTOR closer = XMVectorLess(distance, best_distance);
+				best_distance = XMVectorSelect(best_distance, distance, closer);
+				best_index = XMVectorSelect(best_index, XMVectorReplicate(float(p)), closer);
+			}
+			XMFLOAT4 best;
+			XMStoreFloat4(&best, best_index);
+			indices[row * 4 + 0] = uint8_t(best.x);
+			indices[row * 4 + 1] = uint8_t(best.y);
+			indices[row * 4 + 2] = uint8_t(best.z);
+			indices[row * 4 + 3] = uint8_t(best.w);
+			error += XMVectorGetX(XMVectorSum(best_distance));
+		}
+		return error;
+	}
+
+	// Computes the endpoints that minimize the squared error for the selected indices
+	//	weights: interpolation weight of each palette index from endpoint0 towards endpoint1
+	//	returns false if the indices don't determine the endpoints (for example all pixels use the same index)
+	static bool RefineEndpoints(const Block& block, int channel_count, const uint8_t indices[16], const float* weights, float endpoint0[4], float endpoint1[4])
+	{
+		XMVECTOR w[4];
+		for (int row = 0; row < 4; ++row)
+		{
+			w[row] = XMVectorSet(weights[indices[row * 4 + 0]], weights[indices[row * 4 + 1]], weights[indices[row * 4 + 2]], weights[indices[row * 4 + 3]]);
+		}
+		XMVECTOR aa[4], ab[4], bb[4];
+		for (int row = 0; row < 4; ++row)
+		{
+			const XMVECTOR inv = XMVectorSubtract(XMVectorSplatOne(), w[row]);
+			aa[row] = XMVectorMultiply(inv, inv);
+			ab[row] = XMVectorMultiply(inv, w[row]);
+			bb[row] = XMVectorMultiply(w[row], w[row]);
+		}
+		const float a = Sum16(aa);
+		const float b = Sum16(ab);
+		const float d = Sum16(bb);
+		const float det = a * d - b * b;
+		if (std::abs(det) < 1e-6f)
+			return false;
+		const float rcp_det = 1.0f / det;
+
+		for (int c = 0; c < channel_count; ++c)
+		{
+			XMVECTOR x0[4], x1[4];
+			for (int row = 0; row < 4; ++row)
+			{
+				x0[row] = XMVectorMultiply(XMVectorSubtract(XMVectorSplatOne(), w[row]), block.channels[c][row]);
+				x1[row] = XMVectorMultiply(w[row], block.channels[c][row]);
+			}
+			const float sum0 = Sum16(x0);
+			const float sum1 = Sum16(x1);
+			endpoint0[c] = wi::math::Clamp((d * sum0 - b * sum1) * rcp_det, 0, 255);
+			endpoint1[c] = wi::math::Clamp((a * sum1 - b * sum0) * rcp_det, 0, 255);
+		}
+		return true;
+	}
+
+	inline uint16_t QuantizeRGB565(const float color[4])
+	{
+		const uint16_t r = uint16_t(color[0] * (31.0f / 255.0f) + 0.5f);
+		const uint16_t g = uint16_t(color[1] * (63.0f / 255.0f) + 0.5f);
+		const uint16_t b = uint16_t(color[2] * (31.0f / 255.0f) + 0.5f);
+		return uint16_t((r << 11) | (g << 5) | b);
+	}
+	inline void UnquantizeRGB565(uint16_t value, uint32_t color[3])
+	{
+		const uint32_t r = (value >> 11) & 31;
+		const uint32_t g = (value >> 5) & 63;
+		const uint32_t b = value & 31;
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+	}
+
+	// Encodes the 8 byte color block of BC1 and BC3 in four color mode, alpha is ignored
+	static void EncodeColorBlock(const Block& block, uint8_t* dst)
+	{
+		static constexpr float weights[4] = { 0, 1, 1.0f / 3.0f, 2.0f / 3.0f };
+
+		float endpoint0[4] = {};
+		float endpoint1[4] = {};
+		FitLine(block, 3, endpoint0, endpoint1);
+
+		float best_error = FLT_MAX;
+		uint16_t best_color0 = 0;
+		uint16_t best_color1 = 0;
+		uint8_t best_indices[16] = {};
+		for (int iteration = 0; iteration < 2; ++iteration)
+		{
+			// Four color mode requires color0 > color1, which are the first and second palette entries:
+			uint16_t color0 = QuantizeRGB565(endpoint1);
+			uint16_t color1 = QuantizeRGB565(endpoint0);
+			if (color0 < color1)
+			{
+				std::swap(color0, color1);
+			}
+			uint32_t rgb0[3];
+			uint32_t rgb1[3];
+			UnquantizeRGB565(color0, rgb0);
+			UnquantizeRGB565(color1, rgb1);
+			float palette[4][4] = {};
+			for (int c = 0; c < 3; ++c)
+			{
+				palette[0][c] = float(rgb0[c]);
+				palette[1][c] = float(rgb1[c]);
+				palette[2][c] = float(2 * rgb0[c] + rgb1[c]) / 3.0f;
+				palette[3][c] = float(rgb0[c] + 2 * rgb1[c]) / 3.0f;
+			}
+
+			uint8_t indices[16];
+			const float error = SelectIndices(block.channels, 3, palette, color0 == color1 ? 1 : 4, indices);
+			if (error < best_error)
+			{
+				best_error = error;
+				best_color0 = color0;
+				best_color1 = color1;
+				std::memcpy(best_indices, indices, sizeof(indices));
+			}
+			if (color0 == color1 || !RefineEndpoints(block, 3, indices, weights, endpoint1, endpoint0))
+				break;
+		}
+
+		uint32_t index_bits = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			index_bits |= uint32_t(best_indices[i]) << (i * 2);
+		}
+		dst[0] = uint8_t(best_color0 & 0xFF);
+		dst[1] = uint8_t(best_color0 >> 8);
+		dst[2] = uint8_t(best_color1 & 0xFF);
+		dst[3] = uint8_t(best_color1 >> 8);
+		std::memcpy(dst + 4, &index_bits, sizeof(index_bits));
+	}
+
+	// Encodes the 8 byte single channel block of BC4, which is also used by BC3 alpha and both channels of BC5
+	static void EncodeSingleChannelBlock(const Block& block, int channel, uint8_t* dst)
+	{
+		XMVECTOR channel_min = block.channels[channel][0];
+		XMVECTOR channel_max = block.channels[channel][0];
+		for (int row = 1; row < 4; ++row)
+		{
+			channel_min = XMVectorMin(channel_min, block.channels[channel][row]);
+			channel_max = XMVectorMax(channel_max, block.channels[channel][row]);
+		}
+		// Eight value mode requires value0 > value1:
+		const uint8_t value0 = uint8_t(HorizontalMax(channel_max) + 0.5f);
+		const uint8_t value1 = uint8_t(HorizontalMin(channel_min) + 0.5f);
+
+		float palette[8][4] = {};
+		palette[0][0] = float(value0);
+		palette[1][0] = float(value1);
+		for (int i = 2; i < 8; ++i)
+		{
+			palette[i][0] = float((8 - i) * value0 + (i - 1) * value1) / 7.0f;
+		}
+
+		uint8_t indices[16];
+		SelectIndices(block.channels + channel, 1, palette, value0 == value1 ? 1 : 8, indices);
+
+		uint64_t index_bits = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			index_bits |= uint64_t(indices[i]) << (i * 3);
+		}
+		dst[0] = value0;
+		dst[1] = value1;
+		for (int i = 0; i < 6; ++i)
+		{
+			dst[2 + i] = uint8_t(index_bits >> (i * 8));
+		}
+	}
+
+	static constexpr uint32_t bc7_weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Quantizes an RGBA endpoint to 7 bits per channel with the shared p-bit that gives the lowest error
+	static void QuantizeBC7Endpoint(const float color[4], uint32_t quantized[4], uint32_t& pbit)
+	{
+		float best_error = FLT_MAX;
+		for (uint32_t p = 0; p < 2; ++p)
+		{
+			uint32_t q[4];
+			float error = 0;
+			for (int c = 0; c < 4; ++c)
+			{
+				q[c] = (uint32_t)wi::math::Clamp(std::round((color[c] - float(p)) * 0.5f), 0, 127);
+				const float difference = float((q[c] << 1) | p) - color[c];
+				error += difference * difference;
+			}
+			if (error < best_error)
+			{
+				best_error = error;
+				pbit = p;
+				std::memcpy(quantized, q, sizeof(q));
+			}
+		}
+	}
+
+	struct BitWriter
+	{
+		uint8_t* data = nullptr;
+		uint32_t position = 0;
+		void Write(uint32_t value, uint32_t bits)
+		{
+			for (uint32_t i = 0; i < bits; ++i)
+			{
+				data[position >> 3] |= uint8_t(((value >> i) & 1u) << (position & 7));
+				position++;
+			}
+		}
+	};
+	struct BitReader
+	{
+		const uint8_t* data = nullptr;
+		uint32_t position = 0;
+		uint32_t Read(uint32_t bits)
+		{
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < bits; ++i)
+			{
+				value |= uint32_t((data[position >> 3] >> (position & 7)) & 1u) << i;
+				position++;
+			}
+			return value;
+		}
+	};
+
+	// Encodes a 16 byte BC7 block in mode 6
+	static void EncodeBC7Block(const Block& block, uint8_t* dst)
+	{
+		float weights[16];
+		for (int i = 0; i < 16; ++i)
+		{
+			weights[i] = float(bc7_weights4[i]) / 64.0f;
+		}
+
+		float endpoint0[4] = {};
+		float endpoint1[4] = {};
+		FitLine(block, 4, endpoint0, endpoint1);
+
+		float best_error = FLT_MAX;
+		uint32_t best_quantized[2][4] = {};
+		uint32_t best_pbits[2] = {};
+		uint8_t best_indices[16] = {};
+		for (int iteration = 0; iteration < 2; ++iteration)
+		{
+			uint32_t quantized[2][4];
+			uint32_t pbits[2];
+			QuantizeBC7Endpoint(endpoint0, quantized[0], pbits[0]);
+			QuantizeBC7Endpoint(endpoint1, quantized[1], pbits[1]);
+
+			float palette[16][4];
+			for (int c = 0; c < 4; ++c)
+			{
+				const uint32_t value0 = (quantized[0][c] << 1) | pbits[0];
+				const uint32_t value1 = (quantized[1][c] << 1) | pbits[1];
+				for (int i = 0; i < 16; ++i)
+				{
+					palette[i][c] = float(((64 - bc7_weights4[i]) * value0 + bc7_weights4[i] * value1 + 32) >> 6);
+				}
+			}
+
+			uint8_t indices[16];
+			const float error = SelectIndices(block.channels, 4, palette, 16, indices);
+			if (error < best_error)
+			{
+				best_error = error;
+				std::memcpy(best_quantized, quantized, sizeof(quantized));
+				std::memcpy(best_pbits, pbits, sizeof(pbits));
+				std::memcpy(best_indices, indices, sizeof(indices));
+			}
+			if (!RefineEndpoints(block, 4, indices, weights, endpoint0, endpoint1))
+				break;
+		}
+
+		// The anchor index of the first pixel is stored without its highest bit, so it must be less than 8:
+		if (best_indices[0] >= 8)
+		{
+			std::swap(best_quantized[0], best_quantized[1]);
+			std::swap(best_pbits[0], best_pbits[1]);
+			for (int i = 0; i < 16; ++i)
+			{
+				best_indices[i] = 15 - best_indices[i];
+			}
+		}
+
+		std::memset(dst, 0, 16);
+		BitWriter writer;
+		writer.data = dst;
+		writer.Write(1u << 6, 7); // mode 6
+		for (int c = 0; c < 4; ++c)
+		{
+			writer.Write(best_quantized[0][c], 7);
+			writer.Write(best_quantized[1][c], 7);
+		}
+		writer.Write(best_pbits[0], 1);
+		writer.Write(best_pbits[1], 1);
+		writer.Write(best_indices[0], 3);
+		for (int i = 1; i < 16; ++i)
+		{
+			writer.Write(best_indices[i], 4);
+		}
+	}
+
+	static void DecodeColorBlock(const uint8_t* src, bool three_color_mode_allowed, wi::Color pixels[16])
+	{
+		const uint16_t color0 = uint16_t(src[0] | (src[1] << 8));
+		const uint16_t color1 = uint16_t(src[2] | (src[3] << 8));
+		uint32_t rgb0[3];
+		uint32_t rgb1[3];
+		UnquantizeRGB565(color0, rgb0);
+		UnquantizeRGB565(color1, rgb1);
+		wi::Color palette[4];
+		palette[0] = wi::Color(uint8_t(rgb0[0]), uint8_t(rgb0[1]), uint8_t(rgb0[2]));
+		palette[1] = wi::Color(uint8_t(rgb1[0]), uint8_t(rgb1[1]), uint8_t(rgb1[2]));
+		if (color0 > color1 || !three_color_mode_allowed)
+		{
+			palette[2] = wi::Color(uint8_t((2 * rgb0[0] + rgb1[0]) / 3), uint8_t((2 * rgb0[1] + rgb1[1]) / 3), uint8_t((2 * rgb0[2] + rgb1[2]) / 3));
+			palette[3] = wi::Color(uint8_t((rgb0[0] + 2 * rgb1[0]) / 3), uint8_t((rgb0[1] + 2 * rgb1[1]) / 3), uint8_t((rgb0[2] + 2 * rgb1[2]) / 3));
+		}
+		else
+		{
+			palette[2] = wi::Color(uint8_t((rgb0[0] + rgb1[0]) / 2), uint8_t((rgb0[1] + rgb1[1]) / 2), uint8_t((rgb0[2] + rgb1[2]) / 2));
+			palette[3] = wi::Color(0, 0, 0, 0);
+		}
+		uint32_t index_bits;
+		std::memcpy(&index_bits, src + 4, sizeof(index_bits));
+		for (int i = 0; i < 16; ++i)
+		{
+			pixels[i] = palette[(index_bits >> (i * 2)) & 3];
+		}
+	}
+
+	static void DecodeSingleChannelBlock(const uint8_t* src, uint8_t values[16])
+	{
+		const uint32_t value0 = src[0];
+		const uint32_t value1 = src[1];
+		uint8_t palette[8];
+		palette[0] = uint8_t(value0);
+		palette[1] = uint8_t(value1);
+		if (value0 > value1)
+		{
+			for (uint32_t i = 2; i < 8; ++i)
+			{
+				palette[i] = uint8_t(float((8 - i) * value0 + (i - 1) * value1) / 7.0f + 0.5f);
+			}
+		}
+		else
+		{
+			for (uint32_t i = 2; i < 6; ++i)
+			{
+				palette[i] = uint8_t(float((6 - i) * value0 + (i - 1) * value1) / 5.0f + 0.5f);
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+		uint64_t index_bits = 0;
+		for (int i = 0; i < 6; ++i)
+		{
+			index_bits |= uint64_t(src[2 + i]) << (i * 8);
+		}
+		for (int i = 0; i < 16; ++i)
+		{
+			values[i] = palette[(index_bits >> (i * 3)) & 7];
+		}
+	}
+
+	static bool DecodeBC7Block(const uint8_t* src, wi::Color pixels[16])
+	{
+		BitReader reader;
+		reader.data = src;
+		if (reader.Read(7) != (1u << 6))
+			return false; // not mode 6
+		uint32_t quantized[2][4];
+		for (int c = 0; c < 4; ++c)
+		{
+			quantized[0][c] = reader.Read(7);
+			quantized[1][c] = reader.Read(7);
+		}
+		const uint32_t pbit0 = reader.Read(1);
+		const uint32_t pbit1 = reader.Read(1);
+		for (int i = 0; i < 16; ++i)
+		{
+			const uint32_t weight = bc7_weights4[reader.Read(i == 0 ? 3 : 4)];
+			uint8_t rgba[4];
+			for (int c = 0; c < 4; ++c)
+			{
+				const uint32_t value0 = (quantized[0][c] << 1) | pbit0;
+				const uint32_t value1 = (quantized[1][c] << 1) | pbit1;
+				rgba[c] = uint8_t(((64 - weight) * value0 + weight * value1 + 32) >> 6);
+			}
+			pixels[i] = wi::Color(rgba[0], rgba[1], rgba[2], rgba[3]);
+		}
+		return true;
+	}
+
+	// Returns the UNORM format that the encoder uses for the format, or UNKNOWN if it's not supported
+	constexpr Format GetEncoderFormat(Format format)
+	{
+		switch (format)
+		{
+		case Format::BC1_UNORM:
+		case Format::BC1_UNORM_SRGB:
+			return Format::BC1_UNORM;
+		case Format::BC3_UNORM:
+		case Format::BC3_UNORM_SRGB:
+			return Format::BC3_UNORM;
+		case Format::BC4_UNORM:
+			return Format::BC4_UNORM;
+		case Format::BC5_UNORM:
+			return Format::BC5_UNORM;
+		case Format::BC7_UNORM:
+		case Format::BC7_UNORM_SRGB:
+			return Format::BC7_UNORM;
+		default:
+			return Format::UNKNOWN;
+		}
+	}
+
+	static void EncodeBlock(Format format, const Block& block, uint8_t* dst)
+	{
+		switch (format)
+		{
+		case Format::BC1_UNORM:
+			EncodeColorBlock(block, dst);
+			break;
+		case Format::BC3_UNORM:
+			EncodeSingleChannelBlock(block, 3, dst);
+			EncodeColorBlock(block, dst + 8);
+			break;
+		case Format::BC4_UNORM:
+			EncodeSingleChannelBlock(block, 0, dst);
+			break;
+		case Format::BC5_UNORM:
+			EncodeSingleChannelBlock(block, 0, dst);
+			EncodeSingleChannelBlock(block, 1, dst + 8);
+			break;
+		case Format::BC7_UNORM:
+			EncodeBC7Block(block, dst);
+			break;
+		default:
+			assert(0);
+			break;
+		}
+	}
+
+	// Schedules the compression of an image with one job per row of blocks
+	//	block_count_x, block_count_y: size of the output in blocks, the image is extended by repeating the border pixels to cover it
+	static void CompressImage(wi::jobsystem::context& ctx, const wi::Color* rgba, uint32_t width, uint32_t height, uint32_t block_count_x, uint32_t block_count_y, Format format, uint8_t* output)
+	{
+		const uint32_t block_bytes = GetFormatStride(format);
+		wi::jobsystem::Dispatch(ctx, block_count_y, 1, [=](wi::jobsystem::JobArgs args) {
+			uint8_t* dst = output + size_t(args.jobIndex) * block_count_x * block_bytes;
+			Block block;
+			for (uint32_t blockX = 0; blockX < block_count_x; ++blockX)
+			{
+				LoadBlock(rgba, width, height, blockX, args.jobIndex, block);
+				EncodeBlock(format, block, dst);
+				dst += block_bytes;
+			}
+		});
+	}
+
+	// Schedules the 2x2 box filter downsampling of an image to half size rounded down, so the last row and column of odd sizes are dropped
+	//	A size of 1 is kept, in that case the single row or column is sampled twice
+	static void Downsample(wi::jobsystem::context& ctx, const wi::Color* src, uint32_t src_width, uint32_t src_height, wi::Color* dst, uint32_t dst_width)
+	{
+		wi::jobsystem::Dispatch(ctx, std::max(1u, src_height / 2), 16, [=](wi::jobsystem::JobArgs args) {
+			const wi::Color* row0 = src + size_t(std::min(args.jobIndex * 2, src_height - 1)) * src_width;
+			const wi::Color* row1 = src + size_t(std::min(args.jobIndex * 2 + 1, src_height - 1)) * src_width;
+			wi::Color* dst_row = dst + size_t(args.jobIndex) * dst_width;
+			for (uint32_t x = 0; x < dst_width; ++x)
+			{
+				const uint32_t x0 = std::min(x * 2, src_width - 1);
+				const uint32_t x1 = std::min(x * 2 + 1, src_width - 1);
+				const XMVECTOR sum = XMVectorAdd(
+					XMVectorAdd(XMLoadUByte4((const XMUBYTE4*)&row0[x0]), XMLoadUByte4((const XMUBYTE4*)&row0[x1])),
+					XMVectorAdd(XMLoadUByte4((const XMUBYTE4*)&row1[x0]), XMLoadUByte4((const XMUBYTE4*)&row1[x1]))
+				);
+				XMUBYTE4 average;
+				XMStoreUByte4(&average, XMVectorMultiplyAdd(sum, XMVectorReplicate(0.25f), XMVectorReplicate(0.5f)));
+				dst_row[x] = wi::Color(average.v);
+			}
+		});
+	}
+
+	bool IsFormatSupported(Format format)
+	{
+		return GetEncoderFormat(format) != Format::UNKNOWN;
+	}
+
+	bool Compress(const wi::Color* rgba, uint32_t width, uint32_t height, Format format, wi::vector<uint8_t>& output)
+	{
+		format = GetEncoderFormat(format);
+		if (format == Format::UNKNOWN || width == 0 || height == 0)
+			return false;
+
+		const uint32_t block_count_x = (width + 3) / 4;
+		const uint32_t block_count_y = (height + 3) / 4;
+		output.resize(size_t(block_count_x) * block_count_y * GetFormatStride(format));
+
+		wi::jobsystem::context ctx;
+		CompressImage(ctx, rgba, width, height, block_count_x, block_count_y, format, output.data());
+		wi::jobsystem::Wait(ctx);
+		return true;
+	}
+
+	bool CompressMipChain(const wi::Color* rgba, TextureDesc& desc, wi::vector<uint8_t>& output)
+	{
+		const Format format = GetEncoderFormat(desc.format);
+		if (format == Format::UNKNOWN || desc.width == 0 || desc.height == 0)
+			return false;
+
+		uint32_t image_width = desc.width;
+		uint32_t image_height = desc.height;
+		const uint32_t block_size = GetFormatBlockSize(format);
+		const uint32_t block_bytes = GetFormatStride(format);
+		desc.width = align(desc.width, block_size);
+		desc.height = align(desc.height, block_size);
+		desc.depth = 1;
+		desc.array_size = 1;
+		desc.mip_levels = GetMipCount(desc.width, desc.height, 1, block_size);
+
+		size_t mip_offsets[16] = {};
+		size_t total_size = 0;
+		for (uint32_t mip = 0; mip < desc.mip_levels; ++mip)
+		{
+			const uint32_t block_count_x = (std::max(1u, desc.width >> mip) + block_size - 1) / block_size;
+			const uint32_t block_count_y = (std::max(1u, desc.height >> mip) + block_size - 1) / block_size;
+			mip_offsets[mip] = total_size;
+			total_size += size_t(block_count_x) * block_count_y * block_bytes;
+		}
+		output.resize(total_size);
+
+		// Compression of a mip level runs while the next mip level is downsampled from it:
+		wi::vector<wi::vector<wi::Color>> mips(desc.mip_levels - 1);
+		wi::jobsystem::context compress_ctx;
+		wi::jobsystem::context downsample_ctx;
+		const wi::Color* src = rgba;
+		for (uint32_t mip = 0; mip < desc.mip_levels; ++mip)
+		{
+			if (mip > 0)
+			{
+				const uint32_t mip_width = std::max(1u, image_width / 2);
+				const uint32_t mip_height = std::max(1u, image_height / 2);
+				wi::vector<wi::Color>& dst = mips[mip - 1];
+				dst.resize(size_t(mip_width) * mip_height);
+				Downsample(downsample_ctx, src, image_width, image_height, dst.data(), mip_width);
+				wi::jobsystem::Wait(downsample_ctx);
+				src = dst.data();
+				image_width = mip_width;
+				image_height = mip_height;
+			}
+			const uint32_t block_count_x = (std::max(1u, desc.width >> mip) + block_size - 1) / block_size;
+			const uint32_t block_count_y = (std::max(1u, desc.height >> mip) + block_size - 1) / block_size;
+			CompressImage(compress_ctx, src, image_width, image_height, block_count_x, block_count_y, format, output.data() + mip_offsets[mip]);
+		}
+		wi::jobsystem::Wait(compress_ctx);
+		return true;
+	}
+
+	bool Decompress(const uint8_t* data, uint32_t width, uint32_t height, Format format, wi::Color* rgba)
+	{
+		format = GetEncoderFormat(format);
+		if (format == Format::UNKNOWN)
+			return false;
+
+		const uint32_t block_bytes = GetFormatStride(format);
+		const uint32_t block_count_x = (width + 3) / 4;
+		const uint32_t block_count_y = (height + 3) / 4;
+		for (uint32_t blockY = 0; blockY < block_count_y; ++blockY)
+		{
+			for (uint32_t blockX = 0; blockX < block_count_x; ++blockX)
+			{
+				const uint8_t* src = data + (size_t(blockY) * block_count_x + blockX) * block_bytes;
+				wi::Color pixels[16];
+				uint8_t values[16];
+				switch (format)
+				{
+				case Format::BC1_UNORM:
+					DecodeColorBlock(src, true, pixels);
+					break;
+				case Format::BC3_UNORM:
+					DecodeColorBlock(src + 8, false, pixels);
+					DecodeSingleChannelBlock(src, values);
+					for (int i = 0; i < 16; ++i)
+					{
+						pixels[i].setA(values[i]);
+					}
+					break;
+				case Format::BC4_UNORM:
+					DecodeSingleChannelBlock(src, values);
+					for (int i = 0; i < 16; ++i)
+					{
+						pixels[i] = wi::Color(values[i], 0, 0, 255);
+					}
+					break;
+				case Format::BC5_UNORM:
+					DecodeSingleChannelBlock(src, values);
+					for (int i = 0; i < 16; ++i)
+					{
+						pixels[i] = wi::Color(values[i], 0, 0, 255);
+					}
+					DecodeSingleChannelBlock(src + 8, values);
+					for (int i = 0; i < 16; ++i)
+					{
+						pixels[i].setG(values[i]);
+					}
+					break;
+				case Format::BC7_UNORM:
+					if (!DecodeBC7Block(src, pixels))
+						return false;
+					break;
+				default:
+					return false;
+				}
+				for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; ++y)
+				{
+					for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; ++x)
+					{
+						rgba[size_t(blockY * 4 + y) * width + blockX * 4 + x] = pixels[y * 4 + x];
+					}
+				}
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiGraphics.h"
+#include "wiColor.h"
+#include "wiVector.h"
+
+namespace wi::blockcompression
+{
+	// CPU block compression encoder, the GPU alternative is wi::renderer::BlockCompress()
+	//	4x4 blocks are encoded with SIMD (4 pixels per vector) on job threads, one job per row of blocks
+	//	Endpoints are fitted along the principal axis of the block colors, then refined with least squares
+	//	BC7 output always uses mode 6 (single subset, RGBA endpoints with 4 bit indices)
+
+	// Returns true if the format can be encoded with this encoder: BC1, BC3, BC4, BC5, BC7 (including SRGB variants)
+	bool IsFormatSupported(wi::graphics::Format format);
+
+	// Compresses an RGBA8 image and waits for completion
+	//	The image is extended by repeating the border pixels if its size is not a multiple of 4
+	//	BC4 compresses the red channel, BC5 compresses the red and green channels
+	//	output: receives the tightly packed blocks, row by row
+	//	returns false if the format is not supported
+	bool Compress(const wi::Color* rgba, uint32_t width, uint32_t height, wi::graphics::Format format, wi::vector<uint8_t>& output);
+
+	// Generates the mip chain of an RGBA8 image with a box filter and compresses every mip level
+	//	desc: format selects the block compressed format, width and height are the image size
+	//		on return, width and height are aligned to the block size and mip_levels is filled (same as the GPU import path)
+	//	output: receives every mip level tightly packed, this can be written with wi::helper::saveTextureToMemoryFile()
+	bool CompressMipChain(const wi::Color* rgba, wi::graphics::TextureDesc& desc, wi::vector<uint8_t>& output);
+
+	// Decompresses block compressed data into an RGBA8 image, this is intended for validation and tools
+	//	BC7 can only be decoded if the blocks use mode 6, like those of Compress()
+	bool Decompress(const uint8_t* data, uint32_t width, uint32_t height, wi::graphics::Format format, wi::Color* rgba);
+}
@@ -7,11 +7,16 @@
 #include "wiUnorderedSet.h"
 #include "wiVector.h"
 #include "wiAllocator.h"
+#include "wiSpinLock.h"
+#include "wiTimer.h"
 
 #include <cstdint>
 #include <cassert>
 #include <atomic>
 #include <memory>
+#include <array>
+#include <tuple>
+#include <utility>
 #include <string>
 
 // Entity-Component System
@@ -32,22 +37,116 @@ namespace wi::ecs
 	}
 	inline static constexpr size_t INVALID_INDEX = ~0ull;
 
+	// Returns a globally unique number that can identify the state of a container
+	inline uint64_t NextGeneration()
+	{
+		static std::atomic<uint64_t> next{ 1 };
+		return next.fetch_add(1, std::memory_order_relaxed);
+	}
+
 	class ComponentLibrary;
 	struct EntitySerializer
 	{
 		wi::jobsystem::context ctx; // allow components to spawn serialization subtasks
 		wi::unordered_map<uint64_t, Entity> remap;
 		bool allow_remap = true;
+		bool allow_chunks = false; // if true, the ComponentLibrary will write component managers into separate archive chunks (from archive version 94)
+		bool allow_parallel = true; // if true, the ComponentLibrary will deserialize component managers from separate archive chunks in parallel
 		uint64_t version = 0; // The ComponentLibrary serialization will modify this by the registered component's version number
 		wi::unordered_set<std::string> resource_registration; // register for resource manager serialization
 		ComponentLibrary* componentlibrary = nullptr;
 		wi::unordered_map<std::string, uint64_t> library_versions;
 
+		// Per component manager timings, filled by ComponentLibrary::Serialize() when reading separate archive chunks:
+		struct ComponentTiming
+		{
+			std::string name;
+			double read_milliseconds = 0; // reading and decompressing the chunk
+			double serialize_milliseconds = 0; // deserializing the components
+		};
+		wi::vector<ComponentTiming> component_timings;
+
+		// Parallel entity remapping:
+		//	While parallel remapping is active, the remap table is split into shards that are locked individually,
+		//	and EntitySerializers of parallel jobs refer to the parent EntitySerializer that holds the shards
+		EntitySerializer* parent = nullptr;
+		struct RemapShard
+		{
+			wi::SpinLock locker;
+			wi::unordered_map<uint64_t, Entity> remap;
+		};
+		static constexpr size_t remap_shard_count = 64;
+		std::unique_ptr<RemapShard[]> remap_shards;
+
 		~EntitySerializer()
 		{
 			wi::jobsystem::Wait(ctx); // automatically wait for all subtasks after serialization
 		}
 
+		// Returns the entity that a serialized entity is remapped to, a new entity is created on the first occurence
+		//	It is thread safe between BeginParallelRemap() and EndParallelRemap()
+		Entity Remap(uint64_t mem)
+		{
+			if (parent != nullptr)
+				return parent->Remap(mem);
+
+			if (remap_shards != nullptr)
+			{
+				// Note: shard is selected by low bits, because the maps are hashing with high bits
+				RemapShard& shard = remap_shards[mem % remap_shard_count];
+				shard.locker.lock();
+				auto it = shard.remap.find(mem);
+				Entity entity = INVALID_ENTITY;
+				if (it == shard.remap.end())
+				{
+					entity = CreateEntity();
+					shard.remap[mem] = entity;
+				}
+				else
+				{
+					entity = it->second;
+				}
+				shard.locker.unlock();
+				return entity;
+			}
+
+			auto it = remap.find(mem);
+			if (it == remap.end())
+			{
+				Entity entity = CreateEntity();
+				remap[mem] = entity;
+				return entity;
+			}
+			return it->second;
+		}
+
+		// Distributes the remap table into shards, so that Remap() can be used from multiple threads
+		void BeginParallelRemap()
+		{
+			assert(parent == nullptr);
+			assert(remap_shards == nullptr);
+			remap_shards = std::make_unique<RemapShard[]>(remap_shard_count);
+			for (auto& it : remap)
+			{
+				remap_shards[it.first % remap_shard_count].remap[it.first] = it.second;
+			}
+			remap.clear();
+		}
+
+		// Merges the remap shards back into the remap table
+		void EndParallelRemap()
+		{
+			assert(remap_shards != nullptr);
+			for (size_t i = 0; i < remap_shard_count; ++i)
+			{
+				for (auto& it : remap_shards[i].remap)
+				{
+					remap[it.first] = it.second;
+				}
+			}
+			remap_shards.reset();
+		}
+
 		// Returns the library version of the currently serializing Component
 		//	If not using ComponentLibrary, it returns version set by the user.
 		uint64_t GetVersion() const
@@ -82,16 +181,7 @@ namespace wi::ecs
 
 			if (mem != INVALID_ENTITY && seri.allow_remap)
 			{
-				auto it = seri.remap.find(mem);
-				if (it == seri.remap.end())
-				{
-					entity = CreateEntity();
-					seri.remap[mem] = entity;
-				}
-				else
-				{
-					entity = it->second;
-				}
+				entity = seri.Remap(mem);
 			}
 			else
 			{
@@ -167,6 +257,7 @@ namespace wi::ecs
 			components.clear();
 			entities.clear();
 			lookup.clear();
+			generation = NextGeneration();
 		}
 
 		// Perform deep copy of all the contents of "other" into this
@@ -182,6 +273,7 @@ namespace wi::ecs
 				lookup.insert(entity, components.size());
 				components.push_back(other.components[i]);
 			}
+			generation = NextGeneration();
 		}
 
 		// Merge in an other component manager of the same type to this.
@@ -200,6 +292,7 @@ namespace wi::ecs
 				lookup.insert(entity, components.size());
 				components.push_back(std::move(other.components[i]));
 			}
+			generation = NextGeneration();
 
 			other.Clear();
 		}
@@ -241,6 +334,7 @@ namespace wi::ecs
 						entities[prev_count + i] = entity;
 						lookup.insert(entity, prev_count + i);
 					}
+					generation = NextGeneration();
 				}
 				else
 				{
@@ -317,6 +411,8 @@ namespace wi::ecs
 			// Also push corresponding entity:
 			entities.push_back(entity);
 
+			generation = NextGeneration();
+
 			return components.back();
 		}
 
@@ -340,6 +436,7 @@ namespace wi::ecs
 				components.pop_back();
 				entities.pop_back();
 				lookup.erase(entity);
+				generation = NextGeneration();
 			}
 		}
 
@@ -368,6 +465,7 @@ namespace wi::ecs
 				components.pop_back();
 				entities.pop_back();
 				lookup.erase(entity);
+				generation = NextGeneration();
 			}
 		}
 
@@ -399,6 +497,7 @@ namespace wi::ecs
 			components[index_to] = std::move(component);
 			entities[index_to] = entity;
 			lookup.insert(entity, index_to);
+			generation = NextGeneration();
 		}
 
 		// Check if a component exists for a given entity or not
@@ -456,11 +555,17 @@ namespace wi::ecs
 		inline const Component* GetData() const { return components.data(); }
 		inline Component* GetData() { return components.data(); }
 
+		// Returns a number that changes every time when entities are added, removed or reordered
+		//	It can be used to validate cached component indices
+		inline uint64_t GetGeneration() const { return generation; }
+
 	private:
 		// This is a linear array of alive components
 		wi::vector<Component> components;
 		// This is a linear array of entities corresponding to each alive component
 		wi::vector<Entity> entities;
+		// This identifies the current layout of the entity array
+		uint64_t generation = NextGeneration();
 
 //#define LOOKUP_STRAIGHT
 //#define LOOKUP_SPARSE
@@ -704,6 +809,239 @@ namespace wi::ecs
 		ComponentManager(const ComponentManager&) = delete;
 	};
 
+	// Frequently accessed (hot) fields of components in structure of arrays layout, kept in the same order as the components of a ComponentManager
+	//	Every field is stored in a separate packed array, so systems that only need a few fields of large components stream through contiguous memory,
+	//	and SIMD code can load the same field of 4 consecutive components at once (the arrays are padded to a multiple of 4 elements, the padding must be ignored)
+	//	Sync() must be called before the streams are written
+	//
+	//	Example:
+	//		ComponentStream<float, float, float> positions; // x, y and z streams
+	//		positions.Sync(components);
+	//		float* x = positions.Get<0>();
+	template<typename... Fields>
+	class ComponentStream
+	{
+		static_assert(sizeof...(Fields) > 0, "ComponentStream needs at least one field!");
+
+	public:
+		// Resizes the streams to match the component manager
+		//	returns true if the components were added, removed or reordered since the last Sync(), which means that the contents are invalid
+		template<typename Component>
+		inline bool Sync(const ComponentManager<Component>& manager)
+		{
+			if (generation == manager.GetGeneration() && count == manager.GetCount())
+				return false;
+			count = manager.GetCount();
+			const size_t padded_count = (count + 3) & ~size_t(3);
+			std::apply([padded_count](auto&... streams) { (streams.resize(padded_count), ...); }, streams);
+			generation = manager.GetGeneration();
+			return true;
+		}
+
+		inline void Clear()
+		{
+			std::apply([](auto&... streams) { (streams.clear(), ...); }, streams);
+			count = 0;
+			generation = 0;
+		}
+
+		// Returns the packed array of a field
+		template<size_t Field>
+		inline auto* Get() { return std::get<Field>(streams).data(); }
+		template<size_t Field>
+		inline const auto* Get() const { return std::get<Field>(streams).data(); }
+
+		// Number of components, without the padding
+		inline size_t GetCount() const { return count; }
+
+	private:
+		std::tuple<wi::vector<Fields>...> streams;
+		size_t count = 0;
+		uint64_t generation = 0;
+	};
+
+	// Marks a component type as optional in a Query
+	//	Optional components are given as pointers, which are nullptr if the entity doesn't have that component
+	template<typename Component>
+	struct Optional {};
+
+	namespace query_internal
+	{
+		template<typename T>
+		struct traits
+		{
+			using component_type = T;
+			using param_type = T&;
+			static constexpr bool optional = false;
+		};
+		template<typename T>
+		struct traits<Optional<T>>
+		{
+			using component_type = T;
+			using param_type = T*;
+			static constexpr bool optional = true;
+		};
+	}
+
+	// Joins multiple component managers by entity and caches the matching component indices
+	//	The first component manager drives the iteration, its components are matched with the components of the same entity in the other managers
+	//	An entity is only part of the query if it has all the components that are not marked as Optional<>
+	//	Update() must be called before using the query. It only rebuilds the cache if any of the component managers added, removed or reordered components,
+	//	otherwise iteration is a linear walk over the cached indices, without lookups
+	//
+	//	Example:
+	//		Query<LightComponent, TransformComponent, Optional<LayerComponent>> query(lights, transforms, layers);
+	//		query.Update();
+	//		query.ForEach([](Entity entity, LightComponent& light, TransformComponent& transform, LayerComponent* layer) { ... });
+	template<typename... Components>
+	class Query
+	{
+		static_assert(sizeof...(Components) > 0, "Query needs at least one component type!");
+
+	public:
+		static constexpr size_t component_count = sizeof...(Components);
+		using Row = std::array<uint32_t, component_count>;
+		using Managers = std::tuple<ComponentManager<typename query_internal::traits<Components>::component_type>*...>;
+
+		Query(ComponentManager<typename query_internal::traits<Components>::component_type>&... component_managers) : managers(&component_managers...)
+		{
+			static_assert(!query_internal::traits<std::tuple_element_t<0, std::tuple<Components...>>>::optional, "The first component of a Query can't be optional!");
+		}
+
+		// Rebuilds the cached indices if any of the component managers changed its layout since the last Update()
+		//	returns true if the cache was rebuilt
+		inline bool Update()
+		{
+			bool changed = false;
+			check_generations(changed, std::index_sequence_for<Components...>{});
+			if (!changed)
+				return false;
+
+			rows.clear();
+			entities.clear();
+			const auto& first = *std::get<0>(managers);
+			for (size_t i = 0; i < first.GetCount(); ++i)
+			{
+				const Entity entity = first.GetEntity(i);
+				Row row;
+				if (match(entity, row, std::index_sequence_for<Components...>{}))
+				{
+					row[0] = (uint32_t)i;
+					rows.push_back(row);
+					entities.push_back(entity);
+				}
+			}
+			return true;
+		}
+
+		// Forces rebuilding the cache in the next Update()
+		inline void Invalidate()
+		{
+			for (auto& generation : generations)
+			{
+				generation = 0;
+			}
+		}
+
+		// Returns the number of matched entities
+		inline size_t GetCount() const { return rows.size(); }
+
+		// Returns the entity of a matched row
+		inline Entity GetEntity(size_t row) const { return entities[row]; }
+
+		// Returns the index of the component of a matched row in the Nth component manager, or INVALID_INDEX if it's a missing optional component
+		template<size_t N>
+		inline size_t GetIndex(size_t row) const
+		{
+			const uint32_t index = rows[row][N];
+			return index == ~0u ? INVALID_INDEX : (size_t)index;
+		}
+
+		// Returns the component of a matched row from the Nth component manager
+		//	It is a reference for required components, and a pointer for optional components
+		template<size_t N>
+		inline typename query_internal::traits<std::tuple_element_t<N, std::tuple<Components...>>>::param_type Get(size_t row) const
+		{
+			auto& manager = *std::get<N>(managers);
+			const uint32_t index = rows[row][N];
+			if constexpr (query_internal::traits<std::tuple_element_t<N, std::tuple<Components...>>>::optional)
+			{
+				return index == ~0u ? nullptr : &manager[index];
+			}
+			else
+			{
+				return manager[index];
+			}
+		}
+
+		// Iterates through all matched rows on the calling thread
+		//	func must have the signature: void(Entity entity, Components... components)
+		template<typename F>
+		inline void ForEach(const F& func) const
+		{
+			for (size_t row = 0; row < rows.size(); ++row)
+			{
+				invoke(func, row, std::index_sequence_for<Components...>{});
+			}
+		}
+
+		// Iterates through all matched rows with the job system, each row is one job, args.jobIndex is the row index
+		//	func must have the signature: void(wi::jobsystem::JobArgs args, Entity entity, Components... components)
+		//	func is copied into the jobs, so it must fit into a job function together with a pointer
+		template<typename F>
+		inline void Dispatch(wi::jobsystem::context& ctx, uint32_t groupSize, const F& func, size_t sharedmemory_size = 0) const
+		{
+			wi::jobsystem::Dispatch(ctx, (uint32_t)rows.size(), groupSize, [this, func](wi::jobsystem::JobArgs args) {
+				invoke_args(func, args, std::index_sequence_for<Components...>{});
+			}, sharedmemory_size);
+		}
+
+	private:
+		Managers managers;
+		wi::vector<Row> rows;
+		wi::vector<Entity> entities;
+		uint64_t generations[component_count] = {};
+
+		template<size_t... I>
+		inline void check_generations(bool& changed, std::index_sequence<I...>)
+		{
+			((changed |= generations[I] != std::get<I>(managers)->GetGeneration(), generations[I] = std::get<I>(managers)->GetGeneration()), ...);
+		}
+
+		template<size_t... I>
+		inline bool match(Entity entity, Row& row, std::index_sequence<I...>) const
+		{
+			return (match_one<I>(entity, row) && ...);
+		}
+
+		template<size_t N>
+		inline bool match_one(Entity entity, Row& row) const
+		{
+			if constexpr (N == 0)
+			{
+				return true;
+			}
+			else
+			{
+				const size_t index = std::get<N>(managers)->GetIndex(entity);
+				row[N] = index == INVALID_INDEX ? ~0u : (uint32_t)index;
+				return index != INVALID_INDEX || query_internal::traits<std::tuple_element_t<N, std::tuple<Components...>>>::optional;
+			}
+		}
+
+		template<typename F, size_t... I>
+		inline void invoke(const F& func, size_t row, std::index_sequence<I...>) const
+		{
+			func(entities[row], Get<I>(row)...);
+		}
+
+		template<typename F, size_t... I>
+		inline void invoke_args(const F& func, wi::jobsystem::JobArgs args, std::index_sequence<I...>) const
+		{
+			func(args, entities[args.jobIndex], Get<I>(args.jobIndex)...);
+		}
+	};
+
 	// This is the class to store all component managers,
 	// this is useful for bulk operation of all attached components within an entity
 	class ComponentLibrary
@@ -754,9 +1092,151 @@ namespace wi::ecs
 		}
 
 		// Serialize all registered component managers
+		//	If EntitySerializer::allow_chunks is true, each component manager is serialized into a separate archive chunk:
+		//	- chunks of component managers that are not registered are not read at all
+		//	- the chunks are read and decompressed in parallel before deserializing the component managers
 		inline void Serialize(wi::Archive& archive, EntitySerializer& seri)
 		{
 			seri.componentlibrary = this;
+			bool chunked = false;
+			if (archive.GetVersion() >= 94)
+			{
+				if (archive.IsReadMode())
+				{
+					archive >> chunked;
+				}
+				else
+				{
+					chunked = seri.allow_chunks;
+					archive << chunked;
+				}
+			}
+			if (chunked)
+			{
+				if (archive.IsReadMode())
+				{
+					struct ChunkEntry
+					{
+						const std::string* name = nullptr;
+						ComponentManager_Interface* component_manager = nullptr;
+						uint64_t version = 0;
+						size_t chunk_index = 0;
+						wi::Archive chunk;
+						double read_milliseconds = 0;
+						double serialize_milliseconds = 0;
+					};
+					wi::vector<ChunkEntry> chunk_entries;
+
+					// Gather component type versions and chunks that will be needed:
+					bool has_next = false;
+					do
+					{
+						archive >> has_next;
+						if (has_next)
+						{
+							std::string name;
+							archive >> name;
+							uint64_t version = 0;
+							archive >> version;
+							size_t chunk_index = 0;
+							archive >> chunk_index;
+							auto it = entries.find(name);
+							if (it != entries.end())
+							{
+								seri.library_versions[name] = version;
+								ChunkEntry& chunk_entry = chunk_entries.emplace_back();
+								chunk_entry.name = &it->first;
+								chunk_entry.component_manager = it->second.component_manager.get();
+								chunk_entry.version = version;
+								chunk_entry.chunk_index = chunk_index;
+							}
+							// else: component manager of this name was not registered, its chunk will not be read
+						}
+					} while (has_next);
+
+					// Read and decompress all needed chunks in parallel, and if allowed, also deserialize them in parallel:
+					//	At this point, all existing component type versions are available
+					//	Each component manager is deserialized by only one job, but entity remapping is shared between them
+					const bool parallel = seri.allow_parallel;
+					if (parallel)
+					{
+						seri.BeginParallelRemap();
+					}
+					wi::jobsystem::context ctx;
+					ctx.priority = seri.ctx.priority;
+					wi::jobsystem::Dispatch(ctx, (uint32_t)chunk_entries.size(), 1, [&](wi::jobsystem::JobArgs args) {
+						ChunkEntry& chunk_entry = chunk_entries[args.jobIndex];
+						wi::Timer timer;
+						if (!archive.ReadChunk(chunk_entry.chunk_index, chunk_entry.chunk))
+						{
+							chunk_entry.chunk.Close();
+							return;
+						}
+						chunk_entry.read_milliseconds = timer.record_elapsed_seconds() * 1000.0;
+						if (!parallel)
+							return;
+
+						{
+							EntitySerializer job_seri;
+							job_seri.parent = &seri;
+							job_seri.ctx.priority = seri.ctx.priority;
+							job_seri.allow_remap = seri.allow_remap;
+							job_seri.version = chunk_entry.version;
+							job_seri.componentlibrary = this;
+							job_seri.library_versions = seri.library_versions;
+							chunk_entry.component_manager->Serialize(chunk_entry.chunk, job_seri);
+						} // job_seri waits for its subtasks here
+						chunk_entry.serialize_milliseconds = timer.elapsed_milliseconds();
+						chunk_entry.chunk.Close(); // releases chunk data
+					});
+					wi::jobsystem::Wait(ctx);
+					if (parallel)
+					{
+						seri.EndParallelRemap();
+					}
+
+					for (ChunkEntry& chunk_entry : chunk_entries)
+					{
+						if (!parallel && chunk_entry.chunk.IsOpen())
+						{
+							wi::Timer timer;
+							seri.version = chunk_entry.version;
+							chunk_entry.component_manager->Serialize(chunk_entry.chunk, seri);
+							chunk_entry.chunk.Close(); // releases chunk data, but the source directory is kept
+							chunk_entry.serialize_milliseconds = timer.elapsed_milliseconds();
+						}
+						EntitySerializer::ComponentTiming& timing = seri.component_timings.emplace_back();
+						timing.name = *chunk_entry.name;
+						timing.read_milliseconds = chunk_entry.read_milliseconds;
+						timing.serialize_milliseconds = chunk_entry.serialize_milliseconds;
+					}
+
+					// Component serialization subtasks can refer to the chunk archives (eg. source directory), so they must finish before the chunks are destroyed:
+					wi::jobsystem::Wait(seri.ctx);
+				}
+				else
+				{
+					// Save all component type versions:
+					for (auto& it : entries)
+					{
+						seri.library_versions[it.first] = it.second.version;
+					}
+					// Serialize all component data into separate chunks:
+					for (auto& it : entries)
+					{
+						wi::Archive chunk;
+						seri.version = it.second.version;
+						it.second.component_manager->Serialize(chunk, seri);
+						archive << true;
+						archive << it.first; // name
+						archive << it.second.version;
+						archive << archive.WriteChunk(it.first, chunk);
+					}
+					archive << false;
+				}
+				return;
+			}
+
 			if(archive.IsReadMode())
 			{
 				bool has_next = false;
@@ -14,6 +14,7 @@
 #include "wiUnorderedSet.h"
 #include "wiVector.h"
 #include "wiMath.h"
+#include "wiArchive.h"
 
 #include "Utility/liberation_sans.h"
 #include "Utility/stb_truetype.h"
@@ -46,15 +47,113 @@ namespace wi::font
 
 		static Texture texture;
 
+		// SDF glyphs are rasterized only at this height, and they are scaled to the requested text size when rendering
+		static constexpr uint32_t sdf_glyph_height = 48;
+
+		// The atlas is square, it starts at the min size and its size is doubled when it is full
+		static constexpr int atlas_min_size = 512;
+		static constexpr int atlas_max_size = 4096;
+
+		struct Bitmap
+		{
+			int width;
+			int height;
+			int xoff;
+			int yoff;
+			wi::vector<uint8_t> data;
+		};
+
+		// The glyph cache stores the SDF glyph bitmaps of fonts in files, if the directory is not empty
+		static std::string glyph_cache_directory;
+		static constexpr uint64_t glyph_cache_version = 1; // increment this if the format or the SDF parameters change
+
 		struct FontStyle
 		{
 			std::string name;
 			wi::vector<uint8_t> fontBuffer; // only used if loaded from file, need to keep alive
 			stbtt_fontinfo fontInfo;
 			int ascent, descent, lineGap;
+			uint64_t data_hash = 0; // identifies the glyph cache file of the font
+			wi::unordered_map<int, Bitmap> sdf_glyphs; // glyph cache: SDF bitmaps by glyph index
+			bool sdf_glyphs_changed = false; // there are new glyphs that are not in the glyph cache file yet
+
+			std::string GetGlyphCacheFileName() const
+			{
+				char filename[32] = {};
+				snprintf(filename, arraysize(filename), "%016llx.wiglyphs", (unsigned long long)data_hash);
+				return glyph_cache_directory + filename;
+			}
+			void LoadGlyphCache()
+			{
+				sdf_glyphs.clear();
+				sdf_glyphs_changed = false;
+				const std::string filename = GetGlyphCacheFileName();
+				if (!wi::helper::FileExists(filename))
+					return;
+				wi::Archive archive(filename, true, false);
+				if (!archive.IsOpen())
+					return;
+				uint64_t version = 0;
+				uint32_t height = 0;
+				uint32_t padding = 0;
+				uint32_t onedge_value = 0;
+				archive >> version;
+				archive >> height;
+				archive >> padding;
+				archive >> onedge_value;
+				if (version != glyph_cache_version || height != sdf_glyph_height || padding != SDF::padding || onedge_value != SDF::onedge_value)
+					return;
+				size_t count = 0;
+				archive >> count;
+				for (size_t i = 0; i < count && archive.GetPos() < archive.GetSize(); ++i)
+				{
+					int glyphIndex = 0;
+					Bitmap bitmap;
+					archive >> glyphIndex;
+					archive >> bitmap.width;
+					archive >> bitmap.height;
+					archive >> bitmap.xoff;
+					archive >> bitmap.yoff;
+					archive >> bitmap.data;
+					if (bitmap.data.size() == size_t(bitmap.width) * size_t(bitmap.height))
+					{
+						sdf_glyphs[glyphIndex] = std::move(bitmap);
+					}
+				}
+			}
+			void SaveGlyphCache()
+			{
+				if (!sdf_glyphs_changed)
+					return;
+				wi::Archive archive;
+				archive << glyph_cache_version;
+				archive << sdf_glyph_height;
+				archive << SDF::padding;
+				archive << SDF::onedge_value;
+				archive << sdf_glyphs.size();
+				for (auto& it : sdf_glyphs)
+				{
+					archive << it.first;
+					archive << it.second.width;
+					archive << it.second.height;
+					archive << it.second.xoff;
+					archive << it.second.yoff;
+					archive << it.second.data;
+				}
+				if (!wi::helper::DirectoryExists(glyph_cache_directory))
+				{
+					wi::helper::DirectoryCreate(glyph_cache_directory);
+				}
+				if (wi::helper::FileWriteAtomic(GetGlyphCacheFileName(), archive.GetData(), archive.GetPos()))
+				{
+					sdf_glyphs_changed = false;
+				}
+			}
+
 			void Create(const std::string& newName, const uint8_t* data, size_t size)
 			{
 				name = newName;
+				data_hash = wi::helper::data_hash(data, size);
 				int offset = stbtt_GetFontOffsetForIndex(data, 0);
 
 				if (!stbtt_InitFont(&fontInfo, data, offset))
@@ -63,6 +162,11 @@ namespace wi::font
 				}
 
 				stbtt_GetFontVMetrics(&fontInfo, &ascent, &descent, &lineGap);
+
+				if (!glyph_cache_directory.empty())
+				{
+					LoadGlyphCache();
+				}
 			}
 			void Create(const std::string& newName)
 			{
@@ -91,22 +195,18 @@ namespace wi::font
 			const FontStyle* fontStyle = nullptr;
 		};
 		static wi::unordered_map<int32_t, Glyph> glyph_lookup;
-		static wi::unordered_map<int32_t, wi::rectpacker::Rect> rect_lookup;
-		struct Bitmap
-		{
-			int width;
-			int height;
-			int xoff;
-			int yoff;
-			wi::vector<uint8_t> data;
-		};
-		static wi::unordered_map<int32_t, Bitmap> bitmap_lookup;
+		static wi::unordered_map<int32_t, wi::rectpacker::Rect> rect_lookup; // placement of glyphs in the atlas, including 1 pixel border
+		static wi::rectpacker::State atlas_packer; // new glyphs are packed into the remaining space of the atlas
+		static wi::vector<uint8_t> atlas_bitmap; // CPU-side copy of the atlas texture
+		static int atlas_size = 0;
+		static bool atlas_full = false; // the packer can't continue packing into the current atlas
+		static bool atlas_repack_failed = false; // the glyphs didn't fit into the largest atlas, repacking is not attempted again until glyphs are removed
 		union GlyphHash
 		{
 			struct
 			{
 				uint32_t code : 16;		// character code range supported: 0 - 65535
-				uint32_t height : 10;	// height supported: 0 - 1023
+				uint32_t height : 10;	// height supported: 0 - 1023 (always 0 for SDF, as SDF glyphs are shared by all sizes)
 				uint32_t style : 5;		// number of font styles supported: 0 - 31
 				uint32_t sdf : 1;		// true or false
 			} bits;
@@ -114,6 +214,7 @@ namespace wi::font
 		};
 		static_assert(sizeof(GlyphHash) == sizeof(uint32_t));
 		static wi::unordered_set<uint32_t> pendingGlyphs;
+		static wi::unordered_set<uint32_t> missingGlyphs; // glyphs that were not found in any font style
 		static std::mutex locker;
 
 		struct ParseStatus
@@ -160,7 +261,7 @@ namespace wi::font
 				int code = (int)text[i];
 				GlyphHash hash;
 				hash.bits.code = text[i];
-				hash.bits.height = params.size;
+				hash.bits.height = params.isSDFRenderingEnabled() ? 0 : params.size;
 				hash.bits.style = (uint32_t)params.style;
 				hash.bits.sdf = params.isSDFRenderingEnabled() ? 1 : 0;
 
@@ -194,10 +295,11 @@ namespace wi::font
 				else
 				{
 					const Glyph& glyph = glyph_lookup.at(hash.raw);
-					const float glyphWidth = glyph.width;
-					const float glyphHeight = glyph.height;
-					const float glyphOffsetX = glyph.x;
-					const float glyphOffsetY = glyph.y;
+					const float glyphScale = hash.bits.sdf ? float(params.size) / float(sdf_glyph_height) : 1.0f;
+					const float glyphWidth = glyph.width * glyphScale;
+					const float glyphHeight = glyph.height * glyphScale;
+					const float glyphOffsetX = glyph.x * glyphScale;
+					const float glyphOffsetY = glyph.y * glyphScale;
 					const float fontScale = stbtt_ScaleForPixelHeight(&glyph.fontStyle->fontInfo, (float)params.size);
 
 					const size_t vertexID = size_t(status.quadCount) * 4;
@@ -347,62 +449,97 @@ namespace wi::font
 		wilog("wi::font Initialized (%d ms)", (int)std::round(timer.elapsed()));
 	}
 
-	void InvalidateAtlas()
+	// Removes glyphs that will need to be rendered again, their space in the atlas is reclaimed when the atlas is repacked
+	template<typename F>
+	void RemoveGlyphs(F should_remove)
 	{
-		texture = {};
-		glyph_lookup.clear();
-		rect_lookup.clear();
-		bitmap_lookup.clear();
+		for (auto it = glyph_lookup.begin(); it != glyph_lookup.end();)
+		{
+			if (should_remove(it->first))
+			{
+				rect_lookup.erase(it->first);
+				missingGlyphs.erase(it->first);
+				it = glyph_lookup.erase(it);
+				atlas_repack_failed = false;
+			}
+			else
+			{
+				++it;
+			}
+		}
 	}
 	void UpdateAtlas(float upscaling)
 	{
 		std::scoped_lock lck(locker);
 
-		upscaling = std::max(1.5f, upscaling); // add some minimum upscaling, especially for SDF
+		upscaling = std::max(1.5f, upscaling); // add some minimum upscaling, especially for bitmap glyphs
 		static float upscaling_prev = 1;
 		const float upscaling_rcp = 1.0f / upscaling;
 
 		if (upscaling_prev != upscaling)
 		{
-			// If upscaling changed (DPI change), clear glyph caches, they will need to be re-rendered:
-			InvalidateAtlas();
+			// If upscaling changed (DPI change), bitmap glyphs will need to be re-rendered
+			//	SDF glyphs don't depend on upscaling, so they are kept
+			RemoveGlyphs([](int32_t raw) {
+				GlyphHash hash;
+				hash.raw = raw;
+				return hash.bits.sdf == 0;
+			});
 			upscaling_prev = upscaling;
 		}
 
-		// If there are pending glyphs, render them and repack the atlas:
-		if (!pendingGlyphs.empty())
+		if (pendingGlyphs.empty())
+			return;
+
+		// Render pending glyphs:
+		static thread_local wi::unordered_map<int32_t, Bitmap> new_bitmaps;
+		static thread_local wi::vector<wi::rectpacker::Rect> new_rects;
+		new_bitmaps.clear();
+		new_rects.clear();
+		for (int32_t raw : pendingGlyphs)
 		{
-			for (int32_t raw : pendingGlyphs)
+			GlyphHash hash;
+			hash.raw = raw;
+			const int code = (int)hash.bits.code;
+			const bool is_sdf = hash.bits.sdf ? true : false;
+			const float height = is_sdf ? float(sdf_glyph_height) : (float)hash.bits.height * upscaling;
+			uint32_t style = hash.bits.style;
+			FontStyle* fontStyle = fontStyles[style].get();
+			int glyphIndex = stbtt_FindGlyphIndex(&fontStyle->fontInfo, code);
+			if (glyphIndex == 0)
 			{
-				GlyphHash hash;
-				hash.raw = raw;
-				const int code = (int)hash.bits.code;
-				const float height = (float)hash.bits.height;
-				const bool is_sdf = hash.bits.sdf ? true : false;
-				uint32_t style = hash.bits.style;
-				FontStyle* fontStyle = fontStyles[style].get();
-				int glyphIndex = stbtt_FindGlyphIndex(&fontStyle->fontInfo, code);
+				// Try fallback to an other font style that has this character:
+				style = 0;
+				while (glyphIndex == 0 && style < fontStyles.size())
+				{
+					fontStyle = fontStyles[style].get();
+					glyphIndex = stbtt_FindGlyphIndex(&fontStyle->fontInfo, code);
+					style++;
+				}
 				if (glyphIndex == 0)
 				{
-					// Try fallback to an other font style that has this character:
-					style = 0;
-					while (glyphIndex == 0 && style < fontStyles.size())
-					{
-						fontStyle = fontStyles[style].get();
-						glyphIndex = stbtt_FindGlyphIndex(&fontStyle->fontInfo, code);
-						style++;
-					}
+					// Remember it, because a font style that is added later could contain it:
+					missingGlyphs.insert(hash.raw);
 				}
+			}
 
-				float fontScaling = stbtt_ScaleForPixelHeight(&fontStyle->fontInfo, height * upscaling);
+			float fontScaling = stbtt_ScaleForPixelHeight(&fontStyle->fontInfo, height);
 
-				Bitmap& bitmap = bitmap_lookup[hash.raw];
-				bitmap.width = 0;
-				bitmap.height = 0;
-				bitmap.xoff = 0;
-				bitmap.yoff = 0;
+			Bitmap& bitmap = new_bitmaps[hash.raw];
+			bitmap.width = 0;
+			bitmap.height = 0;
+			bitmap.xoff = 0;
+			bitmap.yoff = 0;
 
-				if (is_sdf)
+			if (is_sdf)
+			{
+				const bool glyph_cache_enabled = !glyph_cache_directory.empty();
+				auto cached = glyph_cache_enabled ? fontStyle->sdf_glyphs.find(glyphIndex) : fontStyle->sdf_glyphs.end();
+				if (cached != fontStyle->sdf_glyphs.end())
+				{
+					bitmap = cached->second;
+				}
+				else
 				{
 					unsigned char* data = stbtt_GetGlyphSDF(
 						&fontStyle->fontInfo,
@@ -419,103 +556,168 @@ namespace wi::font
 					bitmap.data.resize(bitmap.width * bitmap.height);
 					if (data) std::memcpy(bitmap.data.data(), data, bitmap.data.size());
 					stbtt_FreeSDF(data, nullptr);
+					if (glyph_cache_enabled)
+					{
+						fontStyle->sdf_glyphs[glyphIndex] = bitmap;
+						fontStyle->sdf_glyphs_changed = true;
+					}
 				}
-				else
-				{
-					unsigned char* data = stbtt_GetGlyphBitmap(
-						&fontStyle->fontInfo,
-						fontScaling,
-						fontScaling,
-						glyphIndex,
-						&bitmap.width,
-						&bitmap.height,
-						&bitmap.xoff,
-						&bitmap.yoff
-					);
-					bitmap.data.resize(bitmap.width * bitmap.height);
-					if (data) std::memcpy(bitmap.data.data(), data, bitmap.data.size());
-					stbtt_FreeBitmap(data, nullptr);
-				}
+			}
+			else
+			{
+				unsigned char* data = stbtt_GetGlyphBitmap(
+					&fontStyle->fontInfo,
+					fontScaling,
+					fontScaling,
+					glyphIndex,
+					&bitmap.width,
+					&bitmap.height,
+					&bitmap.xoff,
+					&bitmap.yoff
+				);
+				bitmap.data.resize(bitmap.width * bitmap.height);
+				if (data) std::memcpy(bitmap.data.data(), data, bitmap.data.size());
+				stbtt_FreeBitmap(data, nullptr);
+			}
 
-				wi::rectpacker::Rect rect = {};
-				rect.w = bitmap.width + 2;
-				rect.h = bitmap.height + 2;
-				rect.id = hash.raw;
-				rect_lookup[hash.raw] = rect;
-
-				Glyph& glyph = glyph_lookup[hash.raw];
-				glyph.x = float(bitmap.xoff) * upscaling_rcp;
-				glyph.y = (float(bitmap.yoff) + float(fontStyle->ascent) * fontScaling) * upscaling_rcp;
-				glyph.width = float(bitmap.width) * upscaling_rcp;
-				glyph.height = float(bitmap.height) * upscaling_rcp;
-				glyph.fontStyle = fontStyle;
+			wi::rectpacker::Rect rect = {};
+			rect.w = bitmap.width + 2;
+			rect.h = bitmap.height + 2;
+			rect.id = hash.raw;
+			new_rects.push_back(rect);
+
+			// SDF glyphs are measured in sdf_glyph_height units, ParseText() scales them to the text size
+			const float metric_scale = is_sdf ? 1.0f : upscaling_rcp;
+			Glyph& glyph = glyph_lookup[hash.raw];
+			glyph.x = float(bitmap.xoff) * metric_scale;
+			glyph.y = (float(bitmap.yoff) + float(fontStyle->ascent) * fontScaling) * metric_scale;
+			glyph.width = float(bitmap.width) * metric_scale;
+			glyph.height = float(bitmap.height) * metric_scale;
+			glyph.tc_left = 0;
+			glyph.tc_right = 0;
+			glyph.tc_top = 0;
+			glyph.tc_bottom = 0;
+			glyph.fontStyle = fontStyle;
+		}
+		pendingGlyphs.clear();
+
+		auto compute_texcoords = [](const wi::rectpacker::Rect& rect) {
+			const float inv_size = 1.0f / float(atlas_size);
+			Glyph& glyph = glyph_lookup[rect.id];
+			glyph.tc_left = float(rect.x + 1) * inv_size;
+			glyph.tc_right = float(rect.x + rect.w - 1) * inv_size;
+			glyph.tc_top = float(rect.y + 1) * inv_size;
+			glyph.tc_bottom = float(rect.y + rect.h - 1) * inv_size;
+		};
+		auto copy_bitmap = [](const Bitmap& bitmap, const wi::rectpacker::Rect& rect) {
+			for (int row = 0; row < bitmap.height; ++row)
+			{
+				uint8_t* dst = atlas_bitmap.data() + (rect.x + 1) + size_t(rect.y + 1 + row) * atlas_size;
+				const uint8_t* src = bitmap.data.data() + row * bitmap.width;
+				std::memcpy(dst, src, bitmap.width);
 			}
-			pendingGlyphs.clear();
+		};
 
-			// Setup packer, this will allocate memory if needed:
-			static thread_local wi::rectpacker::State packer;
-			packer.clear();
+		// First try to place the new glyphs into the free space of the atlas, the existing glyphs stay where they are:
+		if (atlas_size > 0 && !atlas_full && atlas_packer.pack_incremental(new_rects.data(), int(new_rects.size())))
+		{
+			for (auto& rect : new_rects)
+			{
+				copy_bitmap(new_bitmaps[rect.id], rect);
+				compute_texcoords(rect);
+				rect_lookup[rect.id] = rect;
+			}
+		}
+		else if (atlas_repack_failed)
+		{
+			// The new glyphs stay in the lookup with empty texture coordinates, the failure was already reported
+			return;
+		}
+		else
+		{
+			// The atlas is full, repack every glyph, the atlas size is doubled if they still don't fit:
+			static thread_local wi::vector<wi::rectpacker::Rect> all_rects;
+			all_rects.clear();
 			for (auto& it : rect_lookup)
 			{
-				packer.add_rect(it.second);
+				all_rects.push_back(it.second);
 			}
-
-			// Perform packing and process the result if successful:
-			if (packer.pack(4096))
+			for (auto& rect : new_rects)
 			{
-				// Retrieve texture atlas dimensions:
-				const int atlasWidth = packer.width;
-				const int atlasHeight = packer.height;
-				const float inv_width = 1.0f / atlasWidth;
-				const float inv_height = 1.0f / atlasHeight;
-
-				// Create the CPU-side texture atlas and fill with transparency (0):
-				wi::vector<uint8_t> atlas(size_t(atlasWidth) * size_t(atlasHeight), 0);
+				all_rects.push_back(rect);
+			}
+			int size = std::max(atlas_size, atlas_min_size);
+			bool success = false;
+			while (!success && size <= atlas_max_size)
+			{
+				atlas_packer.init(size, size);
+				success = atlas_packer.pack_incremental(all_rects.data(), int(all_rects.size()));
+				if (!success)
+				{
+					size *= 2;
+				}
+			}
 
-				// Iterate all packed glyph rectangles:
-				for (auto& rect : packer.rects)
+			if (success)
+			{
+				// Existing glyphs are copied over from the previous atlas, new glyphs from their rendered bitmaps:
+				wi::vector<uint8_t> prev_atlas_bitmap = std::move(atlas_bitmap);
+				const int prev_atlas_size = atlas_size;
+				atlas_size = size;
+				atlas_bitmap.clear();
+				atlas_bitmap.resize(size_t(atlas_size) * size_t(atlas_size), 0);
+				for (auto& rect : all_rects)
 				{
-					rect.x += 1;
-					rect.y += 1;
-					rect.w -= 2;
-					rect.h -= 2;
-
-					const int32_t hash = rect.id;
-					//const wchar_t code = codefromhash(hash);
-					//const int style = stylefromhash(hash);
-					//const float height = (float)heightfromhash(hash);
-					Glyph& glyph = glyph_lookup[hash];
-					Bitmap& bitmap = bitmap_lookup[hash];
-
-					for (int row = 0; row < bitmap.height; ++row)
+					auto it = new_bitmaps.find(rect.id);
+					if (it != new_bitmaps.end())
 					{
-						uint8_t* dst = atlas.data() + rect.x + (rect.y + row) * atlasWidth;
-						uint8_t* src = bitmap.data.data() + row * bitmap.width;
-						std::memcpy(dst, src, bitmap.width);
+						copy_bitmap(it->second, rect);
 					}
-
-					// Compute texture coordinates for the glyph:
-					glyph.tc_left = float(rect.x);
-					glyph.tc_right = glyph.tc_left + float(rect.w);
-					glyph.tc_top = float(rect.y);
-					glyph.tc_bottom = glyph.tc_top + float(rect.h);
-
-					glyph.tc_left *= inv_width;
-					glyph.tc_right *= inv_width;
-					glyph.tc_top *= inv_height;
-					glyph.tc_bottom *= inv_height;
+					else
+					{
+						const wi::rectpacker::Rect& prev_rect = rect_lookup[rect.id];
+						for (int row = 0; row < rect.h; ++row)
+						{
+							uint8_t* dst = atlas_bitmap.data() + rect.x + size_t(rect.y + row) * atlas_size;
+							const uint8_t* src = prev_atlas_bitmap.data() + prev_rect.x + size_t(prev_rect.y + row) * prev_atlas_size;
+							std::memcpy(dst, src, rect.w);
+						}
+					}
+					compute_texcoords(rect);
 				}
-
-				// Upload the CPU-side texture atlas bitmap to the GPU:
-				wi::texturehelper::CreateTexture(texture, atlas.data(), atlasWidth, atlasHeight, Format::R8_UNORM);
-				GetDevice()->SetName(&texture, "wi::font::texture");
+				for (auto& rect : all_rects)
+				{
+					rect_lookup[rect.id] = rect;
+				}
+				atlas_full = false;
+				atlas_repack_failed = false;
 			}
 			else
 			{
 				assert(0); // rect packing failure
+				wi::backlog::post("wi::font atlas is full, some glyphs will not be displayed!", wi::backlog::LogLevel::Error);
+
+				// The new glyphs stay in the lookup with empty texture coordinates, so they are not rendered again every frame
+				//	The packer state no longer matches the previous atlas, so a repack is attempted again only after some glyphs were removed
+				atlas_full = true;
+				atlas_repack_failed = true;
+				return;
 			}
 		}
 
+		// Upload the CPU-side texture atlas bitmap to the GPU:
+		wi::texturehelper::CreateTexture(texture, atlas_bitmap.data(), atlas_size, atlas_size, Format::R8_UNORM);
+		GetDevice()->SetName(&texture, "wi::font::texture");
+	}
+	// Missing glyphs are removed, so that they will be looked up again in all font styles
+	void InvalidateMissingGlyphs()
+	{
+		if (missingGlyphs.empty())
+			return;
+		RemoveGlyphs([](int32_t raw) {
+			return missingGlyphs.count(raw) > 0;
+		});
+		missingGlyphs.clear();
 	}
 	const Texture* GetAtlas()
 	{
@@ -534,7 +736,7 @@ namespace wi::font
 		}
 		fontStyles.push_back(std::make_unique<FontStyle>());
 		fontStyles.back()->Create(fontName);
-		InvalidateAtlas(); // invalidate atlas, in case there were missing glyphs, upon adding new font style they could become valid
+		InvalidateMissingGlyphs(); // glyphs that were missing could be found in the new font style
 		return int(fontStyles.size() - 1);
 	}
 	int AddFontStyle(const std::string& fontName, const uint8_t* data, size_t size, bool copyData)
@@ -556,10 +758,46 @@ namespace wi::font
 			data = fontStyles.back()->fontBuffer.data();
 		}
 		fontStyles.back()->Create(fontName, data, size);
-		InvalidateAtlas(); // invalidate atlas, in case there were missing glyphs, upon adding new font style they could become valid
+		InvalidateMissingGlyphs(); // glyphs that were missing could be found in the new font style
 		return int(fontStyles.size() - 1);
 	}
 
+	void SetGlyphCacheDirectory(const std::string& directory)
+	{
+		std::scoped_lock lck(locker);
+		glyph_cache_directory = directory;
+		if (!glyph_cache_directory.empty() && glyph_cache_directory.back() != '/' && glyph_cache_directory.back() != '\\')
+		{
+			glyph_cache_directory += "/";
+		}
+		for (auto& fontStyle : fontStyles)
+		{
+			if (glyph_cache_directory.empty())
+			{
+				fontStyle->sdf_glyphs.clear();
+				fontStyle->sdf_glyphs_changed = false;
+			}
+			else
+			{
+				fontStyle->LoadGlyphCache();
+			}
+		}
+	}
+	const std::string& GetGlyphCacheDirectory()
+	{
+		return glyph_cache_directory;
+	}
+	void SaveGlyphCache()
+	{
+		std::scoped_lock lck(locker);
+		if (glyph_cache_directory.empty())
+			return;
+		for (auto& fontStyle : fontStyles)
+		{
+			fontStyle->SaveGlyphCache();
+		}
+	}
+
 	template<typename T>
 	Cursor Draw_internal(const T* text, size_t text_length, const Params& params, CommandList cmd)
 	{
@@ -156,10 +156,20 @@ namespace wi::font
 	//	not deleted while the font is in use (unless copyData is specified as true)
 	int AddFontStyle(const std::string& fontName, const uint8_t* data, size_t size, bool copyData = false);
 
+	// Glyph cache: the SDF glyphs of every font style are stored in a file per font in this directory, which is loaded when the font style is added
+	//	This avoids rendering the SDF glyphs again when the application starts next time
+	//	directory: empty string disables the glyph cache (default)
+	void SetGlyphCacheDirectory(const std::string& directory);
+	const std::string& GetGlyphCacheDirectory();
+	// Writes the glyph cache files of font styles that have newly rendered SDF glyphs, for example call it before the application exits
+	void SaveGlyphCache();
+
 	// Set canvas for the CommandList to handle DPI-aware font rendering on the current thread
 	void SetCanvas(const wi::Canvas& current_canvas);
 	// Call once per frame to update font atlas texture
-	//	upscaling : this should be the DPI upscaling factor, otherwise there will be no upscaling. Upscaling will cause glyphs to be cached at higher resolution.
+	//	upscaling : this should be the DPI upscaling factor, otherwise there will be no upscaling. Upscaling will cause bitmap glyphs to be cached at higher resolution.
+	//	SDF glyphs are rendered once at a fixed resolution and shared by all text sizes, they don't depend on upscaling
+	//	New glyphs are packed into the free space of the atlas, the atlas is only repacked (and grows) when it is full
 	void UpdateAtlas(float upscaling = 1.0f);
 
 	// Draw text with specified parameters and return cursor for last word
@@ -26,6 +26,8 @@
 #include <vector>
 #include <iostream>
 #include <cstdlib>
+#include <random>
+#include <atomic>
 
 #if defined(_WIN32)
 #include <direct.h>
@@ -44,6 +46,13 @@
 #include <sys/sysinfo.h>
 #endif // PLATFORM_LINUX
 
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_APPLE)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // PLATFORM_LINUX || PLATFORM_APPLE
+
 #ifdef PLATFORM_WINDOWS_DESKTOP
 #include <comdef.h> // com_error
 #endif // PLATFORM_WINDOWS_DESKTOP
@@ -56,6 +65,69 @@
 namespace wi::helper
 {
 
+	uint64_t data_hash(const void* data, size_t size, uint64_t seed)
+	{
+		// XXH64: https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+		static constexpr uint64_t prime1 = 0x9E3779B185EBCA87ull;
+		static constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+		static constexpr uint64_t prime3 = 0x165667B19E3779F9ull;
+		static constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+		static constexpr uint64_t prime5 = 0x27D4EB2F165667C5ull;
+		auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+		auto round = [&](uint64_t acc, uint64_t input) { return rotl(acc + input * prime2, 31) * prime1; };
+		auto merge = [&](uint64_t acc, uint64_t value) { return (acc ^ round(0, value)) * prime1 + prime4; };
+		auto read64 = [](const uint8_t* p) { uint64_t value; std::memcpy(&value, p, sizeof(value)); return value; };
+		auto read32 = [](const uint8_t* p) { uint32_t value; std::memcpy(&value, p, sizeof(value)); return value; };
+
+		const uint8_t* p = (const uint8_t*)data;
+		const uint8_t* end = p + size;
+		uint64_t hash;
+		if (size >= 32)
+		{
+			uint64_t v1 = seed + prime1 + prime2;
+			uint64_t v2 = seed + prime2;
+			uint64_t v3 = seed;
+			uint64_t v4 = seed - prime1;
+			do
+			{
+				v1 = round(v1, read64(p));
+				v2 = round(v2, read64(p + 8));
+				v3 = round(v3, read64(p + 16));
+				v4 = round(v4, read64(p + 24));
+				p += 32;
+			} while (p + 32 <= end);
+			hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+			hash = merge(hash, v1);
+			hash = merge(hash, v2);
+			hash = merge(hash, v3);
+			hash = merge(hash, v4);
+		}
+		else
+		{
+			hash = seed + prime5;
+		}
+		hash += (uint64_t)size;
+		for (; p + 8 <= end; p += 8)
+		{
+			hash = rotl(hash ^ round(0, read64(p)), 27) * prime1 + prime4;
+		}
+		if (p + 4 <= end)
+		{
+			hash = rotl(hash ^ (uint64_t(read32(p)) * prime1), 23) * prime2 + prime3;
+			p += 4;
+		}
+		for (; p < end; ++p)
+		{
+			hash = rotl(hash ^ (uint64_t(*p) * prime5), 11) * prime1;
+		}
+		hash ^= hash >> 33;
+		hash *= prime2;
+		hash ^= hash >> 29;
+		hash *= prime3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
 	std::string toUpper(const std::string& s)
 	{
 		std::string result;
@@ -1353,6 +1425,109 @@ namespace wi::helper
 		return false;
 	}
 
+	bool FileWriteAtomic(const std::string& fileName, const uint8_t* data, size_t size)
+	{
+		static const uint64_t process_token = (uint64_t(std::random_device()()) << 32ull) | uint64_t(std::random_device()());
+		static std::atomic<uint64_t> write_counter{ 0 };
+		std::stringstream ss;
+		ss << fileName << "." << std::hex << process_token << "." << write_counter.fetch_add(1) << ".tmp";
+		const std::string tempfilename = ss.str();
+		if (FileWrite(tempfilename, data, size) && FileRename(tempfilename, fileName))
+		{
+			return true;
+		}
+		FileRemove(tempfilename);
+		return false;
+	}
+
+	struct MappedFileInternal
+	{
+#if defined(PLATFORM_WINDOWS_DESKTOP)
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = NULL;
+		void* view = nullptr;
+		~MappedFileInternal()
+		{
+			if (view != nullptr)
+				UnmapViewOfFile(view);
+			if (mapping != NULL)
+				CloseHandle(mapping);
+			if (file != INVALID_HANDLE_VALUE)
+				CloseHandle(file);
+		}
+#elif defined(PLATFORM_LINUX) || defined(PLATFORM_APPLE)
+		void* view = MAP_FAILED;
+		size_t size = 0;
+		~MappedFileInternal()
+		{
+			if (view != MAP_FAILED)
+				munmap(view, size);
+		}
+#else
+		wi::vector<uint8_t> data;
+#endif // PLATFORM_WINDOWS_DESKTOP
+	};
+	bool FileMap(const std::string& fileName, MappedFile& mapping)
+	{
+		mapping = {};
+		auto internal_state = std::make_shared<MappedFileInternal>();
+#if defined(PLATFORM_WINDOWS_DESKTOP)
+		internal_state->file = CreateFileW(ToNativeString(fileName).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (internal_state->file == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER size = {};
+		if (!GetFileSizeEx(internal_state->file, &size) || size.QuadPart == 0)
+			return false;
+		internal_state->mapping = CreateFileMappingW(internal_state->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (internal_state->mapping == NULL)
+			return false;
+		internal_state->view = MapViewOfFile(internal_state->mapping, FILE_MAP_READ, 0, 0, 0);
+		if (internal_state->view == nullptr)
+			return false;
+		mapping.data = (const uint8_t*)internal_state->view;
+		mapping.size = (size_t)size.QuadPart;
+#elif defined(PLATFORM_LINUX) || defined(PLATFORM_APPLE)
+		std::string filepath = fileName;
+		std::replace(filepath.begin(), filepath.end(), '\\', '/');
+		const int fd = open(filepath.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat info = {};
+		if (fstat(fd, &info) != 0 || info.st_size <= 0)
+		{
+			close(fd);
+			return false;
+		}
+		internal_state->size = (size_t)info.st_size;
+		internal_state->view = mmap(nullptr, internal_state->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd); // the mapping remains valid after closing the file
+		if (internal_state->view == MAP_FAILED)
+			return false;
+		mapping.data = (const uint8_t*)internal_state->view;
+		mapping.size = internal_state->size;
+#else
+		if (!FileRead(fileName, internal_state->data) || internal_state->data.empty())
+			return false;
+		mapping.data = internal_state->data.data();
+		mapping.size = internal_state->data.size();
+#endif // PLATFORM_WINDOWS_DESKTOP
+		mapping.internal_state = internal_state;
+		return true;
+	}
+
+	bool FileRename(const std::string& fileName, const std::string& newFileName)
+	{
+		std::error_code ec;
+		std::filesystem::rename(ToNativeString(fileName), ToNativeString(newFileName), ec);
+		return !ec;
+	}
+
+	bool FileRemove(const std::string& fileName)
+	{
+		std::error_code ec;
+		return std::filesystem::remove(ToNativeString(fileName), ec);
+	}
+
 	bool FileExists(const std::string& fileName)
 	{
 		bool exists = std::filesystem::exists(ToNativeString(fileName));
@@ -6,6 +6,7 @@
 
 #include <string>
 #include <functional>
+#include <memory>
 
 #if WI_VECTOR_TYPE
 namespace std
@@ -39,6 +40,9 @@ namespace wi::helper
 		return hash;
 	}
 
+	// 64-bit hash of arbitrary data (XXH64), which is suitable to identify file contents
+	uint64_t data_hash(const void* data, size_t size, uint64_t seed = 0);
+
 	std::string toUpper(const std::string& s);
 
 	std::string toLower(const std::string& s);
@@ -130,6 +134,29 @@ namespace wi::helper
 
 	bool FileWrite(const std::string& fileName, const uint8_t* data, size_t size);
 
+	// Writes a temporary file first, then renames it to fileName, so other threads or processes never read a partially written file
+	//	The temporary file name is unique across threads and processes, and it is removed if the write or the rename fails
+	bool FileWriteAtomic(const std::string& fileName, const uint8_t* data, size_t size);
+
+	// Read only memory mapping of a whole file
+	//	The data stays valid while the MappedFile (or a copy of it) is alive
+	//	On platforms without memory mapping support the file contents are read into memory instead
+	struct MappedFile
+	{
+		std::shared_ptr<void> internal_state;
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+		constexpr bool IsValid() const { return data != nullptr; }
+	};
+	// Returns false if the file couldn't be opened or it is empty
+	bool FileMap(const std::string& fileName, MappedFile& mapping);
+
+	// Renames or moves a file, an existing file with the new name is replaced
+	bool FileRename(const std::string& fileName, const std::string& newFileName);
+
+	// Deletes a file, returns false if it didn't exist or couldn't be deleted
+	bool FileRemove(const std::string& fileName);
+
 	bool FileExists(const std::string& fileName);
 
 	bool DirectoryExists(const std::string& fileName);
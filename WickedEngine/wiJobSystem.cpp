@@ -34,6 +34,31 @@
 
 namespace wi::jobsystem
 {
+	// Executes a range of jobs that belong to one group, but doesn't update the context
+	__forceinline void execute_group(const job_function_type& task, uint32_t groupID, uint32_t groupJobOffset, uint32_t groupJobEnd, uint32_t sharedmemory_size)
+	{
+		JobArgs args;
+		args.groupID = groupID;
+		if (sharedmemory_size > 0)
+		{
+			static constexpr uint32_t alignment = 64; // avx-512 alignment is assumed at max
+			args.sharedmemory = alloca(sharedmemory_size + alignment); // overestimated alignment to not overwrite after allocation from the aligned pointer
+			args.sharedmemory = (void*)align((uint64_t)args.sharedmemory, (uint64_t)alignment);
+		}
+		else
+		{
+			args.sharedmemory = nullptr;
+		}
+
+		for (uint32_t j = groupJobOffset; j < groupJobEnd; ++j)
+		{
+			args.jobIndex = j;
+			args.groupIndex = j - groupJobOffset;
+			args.isFirstJobInGroup = (j == groupJobOffset);
+			args.isLastJobInGroup = (j == groupJobEnd - 1);
+			task(args);
+		}
+	}
 	struct alignas(64) Job
 	{
 		job_function_type task;
@@ -44,29 +69,80 @@ namespace wi::jobsystem
 		uint32_t sharedmemory_size;
 		inline uint32_t execute()
 		{
-			JobArgs args;
-			args.groupID = groupID;
-			if (sharedmemory_size > 0)
-			{
-				static constexpr uint32_t alignment = 64; // avx-512 alignment is assumed at max
-				args.sharedmemory = alloca(sharedmemory_size + alignment); // overestimated alignment to not overwrite after allocation from the aligned pointer
-				args.sharedmemory = (void*)align((uint64_t)args.sharedmemory, (uint64_t)alignment);
-			}
-			else
+			execute_group(task, groupID, groupJobOffset, groupJobEnd, sharedmemory_size);
+			return ctx->counter.fetch_sub(1, std::memory_order_relaxed); // returns context counter's previous value
+		}
+	};
+	// Describes a whole Dispatch() that was scheduled with work stealing, every group of it references this
+	struct alignas(64) JobDesc
+	{
+		job_function_type task;
+		context* ctx = nullptr;
+		uint32_t jobCount = 0;
+		uint32_t groupSize = 0;
+		uint32_t sharedmemory_size = 0;
+		std::atomic<uint32_t> refcount{ 0 }; // number of groups that are not yet finished
+		std::atomic<uint32_t> next_free{ ~0u }; // free list link
+	};
+	// Chase-Lev work stealing deque with fixed capacity:
+	//	Only the owner thread can push() and pop() from the bottom, other threads can steal() from the top
+	//	The items are packed job group references (JobDesc index in the high 32 bits, groupID in the low 32 bits)
+	//	Because the capacity is fixed, a slot can't be overwritten while a thief still has a chance to claim it
+	struct JobDeque
+	{
+		static constexpr int64_t capacity = 4096;
+		static constexpr int64_t mask = capacity - 1;
+		static_assert((capacity & mask) == 0, "capacity must be power of two");
+		alignas(64) std::atomic<int64_t> top{ 0 };
+		alignas(64) std::atomic<int64_t> bottom{ 0 };
+		alignas(64) std::atomic<uint64_t> items[capacity] = {};
+
+		inline bool push(uint64_t item)
+		{
+			const int64_t b = bottom.load(std::memory_order_relaxed);
+			const int64_t t = top.load(std::memory_order_acquire);
+			if (b - t >= capacity)
+				return false; // full
+			items[b & mask].store(item, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return true;
+		}
+		inline bool pop(uint64_t& item)
+		{
+			const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = top.load(std::memory_order_relaxed);
+			if (t > b)
 			{
-				args.sharedmemory = nullptr;
+				// empty
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return false;
 			}
-
-			for (uint32_t j = groupJobOffset; j < groupJobEnd; ++j)
+			item = items[b & mask].load(std::memory_order_relaxed);
+			if (t == b)
 			{
-				args.jobIndex = j;
-				args.groupIndex = j - groupJobOffset;
-				args.isFirstJobInGroup = (j == groupJobOffset);
-				args.isLastJobInGroup = (j == groupJobEnd - 1);
-				task(args);
+				// last item, race against thieves:
+				const bool success = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return success;
 			}
-
-			return ctx->counter.fetch_sub(1, std::memory_order_relaxed); // returns context counter's previous value
+			return true;
+		}
+		inline bool steal(uint64_t& item)
+		{
+			int64_t t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const int64_t b = bottom.load(std::memory_order_acquire);
+			if (t >= b)
+				return false; // empty
+			item = items[t & mask].load(std::memory_order_relaxed);
+			return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		}
+		inline bool empty() const
+		{
+			return top.load(std::memory_order_relaxed) >= bottom.load(std::memory_order_relaxed);
 		}
 	};
 	struct JobQueue
@@ -136,11 +212,18 @@ namespace wi::jobsystem
 			return true;
 		}
 	};
+	// Work stealing deque index of the current thread for every priority (0: none, otherwise deque index + 1)
+	static thread_local uint32_t local_deque_indices[int(Priority::Count)] = {};
+
 	struct PriorityResources
 	{
+		Priority priority = Priority::High;
 		uint32_t numThreads = 0;
 		wi::vector<std::thread> threads;
 		std::unique_ptr<JobQueue[]> jobQueuePerThread;
+		std::unique_ptr<JobDeque[]> jobDequePerThread; // +1 deque for the main thread
+		std::unique_ptr<JobDesc[]> jobDescs;
+		std::atomic<uint64_t> jobDescFreeList{ ~0ull }; // low 32 bits: first free index, high 32 bits: tag against ABA
 		std::atomic<uint8_t> nextQueue{ 0 };
 		std::condition_variable sleepingCondition; // for workers that are sleeping
 		std::mutex sleepingMutex; // for workers that are sleeping
@@ -148,6 +231,8 @@ namespace wi::jobsystem
 		std::mutex waitingMutex; // for unblocking a Wait()
 		uint8_t mod_lut[256] = {}; // lookup table from atomic uint8_t -> threadID (avoiding modulo)
 
+		static constexpr uint32_t jobDescCount = 1024;
+
 		constexpr uint8_t constrain_queue_index(uint8_t idx) const
 		{
 			//idx = idx % numThreads;
@@ -164,26 +249,153 @@ namespace wi::jobsystem
 			return jobQueuePerThread[next_queue_index()];
 		}
 
+		// Returns the work stealing deque owned by the current thread, or nullptr if it doesn't own one
+		inline JobDeque* get_local_deque()
+		{
+			const uint32_t idx = local_deque_indices[int(priority)];
+			if (idx == 0 || idx > numThreads + 1 || jobDequePerThread == nullptr)
+				return nullptr;
+			return &jobDequePerThread[idx - 1];
+		}
+
+		inline bool allocate_desc(uint32_t& index)
+		{
+			uint64_t head = jobDescFreeList.load(std::memory_order_acquire);
+			while (true)
+			{
+				const uint32_t first = uint32_t(head & 0xFFFFFFFF);
+				if (first == ~0u)
+					return false; // all descriptors are in use
+				const uint32_t next = jobDescs[first].next_free.load(std::memory_order_relaxed);
+				const uint64_t new_head = (((head >> 32ull) + 1) << 32ull) | uint64_t(next);
+				if (jobDescFreeList.compare_exchange_weak(head, new_head, std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					index = first;
+					return true;
+				}
+			}
+		}
+		inline void release_desc(uint32_t index, uint32_t count)
+		{
+			JobDesc& desc = jobDescs[index];
+			if (desc.refcount.fetch_sub(count, std::memory_order_acq_rel) != count)
+				return;
+			// This was the last group, the descriptor can be reused:
+			desc.task = job_function_type();
+			desc.ctx = nullptr;
+			uint64_t head = jobDescFreeList.load(std::memory_order_relaxed);
+			uint64_t new_head;
+			do {
+				desc.next_free.store(uint32_t(head & 0xFFFFFFFF), std::memory_order_relaxed);
+				new_head = (((head >> 32ull) + 1) << 32ull) | uint64_t(index);
+			} while (!jobDescFreeList.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		// Tries to schedule the groups of a dispatch onto the work stealing deque of the current thread
+		//	Returns the number of groups that were scheduled, the rest must be scheduled by the caller
+		inline uint32_t push_local(context& ctx, uint32_t jobCount, uint32_t groupSize, uint32_t groupCount, const job_function_type& task, uint32_t sharedmemory_size)
+		{
+			JobDeque* local_deque = get_local_deque();
+			if (local_deque == nullptr)
+				return 0;
+			uint32_t descIndex = 0;
+			if (!allocate_desc(descIndex))
+				return 0;
+			JobDesc& desc = jobDescs[descIndex];
+			desc.task = task;
+			desc.ctx = &ctx;
+			desc.jobCount = jobCount;
+			desc.groupSize = groupSize;
+			desc.sharedmemory_size = sharedmemory_size;
+			desc.refcount.store(groupCount, std::memory_order_relaxed);
+
+			uint32_t groupID = 0;
+			for (; groupID < groupCount; ++groupID)
+			{
+				if (!local_deque->push((uint64_t(descIndex) << 32ull) | uint64_t(groupID)))
+					break; // deque is full
+			}
+			if (groupID < groupCount)
+			{
+				// The groups that didn't fit will be scheduled elsewhere, they don't reference the descriptor:
+				release_desc(descIndex, groupCount - groupID);
+			}
+			return groupID;
+		}
+
+		inline void finish_job(uint32_t progress_before)
+		{
+			if (progress_before == 1)
+			{
+				// This is likely the last job because the counter was 1 before it was decremented in execute()
+				//	So wake up the waiting threads here
+				std::unique_lock<std::mutex> lock(waitingMutex);
+				waitingCondition.notify_all();
+			}
+		}
+		inline void execute_item(uint64_t item)
+		{
+			const uint32_t descIndex = uint32_t(item >> 32ull);
+			const uint32_t groupID = uint32_t(item & 0xFFFFFFFF);
+			JobDesc& desc = jobDescs[descIndex];
+			const uint32_t groupJobOffset = groupID * desc.groupSize;
+			const uint32_t groupJobEnd = std::min(groupJobOffset + desc.groupSize, desc.jobCount);
+			execute_group(desc.task, groupID, groupJobOffset, groupJobEnd, desc.sharedmemory_size);
+			context* ctx = desc.ctx;
+			release_desc(descIndex, 1); // before the context is signaled, so that the descriptor is free after Wait()
+			finish_job(ctx->counter.fetch_sub(1, std::memory_order_relaxed));
+		}
+
 		// Start working on a job queue
 		//	After the job queue is finished, it can switch to an other queue and steal jobs from there
 		inline void work(uint32_t startingQueue)
 		{
 			Job job;
+			uint64_t item = 0;
+			JobDeque* local_deque = get_local_deque();
 			for (uint32_t i = 0; i < numThreads; ++i)
 			{
+				if (local_deque != nullptr)
+				{
+					// Jobs that this thread scheduled for itself are executed first, newest first:
+					while (local_deque->pop(item))
+					{
+						execute_item(item);
+					}
+				}
 				JobQueue& job_queue = jobQueuePerThread[constrain_queue_index(startingQueue)];
 				while (job_queue.pop_front(job))
 				{
-					uint32_t progress_before = job.execute();
-					if (progress_before == 1)
+					finish_job(job.execute());
+				}
+				startingQueue++; // go to next queue
+			}
+
+			if (jobDequePerThread == nullptr)
+				return;
+
+			// Steal from the work stealing deques of all threads:
+			const uint32_t dequeCount = numThreads + 1;
+			uint32_t victim = startingQueue % dequeCount;
+			for (uint32_t i = 0; i < dequeCount; ++i)
+			{
+				JobDeque& deque = jobDequePerThread[victim];
+				while (!deque.empty())
+				{
+					if (deque.steal(item))
 					{
-						// This is likely the last job because the counter was 1 before it was decremented in execute()
-						//	So wake up the waiting threads here
-						std::unique_lock<std::mutex> lock(waitingMutex);
-						waitingCondition.notify_all();
+						execute_item(item);
+						if (local_deque != nullptr)
+						{
+							// The stolen job could have scheduled more jobs for this thread:
+							while (local_deque->pop(item))
+							{
+								execute_item(item);
+							}
+						}
 					}
 				}
-				startingQueue++; // go to next queue
+				victim = victim + 1 < dequeCount ? victim + 1 : 0;
 			}
 		}
 	};
@@ -195,6 +407,7 @@ namespace wi::jobsystem
 		uint32_t numCores = 0;
 		PriorityResources resources[int(Priority::Count)];
 		std::atomic_bool alive{ true };
+		std::atomic_bool work_stealing{ false };
 		void ShutDown()
 		{
 			if (IsShuttingDown())
@@ -222,6 +435,9 @@ namespace wi::jobsystem
 			for (auto& x : resources)
 			{
 				x.jobQueuePerThread.reset();
+				x.jobDequePerThread.reset();
+				x.jobDescs.reset();
+				x.jobDescFreeList.store(~0ull);
 				x.threads.clear();
 				x.numThreads = 0;
 			}
@@ -248,6 +464,7 @@ namespace wi::jobsystem
 		{
 			const Priority priority = (Priority)prio;
 			PriorityResources& res = internal_state.resources[prio];
+			res.priority = priority;
 
 			// Calculate the actual number of worker threads we want:
 			switch (priority)
@@ -267,8 +484,18 @@ namespace wi::jobsystem
 			}
 			res.numThreads = clamp(res.numThreads, 1u, maxThreadCount);
 			res.jobQueuePerThread.reset(new JobQueue[res.numThreads]);
+			res.jobDequePerThread.reset(new JobDeque[res.numThreads + 1]);
+			res.jobDescs.reset(new JobDesc[PriorityResources::jobDescCount]);
+			for (uint32_t i = 0; i < PriorityResources::jobDescCount; ++i)
+			{
+				res.jobDescs[i].next_free.store(i + 1 < PriorityResources::jobDescCount ? i + 1 : ~0u);
+			}
+			res.jobDescFreeList.store(0);
 			res.threads.reserve(res.numThreads);
 
+			// The last deque is owned by the thread that initializes the job system (main thread):
+			local_deque_indices[prio] = res.numThreads + 1;
+
 			// Precompute lookup table of modulos to avoid divs at runtime:
 			for (uint32_t i = 0; i < arraysize(res.mod_lut); ++i)
 			{
@@ -279,6 +506,8 @@ namespace wi::jobsystem
 			{
 				std::thread& worker = res.threads.emplace_back([threadID, priority, &res] {
 
+					local_deque_indices[int(priority)] = threadID + 1;
+
 #if defined(__FREEBSD__)
 // TODO: FreeBSD's setpriority is incompatible with the expected Linux non-standard behavior
 #elif defined(PLATFORM_LINUX)
@@ -444,6 +673,16 @@ namespace wi::jobsystem
 		return internal_state.alive.load(std::memory_order_relaxed) == false;
 	}
 
+	void SetWorkStealingEnabled(bool value)
+	{
+		internal_state.work_stealing.store(value);
+	}
+
+	bool IsWorkStealingEnabled()
+	{
+		return internal_state.work_stealing.load(std::memory_order_relaxed);
+	}
+
 	uint32_t GetThreadCount(Priority priority)
 	{
 		return internal_state.resources[int(priority)].numThreads;
@@ -456,6 +695,12 @@ namespace wi::jobsystem
 		// Context state is updated:
 		ctx.counter.fetch_add(1, std::memory_order_relaxed);
 
+		if (res.numThreads > 0 && internal_state.work_stealing.load(std::memory_order_relaxed) && res.push_local(ctx, 1, 1, 1, task, 0) > 0)
+		{
+			res.sleepingCondition.notify_one();
+			return;
+		}
+
 		Job job;
 		job.ctx = &ctx;
 		job.task = task;
@@ -488,26 +733,36 @@ namespace wi::jobsystem
 		// Context state is updated:
 		ctx.counter.fetch_add(groupCount, std::memory_order_relaxed);
 
-		Job job;
-		job.ctx = &ctx;
-		job.task = task;
-		job.sharedmemory_size = (uint32_t)sharedmemory_size;
+		uint32_t groupID = 0;
+		if (res.numThreads > 0 && internal_state.work_stealing.load(std::memory_order_relaxed))
+		{
+			// Schedule onto the current thread's own deque, other threads will steal from it:
+			groupID = res.push_local(ctx, jobCount, groupSize, groupCount, task, (uint32_t)sharedmemory_size);
+		}
 
-		for (uint32_t groupID = 0; groupID < groupCount; ++groupID)
+		if (groupID < groupCount)
 		{
-			// For each group, generate one real job:
-			job.groupID = groupID;
-			job.groupJobOffset = groupID * groupSize;
-			job.groupJobEnd = std::min(job.groupJobOffset + groupSize, jobCount);
+			Job job;
+			job.ctx = &ctx;
+			job.task = task;
+			job.sharedmemory_size = (uint32_t)sharedmemory_size;
 
-			if (res.numThreads < 1)
+			for (; groupID < groupCount; ++groupID)
 			{
-				// If job system is not yet initialized, job will be executed immediately here instead of thread:
-				job.execute();
-			}
-			else
-			{
-				res.next_queue().push_back(job);
+				// For each group, generate one real job:
+				job.groupID = groupID;
+				job.groupJobOffset = groupID * groupSize;
+				job.groupJobEnd = std::min(job.groupJobOffset + groupSize, jobCount);
+
+				if (res.numThreads < 1)
+				{
+					// If job system is not yet initialized, job will be executed immediately here instead of thread:
+					job.execute();
+				}
+				else
+				{
+					res.next_queue().push_back(job);
+				}
 			}
 		}
 
@@ -558,4 +813,83 @@ namespace wi::jobsystem
 	{
 		return ctx.counter.load(std::memory_order_relaxed);
 	}
+
+	TaskGraph::Task TaskGraph::Add(const task_function_type& task)
+	{
+		Task handle = (Task)nodes.size();
+		Node& node = nodes.emplace_back();
+		node.task = task;
+		return handle;
+	}
+
+	void TaskGraph::AddDependency(Task task, Task dependency)
+	{
+		assert(task < nodes.size());
+		assert(dependency < nodes.size());
+		assert(task != dependency);
+		nodes[dependency].successors.push_back(task);
+		nodes[task].dependency_count++;
+	}
+
+	void TaskGraph::Clear()
+	{
+		assert(ctx == nullptr || !IsBusy(*ctx)); // must not be cleared while executing
+		nodes.clear();
+		ctx = nullptr;
+	}
+
+	// Runs a task of the graph, then schedules the successors that have no more unfinished dependencies
+	static void RunTask(TaskGraph& graph, TaskGraph::Task task)
+	{
+		TaskGraph::Node& node = graph.nodes[task];
+		TaskGraph::State& state = graph.states[task];
+		node.task(state.task_ctx);
+		Wait(state.task_ctx); // the task is finished when its jobs are finished
+
+		for (TaskGraph::Task successor : node.successors)
+		{
+			if (graph.states[successor].remaining_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				// Continuation, the submit context is still busy at this point because the current task is not yet finished:
+				Execute(*graph.ctx, [&graph, successor](JobArgs args) {
+					RunTask(graph, successor);
+				});
+			}
+		}
+	}
+
+	void Submit(context& ctx, TaskGraph& graph)
+	{
+		if (graph.nodes.empty())
+			return;
+
+		if (graph.states_capacity < graph.nodes.size())
+		{
+			graph.states_capacity = graph.nodes.size();
+			graph.states.reset(new TaskGraph::State[graph.states_capacity]);
+		}
+		graph.ctx = &ctx;
+
+		bool root_found = false;
+		for (size_t i = 0; i < graph.nodes.size(); ++i)
+		{
+			TaskGraph::State& state = graph.states[i];
+			assert(!IsBusy(state.task_ctx));
+			state.remaining_dependencies.store(graph.nodes[i].dependency_count, std::memory_order_relaxed);
+			state.task_ctx.priority = ctx.priority;
+			root_found |= graph.nodes[i].dependency_count == 0;
+		}
+		assert(root_found); // there must be at least one task without dependencies, otherwise the graph has a cycle
+
+		for (size_t i = 0; i < graph.nodes.size(); ++i)
+		{
+			if (graph.nodes[i].dependency_count == 0)
+			{
+				const TaskGraph::Task task = (TaskGraph::Task)i;
+				Execute(ctx, [&graph, task](JobArgs args) {
+					RunTask(graph, task);
+				});
+			}
+		}
+	}
 }
@@ -10,7 +10,10 @@
 #include <functional>
 #endif // JOB_SYSTEM_FIXED_SIZE_FUNCTION
 
+#include "wiVector.h"
+
 #include <atomic>
+#include <memory>
 
 namespace wi::jobsystem
 {
@@ -31,10 +34,14 @@ namespace wi::jobsystem
 		void* sharedmemory;		// stack memory shared within the current group (jobs within a group execute serially)
 	};
 
+	struct context;
+
 #ifdef JOB_SYSTEM_FIXED_SIZE_FUNCTION
 	using job_function_type = wi::function<void(JobArgs), 96>; // 96 is chosen to fit the whole job storage with parameters in 128 bytes
+	using task_function_type = wi::function<void(context&), 96>;
 #else
 	using job_function_type = std::function<void(JobArgs)>;
+	using task_function_type = std::function<void(context&)>;
 #endif // JOB_SYSTEM_FIXED_SIZE_FUNCTION
 
 	enum class Priority
@@ -54,6 +61,12 @@ namespace wi::jobsystem
 
 	uint32_t GetThreadCount(Priority priority = Priority::High);
 
+	// Enable/disable the work stealing scheduler (disabled by default)
+	//	When enabled, jobs scheduled from worker threads or the main thread are put into a lock-free deque owned by the scheduling thread and idle threads steal from them
+	//	When disabled, jobs are distributed into the per-thread queues that are protected by locks
+	void SetWorkStealingEnabled(bool value);
+	bool IsWorkStealingEnabled();
+
 	// Add a task to execute asynchronously. Any idle thread will execute this.
 	void Execute(context& ctx, const job_function_type& task);
 
@@ -76,4 +89,44 @@ namespace wi::jobsystem
 
 	// Returns the number of remaining jobs
 	uint32_t GetRemainingJobCount(const context& ctx);
+
+	// A set of tasks with explicit dependencies between them, that can be submitted and waited on as a whole
+	//	A task starts as soon as all of its dependencies are finished, so unrelated tasks don't need to wait on a common barrier
+	//	The graph must not be modified or destroyed while it is executing
+	struct TaskGraph
+	{
+		using Task = uint32_t;
+
+		// Add a task to the graph, returns a handle that can be used to declare dependencies
+		//	task	: receives a context of its own. The task is only finished when every job that it scheduled into this context is finished too
+		Task Add(const task_function_type& task);
+
+		// The task will only be started after the dependency task has finished
+		void AddDependency(Task task, Task dependency);
+
+		// Remove all tasks
+		void Clear();
+
+		size_t GetTaskCount() const { return nodes.size(); }
+
+		struct Node
+		{
+			task_function_type task;
+			wi::vector<Task> successors;
+			uint32_t dependency_count = 0;
+		};
+		struct State
+		{
+			std::atomic<uint32_t> remaining_dependencies{ 0 };
+			context task_ctx; // the context that the task schedules its jobs into
+		};
+		wi::vector<Node> nodes;
+		std::unique_ptr<State[]> states;
+		size_t states_capacity = 0;
+		context* ctx = nullptr; // the context that the graph was submitted with
+	};
+
+	// Schedule every task of the graph for execution, when their dependencies are finished they will run as continuations
+	//	The whole graph can be waited on with Wait(ctx)
+	void Submit(context& ctx, TaskGraph& graph);
 }
@@ -646,6 +646,27 @@ namespace wi::math
 		return pack_unorm16x4(value.x, value.y, value.z, value.w);
 	}
 
+	// Expands a 10-bit integer into 30 bits by inserting 2 zeros after each bit.
+	constexpr uint32_t expandBits(uint32_t v)
+	{
+		v = (v * 0x00010001u) & 0xFF0000FFu;
+		v = (v * 0x00000101u) & 0x0F00F00Fu;
+		v = (v * 0x00000011u) & 0xC30C30C3u;
+		v = (v * 0x00000005u) & 0x49249249u;
+		return v;
+	}
+	// Calculates a 30-bit Morton code for the given 3D point located within the unit cube [0,1] (same as morton3D() in shaders)
+	constexpr uint32_t morton3D(float x, float y, float z)
+	{
+		x = std::min(std::max(x * 1024, 0.0f), 1023.0f);
+		y = std::min(std::max(y * 1024, 0.0f), 1023.0f);
+		z = std::min(std::max(z * 1024, 0.0f), 1023.0f);
+		const uint32_t xx = expandBits((uint32_t)x);
+		const uint32_t yy = expandBits((uint32_t)y);
+		const uint32_t zz = expandBits((uint32_t)z);
+		return xx * 4 + yy * 2 + zz;
+	}
+
 
 	//-----------------------------------------------------------------------------
 	// Compute the intersection of a ray (Origin, Direction) with a triangle
@@ -0,0 +1,332 @@
+#include "wiOcclusionBuffer.h"
+#include "wiJobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace wi::primitive;
+
+namespace wi
+{
+	static constexpr uint32_t TILE_PIXEL_COUNT = OcclusionBuffer::TILE_SIZE * OcclusionBuffer::TILE_SIZE;
+
+	// Projects a clip space triangle to the screen and computes its edge functions and depth plane
+	static void SetupTriangle(const XMFLOAT4 clip[3], uint32_t width, uint32_t height, wi::vector<OcclusionBuffer::Triangle>& result)
+	{
+		float x[3];
+		float y[3];
+		float z[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			if (clip[i].w <= 0)
+				return;
+			const float rcp_w = 1.0f / clip[i].w;
+			x[i] = (clip[i].x * rcp_w * 0.5f + 0.5f) * width;
+			y[i] = (0.5f - clip[i].y * rcp_w * 0.5f) * height;
+			z[i] = clip[i].z * rcp_w;
+		}
+
+		// Front faces are counter clockwise on the screen, which is negative area because screen Y is pointing down.
+		//	Back faces and degenerate triangles are discarded, front faces are flipped to positive area:
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (!(area < 0))
+			return;
+		std::swap(x[1], x[2]);
+		std::swap(y[1], y[2]);
+		std::swap(z[1], z[2]);
+		area = -area;
+
+		// Pixel centers inside the bounds:
+		const float minx = std::min(x[0], std::min(x[1], x[2]));
+		const float maxx = std::max(x[0], std::max(x[1], x[2]));
+		const float miny = std::min(y[0], std::min(y[1], y[2]));
+		const float maxy = std::max(y[0], std::max(y[1], y[2]));
+		OcclusionBuffer::Triangle tri;
+		tri.minX = (int)std::max(0.0f, std::ceil(minx - 0.5f));
+		tri.minY = (int)std::max(0.0f, std::ceil(miny - 0.5f));
+		tri.maxX = (int)std::min(float(width - 1), std::floor(maxx - 0.5f));
+		tri.maxY = (int)std::min(float(height - 1), std::floor(maxy - 0.5f));
+		if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+			return;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			const int j = (i + 1) % 3;
+			tri.edge[i][0] = y[i] - y[j];
+			tri.edge[i][1] = x[j] - x[i];
+			tri.edge[i][2] = (y[j] - y[i]) * x[i] - (x[j] - x[i]) * y[i];
+		}
+
+		const float rcp_area = 1.0f / area;
+		const float dzdx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * rcp_area;
+		const float dzdy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * rcp_area;
+		tri.depth[0] = dzdx;
+		tri.depth[1] = dzdy;
+		tri.depth[2] = z[0] - dzdx * x[0] - dzdy * y[0];
+
+		result.push_back(tri);
+	}
+
+	// Clips a clip space triangle against the near plane (reversed Z: z <= w) and sets up the remaining triangles
+	static void ClipAndSetupTriangle(const XMFLOAT4 clip[3], uint32_t width, uint32_t height, wi::vector<OcclusionBuffer::Triangle>& result)
+	{
+		float dist[3];
+		uint32_t inside_count = 0;
+		for (int i = 0; i < 3; ++i)
+		{
+			dist[i] = clip[i].w - clip[i].z;
+			inside_count += dist[i] >= 0 ? 1 : 0;
+		}
+		if (inside_count == 3)
+		{
+			SetupTriangle(clip, width, height, result);
+			return;
+		}
+		if (inside_count == 0)
+			return;
+
+		// The clipped polygon keeps the winding and has at most 4 vertices:
+		XMFLOAT4 polygon[4];
+		uint32_t polygon_count = 0;
+		for (int i = 0; i < 3; ++i)
+		{
+			const int j = (i + 1) % 3;
+			if (dist[i] >= 0)
+			{
+				polygon[polygon_count++] = clip[i];
+			}
+			if ((dist[i] >= 0) != (dist[j] >= 0))
+			{
+				const float t = dist[i] / (dist[i] - dist[j]);
+				XMStoreFloat4(&polygon[polygon_count++], XMVectorLerp(XMLoadFloat4(&clip[i]), XMLoadFloat4(&clip[j]), t));
+			}
+		}
+		for (uint32_t i = 1; i + 1 < polygon_count; ++i)
+		{
+			const XMFLOAT4 fan[3] = { polygon[0], polygon[i], polygon[i + 1] };
+			SetupTriangle(fan, width, height, result);
+		}
+	}
+
+	void OcclusionBuffer::Begin(const XMFLOAT4X4& viewProjection, uint32_t width, uint32_t height)
+	{
+		this->viewProjection = viewProjection;
+		this->width = align(std::max(1u, width), TILE_SIZE);
+		this->height = align(std::max(1u, height), TILE_SIZE);
+		tile_count_x = this->width / TILE_SIZE;
+		tile_count_y = this->height / TILE_SIZE;
+		occluders.clear();
+		triangles.clear();
+		depths.resize(this->width * this->height);
+		std::fill(depths.begin(), depths.end(), 0.0f);
+		tile_depths.resize(tile_count_x * tile_count_y);
+		std::fill(tile_depths.begin(), tile_depths.end(), 0.0f);
+	}
+
+	void OcclusionBuffer::AddOccluder(const XMFLOAT3* vertex_positions, const uint32_t* indices, uint32_t index_count, const XMFLOAT4X4& worldMatrix)
+	{
+		if (vertex_positions == nullptr || indices == nullptr || index_count < 3)
+			return;
+		Occluder& occluder = occluders.emplace_back();
+		occluder.vertex_positions = vertex_positions;
+		occluder.indices = indices;
+		occluder.index_count = index_count;
+		occluder.worldMatrix = worldMatrix;
+	}
+
+	void OcclusionBuffer::Rasterize()
+	{
+		wi::jobsystem::context ctx;
+
+		// Transform, clip and set up the triangles of each occluder in parallel:
+		if (occluder_triangles.size() < occluders.size())
+		{
+			occluder_triangles.resize(occluders.size());
+		}
+		wi::jobsystem::Dispatch(ctx, (uint32_t)occluders.size(), 1, [this](wi::jobsystem::JobArgs args) {
+			const Occluder& occluder = occluders[args.jobIndex];
+			wi::vector<Triangle>& result = occluder_triangles[args.jobIndex];
+			result.clear();
+
+			const XMMATRIX W = XMLoadFloat4x4(&occluder.worldMatrix);
+			const XMMATRIX M = W * XMLoadFloat4x4(&viewProjection);
+			// Mirroring transform swaps the winding:
+			const bool mirrored = XMVectorGetX(XMMatrixDeterminant(W)) < 0;
+			for (uint32_t i = 0; i + 2 < occluder.index_count; i += 3)
+			{
+				XMFLOAT4 clip[3];
+				for (int j = 0; j < 3; ++j)
+				{
+					XMStoreFloat4(&clip[j], XMVector3Transform(XMLoadFloat3(&occluder.vertex_positions[occluder.indices[i + j]]), M));
+				}
+				if (mirrored)
+				{
+					std::swap(clip[1], clip[2]);
+				}
+				ClipAndSetupTriangle(clip, width, height, result);
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+
+		// Merge the triangles in occluder order and bin them into tile rows:
+		triangles.clear();
+		tile_row_bins.resize(tile_count_y);
+		for (auto& bin : tile_row_bins)
+		{
+			bin.clear();
+		}
+		for (size_t i = 0; i < occluders.size(); ++i)
+		{
+			for (const Triangle& tri : occluder_triangles[i])
+			{
+				const uint32_t triangleIndex = (uint32_t)triangles.size();
+				triangles.push_back(tri);
+				for (int tileY = tri.minY / (int)TILE_SIZE; tileY <= tri.maxY / (int)TILE_SIZE; ++tileY)
+				{
+					tile_row_bins[tileY].push_back(triangleIndex);
+				}
+			}
+		}
+
+		// Each tile row is rasterized by a separate job, so the jobs never write to the same pixels:
+		wi::jobsystem::Dispatch(ctx, tile_count_y, 1, [this](wi::jobsystem::JobArgs args) {
+			const uint32_t tileY = args.jobIndex;
+			for (uint32_t triangleIndex : tile_row_bins[tileY])
+			{
+				RasterizeTriangle(triangles[triangleIndex], tileY);
+			}
+
+			// Update the farthest depth of the tiles in the row:
+			for (uint32_t tileX = 0; tileX < tile_count_x; ++tileX)
+			{
+				const uint32_t tileIndex = tileX + tileY * tile_count_x;
+				const float* tile = depths.data() + tileIndex * TILE_PIXEL_COUNT;
+				XMVECTOR farthest = XMLoadFloat4((const XMFLOAT4*)tile);
+				for (uint32_t i = 4; i < TILE_PIXEL_COUNT; i += 4)
+				{
+					farthest = XMVectorMin(farthest, XMLoadFloat4((const XMFLOAT4*)(tile + i)));
+				}
+				XMFLOAT4 f;
+				XMStoreFloat4(&f, farthest);
+				tile_depths[tileIndex] = std::min(std::min(f.x, f.y), std::min(f.z, f.w));
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+	}
+
+	void OcclusionBuffer::RasterizeTriangle(const Triangle& tri, uint32_t tileY)
+	{
+		const int row_start = std::max(tri.minY, int(tileY * TILE_SIZE));
+		const int row_end = std::min(tri.maxY, int(tileY * TILE_SIZE + TILE_SIZE - 1));
+		const int column_start = tri.minX & ~3;
+		const XMVECTOR lane_offsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+		const XMVECTOR zero = XMVectorZero();
+		const XMVECTOR edgeX0 = XMVectorReplicate(tri.edge[0][0]);
+		const XMVECTOR edgeX1 = XMVectorReplicate(tri.edge[1][0]);
+		const XMVECTOR edgeX2 = XMVectorReplicate(tri.edge[2][0]);
+		const XMVECTOR depthX = XMVectorReplicate(tri.depth[0]);
+
+		for (int y = row_start; y <= row_end; ++y)
+		{
+			const float py = float(y) + 0.5f;
+			const XMVECTOR edgeY0 = XMVectorReplicate(tri.edge[0][1] * py + tri.edge[0][2]);
+			const XMVECTOR edgeY1 = XMVectorReplicate(tri.edge[1][1] * py + tri.edge[1][2]);
+			const XMVECTOR edgeY2 = XMVectorReplicate(tri.edge[2][1] * py + tri.edge[2][2]);
+			const XMVECTOR depthY = XMVectorReplicate(tri.depth[1] * py + tri.depth[2]);
+			float* row = depths.data() + tileY * tile_count_x * TILE_PIXEL_COUNT + (y % TILE_SIZE) * TILE_SIZE;
+
+			for (int x = column_start; x <= tri.maxX; x += 4)
+			{
+				const XMVECTOR px = XMVectorAdd(XMVectorReplicate(float(x)), lane_offsets);
+				XMVECTOR coverage = XMVectorGreaterOrEqual(XMVectorMultiplyAdd(edgeX0, px, edgeY0), zero);
+				coverage = XMVectorAndInt(coverage, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(edgeX1, px, edgeY1), zero));
+				coverage = XMVectorAndInt(coverage, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(edgeX2, px, edgeY2), zero));
+				if (XMVector4EqualInt(coverage, zero))
+					continue;
+
+				float* dst = row + (x / TILE_SIZE) * TILE_PIXEL_COUNT + (x % TILE_SIZE);
+				const XMVECTOR depth = XMVectorMultiplyAdd(depthX, px, depthY);
+				const XMVECTOR current = XMLoadFloat4((const XMFLOAT4*)dst);
+				XMStoreFloat4((XMFLOAT4*)dst, XMVectorSelect(current, XMVectorMax(current, depth), coverage));
+			}
+		}
+	}
+
+	bool OcclusionBuffer::IsVisible(const AABB& aabb) const
+	{
+		if (occluders.empty() || !aabb.IsValid())
+			return true;
+
+		const XMMATRIX VP = XMLoadFloat4x4(&viewProjection);
+		float minx = std::numeric_limits<float>::max();
+		float miny = std::numeric_limits<float>::max();
+		float maxx = std::numeric_limits<float>::lowest();
+		float maxy = std::numeric_limits<float>::lowest();
+		float closest = std::numeric_limits<float>::lowest();
+		for (int i = 0; i < 8; ++i)
+		{
+			const XMFLOAT3 corner = aabb.corner(i);
+			XMFLOAT4 clip;
+			XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&corner), VP));
+			if (clip.w <= 0 || clip.z > clip.w)
+				return true; // intersects the near plane, the projected bounds would be wrong
+			const float rcp_w = 1.0f / clip.w;
+			const float x = (clip.x * rcp_w * 0.5f + 0.5f) * width;
+			const float y = (0.5f - clip.y * rcp_w * 0.5f) * height;
+			minx = std::min(minx, x);
+			maxx = std::max(maxx, x);
+			miny = std::min(miny, y);
+			maxy = std::max(maxy, y);
+			closest = std::max(closest, clip.z * rcp_w);
+		}
+
+		// Every pixel that the projected box touches:
+		const int x0 = (int)std::max(0.0f, std::floor(minx));
+		const int y0 = (int)std::max(0.0f, std::floor(miny));
+		const int x1 = (int)std::min(float(width - 1), std::floor(maxx));
+		const int y1 = (int)std::min(float(height - 1), std::floor(maxy));
+		if (x0 > x1 || y0 > y1)
+			return true;
+
+		const XMVECTOR box_depth = XMVectorReplicate(closest);
+		const XMVECTOR lane_indices = XMVectorSet(0, 1, 2, 3);
+		const XMVECTOR column_min = XMVectorReplicate(float(x0));
+		const XMVECTOR column_max = XMVectorReplicate(float(x1));
+		const XMVECTOR zero = XMVectorZero();
+		for (int tileY = y0 / (int)TILE_SIZE; tileY <= y1 / (int)TILE_SIZE; ++tileY)
+		{
+			for (int tileX = x0 / (int)TILE_SIZE; tileX <= x1 / (int)TILE_SIZE; ++tileX)
+			{
+				const uint32_t tileIndex = uint32_t(tileX + tileY * tile_count_x);
+				if (tile_depths[tileIndex] > closest)
+					continue; // every pixel of the tile is closer than the box
+
+				// Per pixel test in the part of the tile that is covered by the box:
+				const float* tile = depths.data() + tileIndex * TILE_PIXEL_COUNT;
+				const int row_start = std::max(y0, tileY * (int)TILE_SIZE);
+				const int row_end = std::min(y1, tileY * (int)TILE_SIZE + (int)TILE_SIZE - 1);
+				const int column_start = std::max(x0, tileX * (int)TILE_SIZE) & ~3;
+				const int column_end = std::min(x1, tileX * (int)TILE_SIZE + (int)TILE_SIZE - 1);
+				for (int y = row_start; y <= row_end; ++y)
+				{
+					const float* row = tile + (y % TILE_SIZE) * TILE_SIZE;
+					for (int x = column_start; x <= column_end; x += 4)
+					{
+						const XMVECTOR columns = XMVectorAdd(XMVectorReplicate(float(x)), lane_indices);
+						XMVECTOR mask = XMVectorAndInt(XMVectorGreaterOrEqual(columns, column_min), XMVectorLessOrEqual(columns, column_max));
+						mask = XMVectorAndInt(mask, XMVectorLessOrEqual(XMLoadFloat4((const XMFLOAT4*)(row + (x % TILE_SIZE))), box_depth));
+						if (!XMVector4EqualInt(mask, zero))
+							return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	float OcclusionBuffer::GetDepth(uint32_t x, uint32_t y) const
+	{
+		const uint32_t tileIndex = x / TILE_SIZE + (y / TILE_SIZE) * tile_count_x;
+		return depths[tileIndex * TILE_PIXEL_COUNT + (y % TILE_SIZE) * TILE_SIZE + (x % TILE_SIZE)];
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiPrimitive.h"
+#include "wiVector.h"
+
+namespace wi
+{
+	// CPU software occlusion culling with a tiled hierarchical depth buffer
+	//	Occluder triangles are rasterized on job threads with SIMD edge function coverage masks,
+	//	then bounding boxes can be tested against the depth buffer, first with the conservative per tile depth, then per pixel.
+	//	The depth buffer uses reversed Z like the renderer, so greater depth is closer to the camera and 0 is the far plane.
+	//	The result is deterministic: every pixel keeps the closest depth of all triangles that cover it,
+	//	which doesn't depend on the order of occluders or the number of job threads.
+	//
+	//	Usage:
+	//	1) Begin() with the view projection matrix and buffer resolution
+	//	2) AddOccluder() for every occluder, the vertex and index data must remain valid until Rasterize() is finished
+	//	3) Rasterize()
+	//	4) IsVisible() for the bounding boxes, which is thread safe
+	class OcclusionBuffer
+	{
+	public:
+		static constexpr uint32_t TILE_SIZE = 8; // width and height of a tile in pixels, the buffer resolution is aligned to this
+
+		void Begin(const XMFLOAT4X4& viewProjection, uint32_t width, uint32_t height);
+		// Only front facing triangles (counter clockwise on screen) are rasterized, double sided occluders must contain both windings
+		void AddOccluder(const XMFLOAT3* vertex_positions, const uint32_t* indices, uint32_t index_count, const XMFLOAT4X4& worldMatrix);
+		// Renders the occluders on job threads and waits for completion
+		void Rasterize();
+
+		// Returns false if the box is completely hidden behind occluders
+		//	Boxes that intersect the near plane or are behind the camera are always visible
+		bool IsVisible(const wi::primitive::AABB& aabb) const;
+
+		// Returns the depth of a pixel (reversed Z)
+		float GetDepth(uint32_t x, uint32_t y) const;
+		// Returns the farthest depth of a tile (reversed Z)
+		float GetTileDepth(uint32_t tileX, uint32_t tileY) const { return tile_depths[tileX + tileY * tile_count_x]; }
+
+		constexpr uint32_t GetWidth() const { return width; }
+		constexpr uint32_t GetHeight() const { return height; }
+		constexpr uint32_t GetTileCountX() const { return tile_count_x; }
+		constexpr uint32_t GetTileCountY() const { return tile_count_y; }
+		inline uint32_t GetOccluderCount() const { return (uint32_t)occluders.size(); }
+		// Number of triangles that remained after clipping and backface culling in the last Rasterize()
+		inline uint32_t GetTriangleCount() const { return (uint32_t)triangles.size(); }
+
+		struct Triangle
+		{
+			// Edge functions: e = x * edge[i][0] + y * edge[i][1] + edge[i][2], inside if all are >= 0
+			float edge[3][3];
+			// Depth plane: z = x * depth[0] + y * depth[1] + depth[2]
+			float depth[3];
+			// Pixel bounds, inclusive:
+			int minX, minY, maxX, maxY;
+		};
+
+	private:
+		struct Occluder
+		{
+			const XMFLOAT3* vertex_positions = nullptr;
+			const uint32_t* indices = nullptr;
+			uint32_t index_count = 0;
+			XMFLOAT4X4 worldMatrix;
+		};
+		XMFLOAT4X4 viewProjection = {};
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t tile_count_x = 0;
+		uint32_t tile_count_y = 0;
+		wi::vector<Occluder> occluders;
+		wi::vector<wi::vector<Triangle>> occluder_triangles; // per occluder setup results, merged into triangles in occluder order
+		wi::vector<Triangle> triangles;
+		wi::vector<wi::vector<uint32_t>> tile_row_bins; // triangle indices per tile row
+		wi::vector<float> depths; // tiled layout: TILE_SIZE * TILE_SIZE pixels of a tile are contiguous
+		wi::vector<float> tile_depths; // farthest depth per tile
+
+		void RasterizeTriangle(const Triangle& tri, uint32_t tileY);
+	};
+}
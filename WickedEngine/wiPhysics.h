@@ -26,6 +26,11 @@ namespace wi::physics
 	void SetInterpolationEnabled(bool value);
 	bool IsInterpolationEnabled();
 
+	// Enable/disable running the simulation jobs on the engine's job system (enabled by default)
+	//	When disabled, the physics engine uses its own thread pool, which competes with the engine's worker threads for the CPU cores
+	void SetSharedJobSystemEnabled(bool value);
+	bool IsSharedJobSystemEnabled();
+
 	// Enable/disable debug drawing of physics objects
 	void SetDebugDrawEnabled(bool value);
 	bool IsDebugDrawEnabled();
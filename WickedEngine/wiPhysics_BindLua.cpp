@@ -13,6 +13,8 @@ namespace wi::lua
 		lunamethod(Physics_BindLua, IsSimulationEnabled),
 		lunamethod(Physics_BindLua, SetInterpolationEnabled),
 		lunamethod(Physics_BindLua, IsInterpolationEnabled),
+		lunamethod(Physics_BindLua, SetSharedJobSystemEnabled),
+		lunamethod(Physics_BindLua, IsSharedJobSystemEnabled),
 		lunamethod(Physics_BindLua, SetDebugDrawEnabled),
 		lunamethod(Physics_BindLua, IsDebugDrawEnabled),
 		lunamethod(Physics_BindLua, SetAccuracy),
@@ -106,6 +108,22 @@ namespace wi::lua
 		wi::lua::SSetBool(L, wi::physics::IsInterpolationEnabled());
 		return 1;
 	}
+	int Physics_BindLua::SetSharedJobSystemEnabled(lua_State* L)
+	{
+		int argc = wi::lua::SGetArgCount(L);
+		if (argc > 0)
+		{
+			wi::physics::SetSharedJobSystemEnabled(wi::lua::SGetBool(L, 1));
+		}
+		else
+			wi::lua::SError(L, "SetSharedJobSystemEnabled(bool value) not enough arguments!");
+		return 0;
+	}
+	int Physics_BindLua::IsSharedJobSystemEnabled(lua_State* L)
+	{
+		wi::lua::SSetBool(L, wi::physics::IsSharedJobSystemEnabled());
+		return 1;
+	}
 	int Physics_BindLua::SetDebugDrawEnabled(lua_State* L)
 	{
 		int argc = wi::lua::SGetArgCount(L);
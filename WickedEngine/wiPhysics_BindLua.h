@@ -21,6 +21,8 @@ namespace wi::lua
 		int IsSimulationEnabled(lua_State* L);
 		int SetInterpolationEnabled(lua_State* L);
 		int IsInterpolationEnabled(lua_State* L);
+		int SetSharedJobSystemEnabled(lua_State* L);
+		int IsSharedJobSystemEnabled(lua_State* L);
 		int SetDebugDrawEnabled(lua_State* L);
 		int IsDebugDrawEnabled(lua_State* L);
 		int SetAccuracy(lua_State* L);
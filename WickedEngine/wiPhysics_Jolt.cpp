@@ -13,6 +13,7 @@
 #include <Jolt/Core/Factory.h>
 #include <Jolt/Core/TempAllocator.h>
 #include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
 #include <Jolt/Physics/PhysicsSettings.h>
 #include <Jolt/Physics/PhysicsSystem.h>
 #include <Jolt/Physics/Collision/Shape/BoxShape.h>
@@ -95,6 +96,7 @@ namespace wi::physics
 		float CHARACTER_COLLISION_TOLERANCE = 0.05f;
 		float DEBUG_MAX_DRAW_DISTANCE = 500.0f;
 		int COLLISION_STEPS = 1;
+		bool SHARED_JOB_SYSTEM = true;
 
 		// Physics shape cache data structures for reusing complex shapes across multiple rigid bodies
 		struct PhysicsShapeCacheKey
@@ -172,6 +174,244 @@ namespace wi::physics
 
 		static std::atomic<uint32_t> collisionGroupID{}; // generate unique collision group for each ragdoll to enable collision between them
 
+		// Jolt job system that runs the physics jobs on the engine's worker threads with wi::jobsystem
+		//	Jobs that become ready are executed in a wi::jobsystem context, and a barrier is finished when all of its jobs are finished.
+		//	Waiting on a barrier waits on the context, so the waiting thread executes jobs too.
+		class JobSystemWicked final : public JobSystem
+		{
+		public:
+			JobSystemWicked(uint inMaxJobs, wi::jobsystem::Priority priority = wi::jobsystem::Priority::High)
+			{
+				jobs.Init(inMaxJobs, inMaxJobs);
+				ctx.priority = priority;
+			}
+
+			int GetMaxConcurrency() const override
+			{
+				return (int)wi::jobsystem::GetThreadCount(ctx.priority);
+			}
+
+			JobHandle CreateJob(const char* inName, ColorArg inColor, const JobFunction& inJobFunction, uint32 inNumDependencies) override
+			{
+				uint32 index;
+				for (;;)
+				{
+					index = jobs.ConstructObject(inName, inColor, this, inJobFunction, inNumDependencies);
+					if (index != AvailableJobs::cInvalidObjectIndex)
+						break;
+					JPH_ASSERT(false, "No jobs available!");
+					std::this_thread::yield();
+				}
+				Job* job = &jobs.Get(index);
+
+				// The handle keeps a reference, because the queued job may finish immediately:
+				JobHandle handle(job);
+				if (inNumDependencies == 0)
+				{
+					QueueJob(job);
+				}
+				return handle;
+			}
+
+			Barrier* CreateBarrier() override
+			{
+				return new BarrierWicked;
+			}
+
+			void DestroyBarrier(Barrier* inBarrier) override
+			{
+				delete static_cast<BarrierWicked*>(inBarrier);
+			}
+
+			void WaitForJobs(Barrier* inBarrier) override
+			{
+				BarrierWicked* barrier = static_cast<BarrierWicked*>(inBarrier);
+				while (barrier->pending.load(std::memory_order_acquire) > 0)
+				{
+					// Jobs of the barrier that still have dependencies are queued by other jobs while waiting:
+					wi::jobsystem::Wait(ctx);
+					if (barrier->pending.load(std::memory_order_acquire) > 0)
+					{
+						std::this_thread::yield();
+					}
+				}
+			}
+
+		protected:
+			void QueueJob(Job* inJob) override
+			{
+				inJob->AddRef();
+				wi::jobsystem::Execute(ctx, [inJob](wi::jobsystem::JobArgs args) {
+					inJob->Execute();
+					inJob->Release();
+				});
+			}
+
+			void QueueJobs(Job** inJobs, uint inNumJobs) override
+			{
+				for (uint i = 0; i < inNumJobs; ++i)
+				{
+					QueueJob(inJobs[i]);
+				}
+			}
+
+			void FreeJob(Job* inJob) override
+			{
+				jobs.DestructObject(inJob);
+			}
+
+		private:
+			class BarrierWicked final : public Barrier
+			{
+			public:
+				std::atomic<int> pending{ 0 };
+
+				void AddJob(const JobHandle& inJob) override
+				{
+					pending.fetch_add(1, std::memory_order_relaxed);
+					if (!inJob.GetPtr()->SetBarrier(this))
+					{
+						pending.fetch_sub(1, std::memory_order_release); // the job was already finished
+					}
+				}
+
+				void AddJobs(const JobHandle* inHandles, uint inNumHandles) override
+				{
+					for (uint i = 0; i < inNumHandles; ++i)
+					{
+						AddJob(inHandles[i]);
+					}
+				}
+
+			protected:
+				void OnJobFinished(Job* inJob) override
+				{
+					pending.fetch_sub(1, std::memory_order_release);
+				}
+			};
+
+			using AvailableJobs = FixedSizeFreeList<Job>;
+			AvailableJobs jobs;
+			wi::jobsystem::context ctx;
+		};
+
+		// Jolt temp allocator that works like a linear allocator, but grows instead of failing when it runs out of memory
+		//	Allocations are made from chunks, when a chunk is full, the next allocation is made from a new chunk that is at least as large as all previous chunks together.
+		//	After a simulation step, all allocations are freed and multiple chunks are merged into a single one that fits the largest usage, so the next steps reuse one linear memory block,
+		//	and new memory is only allocated when the usage exceeds the previous high-water mark.
+		//	Allocations and frees happen in stack order and are ordered by job dependencies, so no locking is needed.
+		class TempAllocatorWicked final : public TempAllocator
+		{
+		public:
+			static constexpr size_t min_chunk_size = 4 * 1024 * 1024;
+
+			~TempAllocatorWicked() override
+			{
+				assert(usage == 0);
+				for (auto& chunk : chunks)
+				{
+					AlignedFree(chunk.data);
+				}
+			}
+
+			void* Allocate(uint inSize) override
+			{
+				if (inSize == 0)
+					return nullptr;
+				const size_t size = AlignUp(inSize, JPH_RVECTOR_ALIGNMENT);
+				if (chunks.empty() || chunks[current].top + size > chunks[current].size)
+				{
+					// The chunks after the current one are all empty, because allocations are freed in stack order:
+					const size_t next = chunks.empty() ? 0 : current + 1;
+					if (next >= chunks.size() || chunks[next].size < size)
+					{
+						// a next chunk that is too small is replaced by a bigger one:
+						for (size_t i = next; i < chunks.size(); ++i)
+						{
+							AlignedFree(chunks[i].data);
+						}
+						chunks.resize(next);
+						Chunk& chunk = chunks.emplace_back();
+						chunk.size = std::max(std::max(size, min_chunk_size), reserved);
+						chunk.data = (uint8*)AlignedAllocate(chunk.size, JPH_RVECTOR_ALIGNMENT);
+						reserved = 0;
+						for (auto& x : chunks)
+						{
+							reserved += x.size;
+						}
+					}
+					current = next;
+				}
+				Chunk& chunk = chunks[current];
+				void* address = chunk.data + chunk.top;
+				chunk.top += size;
+				usage += size;
+				peak = std::max(peak, usage);
+				highwater = std::max(highwater, usage);
+				return address;
+			}
+
+			void Free(void* inAddress, uint inSize) override
+			{
+				if (inAddress == nullptr)
+				{
+					assert(inSize == 0);
+					return;
+				}
+				const size_t size = AlignUp(inSize, JPH_RVECTOR_ALIGNMENT);
+				Chunk& chunk = chunks[current];
+				chunk.top -= size;
+				usage -= size;
+				assert(chunk.data + chunk.top == inAddress); // must be freed in reverse order of allocation
+				if (chunk.top == 0 && current > 0)
+				{
+					current--;
+				}
+			}
+
+			// Call this when all allocations are freed, merges chunks if the previous usage needed more than one
+			void Reset()
+			{
+				assert(usage == 0);
+				if (chunks.size() > 1)
+				{
+					for (auto& chunk : chunks)
+					{
+						AlignedFree(chunk.data);
+					}
+					chunks.resize(1);
+					chunks[0].size = AlignUp(highwater, min_chunk_size);
+					chunks[0].data = (uint8*)AlignedAllocate(chunks[0].size, JPH_RVECTOR_ALIGNMENT);
+					reserved = chunks[0].size;
+				}
+				current = 0;
+			}
+
+			// Returns the highest usage since the last call and resets it
+			size_t ConsumePeakUsage()
+			{
+				const size_t ret = peak;
+				peak = usage;
+				return ret;
+			}
+			size_t GetUsage() const { return usage; }
+			size_t GetReserved() const { return reserved; }
+
+		private:
+			struct Chunk
+			{
+				uint8* data = nullptr;
+				size_t size = 0;
+				size_t top = 0;
+			};
+			wi::vector<Chunk> chunks;
+			size_t current = 0;
+			size_t usage = 0;
+			size_t peak = 0;
+			size_t highwater = 0;
+			size_t reserved = 0;
+		};
+
 		enum Layers : ObjectLayer
 		{
 			GHOST = 0,
@@ -2107,6 +2347,9 @@ namespace wi::physics
 	bool IsInterpolationEnabled() { return INTERPOLATION; }
 	void SetInterpolationEnabled(bool value) { INTERPOLATION = value; }
 
+	bool IsSharedJobSystemEnabled() { return SHARED_JOB_SYSTEM; }
+	void SetSharedJobSystemEnabled(bool value) { SHARED_JOB_SYSTEM = value; }
+
 	bool IsDebugDrawEnabled() { return DEBUGDRAW_ENABLED; }
 	void SetDebugDrawEnabled(bool value) { DEBUGDRAW_ENABLED = value; }
 
@@ -2843,9 +3086,14 @@ namespace wi::physics
 		// Perform internal simulation step:
 		if (IsSimulationEnabled())
 		{
-			//static TempAllocatorImpl temp_allocator(10 * 1024 * 1024);
-			static TempAllocatorMalloc temp_allocator; // 10-100 MB was not enough for large simulation, I don't want to reserve more memory up front
-			static JobSystemThreadPool job_system(cMaxPhysicsJobs, cMaxPhysicsBarriers, thread::hardware_concurrency() - 1);
+			static TempAllocatorWicked temp_allocator; // grows to the largest usage, because fixed 10-100 MB was not enough for large simulation
+			static JobSystemWicked job_system_shared(cMaxPhysicsJobs);
+			static std::unique_ptr<JobSystemThreadPool> job_system_private; // only created when the shared job system is disabled
+			if (!SHARED_JOB_SYSTEM && job_system_private == nullptr)
+			{
+				job_system_private = std::make_unique<JobSystemThreadPool>(cMaxPhysicsJobs, cMaxPhysicsBarriers, thread::hardware_concurrency() - 1);
+			}
+			JobSystem* job_system = SHARED_JOB_SYSTEM ? (JobSystem*)&job_system_shared : (JobSystem*)job_system_private.get();
 
 			physics_scene.accumulator += dt;
 			physics_scene.accumulator = clamp(physics_scene.accumulator, 0.0f, TIMESTEP * ACCURACY);
@@ -2931,9 +3179,12 @@ namespace wi::physics
 					wi::jobsystem::Wait(ctx);
 				}
 
-				physics_scene.physics_system.Update(TIMESTEP, COLLISION_STEPS, &temp_allocator, &job_system);
+				physics_scene.physics_system.Update(TIMESTEP, COLLISION_STEPS, &temp_allocator, job_system);
+				temp_allocator.Reset();
 				physics_scene.accumulator = next_accumulator;
 			}
+			wi::profiler::SetCounter("Physics temp memory peak (bytes)", temp_allocator.ConsumePeakUsage());
+			wi::profiler::SetCounter("Physics temp memory reserved (bytes)", temp_allocator.GetReserved());
 			physics_scene.alpha = physics_scene.accumulator / TIMESTEP;
 		}
 
@@ -3755,6 +4006,7 @@ namespace wi::physics
 					}
 					wheelmat = Mat44::sRotationTranslation(wheelrot, wheelpos) * Mat44::sScale(cast(wheel_transform->GetScale()));
 					wheel_transform->world = cast(wheelmat);
+					wheel_transform->SetDirty(); // the world matrix doesn't match the local space, so it will be restored next frame
 
 					scene.RefreshHierarchyTopdownFromParent(wheel_entity);
 
@@ -62,11 +62,19 @@ namespace wi::profiler
 	};
 	wi::unordered_map<size_t, Range> ranges;
 
+	struct Counter
+	{
+		std::string name;
+		uint64_t value = 0;
+	};
+	wi::unordered_map<size_t, Counter> counters;
+
 	void BeginFrame()
 	{
 		if (ENABLED_REQUEST != ENABLED)
 		{
 			ranges.clear();
+			counters.clear();
 			ENABLED = ENABLED_REQUEST;
 		}
 
@@ -284,6 +292,25 @@ namespace wi::profiler
 		lock.unlock();
 	}
 
+	void SetCounter(const char* name, uint64_t value)
+	{
+		if (!ENABLED || !initialized)
+			return;
+
+		const size_t id = wi::helper::string_hash(name);
+
+		lock.lock();
+
+		Counter& counter = counters[id];
+		if (counter.name.empty())
+		{
+			counter.name = name;
+		}
+		counter.value = value;
+
+		lock.unlock();
+	}
+
 
 	PipelineState pso_linestrip;
 	PipelineState pso_linelist;
@@ -393,6 +420,18 @@ namespace wi::profiler
 			x.second.total_time = 0;
 		}
 
+		// Print counters:
+		lock.lock();
+		if (!counters.empty())
+		{
+			ss << std::endl << "Counters:" << std::endl;
+			for (auto& x : counters)
+			{
+				ss << "\t" << x.second.name << ": " << x.second.value << std::endl;
+			}
+		}
+		lock.unlock();
+
 		wi::font::Params params = wi::font::Params(x, y + (graph_size.y + graph_padding_y) * 2, wi::font::WIFONTSIZE_DEFAULT - 6, wi::font::WIFALIGN_LEFT, wi::font::WIFALIGN_TOP, text_color);
 
 		// Background:
@@ -52,6 +52,10 @@ namespace wi::profiler
 		inline ~ScopedRangeGPU() { EndRange(id); }
 	};
 
+	// Set a named value that will be displayed together with the profiling results
+	//	The value is kept until it is set again, so it is suitable for per frame statistics
+	void SetCounter(const char* name, uint64_t value);
+
 	// Renders a basic text of the Profiling results to the (x,y) screen coordinate
 	void DrawData(
 		const wi::Canvas& canvas,
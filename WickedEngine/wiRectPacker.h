@@ -62,5 +62,26 @@ namespace wi::rectpacker
 			height = 0;
 			return false;
 		}
+
+		// Starts incremental packing into a fixed size area, this forgets all the previously packed rects
+		void init(int area_width, int area_height)
+		{
+			width = area_width;
+			height = area_height;
+			if (int(nodes.size()) < width)
+			{
+				nodes.resize(width);
+			}
+			stbrp_init_target(&context, width, height, nodes.data(), int(nodes.size()));
+		}
+
+		// Packs additional rects into the remaining free space of the area that was set up with init()
+		//	The rects that were packed before are not moved, so this can be used to add rects to an existing atlas
+		//	The rectangle offsets will be filled after this, this doesn't use the rects array of the State
+		//	returns true if all rects were packed, false if the area is full (in this case some rects might have been packed and used up space)
+		bool pack_incremental(Rect* new_rects, int count)
+		{
+			return stbrp_pack_rects(&context, new_rects, count) != 0;
+		}
 	};
 }
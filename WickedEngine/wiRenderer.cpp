@@ -124,6 +124,8 @@ bool variableRateShadingClassificationDebug = false;
 float GameSpeed = 1;
 bool debugLightCulling = false;
 bool occlusionCulling = true;
+bool hierarchicalCulling = true;
+bool softwareOcclusionCulling = false;
 bool temporalAA = false;
 bool temporalAADEBUG = false;
 uint32_t raytraceBounceCount = 8;
@@ -807,7 +809,7 @@ bool LoadShader(
 			{
 				wi::backlog::post(output.error_message, wi::backlog::LogLevel::Warning);
 			}
-			wi::backlog::post("shader compiled: " + shaderbinaryfilename);
+			wi::backlog::post((output.cache_hit ? "shader from cache: " : "shader compiled: ") + shaderbinaryfilename + " (" + std::to_string((int)std::round(output.compile_time)) + " ms)");
 			return device->CreateShader(stage, output.shaderdata, output.shadersize, &shader, entrypoint.c_str());
 		}
 		else
@@ -3573,6 +3575,198 @@ void ProcessDeferredTextureRequests(CommandList cmd)
 	deferredMIPGenLock.unlock();
 }
 
+// A subtree of the object BVH for hierarchical culling, it uses the same encoding as a BVH::Node4 slot:
+//	if count > 0, then it's a leaf with count objects starting at child in leaf_indices, otherwise child is a Node4 index
+struct ObjectCullEntry
+{
+	uint32_t child;
+	uint32_t count;
+	bool inside; // the subtree is known to be completely inside the frustum
+};
+static void CullObjectBVH(const Visibility& vis, const wi::BVH& bvh, const wi::BVH::FrustumData& frustum, const ObjectCullEntry& entry, wi::vector<uint32_t>& visible_list)
+{
+	if (entry.count == 0)
+	{
+		const wi::BVH::Node4& node = bvh.nodes4[entry.child];
+		uint32_t inside_mask = 0;
+		const uint32_t visible_mask = entry.inside ? ~0u : wi::BVH::IntersectsNode4(frustum, node, inside_mask);
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (node.source[i] == ~0u || (visible_mask & (1u << i)) == 0)
+				continue;
+			CullObjectBVH(vis, bvh, frustum, { node.child[i], node.count[i], entry.inside || (inside_mask & (1u << i)) != 0 }, visible_list);
+		}
+		return;
+	}
+
+	// Leaf objects are tested 4 at a time, unless the leaf is completely inside:
+	const AABB* aabbs = vis.scene->aabb_objects.data();
+	const uint32_t* indices = bvh.leaf_indices.data() + entry.child;
+	for (uint32_t i = 0; i < entry.count; i += 4)
+	{
+		const uint32_t batch = std::min(4u, entry.count - i);
+		uint32_t visible_mask = 0;
+		if (entry.inside)
+		{
+			for (uint32_t j = 0; j < batch; ++j)
+			{
+				visible_mask |= aabbs[indices[i + j]].IsValid() ? (1u << j) : 0;
+			}
+		}
+		else
+		{
+			XMFLOAT4A bmin[3];
+			XMFLOAT4A bmax[3];
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				bmin[axis] = XMFLOAT4A(FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX);
+				bmax[axis] = XMFLOAT4A(-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+			}
+			for (uint32_t j = 0; j < batch; ++j)
+			{
+				const AABB& aabb = aabbs[indices[i + j]];
+				((float*)&bmin[0])[j] = aabb._min.x;
+				((float*)&bmin[1])[j] = aabb._min.y;
+				((float*)&bmin[2])[j] = aabb._min.z;
+				((float*)&bmax[0])[j] = aabb._max.x;
+				((float*)&bmax[1])[j] = aabb._max.y;
+				((float*)&bmax[2])[j] = aabb._max.z;
+			}
+			const XMVECTOR BMIN[3] = { XMLoadFloat4A(&bmin[0]), XMLoadFloat4A(&bmin[1]), XMLoadFloat4A(&bmin[2]) };
+			const XMVECTOR BMAX[3] = { XMLoadFloat4A(&bmax[0]), XMLoadFloat4A(&bmax[1]), XMLoadFloat4A(&bmax[2]) };
+			uint32_t inside_mask = 0;
+			visible_mask = wi::BVH::IntersectsFrustum4(frustum, BMIN, BMAX, inside_mask);
+		}
+		for (uint32_t j = 0; j < batch; ++j)
+		{
+			const uint32_t objectIndex = indices[i + j];
+			if ((visible_mask & (1u << j)) && (aabbs[objectIndex].layerMask & vis.layerMask))
+			{
+				visible_list.push_back(objectIndex);
+			}
+		}
+	}
+}
+
+// Software occlusion culling parameters:
+static constexpr uint32_t software_occlusion_width = 320; // the height is computed from the camera aspect ratio
+static constexpr uint32_t software_occlusion_max_occluders = 64;
+static constexpr uint32_t software_occlusion_max_auto_indices = 3 * 2048; // objects with more triangles are only used if they are marked with ObjectComponent::SetOccluder()
+static constexpr float software_occlusion_min_auto_size = 0.1f; // bounding sphere radius divided by distance to camera
+
+// Removes the frustum culled objects that are hidden behind occluders from vis.visibleObjects, the order of the remaining objects is kept
+//	The occluders are the objects marked with ObjectComponent::SetOccluder() and the largest visible opaque objects on the screen
+static void SoftwareOcclusionCulling(Visibility& vis)
+{
+	auto range = wi::profiler::BeginRangeCPU("Software Occlusion Culling");
+	const Scene& scene = *vis.scene;
+
+	// Select occluders: marked objects come first, then larger screen size, then object index to be deterministic
+	struct OccluderCandidate
+	{
+		bool marked;
+		float size;
+		uint32_t objectIndex;
+		constexpr bool operator<(const OccluderCandidate& other) const
+		{
+			if (marked != other.marked)
+				return marked;
+			if (size != other.size)
+				return size > other.size;
+			return objectIndex < other.objectIndex;
+		}
+	};
+	wi::vector<OccluderCandidate> candidates;
+	for (uint32_t objectIndex : vis.visibleObjects)
+	{
+		const ObjectComponent& object = scene.objects[objectIndex];
+		if (object.mesh_index >= scene.meshes.GetCount() || object.IsForeground())
+			continue;
+		const MeshComponent& mesh = scene.meshes[object.mesh_index];
+		if (mesh.vertex_positions.empty() || mesh.indices.empty() || mesh.IsSkinned() || !mesh.morph_targets.empty() || scene.softbodies.Contains(object.meshID))
+			continue; // the CPU vertex positions don't match the rendered geometry
+		const float size = object.radius / std::max(0.001f, wi::math::Distance(vis.camera->Eye, object.center));
+		if (!object.IsOccluder())
+		{
+			if (!object.IsRenderable() || (object.GetFilterMask() & FILTER_TRANSPARENT) || size < software_occlusion_min_auto_size)
+				continue;
+			uint32_t first_subset = 0;
+			uint32_t last_subset = 0;
+			mesh.GetLODSubsetRange(object.lod, first_subset, last_subset);
+			uint32_t index_count = 0;
+			bool alphatest = false;
+			for (uint32_t subsetIndex = first_subset; subsetIndex < last_subset; ++subsetIndex)
+			{
+				const MeshComponent::MeshSubset& subset = mesh.subsets[subsetIndex];
+				const MaterialComponent* material = scene.materials.GetComponent(subset.materialID);
+				alphatest |= material != nullptr && material->IsAlphaTestEnabled();
+				index_count += subset.indexCount;
+			}
+			if (alphatest || index_count > software_occlusion_max_auto_indices)
+				continue;
+		}
+		candidates.push_back({ object.IsOccluder(), size, objectIndex });
+	}
+	std::sort(candidates.begin(), candidates.end());
+	candidates.resize(std::min(candidates.size(), (size_t)software_occlusion_max_occluders));
+
+	wi::OcclusionBuffer& buffer = vis.occlusion_buffer;
+	const float aspect = vis.camera->height > 0 ? vis.camera->width / vis.camera->height : 1;
+	buffer.Begin(vis.camera->VP, software_occlusion_width, uint32_t(software_occlusion_width / std::max(0.01f, aspect)));
+	wi::vector<uint32_t> occluder_objects;
+	occluder_objects.reserve(candidates.size());
+	for (const OccluderCandidate& candidate : candidates)
+	{
+		const ObjectComponent& object = scene.objects[candidate.objectIndex];
+		const MeshComponent& mesh = scene.meshes[object.mesh_index];
+		uint32_t first_subset = 0;
+		uint32_t last_subset = 0;
+		mesh.GetLODSubsetRange(object.lod, first_subset, last_subset);
+		for (uint32_t subsetIndex = first_subset; subsetIndex < last_subset; ++subsetIndex)
+		{
+			const MeshComponent::MeshSubset& subset = mesh.subsets[subsetIndex];
+			if (subset.indexOffset + subset.indexCount > mesh.indices.size())
+				continue;
+			buffer.AddOccluder(mesh.vertex_positions.data(), mesh.indices.data() + subset.indexOffset, subset.indexCount, scene.matrix_objects[candidate.objectIndex]);
+		}
+		occluder_objects.push_back(candidate.objectIndex);
+	}
+	if (occluder_objects.empty())
+	{
+		wi::profiler::EndRange(range);
+		return;
+	}
+	std::sort(occluder_objects.begin(), occluder_objects.end());
+
+	buffer.Rasterize();
+
+	// Test the bounding boxes in parallel, then compact the visible list serially to keep the order:
+	const uint32_t object_count = (uint32_t)vis.visibleObjects.size();
+	wi::vector<uint8_t> visible(object_count);
+	wi::jobsystem::context ctx;
+	wi::jobsystem::Dispatch(ctx, object_count, 256, [&](wi::jobsystem::JobArgs args) {
+		const uint32_t objectIndex = vis.visibleObjects[args.jobIndex];
+		visible[args.jobIndex] =
+			scene.objects[objectIndex].IsForeground() ||
+			std::binary_search(occluder_objects.begin(), occluder_objects.end(), objectIndex) || // occluders are kept, their own depth could hide their bounds because of precision
+			buffer.IsVisible(scene.aabb_objects[objectIndex])
+			;
+	});
+	wi::jobsystem::Wait(ctx);
+
+	uint32_t visible_count = 0;
+	for (uint32_t i = 0; i < object_count; ++i)
+	{
+		if (visible[i])
+		{
+			vis.visibleObjects[visible_count++] = vis.visibleObjects[i];
+		}
+	}
+	vis.visibleObjects.resize(visible_count);
+
+	wi::profiler::EndRange(range);
+}
+
 void UpdateVisibility(Visibility& vis)
 {
 	// Perform parallel frustum culling and obtain closest reflector:
@@ -3608,6 +3802,11 @@ void UpdateVisibility(Visibility& vis)
 		vis.flags &= ~Visibility::ALLOW_OCCLUSION_CULLING;
 	}
 
+	if (!GetSoftwareOcclusionCullingEnabled() || GetFreezeCullingCameraEnabled())
+	{
+		vis.flags &= ~Visibility::ALLOW_SOFTWARE_OCCLUSION_CULLING;
+	}
+
 	if (vis.flags & Visibility::ALLOW_LIGHTS)
 	{
 		// Cull lights:
@@ -3665,94 +3864,233 @@ void UpdateVisibility(Visibility& vis)
 			}, sharedmemory_size);
 	}
 
+	// Processing of an object that passed culling, shared by the linear and hierarchical culling and the software occlusion culling:
+	auto visible_object = [&vis](uint32_t objectIndex) {
+		const AABB& aabb = vis.scene->aabb_objects[objectIndex];
+		const ObjectComponent& object = vis.scene->objects[objectIndex];
+		Scene::OcclusionResult& occlusion_result = vis.scene->occlusion_results_objects[objectIndex];
+		bool occluded = false;
+		if (vis.flags & Visibility::ALLOW_OCCLUSION_CULLING)
+		{
+			occluded = occlusion_result.IsOccluded();
+		}
+
+		if ((vis.flags & Visibility::ALLOW_REQUEST_REFLECTION) && object.IsRequestPlanarReflection() && !occluded)
+		{
+			// Planar reflection priority request:
+			float dist = wi::math::DistanceEstimated(vis.camera->Eye, object.center);
+			vis.locker.lock();
+			if (dist < vis.closestRefPlane)
+			{
+				vis.closestRefPlane = dist;
+				XMVECTOR P = XMLoadFloat3(&object.center);
+				XMVECTOR N = XMVectorSet(0, 1, 0, 0);
+				N = XMVector3TransformNormal(N, XMLoadFloat4x4(&vis.scene->matrix_objects[objectIndex]));
+				N = XMVector3Normalize(N);
+				XMVECTOR _refPlane = XMPlaneFromPointNormal(P, N);
+				XMStoreFloat4(&vis.reflectionPlane, _refPlane);
+
+				vis.planar_reflection_visible = true;
+			}
+			vis.locker.unlock();
+		}
+
+		if (object.GetFilterMask() & FILTER_TRANSPARENT)
+		{
+			vis.transparents_visible.store(true);
+		}
+
+		if (object.mesh_blend_required)
+		{
+			vis.mesh_blend_visible.store(true);
+		}
+
+		if (vis.flags & Visibility::ALLOW_OCCLUSION_CULLING)
+		{
+			if (object.IsRenderable() && occlusion_result.occlusionQueries[vis.scene->queryheap_idx] < 0)
+			{
+				if (aabb.intersects(vis.camera->Eye))
+				{
+					// camera is inside the instance, mark it as visible in this frame:
+					occlusion_result.occlusionHistory |= 1;
+				}
+				else
+				{
+					occlusion_result.occlusionQueries[vis.scene->queryheap_idx] = vis.scene->queryAllocator.fetch_add(1); // allocate new occlusion query from heap
+				}
+			}
+		}
+	};
+
+	const wi::BVH::FrustumData object_frustum(vis.frustum); // for the SIMD culling of the object bounds streams, it is used by the jobs until the end of this function
+
 	if (vis.flags & Visibility::ALLOW_OBJECTS)
 	{
 		// Cull objects:
 		const uint32_t object_loop = (uint32_t)std::min(vis.scene->aabb_objects.size(), vis.scene->objects.GetCount());
 		vis.visibleObjects.resize(object_loop);
-		wi::jobsystem::Dispatch(ctx, object_loop, groupSize, [&](wi::jobsystem::JobArgs args) {
 
-			// Setup stream compaction:
-			StreamCompaction& stream_compaction = *(StreamCompaction*)args.sharedmemory;
-			if (args.isFirstJobInGroup)
-			{
-				stream_compaction.count = 0; // first thread initializes local counter
-			}
+		// With software occlusion culling, the visible object processing is deferred until the occluded objects are removed:
+		const bool deferred_processing = vis.flags & Visibility::ALLOW_SOFTWARE_OCCLUSION_CULLING;
 
-			const AABB& aabb = vis.scene->aabb_objects[args.jobIndex];
-
-			if ((aabb.layerMask & vis.layerMask) && vis.frustum.CheckBoxFast(aabb))
-			{
-				// Local stream compaction:
-				stream_compaction.list[stream_compaction.count++] = args.groupIndex;
+		if (GetHierarchicalCullingEnabled() && vis.scene->IsObjectBVHValid())
+		{
+			// Hierarchical culling with the object BVH: the top of the tree is culled serially until there are enough subtrees,
+			//	then the subtrees are culled in parallel. Subtrees that are completely inside the frustum are accepted without further plane tests.
+			//	Each subtree appends its visible objects in ascending index order.
+			wi::jobsystem::Execute(ctx, [&vis, visible_object, deferred_processing](wi::jobsystem::JobArgs args) {
+				const wi::BVH& bvh = vis.scene->object_bvh;
+				const wi::BVH::FrustumData frustum(vis.frustum);
 
-				const ObjectComponent& object = vis.scene->objects[args.jobIndex];
-				Scene::OcclusionResult& occlusion_result = vis.scene->occlusion_results_objects[args.jobIndex];
-				bool occluded = false;
-				if (vis.flags & Visibility::ALLOW_OCCLUSION_CULLING)
+				wi::vector<ObjectCullEntry> entries;
+				entries.push_back({ 0, 0, false });
+				static constexpr size_t min_subtree_count = 64;
+				wi::vector<ObjectCullEntry> next_entries;
+				while (entries.size() < min_subtree_count)
 				{
-					occluded = occlusion_result.IsOccluded();
+					bool expanded = false;
+					next_entries.clear();
+					for (const ObjectCullEntry& entry : entries)
+					{
+						if (entry.count > 0)
+						{
+							next_entries.push_back(entry);
+							continue;
+						}
+						expanded = true;
+						const wi::BVH::Node4& node = bvh.nodes4[entry.child];
+						uint32_t inside_mask = 0;
+						const uint32_t visible_mask = entry.inside ? ~0u : wi::BVH::IntersectsNode4(frustum, node, inside_mask);
+						for (uint32_t i = 0; i < 4; ++i)
+						{
+							if (node.source[i] == ~0u || (visible_mask & (1u << i)) == 0)
+								continue;
+							next_entries.push_back({ node.child[i], node.count[i], entry.inside || (inside_mask & (1u << i)) != 0 });
+						}
+					}
+					std::swap(entries, next_entries);
+					if (!expanded)
+						break;
 				}
 
-				if ((vis.flags & Visibility::ALLOW_REQUEST_REFLECTION) && object.IsRequestPlanarReflection() && !occluded)
+				wi::jobsystem::context subtree_ctx;
+				wi::jobsystem::Dispatch(subtree_ctx, (uint32_t)entries.size(), 1, [&](wi::jobsystem::JobArgs args) {
+					wi::vector<uint32_t> visible_list;
+					CullObjectBVH(vis, bvh, frustum, entries[args.jobIndex], visible_list);
+					if (visible_list.empty())
+						return;
+					std::sort(visible_list.begin(), visible_list.end());
+					const uint32_t prev_count = vis.object_counter.fetch_add((uint32_t)visible_list.size());
+					for (size_t i = 0; i < visible_list.size(); ++i)
+					{
+						vis.visibleObjects[prev_count + i] = visible_list[i];
+						if (!deferred_processing)
+						{
+							visible_object(visible_list[i]);
+						}
+					}
+				});
+				wi::jobsystem::Wait(subtree_ctx);
+			});
+		}
+		else if (vis.scene->IsObjectStreamsValid())
+		{
+			// Linear culling with the structure of arrays object bounds: every job tests a block of objects 4 at a time with SIMD,
+			//	then appends the visible ones in ascending index order with one atomic operation
+			static constexpr uint32_t blockSize = 64;
+			wi::jobsystem::Dispatch(ctx, (object_loop + blockSize - 1) / blockSize, 1, [&vis, &object_frustum, visible_object, deferred_processing, object_loop](wi::jobsystem::JobArgs args) {
+				const Scene& scene = *vis.scene;
+				const float* streams_min[3] = {
+					scene.object_streams.Get<Scene::OBJECT_STREAM_MIN_X>(),
+					scene.object_streams.Get<Scene::OBJECT_STREAM_MIN_Y>(),
+					scene.object_streams.Get<Scene::OBJECT_STREAM_MIN_Z>(),
+				};
+				const float* streams_max[3] = {
+					scene.object_streams.Get<Scene::OBJECT_STREAM_MAX_X>(),
+					scene.object_streams.Get<Scene::OBJECT_STREAM_MAX_Y>(),
+					scene.object_streams.Get<Scene::OBJECT_STREAM_MAX_Z>(),
+				};
+				const uint32_t* layerMasks = scene.object_streams.Get<Scene::OBJECT_STREAM_LAYERMASK>();
+
+				uint32_t visible_list[blockSize];
+				uint32_t visible_count = 0;
+				const uint32_t begin = args.jobIndex * blockSize;
+				const uint32_t end = std::min(begin + blockSize, object_loop);
+				for (uint32_t i = begin; i < end; i += 4)
 				{
-					// Planar reflection priority request:
-					float dist = wi::math::DistanceEstimated(vis.camera->Eye, object.center);
-					vis.locker.lock();
-					if (dist < vis.closestRefPlane)
+					// The streams are padded to a multiple of 4, the lanes after the last object are masked out:
+					XMVECTOR bmin[3];
+					XMVECTOR bmax[3];
+					for (int axis = 0; axis < 3; ++axis)
 					{
-						vis.closestRefPlane = dist;
-						XMVECTOR P = XMLoadFloat3(&object.center);
-						XMVECTOR N = XMVectorSet(0, 1, 0, 0);
-						N = XMVector3TransformNormal(N, XMLoadFloat4x4(&vis.scene->matrix_objects[args.jobIndex]));
-						N = XMVector3Normalize(N);
-						XMVECTOR _refPlane = XMPlaneFromPointNormal(P, N);
-						XMStoreFloat4(&vis.reflectionPlane, _refPlane);
-
-						vis.planar_reflection_visible = true;
+						bmin[axis] = XMLoadFloat4((const XMFLOAT4*)(streams_min[axis] + i));
+						bmax[axis] = XMLoadFloat4((const XMFLOAT4*)(streams_max[axis] + i));
+					}
+					uint32_t inside_mask = 0;
+					uint32_t visible_mask = wi::BVH::IntersectsFrustum4(object_frustum, bmin, bmax, inside_mask);
+					if (end - i < 4)
+					{
+						visible_mask &= (1u << (end - i)) - 1;
+					}
+					for (uint32_t lane = 0; lane < 4; ++lane)
+					{
+						if ((visible_mask & (1u << lane)) && (layerMasks[i + lane] & vis.layerMask))
+						{
+							visible_list[visible_count++] = i + lane;
+						}
 					}
-					vis.locker.unlock();
 				}
+				if (visible_count == 0)
+					return;
 
-				if (object.GetFilterMask() & FILTER_TRANSPARENT)
+				const uint32_t prev_count = vis.object_counter.fetch_add(visible_count);
+				for (uint32_t i = 0; i < visible_count; ++i)
 				{
-					vis.transparents_visible.store(true);
+					vis.visibleObjects[prev_count + i] = visible_list[i];
+					if (!deferred_processing)
+					{
+						visible_object(visible_list[i]);
+					}
 				}
+			});
+		}
+		else
+		{
+			wi::jobsystem::Dispatch(ctx, object_loop, groupSize, [&vis, visible_object, deferred_processing](wi::jobsystem::JobArgs args) {
 
-				if (object.mesh_blend_required)
+				// Setup stream compaction:
+				StreamCompaction& stream_compaction = *(StreamCompaction*)args.sharedmemory;
+				if (args.isFirstJobInGroup)
 				{
-					vis.mesh_blend_visible.store(true);
+					stream_compaction.count = 0; // first thread initializes local counter
 				}
 
-				if (vis.flags & Visibility::ALLOW_OCCLUSION_CULLING)
+				const AABB& aabb = vis.scene->aabb_objects[args.jobIndex];
+
+				if ((aabb.layerMask & vis.layerMask) && vis.frustum.CheckBoxFast(aabb))
 				{
-					if (object.IsRenderable() && occlusion_result.occlusionQueries[vis.scene->queryheap_idx] < 0)
+					// Local stream compaction:
+					stream_compaction.list[stream_compaction.count++] = args.groupIndex;
+
+					if (!deferred_processing)
 					{
-						if (aabb.intersects(vis.camera->Eye))
-						{
-							// camera is inside the instance, mark it as visible in this frame:
-							occlusion_result.occlusionHistory |= 1;
-						}
-						else
-						{
-							occlusion_result.occlusionQueries[vis.scene->queryheap_idx] = vis.scene->queryAllocator.fetch_add(1); // allocate new occlusion query from heap
-						}
+						visible_object(args.jobIndex);
 					}
 				}
-			}
 
-			// Global stream compaction:
-			if (args.isLastJobInGroup && stream_compaction.count > 0)
-			{
-				uint32_t prev_count = vis.object_counter.fetch_add(stream_compaction.count);
-				uint32_t groupOffset = args.groupID * groupSize;
-				for (uint32_t i = 0; i < stream_compaction.count; ++i)
+				// Global stream compaction:
+				if (args.isLastJobInGroup && stream_compaction.count > 0)
 				{
-					vis.visibleObjects[prev_count + i] = groupOffset + stream_compaction.list[i];
+					uint32_t prev_count = vis.object_counter.fetch_add(stream_compaction.count);
+					uint32_t groupOffset = args.groupID * groupSize;
+					for (uint32_t i = 0; i < stream_compaction.count; ++i)
+					{
+						vis.visibleObjects[prev_count + i] = groupOffset + stream_compaction.list[i];
+					}
 				}
-			}
 
-			}, sharedmemory_size);
+				}, sharedmemory_size);
+		}
 	}
 
 	if (vis.flags & Visibility::ALLOW_DECALS)
@@ -3891,6 +4229,16 @@ void UpdateVisibility(Visibility& vis)
 	vis.visibleObjects.resize((size_t)vis.object_counter.load());
 	vis.visibleLights.resize((size_t)vis.light_counter.load());
 
+	if ((vis.flags & Visibility::ALLOW_OBJECTS) && (vis.flags & Visibility::ALLOW_SOFTWARE_OCCLUSION_CULLING))
+	{
+		SoftwareOcclusionCulling(vis);
+
+		wi::jobsystem::Dispatch(ctx, (uint32_t)vis.visibleObjects.size(), groupSize, [&vis, visible_object](wi::jobsystem::JobArgs args) {
+			visible_object(vis.visibleObjects[args.jobIndex]);
+		});
+		wi::jobsystem::Wait(ctx);
+	}
+
 	if (vis.scene->weather.IsOceanEnabled())
 	{
 		bool occluded = false;
@@ -19644,6 +19992,10 @@ void SetOcclusionCullingEnabled(bool value)
 	occlusionCulling = value;
 }
 bool GetOcclusionCullingEnabled() { return occlusionCulling; }
+void SetHierarchicalCullingEnabled(bool value) { hierarchicalCulling = value; }
+bool GetHierarchicalCullingEnabled() { return hierarchicalCulling; }
+void SetSoftwareOcclusionCullingEnabled(bool value) { softwareOcclusionCulling = value; }
+bool GetSoftwareOcclusionCullingEnabled() { return softwareOcclusionCulling; }
 void SetTemporalAAEnabled(bool enabled) { temporalAA = enabled; }
 bool GetTemporalAAEnabled() { return temporalAA; }
 void SetTemporalAADebugEnabled(bool enabled) { temporalAADEBUG = enabled; }
@@ -5,6 +5,7 @@
 #include "wiScene.h"
 #include "wiECS.h"
 #include "wiRectPacker.h"
+#include "wiOcclusionBuffer.h"
 #include "wiPrimitive.h"
 #include "wiCanvas.h"
 #include "wiMath.h"
@@ -140,6 +141,7 @@ namespace wi::renderer
 			ALLOW_REQUEST_REFLECTION = 1 << 7,
 			ALLOW_OCCLUSION_CULLING = 1 << 8,
 			ALLOW_SHADOW_ATLAS_PACKING = 1 << 9,
+			ALLOW_SOFTWARE_OCCLUSION_CULLING = 1 << 10,
 
 			ALLOW_EVERYTHING = ~0u
 		};
@@ -157,6 +159,7 @@ namespace wi::renderer
 		wi::rectpacker::State shadow_packer;
 		wi::rectpacker::Rect rain_blocker_shadow_rect;
 		wi::vector<wi::rectpacker::Rect> visibleLightShadowRects;
+		wi::OcclusionBuffer occlusion_buffer; // CPU software occlusion culling depth buffer of the last update
 
 		std::atomic<uint32_t> object_counter;
 		std::atomic<uint32_t> light_counter;
@@ -1238,6 +1241,12 @@ namespace wi::renderer
 	bool GetVariableRateShadingClassificationDebug();
 	void SetOcclusionCullingEnabled(bool enabled);
 	bool GetOcclusionCullingEnabled();
+	// Hierarchical culling uses the scene's object BVH for frustum culling objects instead of testing every object
+	void SetHierarchicalCullingEnabled(bool enabled);
+	bool GetHierarchicalCullingEnabled();
+	// Software occlusion culling rasterizes the largest visible objects on the CPU and removes objects hidden behind them from the visible list in the same frame
+	void SetSoftwareOcclusionCullingEnabled(bool enabled);
+	bool GetSoftwareOcclusionCullingEnabled();
 	void SetTemporalAAEnabled(bool enabled);
 	bool GetTemporalAAEnabled();
 	void SetTemporalAADebugEnabled(bool enabled);
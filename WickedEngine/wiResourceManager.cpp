@@ -5,12 +5,16 @@
 #include "wiUnorderedMap.h"
 #include "wiBacklog.h"
 #include "wiJobSystem.h"
+#include "wiBlockCompression.h"
+#include "wiVersion.h"
 
 #include "Utility/stb_image.h"
 #include "Utility/dds.h"
 
 #include <algorithm>
 #include <mutex>
+#include <atomic>
+#include <thread>
 #include <unordered_map>
 
 #ifdef _WIN32
@@ -51,6 +55,16 @@ namespace wi
 	// Texture resolution limit
 	static uint32_t max_texture_resolution = ~0u;
 
+	// Texture cooking: cache CPU block compressed images as DDS files
+	static bool texture_cooking = false;
+
+	// Derived data cache: imported resources are stored in a directory, keyed by content hash
+	static std::string derived_data_directory;
+	static std::atomic<uint32_t> derived_data_hits{ 0 };
+	static std::atomic<uint32_t> derived_data_misses{ 0 };
+	static std::atomic<uint64_t> derived_data_bytes_read{ 0 };
+	static std::atomic<uint64_t> derived_data_bytes_written{ 0 };
+
 	struct ResourceInternal
 	{
 		resourcemanager::Flags flags = resourcemanager::Flags::NONE;
@@ -223,8 +237,19 @@ namespace wi
 
 	namespace resourcemanager
 	{
-		static std::mutex locker;
-		static wi::unordered_map<std::string, wi::allocator::weak_ptr<ResourceInternal>> resources;
+		// The resources are divided into shards by name hash, each shard has its own lock,
+		//	so that threads loading different resources rarely need to wait on each other
+		struct alignas(64) ResourceShard
+		{
+			std::mutex locker;
+			wi::unordered_map<std::string, wi::allocator::weak_ptr<ResourceInternal>> resources;
+		};
+		static constexpr size_t resource_shard_count = 64;
+		static ResourceShard resource_shards[resource_shard_count];
+		static ResourceShard& GetResourceShard(const std::string& name)
+		{
+			return resource_shards[std::hash<std::string>()(name) % resource_shard_count];
+		}
 		static Mode mode = Mode::NO_EMBEDDING;
 
 		void SetMode(Mode param)
@@ -257,6 +282,8 @@ namespace wi
 			{"HEIF", DataType::IMAGE},
 			{"WAV", DataType::SOUND},
 			{"OGG", DataType::SOUND},
+			{"MP3", DataType::SOUND},
+			{"FLAC", DataType::SOUND},
 			{"LUA", DataType::SCRIPT},
 			{"MP4", DataType::VIDEO_MP4},
 			{"H264", DataType::VIDEO_H264_RAW},
@@ -323,6 +350,190 @@ namespace wi
 			return ret;
 		}
 
+		// The cooked DDS file is stored next to the source file, normal maps are cached separately because they use a different format
+		static std::string GetCookedTextureFileName(const std::string& name, Flags flags)
+		{
+			return name + (has_flag(flags, Flags::IMPORT_NORMALMAP) ? ".normalmap.dds" : ".dds");
+		}
+
+		// Decodes an image with stb_image, compresses it with the CPU block compressor and returns the DDS file data
+		static bool CookImage(const uint8_t* filedata, size_t filesize, Flags flags, wi::vector<uint8_t>& ddsfile)
+		{
+			int width = 0, height = 0, channels = 0;
+			stbi_uc* rgba = stbi_load_from_memory(filedata, (int)filesize, &width, &height, &channels, 4);
+			if (rgba == nullptr)
+				return false;
+
+			// stb_image expands the image to RGBA: 1 channel is written to RGB, 2 channels are written to RGB and A
+			//	The DDS import path derives the swizzle from the format, so two channel images are stored as BC3 instead of swizzled BC5
+			TextureDesc desc;
+			desc.width = uint32_t(width);
+			desc.height = uint32_t(height);
+			if (has_flag(flags, Flags::IMPORT_NORMALMAP))
+			{
+				desc.format = Format::BC5_UNORM;
+				if (channels == 2)
+				{
+					wi::Color* pixels = (wi::Color*)rgba;
+					for (int i = 0; i < width * height; ++i)
+					{
+						pixels[i].setG(pixels[i].getA());
+					}
+				}
+			}
+			else
+			{
+				switch (channels)
+				{
+				case 1:
+					desc.format = Format::BC4_UNORM;
+					break;
+				case 3:
+					desc.format = Format::BC1_UNORM;
+					break;
+				case 2:
+				case 4:
+				default:
+					desc.format = Format::BC3_UNORM;
+					break;
+				}
+			}
+
+			wi::vector<uint8_t> compressed;
+			bool success = wi::blockcompression::CompressMipChain((const wi::Color*)rgba, desc, compressed);
+			stbi_image_free(rgba);
+			if (success)
+			{
+				success = wi::helper::saveTextureToMemoryFile(compressed, desc, "dds", ddsfile);
+			}
+			return success;
+		}
+
+		// Increment this when the layout of derived data entries changes, so that old entries are not used
+		static constexpr uint64_t derived_data_version = 1;
+
+		enum class DerivedDataType : uint32_t
+		{
+			TEXTURE_DDS,	// DDS file with block compression and full mip chain
+			TEXTURE_PIXELS,	// decoded pixels of the top mip level, values: width, height, format, swizzle, block compressed format
+			SOUND_WAV,		// decoded 16 bit PCM WAV file
+		};
+		struct DerivedData
+		{
+			wi::helper::MappedFile mapping;
+			uint32_t values[5] = {}; // type specific values
+			const uint8_t* data = nullptr; // when reading, this points into the memory mapped cache file
+			size_t size = 0;
+		};
+
+		// The key covers everything that can change the result of the import: source file data, import flags and engine version
+		static uint64_t GetDerivedDataKey(const uint8_t* filedata, size_t filesize, Flags flags)
+		{
+			flags &= ~(Flags::IMPORT_RETAIN_FILEDATA | Flags::IMPORT_DELAY | Flags::STREAMING); // these don't modify the cached data
+			const char* version = wi::version::GetVersionString();
+			uint64_t seed = wi::helper::data_hash(version, strlen(version), derived_data_version);
+			seed = wi::helper::data_hash(&flags, sizeof(flags), seed);
+			return wi::helper::data_hash(filedata, filesize, seed);
+		}
+		static std::string GetDerivedDataFileName(uint64_t key)
+		{
+			char filename[32] = {};
+			snprintf(filename, arraysize(filename), "%016llx.wicache", (unsigned long long)key);
+			return derived_data_directory + filename;
+		}
+
+		// Returns false if the entry doesn't exist or it is not valid
+		static bool DerivedDataRead(uint64_t key, DerivedDataType type, DerivedData& entry)
+		{
+			if (wi::helper::FileMap(GetDerivedDataFileName(key), entry.mapping) && entry.mapping.size > 64)
+			{
+				wi::Archive archive(entry.mapping.data, entry.mapping.size, false);
+				if (archive.IsOpen())
+				{
+					uint32_t entry_type = ~0u;
+					uint64_t entry_key = 0;
+					archive >> entry_type;
+					archive >> entry_key;
+					if (entry_type == (uint32_t)type && entry_key == key)
+					{
+						for (auto& x : entry.values)
+						{
+							archive >> x;
+						}
+						archive.MapVector(entry.data, entry.size);
+						if (entry.size <= entry.mapping.size && archive.GetPos() <= entry.mapping.size)
+						{
+							derived_data_hits.fetch_add(1);
+							derived_data_bytes_read.fetch_add(entry.mapping.size);
+							return true;
+						}
+					}
+				}
+			}
+			entry = {};
+			derived_data_misses.fetch_add(1);
+			return false;
+		}
+
+		static void DerivedDataWrite(uint64_t key, DerivedDataType type, const DerivedData& entry)
+		{
+			wi::Archive archive;
+			archive << (uint32_t)type;
+			archive << key;
+			for (auto& x : entry.values)
+			{
+				archive << x;
+			}
+			archive.WriteVector(entry.data, entry.size);
+
+			if (!wi::helper::DirectoryExists(derived_data_directory))
+			{
+				wi::helper::DirectoryCreate(derived_data_directory);
+			}
+			const std::string filename = GetDerivedDataFileName(key);
+			// Other threads or processes can write the same entry with the same data, in that case one of the writes can fail:
+			if (wi::helper::FileWriteAtomic(filename, archive.GetData(), archive.GetPos()))
+			{
+				derived_data_bytes_written.fetch_add(archive.GetPos());
+				resource_log("\tDerived data written: %s", filename.c_str());
+			}
+		}
+
+		// Writes 16 bit PCM samples into a WAV file
+		static void WriteWAV(const wi::audio::SampleInfo& info, wi::vector<uint8_t>& wav)
+		{
+			const uint32_t data_size = uint32_t(info.sample_count * sizeof(short));
+			const uint16_t channels = uint16_t(info.channel_count);
+			const uint16_t block_align = uint16_t(channels * sizeof(short));
+			const uint32_t sample_rate = uint32_t(info.sample_rate);
+			const uint32_t byte_rate = sample_rate * block_align;
+			const uint16_t format_pcm = 1;
+			const uint16_t bits_per_sample = 16;
+			const uint32_t fmt_size = 16;
+			const uint32_t riff_size = 4 + (8 + fmt_size) + (8 + data_size);
+
+			wav.resize(8 + riff_size);
+			uint8_t* dst = wav.data();
+			auto write = [&](const void* src, size_t size) {
+				std::memcpy(dst, src, size);
+				dst += size;
+			};
+			write("RIFF", 4);
+			write(&riff_size, sizeof(riff_size));
+			write("WAVE", 4);
+			write("fmt ", 4);
+			write(&fmt_size, sizeof(fmt_size));
+			write(&format_pcm, sizeof(format_pcm));
+			write(&channels, sizeof(channels));
+			write(&sample_rate, sizeof(sample_rate));
+			write(&byte_rate, sizeof(byte_rate));
+			write(&block_align, sizeof(block_align));
+			write(&bits_per_sample, sizeof(bits_per_sample));
+			write("data", 4);
+			write(&data_size, sizeof(data_size));
+			write(info.samples, data_size);
+		}
+
 		bool LoadResourceDirectly(
 			const std::string& name,
 			Flags& flags, // flags is modified by this function!
@@ -751,6 +962,62 @@ namespace wi
 				}
 				else
 				{
+					if (texture_cooking && has_flag(flags, Flags::IMPORT_BLOCK_COMPRESSED) && !has_flag(flags, Flags::IMPORT_COLORGRADINGLUT))
+					{
+						// Texture cooking: the image is compressed on the CPU and loaded through the DDS path
+						//	The cooked DDS file is reused while it is newer than the source file, otherwise it is cooked again and written next to the source
+						const std::string cooked_filename = GetCookedTextureFileName(name, flags);
+						const bool source_is_file = resource->container_fileoffset == 0 && (resource->container_filename == name || resource->container_filename == cooked_filename) && wi::helper::FileExists(name);
+						wi::vector<uint8_t> cooked;
+						bool cooked_file_valid = false;
+						if (source_is_file && wi::helper::FileExists(cooked_filename) && wi::helper::FileTimestamp(cooked_filename) >= wi::helper::FileTimestamp(name))
+						{
+							cooked_file_valid = wi::helper::FileRead(cooked_filename, cooked);
+						}
+						if (!cooked_file_valid && CookImage(filedata, filesize, flags, cooked))
+						{
+							cooked_file_valid = source_is_file && wi::helper::FileWrite(cooked_filename, cooked.data(), cooked.size());
+							resource_log("\tTexture cooked: %s", cooked_filename.c_str());
+						}
+						if (!cooked.empty())
+						{
+							if (cooked_file_valid && !has_flag(flags, Flags::IMPORT_RETAIN_FILEDATA))
+							{
+								// Streaming will read mip levels from the cooked file:
+								resource->container_filename = cooked_filename;
+								resource->container_filesize = cooked.size();
+								resource->container_fileoffset = 0;
+							}
+							else
+							{
+								// The retained file data is the source image, which can't be used for streaming:
+								flags &= ~Flags::STREAMING;
+							}
+							return LoadResourceDirectly(cooked_filename, flags, cooked.data(), cooked.size(), resource);
+						}
+					}
+
+					const bool derived_data_enabled = !derived_data_directory.empty();
+					const uint64_t derived_data_key = derived_data_enabled ? GetDerivedDataKey(filedata, filesize, flags) : 0;
+					if (derived_data_enabled && has_flag(flags, Flags::IMPORT_BLOCK_COMPRESSED) && !has_flag(flags, Flags::IMPORT_COLORGRADINGLUT))
+					{
+						// Derived data cache: the image is compressed on the CPU once, then the DDS with the full mip chain is loaded from the cache
+						//	The container file remains the source image, so streaming is not possible
+						DerivedData derived_data;
+						wi::vector<uint8_t> cooked;
+						if (!DerivedDataRead(derived_data_key, DerivedDataType::TEXTURE_DDS, derived_data) && CookImage(filedata, filesize, flags, cooked))
+						{
+							derived_data.data = cooked.data();
+							derived_data.size = cooked.size();
+							DerivedDataWrite(derived_data_key, DerivedDataType::TEXTURE_DDS, derived_data);
+						}
+						if (derived_data.data != nullptr)
+						{
+							flags &= ~Flags::STREAMING;
+							return LoadResourceDirectly(name + ".dds", flags, derived_data.data, derived_data.size, resource);
+						}
+					}
+
 					// png, tga, jpg, etc. loader:
 					flags &= ~Flags::STREAMING; // disable streaming
 					int height = 0, width = 0, channels = 0;
@@ -760,7 +1027,23 @@ namespace wi
 					Swizzle swizzle = { ComponentSwizzle::R, ComponentSwizzle::G, ComponentSwizzle::B, ComponentSwizzle::A };
 
 					void* rgba;
-					if (!has_flag(flags, Flags::IMPORT_COLORGRADINGLUT) && stbi_is_16_bit_from_memory(filedata, (int)filesize))
+					DerivedData derived_data;
+					bool rgba_mapped = false; // decoded pixels are memory mapped from the derived data cache
+					if (derived_data_enabled && DerivedDataRead(derived_data_key, DerivedDataType::TEXTURE_PIXELS, derived_data) &&
+						derived_data.size == size_t(derived_data.values[0]) * size_t(derived_data.values[1]) * GetFormatStride((Format)derived_data.values[2]))
+					{
+						rgba_mapped = true;
+						rgba = (void*)derived_data.data;
+						width = int(derived_data.values[0]);
+						height = int(derived_data.values[1]);
+						format = (Format)derived_data.values[2];
+						swizzle.r = ComponentSwizzle(derived_data.values[3] & 0xFF);
+						swizzle.g = ComponentSwizzle((derived_data.values[3] >> 8) & 0xFF);
+						swizzle.b = ComponentSwizzle((derived_data.values[3] >> 16) & 0xFF);
+						swizzle.a = ComponentSwizzle((derived_data.values[3] >> 24) & 0xFF);
+						bc_format = (Format)derived_data.values[4];
+					}
+					else if (!has_flag(flags, Flags::IMPORT_COLORGRADINGLUT) && stbi_is_16_bit_from_memory(filedata, (int)filesize))
 					{
 						is_16bit = true;
 						rgba = stbi_load_16_from_memory(filedata, (int)filesize, &width, &height, &channels, 0);
@@ -854,6 +1137,18 @@ namespace wi
 						}
 					}
 
+					if (derived_data_enabled && !rgba_mapped && rgba != nullptr)
+					{
+						derived_data.values[0] = uint32_t(width);
+						derived_data.values[1] = uint32_t(height);
+						derived_data.values[2] = (uint32_t)format;
+						derived_data.values[3] = uint32_t(swizzle.r) | (uint32_t(swizzle.g) << 8) | (uint32_t(swizzle.b) << 16) | (uint32_t(swizzle.a) << 24);
+						derived_data.values[4] = (uint32_t)bc_format;
+						derived_data.data = (const uint8_t*)rgba;
+						derived_data.size = size_t(width) * size_t(height) * GetFormatStride(format);
+						DerivedDataWrite(derived_data_key, DerivedDataType::TEXTURE_PIXELS, derived_data);
+					}
+
 					if (rgba != nullptr)
 					{
 						TextureDesc desc;
@@ -978,14 +1273,47 @@ namespace wi
 							}
 						}
 					}
-					stbi_image_free(rgba);
+					if (!rgba_mapped)
+					{
+						stbi_image_free(rgba);
+					}
 				}
 			}
 			break;
 
 			case DataType::SOUND:
 			{
-				success = wi::audio::CreateSound(filedata, filesize, &resource->sound);
+				if (has_flag(flags, Flags::STREAMING))
+				{
+					success = wi::audio::CreateSoundStreaming(filedata, filesize, &resource->sound);
+				}
+				else if (!derived_data_directory.empty() && ext.compare("WAV") != 0)
+				{
+					// Derived data cache: compressed sounds are decoded once, then the decoded WAV is loaded from the cache
+					const uint64_t derived_data_key = GetDerivedDataKey(filedata, filesize, flags);
+					DerivedData derived_data;
+					if (DerivedDataRead(derived_data_key, DerivedDataType::SOUND_WAV, derived_data))
+					{
+						success = wi::audio::CreateSound(derived_data.data, derived_data.size, &resource->sound);
+					}
+					else
+					{
+						success = wi::audio::CreateSound(filedata, filesize, &resource->sound);
+						const wi::audio::SampleInfo info = wi::audio::GetSampleInfo(&resource->sound);
+						if (success && info.samples != nullptr && info.sample_count > 0)
+						{
+							wi::vector<uint8_t> wav;
+							WriteWAV(info, wav);
+							derived_data.data = wav.data();
+							derived_data.size = wav.size();
+							DerivedDataWrite(derived_data_key, DerivedDataType::SOUND_WAV, derived_data);
+						}
+					}
+				}
+				else
+				{
+					success = wi::audio::CreateSound(filedata, filesize, &resource->sound);
+				}
 			}
 			break;
 
@@ -1038,10 +1366,7 @@ namespace wi
 			size_t container_fileoffset
 		)
 		{
-			locker.lock();
-			wi::allocator::weak_ptr<ResourceInternal>& weak_resource = resources[name];
-			wi::allocator::shared_ptr<ResourceInternal> resource = weak_resource.lock();
-
+			// The file system is queried before locking, so that the lock is held only for the map access
 			uint64_t timestamp = 0;
 			if(!container_filename.empty())
 			{
@@ -1052,10 +1377,15 @@ namespace wi
 				timestamp = wi::helper::FileTimestamp(name);
 			}
 
+			ResourceShard& shard = GetResourceShard(name);
+			shard.locker.lock();
+			wi::allocator::weak_ptr<ResourceInternal>& weak_resource = shard.resources[name];
+			wi::allocator::shared_ptr<ResourceInternal> resource = weak_resource.lock();
+
 			if (resource == nullptr || resource->timestamp < timestamp)
 			{
 				resource = wi::allocator::make_shared<ResourceInternal>();
-				resources[name] = resource;
+				weak_resource = resource;
 				resource->filename = name;
 
 				// Rememeber the streaming file parameters, which is either the resource filename,
@@ -1092,11 +1422,11 @@ namespace wi
 					resource_log("\tResource reused: %s", name.c_str());
 					Resource retVal;
 					retVal.internal_state = resource;
-					locker.unlock();
+					shard.locker.unlock();
 					return retVal;
 				}
 			}
-			locker.unlock();
+			shard.locker.unlock();
 
 			if (filedata == nullptr || filesize == 0)
 			{
@@ -1139,25 +1469,102 @@ namespace wi
 			return Resource();
 		}
 
+		struct LoadHandleInternal
+		{
+			wi::jobsystem::context ctx;
+			std::atomic_bool ready{ false }; // set after the resource is written, the context counter is not synchronizing memory
+			std::string name;
+			Flags flags = Flags::NONE;
+			Resource resource;
+		};
+		bool LoadHandle::IsReady() const
+		{
+			if (!IsValid())
+				return true;
+			const LoadHandleInternal* handle = (const LoadHandleInternal*)internal_state.get();
+			return handle->ready.load(std::memory_order_acquire);
+		}
+		void LoadHandle::Wait() const
+		{
+			if (!IsValid())
+				return;
+			const LoadHandleInternal* handle = (const LoadHandleInternal*)internal_state.get();
+			wi::jobsystem::Wait(handle->ctx);
+			while (!handle->ready.load(std::memory_order_acquire))
+			{
+				std::this_thread::yield();
+			}
+		}
+		const Resource& LoadHandle::Get() const
+		{
+			static const Resource invalid;
+			if (!IsValid())
+				return invalid;
+			Wait();
+			const LoadHandleInternal* handle = (const LoadHandleInternal*)internal_state.get();
+			return handle->resource;
+		}
+
+		wi::vector<LoadHandle> LoadBatch(const std::string* names, size_t count, Flags flags)
+		{
+			wi::vector<LoadHandle> handles(count);
+			wi::unordered_map<std::string, size_t> unique_names;
+			for (size_t i = 0; i < count; ++i)
+			{
+				auto it = unique_names.find(names[i]);
+				if (it != unique_names.end())
+				{
+					// Repeated name, the handle refers to the first load:
+					handles[i] = handles[it->second];
+					continue;
+				}
+				unique_names[names[i]] = i;
+
+				wi::allocator::shared_ptr<LoadHandleInternal> handle = wi::allocator::make_shared<LoadHandleInternal>();
+				handle->name = names[i];
+				handle->flags = flags;
+				handle->ctx.priority = wi::jobsystem::Priority::Low;
+				handles[i].internal_state = handle;
+
+				// Load() locks only the shard of the name for the map access, file reading and decoding of different resources run in parallel:
+				wi::jobsystem::Execute(handle->ctx, [handle](wi::jobsystem::JobArgs args) {
+					handle->resource = Load(handle->name, handle->flags);
+					handle->ready.store(true, std::memory_order_release);
+				});
+			}
+			return handles;
+		}
+		void Wait(const wi::vector<LoadHandle>& handles)
+		{
+			for (auto& handle : handles)
+			{
+				handle.Wait();
+			}
+		}
+
 		bool Contains(const std::string& name)
 		{
 			bool result = false;
-			locker.lock();
-			auto it = resources.find(name);
-			if (it != resources.end())
+			ResourceShard& shard = GetResourceShard(name);
+			shard.locker.lock();
+			auto it = shard.resources.find(name);
+			if (it != shard.resources.end())
 			{
 				auto resource = it->second.lock();
 				result = resource != nullptr;
 			}
-			locker.unlock();
+			shard.locker.unlock();
 			return result;
 		}
 
 		void Clear()
 		{
-			locker.lock();
-			resources.clear();
-			locker.unlock();
+			for (auto& shard : resource_shards)
+			{
+				shard.locker.lock();
+				shard.resources.clear();
+				shard.locker.unlock();
+			}
 		}
 
 		wi::jobsystem::context streaming_ctx;
@@ -1170,19 +1577,17 @@ namespace wi
 		};
 		std::mutex streaming_replacement_mutex;
 		wi::vector<StreamingTextureReplace> streaming_texture_replacements;
-		float streaming_threshold = 0.8f;
+		std::atomic<float> streaming_threshold{ 0.8f };
 		float streaming_fade_speed = 4;
 
 		void SetStreamingMemoryThreshold(float value)
 		{
-			std::scoped_lock lck(locker);
-			streaming_threshold = value;
+			streaming_threshold.store(value);
 		}
 
 		float GetStreamingMemoryThreshold()
 		{
-			std::scoped_lock lck(locker);
-			return streaming_threshold;
+			return streaming_threshold.load();
 		}
 
 		void UpdateStreamingResources(float dt)
@@ -1199,92 +1604,97 @@ namespace wi
 
 			// Update resource min lod clamps smoothly:
 			GraphicsDevice* device = GetDevice();
-			if (!locker.try_lock()) // Use try lock as this is on the main thread which shouldn't hitch on long locking!
-				return; // Streaming is not that important, we can abandon it if some resource loading is holding the lock
-			for (auto& x : resources)
+
+			// If previous streaming jobs were not finished, gathering new jobs is skipped until next frame:
+			const bool streaming_busy = wi::jobsystem::IsBusy(streaming_ctx);
+			if (!streaming_busy)
 			{
-				wi::allocator::weak_ptr<ResourceInternal>& weak_resource = x.second;
-				wi::allocator::shared_ptr<ResourceInternal> resource = weak_resource.lock();
-				if (resource != nullptr && resource->texture.IsValid() && has_flag(resource->flags, Flags::STREAMING) && resource->streaming_texture.mip_count > 1)
-				{
-					const TextureDesc& desc = resource->texture.desc;
-					const float mip_offset = float(resource->streaming_texture.mip_count - desc.mip_levels);
-					float min_lod_clamp_absolute_next = resource->streaming_texture.min_lod_clamp_absolute - dt * streaming_fade_speed;
-					min_lod_clamp_absolute_next = std::max(mip_offset, min_lod_clamp_absolute_next);
-					if (wi::math::float_equal(min_lod_clamp_absolute_next, resource->streaming_texture.min_lod_clamp_absolute))
-						continue;
-					resource->streaming_texture.min_lod_clamp_absolute = min_lod_clamp_absolute_next;
+				streaming_texture_jobs.clear();
+			}
 
-					const float min_lod_clamp_relative = min_lod_clamp_absolute_next - mip_offset;
+			static wi::vector<const std::string*> removals; // string ptr to avoid string copies, or string constructions from char*
 
-					device->DeleteSubresources(&resource->texture);
+			for (auto& shard : resource_shards)
+			{
+				if (!shard.locker.try_lock()) // Use try lock as this is on the main thread which shouldn't hitch on long locking!
+					continue; // Streaming is not that important, we can skip the shard if some resource loading is holding the lock
+				for (auto& x : shard.resources)
+				{
+					wi::allocator::weak_ptr<ResourceInternal>& weak_resource = x.second;
+					wi::allocator::shared_ptr<ResourceInternal> resource = weak_resource.lock();
+					if (resource != nullptr && resource->texture.IsValid() && has_flag(resource->flags, Flags::STREAMING) && resource->streaming_texture.mip_count > 1)
+					{
+						const TextureDesc& desc = resource->texture.desc;
+						const float mip_offset = float(resource->streaming_texture.mip_count - desc.mip_levels);
+						float min_lod_clamp_absolute_next = resource->streaming_texture.min_lod_clamp_absolute - dt * streaming_fade_speed;
+						min_lod_clamp_absolute_next = std::max(mip_offset, min_lod_clamp_absolute_next);
+						if (wi::math::float_equal(min_lod_clamp_absolute_next, resource->streaming_texture.min_lod_clamp_absolute))
+							continue;
+						resource->streaming_texture.min_lod_clamp_absolute = min_lod_clamp_absolute_next;
 
-					device->CreateSubresource(
-						&resource->texture,
-						SubresourceType::SRV,
-						0, -1,
-						0, -1,
-						nullptr,
-						nullptr,
-						nullptr,
-						min_lod_clamp_relative
-					);
-					resource->srgb_subresource = -1;
+						const float min_lod_clamp_relative = min_lod_clamp_absolute_next - mip_offset;
 
-					Format srgb_format = GetFormatSRGB(desc.format);
-					if (srgb_format != Format::UNKNOWN && srgb_format != desc.format)
-					{
-						resource->srgb_subresource = device->CreateSubresource(
+						device->DeleteSubresources(&resource->texture);
+
+						device->CreateSubresource(
 							&resource->texture,
 							SubresourceType::SRV,
 							0, -1,
 							0, -1,
-							&srgb_format,
+							nullptr,
 							nullptr,
 							nullptr,
 							min_lod_clamp_relative
 						);
+						resource->srgb_subresource = -1;
+
+						Format srgb_format = GetFormatSRGB(desc.format);
+						if (srgb_format != Format::UNKNOWN && srgb_format != desc.format)
+						{
+							resource->srgb_subresource = device->CreateSubresource(
+								&resource->texture,
+								SubresourceType::SRV,
+								0, -1,
+								0, -1,
+								&srgb_format,
+								nullptr,
+								nullptr,
+								min_lod_clamp_relative
+							);
+						}
 					}
 				}
-			}
-
-			// If previous streaming jobs were not finished, we cancel this until next frame:
-			if (wi::jobsystem::IsBusy(streaming_ctx))
-			{
-				locker.unlock();
-				return;
-			}
-
-			streaming_texture_jobs.clear();
-
-			static wi::vector<const std::string*> removals; // string ptr to avoid string copies, or string constructions from char*
 
-			// Gather the streaming jobs, unload lost resources:
-			for (auto& x : resources)
-			{
-				if (x.second.expired())
+				if (!streaming_busy)
 				{
-					removals.push_back(&x.first);
-					continue;
-				}
+					// Gather the streaming jobs, unload lost resources:
+					for (auto& x : shard.resources)
+					{
+						if (x.second.expired())
+						{
+							removals.push_back(&x.first);
+							continue;
+						}
 
-				wi::allocator::weak_ptr<ResourceInternal>& weak_resource = x.second;
-				wi::allocator::shared_ptr<ResourceInternal> resource = weak_resource.lock();
-				if (resource != nullptr && resource->texture.IsValid() && resource->streaming_texture.mip_count > 1)
-				{
-					streaming_texture_jobs.push_back(resource);
-				}
-			}
+						wi::allocator::weak_ptr<ResourceInternal>& weak_resource = x.second;
+						wi::allocator::shared_ptr<ResourceInternal> resource = weak_resource.lock();
+						if (resource != nullptr && resource->texture.IsValid() && resource->streaming_texture.mip_count > 1)
+						{
+							streaming_texture_jobs.push_back(resource);
+						}
+					}
 
-			for (auto& x : removals)
-			{
-				resource_log("\tResource lost: %s", x->c_str());
-				resources.erase(*x);
+					for (auto& x : removals)
+					{
+						resource_log("\tResource lost: %s", x->c_str());
+						shard.resources.erase(*x);
+					}
+					removals.clear();
+				}
+				shard.locker.unlock();
 			}
-			removals.clear();
-			locker.unlock();
 
-			if (streaming_texture_jobs.empty())
+			if (streaming_busy || streaming_texture_jobs.empty())
 				return;
 
 			// One low priority thread will be responsible for streaming, to not cause any hitching while rendering:
@@ -1402,17 +1812,30 @@ namespace wi
 			});
 		}
 
+		// Returns the resources that are alive from all shards
+		static void GatherResources(wi::vector<wi::allocator::shared_ptr<ResourceInternal>>& out_resources)
+		{
+			for (auto& shard : resource_shards)
+			{
+				std::scoped_lock lck(shard.locker);
+				for (auto& x : shard.resources)
+				{
+					auto resourceinternal = x.second.lock();
+					if (resourceinternal != nullptr)
+					{
+						out_resources.push_back(resourceinternal);
+					}
+				}
+			}
+		}
+
 		bool CheckResourcesOutdated()
 		{
-			std::scoped_lock lck(locker);
+			wi::vector<wi::allocator::shared_ptr<ResourceInternal>> alive_resources;
+			GatherResources(alive_resources);
 
-			for (auto& x : resources)
+			for (auto& resourceinternal : alive_resources)
 			{
-				const std::string& name = x.first;
-				auto resourceinternal = x.second.lock();
-				if (resourceinternal == nullptr)
-					continue;
-
 				uint64_t timestamp = wi::helper::FileTimestamp(resourceinternal->filename);
 				if (resourceinternal->timestamp < timestamp)
 					return true;
@@ -1422,14 +1845,11 @@ namespace wi
 
 		void ReloadOutdatedResources()
 		{
-			std::scoped_lock lck(locker);
+			wi::vector<wi::allocator::shared_ptr<ResourceInternal>> alive_resources;
+			GatherResources(alive_resources);
 
-			for (auto& x : resources)
+			for (auto& resourceinternal : alive_resources)
 			{
-				auto resourceinternal = x.second.lock();
-				if (resourceinternal == nullptr)
-					continue;
-
 				uint64_t timestamp = wi::helper::FileTimestamp(resourceinternal->filename);
 				if (resourceinternal->timestamp < timestamp)
 				{
@@ -1438,12 +1858,12 @@ namespace wi
 					{
 						if (resourceinternal->streaming_texture.mip_count > 1)
 							wi::jobsystem::Wait(streaming_ctx); // reloading a resource that is potentially streaming needs to wait for current streaming job to end
+						resourceinternal->container_filename = resourceinternal->filename;
+						resourceinternal->container_fileoffset = 0;
+						resourceinternal->container_filesize = ~0ull;
 						if (LoadResourceDirectly(resourceinternal->filename, resourceinternal->flags, filedata.data(), filedata.size(), resourceinternal.get()))
 						{
 							resourceinternal->timestamp = timestamp;
-							resourceinternal->container_filename = resourceinternal->filename;
-							resourceinternal->container_fileoffset = 0;
-							resourceinternal->container_filesize = ~0ull;
 							wi::backlog::post("[resourcemanager] reload success: " + resourceinternal->filename);
 						}
 						else
@@ -1461,12 +1881,11 @@ namespace wi
 
 		void CollectResources(wi::unordered_map<std::string, wi::Resource>& out_resources, ResourceType types)
 		{
-			std::scoped_lock lck(locker);
-			for (auto& x : resources)
+			wi::vector<wi::allocator::shared_ptr<ResourceInternal>> alive_resources;
+			GatherResources(alive_resources);
+
+			for (auto& resourceinternal : alive_resources)
 			{
-				auto resourceinternal = x.second.lock();
-				if (resourceinternal == nullptr)
-					continue;
 
 				bool valid = false;
 				if (has_flag(types, ResourceType::TEXTURE) && resourceinternal->texture.IsValid())
@@ -1491,7 +1910,7 @@ namespace wi
 				}
 				if (!valid)
 					continue;
-				out_resources[x.first].internal_state = resourceinternal;
+				out_resources[resourceinternal->filename].internal_state = resourceinternal;
 			}
 		}
 
@@ -1504,6 +1923,54 @@ namespace wi
 			return max_texture_resolution;
 		}
 
+		void SetTextureCookingEnabled(bool value)
+		{
+			texture_cooking = value;
+		}
+		bool IsTextureCookingEnabled()
+		{
+			return texture_cooking;
+		}
+		bool CookTexture(const std::string& filename, Flags flags)
+		{
+			wi::vector<uint8_t> filedata;
+			if (!wi::helper::FileRead(filename, filedata))
+				return false;
+			wi::vector<uint8_t> cooked;
+			if (!CookImage(filedata.data(), filedata.size(), flags, cooked))
+				return false;
+			return wi::helper::FileWrite(GetCookedTextureFileName(filename, flags), cooked.data(), cooked.size());
+		}
+
+		void SetDerivedDataCacheDirectory(const std::string& directory)
+		{
+			derived_data_directory = directory;
+			if (!derived_data_directory.empty() && derived_data_directory.back() != '/' && derived_data_directory.back() != '\\')
+			{
+				derived_data_directory += "/";
+			}
+		}
+		const std::string& GetDerivedDataCacheDirectory()
+		{
+			return derived_data_directory;
+		}
+		DerivedDataCacheStats GetDerivedDataCacheStats()
+		{
+			DerivedDataCacheStats stats;
+			stats.hits = derived_data_hits.load();
+			stats.misses = derived_data_misses.load();
+			stats.bytes_read = derived_data_bytes_read.load();
+			stats.bytes_written = derived_data_bytes_written.load();
+			return stats;
+		}
+		void ResetDerivedDataCacheStats()
+		{
+			derived_data_hits.store(0);
+			derived_data_misses.store(0);
+			derived_data_bytes_read.store(0);
+			derived_data_bytes_written.store(0);
+		}
+
 		void Serialize_READ(wi::Archive& archive, ResourceSerializer& seri)
 		{
 			assert(archive.IsReadMode());
@@ -1517,6 +1984,7 @@ namespace wi
 				std::string name;
 				const uint8_t* filedata = nullptr;
 				size_t filesize = 0;
+				size_t chunk_index = ~0ull;
 			};
 			wi::vector<TempResource> temp_resources;
 			temp_resources.resize(serializable_count);
@@ -1535,11 +2003,21 @@ namespace wi
 				//	We don't apply the flags, because they will be requested later by for example materials
 				//	If we would apply flags here, then flags from previous session would be applied, that maybe we no longer want (for example RETAIN_FILEDATA)
 
-				// We don't read the file data from archive into a vector like usual, instead map the vector,
-				//  this is much faster and we don't need to retain this data after archive lifetime
-				archive.MapVector(resource.filedata, resource.filesize);
+				size_t file_offset = 0;
+				if (archive.GetVersion() >= 94)
+				{
+					// The file data is stored in a separate archive chunk, which will be read on a job thread:
+					archive >> resource.chunk_index;
+					file_offset = archive.GetChunk(resource.chunk_index).offset;
+				}
+				else
+				{
+					// We don't read the file data from archive into a vector like usual, instead map the vector,
+					//  this is much faster and we don't need to retain this data after archive lifetime
+					archive.MapVector(resource.filedata, resource.filesize);
 
-				size_t file_offset = archive.GetPos() - resource.filesize;
+					file_offset = archive.GetPos() - resource.filesize;
+				}
 				
 				resource.name = archive.GetSourceDirectory() + resource.name;
 
@@ -1552,7 +2030,23 @@ namespace wi
 				wi::jobsystem::Execute(ctx, [i, &temp_resources, &seri, &archive, file_offset](wi::jobsystem::JobArgs args) {
 					auto& tmp_resource = temp_resources[i];
 					Flags flags = Flags::IMPORT_DELAY;
-					if (archive.IsCompressionEnabled())
+					wi::vector<uint8_t> chunk_data;
+					if (tmp_resource.chunk_index != ~0ull)
+					{
+						if (!archive.ReadChunkData(tmp_resource.chunk_index, chunk_data))
+						{
+							wilog_error("Resource couldn't be read from archive: %s", tmp_resource.name.c_str());
+							return;
+						}
+						tmp_resource.filedata = chunk_data.data();
+						tmp_resource.filesize = chunk_data.size();
+						if (archive.GetChunk(tmp_resource.chunk_index).compressed)
+						{
+							// If compressed chunk, cannot stream from it, retain file data in memory:
+							flags |= Flags::IMPORT_RETAIN_FILEDATA;
+						}
+					}
+					else if (archive.IsCompressionEnabled())
 					{
 						// If compressed archive, cannot stream from it, retain file data in memory:
 						flags |= Flags::IMPORT_RETAIN_FILEDATA;
@@ -1579,7 +2073,6 @@ namespace wi
 
 			wi::jobsystem::Wait(streaming_ctx); // stop streaming at this point
 
-			locker.lock();
 			size_t serializable_count = 0;
 
 			if (mode == Mode::NO_EMBEDDING)
@@ -1590,34 +2083,42 @@ namespace wi
 			}
 			else
 			{
-				// Count embedded resources:
+				// Gather embedded resources, they are kept alive until they are written:
+				wi::vector<wi::allocator::shared_ptr<ResourceInternal>> serializable_resources;
 				for (auto& name : resource_names)
 				{
-					auto it = resources.find(name);
-					if (it == resources.end())
+					ResourceShard& shard = GetResourceShard(name);
+					std::scoped_lock lck(shard.locker);
+					auto it = shard.resources.find(name);
+					if (it == shard.resources.end())
 						continue;
 					wi::allocator::shared_ptr<ResourceInternal> resource = it->second.lock();
 					if (resource != nullptr)
 					{
-						serializable_count++;
+						serializable_resources.push_back(resource);
 					}
 				}
+				serializable_count = serializable_resources.size();
 
 				// Write all embedded resources:
 				archive << serializable_count;
-				for (auto& name : resource_names)
+				for (auto& resource : serializable_resources)
 				{
-					auto it = resources.find(name);
-					if (it == resources.end())
-						continue;
-					wi::allocator::shared_ptr<ResourceInternal> resource = it->second.lock();
+					// The shard lock is held while the resource is read and modified, because other threads can be loading the same resource:
+					ResourceShard& shard = GetResourceShard(resource->filename);
+					std::scoped_lock lck(shard.locker);
 
-					if (resource != nullptr)
-					{
-						std::string name = it->first;
-						wi::helper::MakePathRelative(archive.GetSourceDirectory(), name);
+					std::string name = resource->filename;
+					wi::helper::MakePathRelative(archive.GetSourceDirectory(), name);
 
-						if (resource->filedata.empty())
+					if (resource->filedata.empty())
+					{
+						if (resource->container_filename != resource->filename && resource->container_filename == GetCookedTextureFileName(resource->filename, resource->flags))
+						{
+							// Cooked textures are embedded as their source image, the cooked file can be recreated from it:
+							wi::helper::FileRead(resource->filename, resource->filedata);
+						}
+						else
 						{
 							// Directly re-read the file part that is needed:
 							wi::helper::FileRead(
@@ -1627,35 +2128,46 @@ namespace wi
 								resource->container_fileoffset
 							);
 						}
+					}
 
-						archive << name;
-						archive << (uint32_t)resource->flags;
+					archive << name;
+					archive << (uint32_t)resource->flags;
+					size_t container_fileoffset = 0;
+					if (archive.GetVersion() >= 94)
+					{
+						// Each resource is stored in its own chunk, so they can be read independently:
+						const size_t chunk_index = archive.WriteChunkData(name, resource->filedata.data(), resource->filedata.size());
+						archive << chunk_index;
+						container_fileoffset = archive.GetChunk(chunk_index).offset;
+					}
+					else
+					{
 						archive << resource->filedata;
+						container_fileoffset = archive.GetPos() - resource->filedata.size();
+					}
 
-						resource_log("Resource written to archive: %s", name.c_str());
+					resource_log("Resource written to archive: %s", name.c_str());
 
-						if (!archive.GetSourceFileName().empty())
+					if (!archive.GetSourceFileName().empty())
+					{
+						// Refresh the container file properties to the current file:
+						//	The old file offsets could get stale otherwise if it's overwritten
+						resource->container_filename = archive.GetSourceFileName();
+						resource->container_fileoffset = container_fileoffset;
+						resource->container_filesize = resource->filedata.size();
+						if (archive.IsCompressionEnabled())
 						{
-							// Refresh the container file properties to the current file:
-							//	The old file offsets could get stale otherwise if it's overwritten
-							resource->container_filename = archive.GetSourceFileName();
-							resource->container_fileoffset = archive.GetPos() - resource->filedata.size();
-							resource->container_filesize = resource->filedata.size();
-							if (archive.IsCompressionEnabled())
-							{
-								// Compressed archive: retain file data to keep resource streamable
-								resource->flags |= Flags::IMPORT_RETAIN_FILEDATA;
-							}
-							if (!has_flag(resource->flags, Flags::IMPORT_RETAIN_FILEDATA))
-							{
-								resource->filedata.clear();
-								resource->filedata.shrink_to_fit();
-							}
+							// Compressed archive: retain file data to keep resource streamable
+							resource->flags |= Flags::IMPORT_RETAIN_FILEDATA;
+						}
+						if (!has_flag(resource->flags, Flags::IMPORT_RETAIN_FILEDATA))
+						{
+							resource->filedata.clear();
+							resource->filedata.shrink_to_fit();
 						}
 					}
 				}
 			}
-			locker.unlock();
 		}
 
 	}
@@ -78,7 +78,7 @@ namespace wi
 			IMPORT_NORMALMAP = 1 << 2, // image import will try to use optimal normal map encoding
 			IMPORT_BLOCK_COMPRESSED = 1 << 3, // image import will request block compression for uncompressed or transcodable formats
 			IMPORT_DELAY = 1 << 4, // delay importing resource until later, for example when proper flags can be determined.
-			STREAMING = 1 << 5, // use streaming if possible
+			STREAMING = 1 << 5, // use streaming if possible (textures: mip level streaming, sounds: incremental decoding while playing)
 		};
 
 		// Load a resource
@@ -96,6 +96,35 @@ namespace wi
 			const std::string& container_filename = "",
 			size_t container_fileoffset = 0
 		);
+
+		// Handle of a resource that is loading in the background, it is returned by LoadBatch()
+		struct LoadHandle
+		{
+			wi::allocator::shared_ptr<void> internal_state;
+			constexpr bool IsValid() const { return internal_state.IsValid(); }
+
+			// Returns true if loading finished (successfully or not), this doesn't block
+			bool IsReady() const;
+			// Blocks until loading finished, the calling thread executes loading jobs while waiting
+			void Wait() const;
+			// Waits for loading to finish, then returns the resource, which is not valid if loading failed
+			const Resource& Get() const;
+		};
+
+		// Load multiple resources in parallel on the job system (low priority threads)
+		//	Every unique name is loaded by a separate job, which reads the file and decodes it. Repeated names are loaded once, and their handles refer to the same load
+		//	names : file names of resources
+		//	count : number of names
+		//	flags : specify flags that modify behaviour for every resource (optional)
+		//	returns a handle for every name, in the same order as names
+		wi::vector<LoadHandle> LoadBatch(const std::string* names, size_t count, Flags flags = Flags::NONE);
+		inline wi::vector<LoadHandle> LoadBatch(const wi::vector<std::string>& names, Flags flags = Flags::NONE)
+		{
+			return LoadBatch(names.data(), names.size(), flags);
+		}
+		// Blocks until all the handles finished loading
+		void Wait(const wi::vector<LoadHandle>& handles);
+
 		// Check if a resource is currently loaded
 		bool Contains(const std::string& name);
 		// Invalidate all resources
@@ -105,6 +134,35 @@ namespace wi
 		void SetTextureResolutionLimit(uint32_t resolution);
 		uint32_t GetTextureResolutionLimit();
 
+		// Texture cooking: images (png, jpg, tga, bmp) imported with IMPORT_BLOCK_COMPRESSED are compressed on the CPU instead of the GPU,
+		//	and cached as DDS files next to the source (file name with .dds or .normalmap.dds appended)
+		//	Later loads use the cached DDS file while it is newer than the source file, so no decoding or compression is needed
+		void SetTextureCookingEnabled(bool value);
+		bool IsTextureCookingEnabled();
+
+		// Compresses an image file on the CPU and writes the DDS file that texture cooking uses, this doesn't need a graphics device
+		//	flags: IMPORT_NORMALMAP selects normal map compression
+		bool CookTexture(const std::string& filename, Flags flags = Flags::NONE);
+
+		// Derived data cache: the results of importing resources are stored in a local directory,
+		//	so that later loads of the same content don't need to decode or compress again
+		//	Entries are keyed by the hash of the source file data, the import flags and the engine version, so they never become outdated
+		//	Cached: decoded images, block compressed images with full mip chain (IMPORT_BLOCK_COMPRESSED), decoded sounds (not STREAMING)
+		//	Entries are read with memory mapping, the cache directory can be deleted any time to clear the cache
+		//	directory: empty string disables the cache (default)
+		void SetDerivedDataCacheDirectory(const std::string& directory);
+		const std::string& GetDerivedDataCacheDirectory();
+
+		struct DerivedDataCacheStats
+		{
+			uint32_t hits = 0;			// number of imports that used a cache entry
+			uint32_t misses = 0;		// number of imports that didn't find a cache entry
+			uint64_t bytes_read = 0;	// size of the cache entries that were used
+			uint64_t bytes_written = 0;	// size of the cache entries that were written
+		};
+		DerivedDataCacheStats GetDerivedDataCacheStats();
+		void ResetDerivedDataCacheStats();
+
 		// Set threshold relative to memory budget for streaming
 		//	If memory usage is below threshold, streaming will work regularly
 		//	If memory usage is above threshold, streaming will try to reduce usage
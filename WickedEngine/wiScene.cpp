@@ -38,6 +38,9 @@ namespace wi::scene
 		this->dt = dt;
 		time += dt;
 
+		transforms_changed.clear();
+		transform_update_count.store(0);
+
 		wi::jobsystem::context ctx;
 
 		UpdateHumanoidFacings();
@@ -382,39 +385,54 @@ namespace wi::scene
 
 		WaitBuildTopDownHierarchy();
 
-		RunProceduralAnimationUpdateSystem(ctx);
-
-		wi::physics::OverrideWehicleWheelTransforms(*this);
-
-		RunArmatureUpdateSystem(ctx);
-
-		RunWeatherUpdateSystem(ctx);
-
-		wi::jobsystem::Wait(ctx); // dependencies
-
-		RunObjectUpdateSystem(ctx);
-
-		RunCameraUpdateSystem(ctx);
-
-		RunDecalUpdateSystem(ctx);
-
-		RunProbeUpdateSystem(ctx);
-
-		RunForceUpdateSystem(ctx);
-
-		RunLightUpdateSystem(ctx);
-
-		RunParticleUpdateSystem(ctx);
-
-		RunSoundUpdateSystem(ctx);
-
-		RunImpostorUpdateSystem(ctx);
-
-		RunSpriteUpdateSystem(ctx);
+		// Meshlets are allocated by object, particle and impostor systems which can run in parallel:
+		meshletAllocator.store(0u);
 
-		RunFontUpdateSystem(ctx);
+		// The rest of the systems are executed as a task graph, so that independent systems can overlap instead of waiting on barriers:
+		{
+			using wi::jobsystem::TaskGraph;
+			TaskGraph graph;
 
-		wi::jobsystem::Wait(ctx); // dependencies
+			const TaskGraph::Task procedural = graph.Add([this](wi::jobsystem::context& ctx) {
+				RunProceduralAnimationUpdateSystem(ctx);
+				wi::physics::OverrideWehicleWheelTransforms(*this);
+			});
+			const TaskGraph::Task weather = graph.Add([this](wi::jobsystem::context& ctx) { RunWeatherUpdateSystem(ctx); });
+			const TaskGraph::Task armature = graph.Add([this](wi::jobsystem::context& ctx) { RunArmatureUpdateSystem(ctx); });
+			graph.AddDependency(armature, procedural);
+
+			// These depend on final transforms:
+			const TaskGraph::Task object = graph.Add([this](wi::jobsystem::context& ctx) { RunObjectUpdateSystem(ctx); });
+			graph.AddDependency(object, armature);
+			graph.AddDependency(object, weather);
+			const TaskGraph::Task particle = graph.Add([this](wi::jobsystem::context& ctx) { RunParticleUpdateSystem(ctx); });
+			graph.AddDependency(particle, armature);
+			graph.AddDependency(particle, weather);
+			const TaskGraph::Task light = graph.Add([this](wi::jobsystem::context& ctx) { RunLightUpdateSystem(ctx); });
+			graph.AddDependency(light, procedural);
+			graph.AddDependency(light, weather); // weather resets the most important light
+			const TaskGraph::Task camera = graph.Add([this](wi::jobsystem::context& ctx) { RunCameraUpdateSystem(ctx); });
+			graph.AddDependency(camera, procedural);
+			const TaskGraph::Task decal = graph.Add([this](wi::jobsystem::context& ctx) { RunDecalUpdateSystem(ctx); });
+			graph.AddDependency(decal, procedural);
+			const TaskGraph::Task probe = graph.Add([this](wi::jobsystem::context& ctx) { RunProbeUpdateSystem(ctx); });
+			graph.AddDependency(probe, procedural);
+			const TaskGraph::Task force = graph.Add([this](wi::jobsystem::context& ctx) { RunForceUpdateSystem(ctx); });
+			graph.AddDependency(force, procedural);
+			const TaskGraph::Task sound = graph.Add([this](wi::jobsystem::context& ctx) { RunSoundUpdateSystem(ctx); });
+			graph.AddDependency(sound, procedural);
+			const TaskGraph::Task font = graph.Add([this](wi::jobsystem::context& ctx) { RunFontUpdateSystem(ctx); });
+			graph.AddDependency(font, sound); // font typewriter uses the sound instances
+
+			// These don't depend on transforms:
+			graph.Add([this](wi::jobsystem::context& ctx) { RunImpostorUpdateSystem(ctx); });
+			graph.Add([this](wi::jobsystem::context& ctx) { RunSpriteUpdateSystem(ctx); });
+
+			wi::jobsystem::Submit(ctx, graph);
+			wi::jobsystem::Wait(ctx); // dependencies
+		}
+
+		wi::profiler::SetCounter("Transforms recomputed", transform_update_count.load());
 
 		// Merge parallel bounds computation (depends on object update system):
 		bounds = AABB();
@@ -423,6 +441,8 @@ namespace wi::scene
 			bounds = AABB::Merge(bounds, group_bound);
 		}
 
+		UpdateObjectBVH(); // depends on object update system
+
 		// Meshlet buffer:
 		uint32_t meshletCount = meshletAllocator.load();
 		if(meshletBuffer.desc.size < meshletCount * sizeof(ShaderMeshlet))
@@ -1042,9 +1062,39 @@ namespace wi::scene
 			shaderscene.voxelgrid.voxelSize = voxelgrid.voxelSize;
 			shaderscene.voxelgrid.voxelSize_rcp = voxelgrid.voxelSize_rcp;
 		}
+
+		// Skinned positions cached before this point are outdated for the Intersects() queries:
+		skinned_position_cache_frame++;
+		if (skinned_position_cache_enabled)
+		{
+			for (auto it = skinned_position_cache.begin(); it != skinned_position_cache.end();)
+			{
+				if (meshes.Contains(it->first))
+				{
+					++it;
+				}
+				else
+				{
+					it = skinned_position_cache.erase(it);
+				}
+			}
+		}
+		else
+		{
+			skinned_position_cache.clear();
+		}
 	}
 	void Scene::Clear()
 	{
+		wi::jobsystem::Wait(object_bvh_workload);
+		object_bvh = {};
+		object_bvh_next = {};
+		object_bvh_next_aabbs.clear();
+		object_bvh_generation = ~0ull;
+		object_bvh_next_generation = ~0ull;
+		object_bvh_refit_count = 0;
+		object_bvh_valid = false;
+
 		for(auto& entry : componentLibrary.entries)
 		{
 			entry.second.component_manager->Clear();
@@ -1066,12 +1116,16 @@ namespace wi::scene
 
 		matrix_objects.clear();
 		matrix_objects_prev.clear();
+		object_bounds_cache.clear();
+		object_streams.Clear();
 
 		collider_count_cpu = 0;
 		collider_count_gpu = 0;
 
 		topdown_hierarchy.clear();
 		gaussian_scene.Clear();
+
+		skinned_position_cache.clear();
 	}
 	void Scene::MergeFastInternal(Scene& other)
 	{
@@ -2006,10 +2060,79 @@ namespace wi::scene
 		}
 	}
 
+	// Finds the keyframes around the time in sorted keyframe times, with the same result as the linear search in RunAnimationUpdateSystem()
+	//	cursor: index of the first keyframe after the time of the previous search, forward playback continues from there with a few steps,
+	//		the binary search is only used when seeking (for example when the animation loops)
+	static void SearchSortedKeyframes(const wi::vector<float>& times, float time, int& cursor, int& keyLeft, int& keyRight, float& timeLeft, float& timeRight)
+	{
+		const int count = (int)times.size();
+		int upper = std::min(std::max(cursor, 0), count);
+		if (upper > 0 && times[upper - 1] > time)
+		{
+			upper = int(std::upper_bound(times.begin(), times.begin() + upper, time) - times.begin());
+		}
+		else
+		{
+			constexpr int max_steps = 4;
+			for (int step = 0; step < max_steps && upper < count && times[upper] <= time; ++step)
+			{
+				upper++;
+			}
+			if (upper < count && times[upper] <= time)
+			{
+				upper = int(std::upper_bound(times.begin() + upper, times.end(), time) - times.begin());
+			}
+		}
+		cursor = upper;
+
+		// Left: the first of the keyframes with the latest time that is not after the time
+		if (upper > 0)
+		{
+			keyLeft = upper - 1;
+			timeLeft = times[keyLeft];
+			while (keyLeft > 0 && times[keyLeft - 1] == timeLeft)
+			{
+				keyLeft--;
+			}
+		}
+		else
+		{
+			keyLeft = 0;
+			timeLeft = -FLT_MAX;
+		}
+
+		// Right: the first of the keyframes with the earliest time that is not before the time
+		if (upper > 0 && timeLeft == time)
+		{
+			keyRight = keyLeft;
+			timeRight = time;
+		}
+		else if (upper < count)
+		{
+			keyRight = upper;
+			timeRight = times[upper];
+		}
+		else
+		{
+			keyRight = 0;
+			timeRight = FLT_MAX;
+		}
+	}
+
 	void Scene::RunAnimationUpdateSystem(wi::jobsystem::context& ctx)
 	{
 		auto range = wi::profiler::BeginRangeCPU("Animations");
 
+		// The keyframe information is only computed again for animation datas whose keyframe count changed:
+		for (size_t i = 0; i < animation_datas.GetCount(); ++i)
+		{
+			AnimationDataComponent& animationdata = animation_datas[i];
+			if (!animationdata.IsKeyframeInfoValid())
+			{
+				animationdata.UpdateKeyframeInfo();
+			}
+		}
+
 		wi::jobsystem::Wait(animation_dependency_scan_workload);
 
 		wi::jobsystem::Dispatch(ctx, (uint32_t)animation_queue_count, 1, [&](wi::jobsystem::JobArgs args) {
@@ -2030,7 +2153,14 @@ namespace wi::scene
 					const AnimationDataComponent* animationdata = data_scene->animation_datas.GetComponent(sampler.data);
 					if (animationdata == nullptr)
 						continue;
-					if (animationdata->keyframe_times.empty())
+					const AnimationDataComponent* timedata = animationdata; // compressed datas have the keyframe times in a separate time track
+					if (animationdata->IsCompressed())
+					{
+						timedata = data_scene->animation_datas.GetComponent(animationdata->time_track);
+						if (timedata == nullptr)
+							continue;
+					}
+					if (timedata->keyframe_times.empty())
 						continue;
 
 					const AnimationComponent::AnimationChannel::PathDataType path_data_type = channel.GetPathDataType();
@@ -2043,26 +2173,36 @@ namespace wi::scene
 					float timeRight = FLT_MAX;
 
 					// search for usable keyframes:
-					for (int k = 0; k < (int)animationdata->keyframe_times.size(); ++k)
+					if (timedata->IsKeyframeInfoValid() && timedata->keyframe_times_sorted)
 					{
-						const float time = animationdata->keyframe_times[k];
-						if (time < timeFirst)
-						{
-							timeFirst = time;
-						}
-						if (time > timeLast)
-						{
-							timeLast = time;
-						}
-						if (time <= animation.timer && time > timeLeft)
-						{
-							timeLeft = time;
-							keyLeft = k;
-						}
-						if (time >= animation.timer && time < timeRight)
+						timeFirst = timedata->time_first;
+						timeLast = timedata->time_last;
+						SearchSortedKeyframes(timedata->keyframe_times, animation.timer, channel.keyframe_cursor, keyLeft, keyRight, timeLeft, timeRight);
+					}
+					else
+					{
+						// unsorted keyframes, or animation data of a different scene that wasn't updated:
+						for (int k = 0; k < (int)timedata->keyframe_times.size(); ++k)
 						{
-							timeRight = time;
-							keyRight = k;
+							const float time = timedata->keyframe_times[k];
+							if (time < timeFirst)
+							{
+								timeFirst = time;
+							}
+							if (time > timeLast)
+							{
+								timeLast = time;
+							}
+							if (time <= animation.timer && time > timeLeft)
+							{
+								timeLeft = time;
+								keyLeft = k;
+							}
+							if (time >= animation.timer && time < timeRight)
+							{
+								timeRight = time;
+								keyRight = k;
+							}
 						}
 					}
 					if (path_data_type != AnimationComponent::AnimationChannel::PathDataType::Event)
@@ -2082,8 +2222,8 @@ namespace wi::scene
 						timeRight = std::max(timeRight, timeLast);
 					}
 
-					const float left = animationdata->keyframe_times[keyLeft];
-					const float right = animationdata->keyframe_times[keyRight];
+					const float left = timedata->keyframe_times[keyLeft];
+					const float right = timedata->keyframe_times[keyRight];
 
 					union Interpolator
 					{
@@ -2302,6 +2442,65 @@ namespace wi::scene
 							}
 						}
 					}
+					else if (animationdata->IsCompressed())
+					{
+						// Compressed path data interpolation, the keyframes are decompressed with SIMD:
+						//	Only the datas of LINEAR samplers are compressed
+						float t = 0;
+						if (keyLeft != keyRight)
+						{
+							t = saturate((animation.timer - left) / (right - left));
+						}
+
+						if (path_data_type == AnimationComponent::AnimationChannel::PathDataType::Weights)
+						{
+							assert(animationdata->component_count == animation.morph_weights_temp.size());
+							const size_t count = std::min(size_t(animationdata->component_count), animation.morph_weights_temp.size());
+							for (size_t j = 0; j < count; j += 4)
+							{
+								XMVECTOR vLeft = animationdata->DecompressKeyframe(keyLeft, j);
+								XMVECTOR vRight = animationdata->DecompressKeyframe(keyRight, j);
+								XMFLOAT4 vAnim;
+								XMStoreFloat4(&vAnim, XMVectorLerp(vLeft, vRight, t));
+								const float* values = &vAnim.x;
+								for (size_t c = 0; c < std::min(size_t(4), count - j); ++c)
+								{
+									animation.morph_weights_temp[j + c] = values[c];
+								}
+							}
+						}
+						else
+						{
+							XMVECTOR vLeft = animationdata->DecompressKeyframe(keyLeft);
+							XMVECTOR vRight = animationdata->DecompressKeyframe(keyRight);
+							XMVECTOR vAnim;
+							if (channel.path == AnimationComponent::AnimationChannel::Path::ROTATION)
+							{
+								vAnim = XMQuaternionSlerp(vLeft, vRight, t);
+								vAnim = XMQuaternionNormalize(vAnim);
+							}
+							else
+							{
+								vAnim = XMVectorLerp(vLeft, vRight, t);
+							}
+							switch (path_data_type)
+							{
+							default:
+							case AnimationComponent::AnimationChannel::PathDataType::Float:
+								interpolator.f = XMVectorGetX(vAnim);
+								break;
+							case AnimationComponent::AnimationChannel::PathDataType::Float2:
+								XMStoreFloat2(&interpolator.f2, vAnim);
+								break;
+							case AnimationComponent::AnimationChannel::PathDataType::Float3:
+								XMStoreFloat3(&interpolator.f3, vAnim);
+								break;
+							case AnimationComponent::AnimationChannel::PathDataType::Float4:
+								XMStoreFloat4(&interpolator.f4, vAnim);
+								break;
+							}
+						}
+					}
 					else
 					{
 						// Path data interpolation:
@@ -2876,74 +3075,359 @@ namespace wi::scene
 	}
 	void Scene::RunTransformUpdateSystem(wi::jobsystem::context& ctx)
 	{
+		transforms_changed.resize(transforms.GetCount());
+
 		wi::jobsystem::Dispatch(ctx, (uint32_t)transforms.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
 
+			uint32_t& group_update_count = *(uint32_t*)args.sharedmemory;
+			if (args.isFirstJobInGroup)
+			{
+				group_update_count = 0;
+			}
+
 			TransformComponent& transform = transforms[args.jobIndex];
-			transform.UpdateTransform();
-		});
+			if (transform.IsDirty())
+			{
+				transform.UpdateTransform();
+				transforms_changed[args.jobIndex] = 1;
+				group_update_count++;
+			}
+
+			if (args.isLastJobInGroup && group_update_count > 0)
+			{
+				transform_update_count.fetch_add(group_update_count, std::memory_order_relaxed);
+			}
+		}, sizeof(uint32_t));
 	}
-	void Scene::RunHierarchyUpdateSystem(wi::jobsystem::context& ctx)
+	void Scene::BuildHierarchyNodes()
 	{
-		wi::jobsystem::Dispatch(ctx, (uint32_t)hierarchy.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
+		const uint32_t count = (uint32_t)hierarchy.GetCount();
 
-			HierarchyComponent& hier = hierarchy[args.jobIndex];
-			Entity entity = hierarchy.GetEntity(args.jobIndex);
+		// Parent indices, a parent that is not attached to anything is ~0u:
+		hierarchy_parents.resize(count);
+		wi::vector<uint32_t> parent_indices(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			hierarchy_parents[i] = hierarchy[i].parentID;
+			parent_indices[i] = (uint32_t)hierarchy.GetIndex(hierarchy_parents[i]);
+		}
 
-			TransformComponent* transform_child = transforms.GetComponent(entity);
-			XMMATRIX worldmatrix;
-			if (transform_child != nullptr)
+		// Depth of every node, each chain is only walked until an already known depth:
+		wi::vector<uint32_t> depths(count, ~0u);
+		uint32_t level_count = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (depths[i] != ~0u)
+				continue;
+			uint32_t steps = 0;
+			uint32_t p = i;
+			while (p != ~0u && depths[p] == ~0u && steps <= count)
+			{
+				p = parent_indices[p];
+				steps++;
+			}
+			if (steps > count)
+			{
+				assert(0); // circular hierarchy, the node will be handled as if it was not attached
+				parent_indices[i] = ~0u;
+				std::fill(depths.begin(), depths.end(), ~0u);
+				level_count = 0;
+				i = ~0u; // restart after the loop increment
+				continue;
+			}
+			uint32_t depth = (p == ~0u ? 0 : depths[p] + 1) + steps - 1;
+			level_count = std::max(level_count, depth + 1);
+			p = i;
+			while (p != ~0u && depths[p] == ~0u)
 			{
-				worldmatrix = transform_child->GetLocalMatrix();
+				depths[p] = depth--;
+				p = parent_indices[p];
 			}
+		}
 
-			LayerComponent* layer_child = layers.GetComponent(entity);
-			if (layer_child != nullptr)
+		// Counting sort by depth:
+		hierarchy_level_offsets.clear();
+		hierarchy_level_offsets.resize(level_count + 1);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			hierarchy_level_offsets[depths[i] + 1]++;
+		}
+		for (uint32_t level = 0; level < level_count; ++level)
+		{
+			hierarchy_level_offsets[level + 1] += hierarchy_level_offsets[level];
+		}
+		wi::vector<uint32_t> node_indices(count);
+		wi::vector<uint32_t> order(count);
+		{
+			wi::vector<uint32_t> offsets(hierarchy_level_offsets.begin(), hierarchy_level_offsets.end() - 1);
+			for (uint32_t i = 0; i < count; ++i)
 			{
-				layer_child->propagationMask = ~0u; // clear propagation mask to full
+				uint32_t node = offsets[depths[i]]++;
+				node_indices[i] = node;
+				order[node] = i;
 			}
+		}
 
-			if (transform_child == nullptr && layer_child == nullptr)
-				return;
+		hierarchy_nodes.resize(count);
+		for (uint32_t node_index = 0; node_index < count; ++node_index)
+		{
+			const uint32_t i = order[node_index];
+			const Entity entity = hierarchy.GetEntity(i);
+			HierarchyNode& node = hierarchy_nodes[node_index];
+			node = {};
+			node.transform_index = (uint32_t)transforms.GetIndex(entity);
+			node.layer_index = (uint32_t)layers.GetIndex(entity);
+			const uint32_t parent_index = parent_indices[i];
+			if (parent_index != ~0u)
+			{
+				node.parent_node = node_indices[parent_index];
+				const HierarchyNode& parent = hierarchy_nodes[node.parent_node];
+				if (parent.transform_index != ~0u)
+				{
+					node.ancestor_transform_index = parent.transform_index;
+					node.ancestor_is_root = 0;
+				}
+				else
+				{
+					node.ancestor_transform_index = parent.ancestor_transform_index;
+					node.ancestor_is_root = parent.ancestor_is_root;
+				}
+			}
+			else
+			{
+				const Entity parentID = hierarchy_parents[i];
+				node.parent_layer_index = (uint32_t)layers.GetIndex(parentID);
+				node.ancestor_transform_index = (uint32_t)transforms.GetIndex(parentID);
+				node.ancestor_is_root = 1;
+			}
+		}
 
-			Entity parentID = hier.parentID;
-			while (parentID != INVALID_ENTITY)
+		hierarchy_generation = hierarchy.GetGeneration();
+		hierarchy_transforms_generation = transforms.GetGeneration();
+		hierarchy_layers_generation = layers.GetGeneration();
+	}
+	void Scene::RunHierarchyUpdateSystem(wi::jobsystem::context& ctx)
+	{
+		// The hierarchy is processed level by level from the roots, so every node only needs to look at its direct parent
+		//	Levels are processed in order, and nodes inside a level are processed in parallel if there are enough of them
+		wi::jobsystem::Execute(ctx, [this, &ctx](wi::jobsystem::JobArgs args) {
+
+			bool rebuild =
+				hierarchy_nodes.size() != hierarchy.GetCount() ||
+				hierarchy_generation != hierarchy.GetGeneration() ||
+				hierarchy_transforms_generation != transforms.GetGeneration() ||
+				hierarchy_layers_generation != layers.GetGeneration();
+			for (size_t i = 0; i < hierarchy.GetCount() && !rebuild; ++i)
 			{
-				TransformComponent* transform_parent = transforms.GetComponent(parentID);
-				if (transform_child != nullptr && transform_parent != nullptr)
+				// parentID can be modified directly, not only with attach/detach:
+				rebuild = hierarchy_parents[i] != hierarchy[i].parentID;
+			}
+			if (rebuild)
+			{
+				BuildHierarchyNodes();
+			}
+			hierarchy_layer_masks.resize(hierarchy_nodes.size());
+			hierarchy_changed.resize(hierarchy_nodes.size());
+			if (transforms_changed.size() < transforms.GetCount())
+			{
+				transforms_changed.resize(transforms.GetCount());
+			}
+
+			// Only those world matrices are recomputed that have changed themselves or have a changed ancestor
+			//	When the hierarchy was rebuilt, everything is recomputed
+			auto update_node = [this, rebuild](uint32_t node_index) -> uint32_t {
+				const HierarchyNode& node = hierarchy_nodes[node_index];
+
+				uint32_t parent_mask = ~0u;
+				if (node.parent_node != ~0u)
+				{
+					parent_mask = hierarchy_layer_masks[node.parent_node];
+				}
+				else if (node.parent_layer_index != ~0u)
+				{
+					parent_mask = layers[node.parent_layer_index].layerMask;
+				}
+				uint32_t mask = parent_mask;
+				if (node.layer_index != ~0u)
 				{
-					worldmatrix *= transform_parent->GetLocalMatrix();
+					LayerComponent& layer_child = layers[node.layer_index];
+					layer_child.propagationMask = parent_mask;
+					mask &= layer_child.layerMask;
 				}
+				hierarchy_layer_masks[node_index] = mask;
 
-				LayerComponent* layer_parent = layers.GetComponent(parentID);
-				if (layer_child != nullptr && layer_parent != nullptr)
+				bool changed = rebuild;
+				if (node.parent_node != ~0u)
+				{
+					changed |= hierarchy_changed[node.parent_node] != 0;
+				}
+				else if (node.ancestor_transform_index != ~0u)
+				{
+					changed |= IsTransformChanged(node.ancestor_transform_index);
+				}
+				if (node.transform_index == ~0u)
 				{
-					layer_child->propagationMask &= layer_parent->layerMask;
+					hierarchy_changed[node_index] = changed ? 1 : 0;
+					return 0;
 				}
+				changed |= IsTransformChanged(node.transform_index);
+				hierarchy_changed[node_index] = changed ? 1 : 0;
+				if (!changed)
+					return 0;
 
-				const HierarchyComponent* hier_recursive = hierarchy.GetComponent(parentID);
-				if (hier_recursive != nullptr)
+				TransformComponent& transform_child = transforms[node.transform_index];
+				XMMATRIX worldmatrix = transform_child.GetLocalMatrix();
+				if (node.ancestor_transform_index != ~0u)
 				{
-					parentID = hier_recursive->parentID;
+					const TransformComponent& transform_parent = transforms[node.ancestor_transform_index];
+					worldmatrix *= node.ancestor_is_root ? transform_parent.GetLocalMatrix() : XMLoadFloat4x4(&transform_parent.world);
+				}
+				XMStoreFloat4x4(&transform_child.world, worldmatrix);
+				transforms_changed[node.transform_index] = 1;
+				return 1;
+			};
+
+			wi::jobsystem::context level_ctx;
+			level_ctx.priority = ctx.priority;
+			for (size_t level = 0; level + 1 < hierarchy_level_offsets.size(); ++level)
+			{
+				const uint32_t offset = hierarchy_level_offsets[level];
+				const uint32_t level_count = hierarchy_level_offsets[level + 1] - offset;
+				if (level_count <= small_subtask_groupsize)
+				{
+					uint32_t update_count = 0;
+					for (uint32_t i = 0; i < level_count; ++i)
+					{
+						update_count += update_node(offset + i);
+					}
+					transform_update_count.fetch_add(update_count, std::memory_order_relaxed);
 				}
 				else
 				{
-					parentID = INVALID_ENTITY;
+					wi::jobsystem::Dispatch(level_ctx, level_count, small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
+						uint32_t& group_update_count = *(uint32_t*)args.sharedmemory;
+						if (args.isFirstJobInGroup)
+						{
+							group_update_count = 0;
+						}
+						group_update_count += update_node(offset + args.jobIndex);
+						if (args.isLastJobInGroup && group_update_count > 0)
+						{
+							transform_update_count.fetch_add(group_update_count, std::memory_order_relaxed);
+						}
+					}, sizeof(uint32_t));
+					wi::jobsystem::Wait(level_ctx);
 				}
 			}
 
-			if (transform_child != nullptr)
+		});
+	}
+	// Groups work items into batches that can be processed in parallel:
+	//	Items that touch a common resource (for example the same transform) are put into the same batch, and every batch processes its items in the order they were added,
+	//	so the results are the same as processing all items serially
+	struct SharedResourceBatches
+	{
+		wi::vector<uint32_t> resource_owner; // item that last touched each resource, or ~0u
+		wi::vector<uint32_t> item_parent; // disjoint set forest of the items
+		wi::vector<uint32_t> batch_index; // batch of each root item
+		wi::vector<uint32_t> offsets; // start of every batch in items, plus the end
+		wi::vector<uint32_t> items;
+
+		void Init(uint32_t item_count, size_t resource_count)
+		{
+			resource_owner.assign(resource_count, ~0u);
+			item_parent.resize(item_count);
+			for (uint32_t i = 0; i < item_count; ++i)
+			{
+				item_parent[i] = i;
+			}
+		}
+		uint32_t Find(uint32_t item)
+		{
+			while (item_parent[item] != item)
+			{
+				item_parent[item] = item_parent[item_parent[item]];
+				item = item_parent[item];
+			}
+			return item;
+		}
+		void Touch(uint32_t item, size_t resource)
+		{
+			if (resource >= resource_owner.size())
+				return;
+			const uint32_t owner = resource_owner[resource];
+			resource_owner[resource] = item;
+			if (owner == ~0u)
+				return;
+			const uint32_t a = Find(owner);
+			const uint32_t b = Find(item);
+			if (a != b)
+			{
+				item_parent[std::max(a, b)] = std::min(a, b);
+			}
+		}
+		// Creates the batches after all items touched their resources
+		//	single_batch : all items are put into one batch in their original order
+		void Build(bool single_batch = false)
+		{
+			const uint32_t item_count = (uint32_t)item_parent.size();
+			if (single_batch)
+			{
+				offsets.clear();
+				offsets.push_back(0);
+				offsets.push_back(item_count);
+				items.resize(item_count);
+				for (uint32_t i = 0; i < item_count; ++i)
+				{
+					items[i] = i;
+				}
+				return;
+			}
+			batch_index.assign(item_count, ~0u);
+			offsets.clear();
+			for (uint32_t i = 0; i < item_count; ++i)
+			{
+				const uint32_t root = Find(i);
+				if (batch_index[root] == ~0u)
+				{
+					batch_index[root] = (uint32_t)offsets.size();
+					offsets.push_back(0);
+				}
+				offsets[batch_index[root]]++;
+			}
+			uint32_t offset = 0;
+			for (uint32_t& x : offsets)
+			{
+				const uint32_t count = x;
+				x = offset;
+				offset += count;
+			}
+			offsets.push_back(offset);
+			items.resize(item_count);
+			wi::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+			for (uint32_t i = 0; i < item_count; ++i)
 			{
-				XMStoreFloat4x4(&transform_child->world, worldmatrix);
+				items[cursor[batch_index[Find(i)]]++] = i;
 			}
+		}
+		uint32_t GetBatchCount() const { return offsets.empty() ? 0 : uint32_t(offsets.size() - 1); }
+	};
 
-		});
-	}
 	void Scene::RunExpressionUpdateSystem(wi::jobsystem::context& ctx)
 	{
-		for (size_t i = 0; i < expressions.GetCount(); ++i)
-		{
-			Entity entity = expressions.GetEntity(i);
-			ExpressionComponent& expression_mastering = expressions[i];
+		// The expression masters are independent, except for the morph targets that they write
+		//	Everything else is computed in parallel here, and the morph target writes are done afterwards in batches of masters that share meshes:
+		const uint32_t expression_count = (uint32_t)expressions.GetCount();
+		wi::jobsystem::context expression_ctx;
+		wi::jobsystem::Dispatch(expression_ctx, expression_count, character_systems_batching_enabled ? 16 : std::max(1u, expression_count), [&](wi::jobsystem::JobArgs args) {
+			Entity entity = expressions.GetEntity(args.jobIndex);
+			ExpressionComponent& expression_mastering = expressions[args.jobIndex];
+
+			// The random numbers come from the entity and the scene time, so they don't depend on which thread updates this master:
+			size_t seed = 0;
+			wi::helper::hash_combine(seed, entity);
+			wi::helper::hash_combine(seed, time);
+			wi::random::RNG rng(uint64_t(seed) | 1ull);
 
 			// Procedural blink:
 			expression_mastering.blink_timer += expression_mastering.blink_frequency * dt;
@@ -2972,7 +3456,7 @@ namespace wi::scene
 					if (expression_mastering.blink_timer >= 1 + all_blink_length)
 					{
 						expression.weight = 0;
-						expression_mastering.blink_timer = -wi::random::GetRandom(0.0f, 1.0f);
+						expression_mastering.blink_timer = -rng.next_float();
 					}
 					expression.SetDirty();
 				}
@@ -2982,8 +3466,8 @@ namespace wi::scene
 			if (expression_mastering.look_timer == 0)
 			{
 				// Roll new random look direction for next look away event:
-				float vertical = wi::random::GetRandom(-1.0f, 1.0f);
-				float horizontal = wi::random::GetRandom(-1.0f, 1.0f);
+				float vertical = rng.next_float(-1.0f, 1.0f);
+				float horizontal = rng.next_float(-1.0f, 1.0f);
 				expression_mastering.look_weights[0] = saturate(vertical);
 				expression_mastering.look_weights[1] = saturate(-vertical);
 				expression_mastering.look_weights[2] = saturate(horizontal);
@@ -3019,7 +3503,7 @@ namespace wi::scene
 				}
 				if (expression_mastering.look_timer >= 1 + expression_mastering.look_length * expression_mastering.look_frequency)
 				{
-					expression_mastering.look_timer = -wi::random::GetRandom(0.0f, 1.0f);
+					expression_mastering.look_timer = -rng.next_float();
 				}
 			}
 
@@ -3044,7 +3528,7 @@ namespace wi::scene
 				int mouth = expression_mastering.presets[(int)expression_mastering.talking_phoneme];
 				ExpressionComponent::Expression& expression = expression_mastering.expressions[mouth];
 
-				if (voice_playing)
+				if (voice_playing && !wi::audio::IsStreaming(&sound->soundResource.GetSound()))
 				{
 					// Take voice sample from audio:
 					wi::audio::SampleInfo info = wi::audio::GetSampleInfo(&sound->soundResource.GetSound());
@@ -3092,7 +3576,7 @@ namespace wi::scene
 				if (prev_slope < 0 && curr_slope > 0)
 				{
 					// New phoneme when voice slope valley is detected:
-					expression_mastering.talking_phoneme = unused_phonemes[wi::random::GetRandom(0, (int)arraysize(unused_phonemes) - 1)];
+					expression_mastering.talking_phoneme = unused_phonemes[rng.next_int(0, (int)arraysize(unused_phonemes) - 1)];
 				}
 
 				expression.SetDirty();
@@ -3128,9 +3612,8 @@ namespace wi::scene
 			float overrideBlinkBlend = 0;
 			float overrideLookBlend = 0;
 
-			// Pass 1: reset targets that will be modified by expressions:
-			//	Also accumulate override weights
-			for(ExpressionComponent::Expression& expression : expression_mastering.expressions)
+			// Accumulate override weights:
+			for(const ExpressionComponent::Expression& expression : expression_mastering.expressions)
 			{
 				if (expression.weight > 0)
 				{
@@ -3160,22 +3643,6 @@ namespace wi::scene
 						overrideLookBlend += blend;
 					}
 				}
-
-				if (!expression.IsDirty())
-					continue;
-
-				for (const ExpressionComponent::Expression::MorphTargetBinding& morph_target_binding : expression.morph_target_bindings)
-				{
-					MeshComponent* mesh = meshes.GetComponent(morph_target_binding.meshID);
-					if (mesh != nullptr && (int)mesh->morph_targets.size() > morph_target_binding.index)
-					{
-						MeshComponent::MorphTarget& morph_target = mesh->morph_targets[morph_target_binding.index];
-						if (morph_target.weight > 0)
-						{
-							morph_target.weight = 0;
-						}
-					}
-				}
 			}
 
 			// Override weights are factored in:
@@ -3221,29 +3688,75 @@ namespace wi::scene
 					expression.weight *= 1 - saturate(overrideLookBlend);
 				}
 			}
+		});
+		wi::jobsystem::Wait(expression_ctx);
 
-			// Pass 2: apply expressions:
-			for (ExpressionComponent::Expression& expression : expression_mastering.expressions)
+		// Masters that write the morph targets of the same mesh are batched together, and processed in the serial order:
+		SharedResourceBatches batches;
+		batches.Init((uint32_t)expressions.GetCount(), meshes.GetCount());
+		for (size_t i = 0; i < expressions.GetCount(); ++i)
+		{
+			for (const ExpressionComponent::Expression& expression : expressions[i].expressions)
 			{
 				if (!expression.IsDirty())
 					continue;
-
-				expression.SetDirty(false);
-				const float blend = expression.IsBinary() ? (expression.weight > 0 ? 1 : 0) : expression.weight;
-
 				for (const ExpressionComponent::Expression::MorphTargetBinding& morph_target_binding : expression.morph_target_bindings)
 				{
-					MeshComponent* mesh = meshes.GetComponent(morph_target_binding.meshID);
-					if (mesh != nullptr && (int)mesh->morph_targets.size() > morph_target_binding.index)
-					{
-						MeshComponent::MorphTarget& morph_target = mesh->morph_targets[morph_target_binding.index];
-						morph_target.weight = wi::math::Lerp(morph_target.weight, morph_target_binding.weight, blend);
-					}
+					batches.Touch((uint32_t)i, meshes.GetIndex(morph_target_binding.meshID));
 				}
 			}
 		}
-	}
-	void Scene::RunProceduralAnimationUpdateSystem(wi::jobsystem::context& ctx)
+		batches.Build(!character_systems_batching_enabled);
+
+		wi::jobsystem::Dispatch(expression_ctx, batches.GetBatchCount(), 16, [&](wi::jobsystem::JobArgs args) {
+			for (uint32_t item = batches.offsets[args.jobIndex]; item < batches.offsets[args.jobIndex + 1]; ++item)
+			{
+				ExpressionComponent& expression_mastering = expressions[batches.items[item]];
+
+				// Pass 1: reset targets that will be modified by expressions:
+				for (const ExpressionComponent::Expression& expression : expression_mastering.expressions)
+				{
+					if (!expression.IsDirty())
+						continue;
+
+					for (const ExpressionComponent::Expression::MorphTargetBinding& morph_target_binding : expression.morph_target_bindings)
+					{
+						MeshComponent* mesh = meshes.GetComponent(morph_target_binding.meshID);
+						if (mesh != nullptr && (int)mesh->morph_targets.size() > morph_target_binding.index)
+						{
+							MeshComponent::MorphTarget& morph_target = mesh->morph_targets[morph_target_binding.index];
+							if (morph_target.weight > 0)
+							{
+								morph_target.weight = 0;
+							}
+						}
+					}
+				}
+
+				// Pass 2: apply expressions:
+				for (ExpressionComponent::Expression& expression : expression_mastering.expressions)
+				{
+					if (!expression.IsDirty())
+						continue;
+
+					expression.SetDirty(false);
+					const float blend = expression.IsBinary() ? (expression.weight > 0 ? 1 : 0) : expression.weight;
+
+					for (const ExpressionComponent::Expression::MorphTargetBinding& morph_target_binding : expression.morph_target_bindings)
+					{
+						MeshComponent* mesh = meshes.GetComponent(morph_target_binding.meshID);
+						if (mesh != nullptr && (int)mesh->morph_targets.size() > morph_target_binding.index)
+						{
+							MeshComponent::MorphTarget& morph_target = mesh->morph_targets[morph_target_binding.index];
+							morph_target.weight = wi::math::Lerp(morph_target.weight, morph_target_binding.weight, blend);
+						}
+					}
+				}
+			}
+		});
+		wi::jobsystem::Wait(expression_ctx);
+	}
+	void Scene::RunProceduralAnimationUpdateSystem(wi::jobsystem::context& ctx)
 	{
 		auto range = wi::profiler::BeginRangeCPU("Procedural Animations");
 
@@ -3412,11 +3925,69 @@ namespace wi::scene
 
 		std::atomic_bool recompute_hierarchy{ false };
 
-		wi::jobsystem::Dispatch(ctx,(uint32_t)inverse_kinematics.GetCount(),1,[this, &recompute_hierarchy](wi::jobsystem::JobArgs args){
-			const InverseKinematicsComponent& ik = inverse_kinematics[args.jobIndex];
+		// IK chains that share any transform (for example chains from both hands up to the spine) are solved in the same batch in the serial order,
+		//	the batches are solved in parallel:
+		SharedResourceBatches ik_batches;
+		ik_batches.Init((uint32_t)inverse_kinematics.GetCount(), transforms.GetCount());
+		for (size_t i = 0; i < inverse_kinematics.GetCount(); ++i)
+		{
+			const InverseKinematicsComponent& ik = inverse_kinematics[i];
+			if (ik.IsDisabled())
+				continue;
+			Entity entity = inverse_kinematics.GetEntity(i);
+			ik_batches.Touch((uint32_t)i, transforms.GetIndex(entity));
+			if (!ik.use_target_position)
+			{
+				ik_batches.Touch((uint32_t)i, transforms.GetIndex(ik.target));
+			}
+			// the chain links (the solver handles at most 32), and the parent of the last link that is read:
+			const HierarchyComponent* hier = hierarchy.GetComponent(entity);
+			Entity parent_entity = hier == nullptr ? INVALID_ENTITY : hier->parentID;
+			for (uint32_t chain = 0; chain <= std::min(ik.chain_length, 32u) && parent_entity != INVALID_ENTITY; ++chain)
+			{
+				ik_batches.Touch((uint32_t)i, transforms.GetIndex(parent_entity));
+				hier = hierarchy.GetComponent(parent_entity);
+				parent_entity = hier == nullptr ? INVALID_ENTITY : hier->parentID;
+			}
+		}
+		ik_batches.Build(!character_systems_batching_enabled);
+
+		// Humanoid leg bones constrain the IK chain links, this lookup gives the same result as searching the humanoids in order for every link:
+		//	the first humanoid that has the bone as a leg bone is used, and within that humanoid the last matching leg bone type
+		struct LegConstraint
+		{
+			size_t humanoid_index = 0;
+			HumanoidComponent::HumanoidBone type = HumanoidComponent::HumanoidBone::Count;
+		};
+		wi::unordered_map<Entity, LegConstraint> leg_constraints;
+		if (inverse_kinematics.GetCount() > 0)
+		{
+			const HumanoidComponent::HumanoidBone leg_bones[] = {
+				HumanoidComponent::HumanoidBone::LeftUpperLeg,
+				HumanoidComponent::HumanoidBone::LeftLowerLeg,
+				HumanoidComponent::HumanoidBone::RightUpperLeg,
+				HumanoidComponent::HumanoidBone::RightLowerLeg,
+			};
+			for (size_t humanoid_idx = humanoids.GetCount(); humanoid_idx > 0; --humanoid_idx)
+			{
+				const HumanoidComponent& humanoid = humanoids[humanoid_idx - 1];
+				for (HumanoidComponent::HumanoidBone type : leg_bones)
+				{
+					const Entity bone = humanoid.bones[size_t(type)];
+					if (bone == INVALID_ENTITY)
+						continue;
+					LegConstraint& constraint = leg_constraints[bone]; // humanoids are visited backwards and bone types forwards, so the wanted ones are written last
+					constraint.humanoid_index = humanoid_idx - 1;
+					constraint.type = type;
+				}
+			}
+		}
+
+		auto solve_ik = [&](uint32_t ik_index) {
+			const InverseKinematicsComponent& ik = inverse_kinematics[ik_index];
 			if (ik.IsDisabled())
 				return;
-			Entity entity = inverse_kinematics.GetEntity(args.jobIndex);
+			Entity entity = inverse_kinematics.GetEntity(ik_index);
 			size_t transform_index = transforms.GetIndex(entity);
 			const HierarchyComponent* hier = hierarchy.GetComponent(entity);
 			if (transform_index == INVALID_INDEX || hier == nullptr)
@@ -3471,36 +4042,28 @@ namespace wi::scene
 					// Check if this transform is part of a humanoid and need some constraining:
 					if (iteration == 0)
 					{
-						for (size_t humanoid_idx = 0; (humanoid_idx < humanoids.GetCount()) && !link.constrain; ++humanoid_idx)
+						auto it = leg_constraints.find(parent_entity);
+						if (it != leg_constraints.end())
 						{
-							const HumanoidComponent& humanoid = humanoids[humanoid_idx];
-							int bone_type_idx = 0;
-							for (auto& bone : humanoid.bones)
+							switch (it->second.type)
 							{
-								if (bone == parent_entity)
-								{
-									switch ((HumanoidComponent::HumanoidBone)bone_type_idx)
-									{
-									default:
-										break;
-									case HumanoidComponent::HumanoidBone::LeftUpperLeg:
-									case HumanoidComponent::HumanoidBone::RightUpperLeg:
-										link.constrain = true;
-										link.constraint_min = XMFLOAT3(XM_PI * 0.6f, XM_PI * 0.1f, XM_PI * 0.1f);
-										link.constraint_max = XMFLOAT3(XM_PI * 0.1f, XM_PI * 0.1f, XM_PI * 0.1f);
-										break;
-									case HumanoidComponent::HumanoidBone::LeftLowerLeg:
-									case HumanoidComponent::HumanoidBone::RightLowerLeg:
-										link.constrain = true;
-										link.constraint_min = XMFLOAT3(0, 0, 0);
-										link.constraint_max = XMFLOAT3(XM_PI * 0.8f, 0, 0);
-										break;
-									}
-								}
-								bone_type_idx++;
+							default:
+								break;
+							case HumanoidComponent::HumanoidBone::LeftUpperLeg:
+							case HumanoidComponent::HumanoidBone::RightUpperLeg:
+								link.constrain = true;
+								link.constraint_min = XMFLOAT3(XM_PI * 0.6f, XM_PI * 0.1f, XM_PI * 0.1f);
+								link.constraint_max = XMFLOAT3(XM_PI * 0.1f, XM_PI * 0.1f, XM_PI * 0.1f);
+								break;
+							case HumanoidComponent::HumanoidBone::LeftLowerLeg:
+							case HumanoidComponent::HumanoidBone::RightLowerLeg:
+								link.constrain = true;
+								link.constraint_min = XMFLOAT3(0, 0, 0);
+								link.constraint_max = XMFLOAT3(XM_PI * 0.8f, 0, 0);
+								break;
 							}
 
-							if (link.constrain && humanoid.knee_bending < 0)
+							if (link.constrain && humanoids[it->second.humanoid_index].knee_bending < 0)
 							{
 								std::swap(link.constraint_min, link.constraint_max);
 							}
@@ -3588,6 +4151,12 @@ namespace wi::scene
 
 				}
 			}
+		};
+		wi::jobsystem::Dispatch(ctx, ik_batches.GetBatchCount(), 1, [&](wi::jobsystem::JobArgs args) {
+			for (uint32_t item = ik_batches.offsets[args.jobIndex]; item < ik_batches.offsets[args.jobIndex + 1]; ++item)
+			{
+				solve_ik(ik_batches.items[item]);
+			}
 		});
 
 		wi::jobsystem::Wait(ctx); // sync needed when there is IK on character arm/leg, and also arm/leg spacing!
@@ -3759,8 +4328,19 @@ namespace wi::scene
 				if (child_index == INVALID_INDEX)
 					return;
 
+				// Only the transforms that were modified procedurally, or have modified ancestors need to be written:
+				auto is_modified = [this](size_t index) {
+					const TransformComponent& modified = transforms_temp[index];
+					const TransformComponent& original = transforms[index];
+					return
+						std::memcmp(&modified.scale_local, &original.scale_local, sizeof(XMFLOAT3)) != 0 ||
+						std::memcmp(&modified.rotation_local, &original.rotation_local, sizeof(XMFLOAT4)) != 0 ||
+						std::memcmp(&modified.translation_local, &original.translation_local, sizeof(XMFLOAT3)) != 0;
+				};
+
 				TransformComponent& transform_child = transforms_temp[child_index];
 				XMMATRIX worldmatrix = transform_child.GetLocalMatrix();
+				bool modified = is_modified(child_index);
 
 				Entity parentID = hier.parentID;
 				while (parentID != INVALID_ENTITY)
@@ -3770,6 +4350,7 @@ namespace wi::scene
 						break;
 					TransformComponent& transform_parent = transforms_temp[parent_index];
 					worldmatrix *= transform_parent.GetLocalMatrix();
+					modified |= is_modified(parent_index);
 
 					const HierarchyComponent* hier_recursive = hierarchy.GetComponent(parentID);
 					if (hier_recursive != nullptr)
@@ -3782,8 +4363,12 @@ namespace wi::scene
 					}
 				}
 
+				if (!modified)
+					return;
+
 				// Now the real (not temp) transform world matrix is updated:
 				XMStoreFloat4x4(&transforms[child_index].world, worldmatrix);
+				transforms[child_index].SetDirty(); // the world matrix doesn't match the local space, so it will be restored next frame
 
 				});
 
@@ -4442,6 +5027,51 @@ namespace wi::scene
 			std::memcpy(instanceArrayMapped + impostorInstanceOffset, &inst, sizeof(inst));
 		}
 	}
+	void Scene::UpdateObjectBVH()
+	{
+		auto range = wi::profiler::BeginRangeCPU("Object BVH");
+		const uint32_t object_count = (uint32_t)std::min(objects.GetCount(), aabb_objects.size());
+
+		// Take the result of the background build when it's finished, this never waits for it:
+		if (object_bvh_next_generation != ~0ull && !wi::jobsystem::IsBusy(object_bvh_workload))
+		{
+			std::swap(object_bvh, object_bvh_next);
+			object_bvh_generation = object_bvh_next_generation;
+			object_bvh_next_generation = ~0ull;
+			object_bvh_refit_count = 0;
+			object_bvh_refit_needed.store(true); // it was built from a copy of older bounds
+		}
+
+		object_bvh_valid =
+			object_count > 0 &&
+			object_bvh.IsValid() &&
+			object_bvh_generation == objects.GetGeneration() &&
+			object_bvh.leaf_indices.size() == object_count
+			;
+
+		// Refit to the current bounds:
+		if (object_bvh_valid && object_bvh_refit_needed.load())
+		{
+			object_bvh.Update(aabb_objects.data(), object_count);
+			object_bvh_refit_count++;
+		}
+		object_bvh_refit_needed.store(false);
+
+		// Rebuild when the object indices changed, or periodically when refits accumulated:
+		static constexpr uint32_t refits_before_rebuild = 60;
+		const bool rebuild_needed = object_count > 0 && (object_bvh_generation != objects.GetGeneration() || object_bvh_refit_count >= refits_before_rebuild);
+		if (rebuild_needed && object_bvh_next_generation == ~0ull && !wi::jobsystem::IsBusy(object_bvh_workload))
+		{
+			object_bvh_next_aabbs.assign(aabb_objects.begin(), aabb_objects.begin() + object_count);
+			object_bvh_next_generation = objects.GetGeneration();
+			object_bvh_workload.priority = wi::jobsystem::Priority::Low;
+			wi::jobsystem::Execute(object_bvh_workload, [this](wi::jobsystem::JobArgs args) {
+				object_bvh_next.Build(object_bvh_next_aabbs.data(), (uint32_t)object_bvh_next_aabbs.size(), wi::BVH::BUILD_MODE::SAH);
+			});
+		}
+
+		wi::profiler::EndRange(range);
+	}
 	void Scene::RunObjectUpdateSystem(wi::jobsystem::context& ctx)
 	{
 		aabb_objects.resize(objects.GetCount());
@@ -4449,7 +5079,19 @@ namespace wi::scene
 		matrix_objects_prev.resize(objects.GetCount());
 		occlusion_results_objects.resize(objects.GetCount());
 
-		meshletAllocator.store(0u);
+		// The cached object bounds are only valid if object indices didn't change since the last update:
+		const bool object_bounds_cache_valid = object_bounds_cache_generation == objects.GetGeneration() && object_bounds_cache.size() == objects.GetCount();
+		object_bounds_cache.resize(objects.GetCount());
+		object_bounds_cache_generation = objects.GetGeneration();
+
+		if (object_streams_enabled)
+		{
+			object_streams.Sync(objects); // every object is written below, so the previous contents don't matter
+		}
+		else
+		{
+			object_streams.Clear();
+		}
 
 		parallel_bounds.clear();
 		parallel_bounds.resize((size_t)wi::jobsystem::DispatchGroupCount((uint32_t)objects.GetCount(), small_subtask_groupsize));
@@ -4501,7 +5143,8 @@ namespace wi::scene
 			object.fadeDistance = object.draw_distance;
 			object.mesh_blend_required = false;
 
-			if (object.meshID != INVALID_ENTITY && meshes.Contains(object.meshID) && transforms.Contains(entity))
+			const size_t transform_index = transforms.GetIndex(entity);
+			if (object.meshID != INVALID_ENTITY && meshes.Contains(object.meshID) && transform_index != INVALID_INDEX)
 			{
 				// These will only be valid for a single frame:
 				object.mesh_index = (uint32_t)meshes.GetIndex(object.meshID);
@@ -4522,14 +5165,33 @@ namespace wi::scene
 					object.wetmap = {};
 				}
 
-				const TransformComponent& transform = *transforms.GetComponent(entity);
+				const TransformComponent& transform = transforms[transform_index];
 
 				XMMATRIX W = XMLoadFloat4x4(&transform.world);
-				aabb = mesh.aabb.transform(W);
+				ObjectBoundsCache& bounds_cache = object_bounds_cache[args.jobIndex];
+				if (
+					!object_bounds_cache_valid ||
+					IsTransformChanged(transform_index) ||
+					std::memcmp(&bounds_cache.mesh_aabb._min, &mesh.aabb._min, sizeof(XMFLOAT3)) != 0 ||
+					std::memcmp(&bounds_cache.mesh_aabb._max, &mesh.aabb._max, sizeof(XMFLOAT3)) != 0
+					)
+				{
+					bounds_cache.mesh_aabb = mesh.aabb;
+					bounds_cache.aabb = mesh.aabb.transform(W);
+					if (!object_bvh_refit_needed.load(std::memory_order_relaxed))
+					{
+						object_bvh_refit_needed.store(true, std::memory_order_relaxed);
+					}
+				}
+				aabb = bounds_cache.aabb;
 
 				if (mesh.IsSkinned() || mesh.IsDynamic())
 				{
 					object.SetDynamic(true);
+					if (!object_bvh_refit_needed.load(std::memory_order_relaxed))
+					{
+						object_bvh_refit_needed.store(true, std::memory_order_relaxed);
+					}
 					const ArmatureComponent* armature = armatures.GetComponent(mesh.armatureID);
 					if (armature != nullptr)
 					{
@@ -4819,15 +5481,24 @@ namespace wi::scene
 				}
 			}
 
+			if (object_streams_enabled)
+			{
+				object_streams.Get<OBJECT_STREAM_MIN_X>()[args.jobIndex] = aabb._min.x;
+				object_streams.Get<OBJECT_STREAM_MIN_Y>()[args.jobIndex] = aabb._min.y;
+				object_streams.Get<OBJECT_STREAM_MIN_Z>()[args.jobIndex] = aabb._min.z;
+				object_streams.Get<OBJECT_STREAM_MAX_X>()[args.jobIndex] = aabb._max.x;
+				object_streams.Get<OBJECT_STREAM_MAX_Y>()[args.jobIndex] = aabb._max.y;
+				object_streams.Get<OBJECT_STREAM_MAX_Z>()[args.jobIndex] = aabb._max.z;
+				object_streams.Get<OBJECT_STREAM_LAYERMASK>()[args.jobIndex] = aabb.layerMask;
+			}
+
 		});
 	}
 	void Scene::RunCameraUpdateSystem(wi::jobsystem::context& ctx)
 	{
-		wi::jobsystem::Dispatch(ctx, (uint32_t)cameras.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
+		camera_query.Update();
+		camera_query.Dispatch(ctx, small_subtask_groupsize, [](wi::jobsystem::JobArgs args, Entity entity, CameraComponent& camera, TransformComponent* transform) {
 
-			CameraComponent& camera = cameras[args.jobIndex];
-			Entity entity = cameras.GetEntity(args.jobIndex);
-			const TransformComponent* transform = transforms.GetComponent(entity);
 			if (transform != nullptr)
 			{
 				camera.TransformCamera(*transform);
@@ -4839,13 +5510,13 @@ namespace wi::scene
 	{
 		aabb_decals.resize(decals.GetCount());
 
-		for (size_t i = 0; i < decals.GetCount(); ++i)
+		decal_query.Update();
+		for (size_t row = 0; row < decal_query.GetCount(); ++row)
 		{
-			DecalComponent& decal = decals[i];
-			Entity entity = decals.GetEntity(i);
-			if (!transforms.Contains(entity))
-				continue;
-			const TransformComponent& transform = *transforms.GetComponent(entity);
+			DecalComponent& decal = decal_query.Get<0>(row);
+			const TransformComponent& transform = decal_query.Get<1>(row);
+			const MaterialComponent& material = decal_query.Get<2>(row);
+			const LayerComponent* layer = decal_query.Get<3>(row);
 			decal.world = transform.world;
 
 			XMMATRIX W = XMLoadFloat4x4(&decal.world);
@@ -4861,11 +5532,10 @@ namespace wi::scene
 			XMStoreFloat3(&scale, S);
 			decal.range = std::max(scale.x, std::max(scale.y, scale.z)) * 2;
 
-			AABB& aabb = aabb_decals[i];
+			AABB& aabb = aabb_decals[decal_query.GetIndex<0>(row)];
 			aabb.createFromHalfWidth(XMFLOAT3(0, 0, 0), XMFLOAT3(1, 1, 1));
 			aabb = aabb.transform(transform.world);
 
-			const LayerComponent* layer = layers.GetComponent(entity);
 			if (layer == nullptr)
 			{
 				aabb.layerMask = ~0;
@@ -4875,7 +5545,6 @@ namespace wi::scene
 				aabb.layerMask = layer->GetLayerMask();
 			}
 
-			const MaterialComponent& material = *materials.GetComponent(entity);
 			decal.color = material.baseColor;
 			decal.emissive = material.GetEmissiveStrength();
 			decal.texture = material.textures[MaterialComponent::BASECOLORMAP].resource;
@@ -4894,13 +5563,12 @@ namespace wi::scene
 		if (dt == 0)
 			return;
 
-		for (size_t probeIndex = 0; probeIndex < probes.GetCount(); ++probeIndex)
+		probe_query.Update();
+		for (size_t row = 0; row < probe_query.GetCount(); ++row)
 		{
-			EnvironmentProbeComponent& probe = probes[probeIndex];
-			Entity entity = probes.GetEntity(probeIndex);
-			if (!transforms.Contains(entity))
-				continue;
-			const TransformComponent& transform = *transforms.GetComponent(entity);
+			EnvironmentProbeComponent& probe = probe_query.Get<0>(row);
+			const TransformComponent& transform = probe_query.Get<1>(row);
+			const LayerComponent* layer = probe_query.Get<2>(row);
 
 			probe.position = transform.GetPosition();
 
@@ -4913,11 +5581,10 @@ namespace wi::scene
 			XMStoreFloat3(&scale, S);
 			probe.range = std::max(scale.x, std::max(scale.y, scale.z)) * 2;
 
-			AABB& aabb = aabb_probes[probeIndex];
+			AABB& aabb = aabb_probes[probe_query.GetIndex<0>(row)];
 			aabb.createFromHalfWidth(XMFLOAT3(0, 0, 0), XMFLOAT3(1, 1, 1));
 			aabb = aabb.transform(transform.world);
 
-			const LayerComponent* layer = layers.GetComponent(entity);
 			if (layer == nullptr)
 			{
 				aabb.layerMask = ~0;
@@ -4945,13 +5612,8 @@ namespace wi::scene
 	}
 	void Scene::RunForceUpdateSystem(wi::jobsystem::context& ctx)
 	{
-		wi::jobsystem::Dispatch(ctx, (uint32_t)forces.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
-
-			ForceFieldComponent& force = forces[args.jobIndex];
-			Entity entity = forces.GetEntity(args.jobIndex);
-			if (!transforms.Contains(entity))
-				return;
-			const TransformComponent& transform = *transforms.GetComponent(entity);
+		force_query.Update();
+		force_query.Dispatch(ctx, small_subtask_groupsize, [](wi::jobsystem::JobArgs args, Entity entity, ForceFieldComponent& force, TransformComponent& transform) {
 
 			XMMATRIX W = XMLoadFloat4x4(&transform.world);
 			XMVECTOR S, R, T;
@@ -4966,18 +5628,14 @@ namespace wi::scene
 	{
 		aabb_lights.resize(lights.GetCount());
 
-		wi::jobsystem::Dispatch(ctx, (uint32_t)lights.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
+		light_query.Update();
+		light_query.Dispatch(ctx, small_subtask_groupsize, [this](wi::jobsystem::JobArgs args, Entity entity, LightComponent& light, TransformComponent& transform, LayerComponent* layer, MaterialComponent* material, VideoComponent* video) {
 
-			LightComponent& light = lights[args.jobIndex];
-			Entity entity = lights.GetEntity(args.jobIndex);
-			if (!transforms.Contains(entity))
-				return;
-			const TransformComponent& transform = *transforms.GetComponent(entity);
-			AABB& aabb = aabb_lights[args.jobIndex];
+			const size_t lightIndex = light_query.GetIndex<0>(args.jobIndex);
+			AABB& aabb = aabb_lights[lightIndex];
 
 			light.occlusionquery = -1;
 
-			const LayerComponent* layer = layers.GetComponent(entity);
 			if (layer == nullptr)
 			{
 				aabb.layerMask = ~0;
@@ -5003,9 +5661,9 @@ namespace wi::scene
 				XMStoreFloat3(&light.direction, XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(0, 1, 0, 0), W)));
 				aabb.createFromHalfWidth(XMFLOAT3(0, 0, 0), XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX));
 				locker.lock();
-				if (args.jobIndex < weather.most_important_light_index)
+				if (lightIndex < weather.most_important_light_index)
 				{
-					weather.most_important_light_index = args.jobIndex;
+					weather.most_important_light_index = (uint32_t)lightIndex;
 					weather.sunColor = light.color;
 					weather.sunColor.x *= light.intensity;
 					weather.sunColor.y *= light.intensity;
@@ -5036,7 +5694,6 @@ namespace wi::scene
 			if (light.type == LightComponent::SPOT || light.type == LightComponent::POINT || light.type == LightComponent::RECTANGLE)
 			{
 				// Material can be used as mask texture for spot, rectangle and point lights:
-				const MaterialComponent* material = materials.GetComponent(entity);
 				if (material != nullptr && material->textures[MaterialComponent::BASECOLORMAP].resource.IsValid())
 				{
 					const Texture& tex = material->textures[MaterialComponent::BASECOLORMAP].resource.GetTexture();
@@ -5054,7 +5711,6 @@ namespace wi::scene
 			if (light.type == LightComponent::SPOT || light.type == LightComponent::RECTANGLE)
 			{
 				// Video attachment will overwrite texture mask for spotlight and rectangle light:
-				const VideoComponent* video = videos.GetComponent(entity);
 				if (video != nullptr)
 				{
 					Texture videoTexture = video->videoinstance.GetCurrentFrameTexture();
@@ -6466,70 +7122,330 @@ namespace wi::scene
 		wi::jobsystem::Wait(ctx);
 	}
 
-	Scene::RayIntersectionResult Scene::Intersects(const Ray& ray, uint32_t filterMask, uint32_t layerMask, uint32_t lod) const
+	const Scene::SkinnedPositionCache* Scene::GetSkinnedPositionCache(Entity meshID, const MeshComponent& mesh, const SoftBodyPhysicsComponent* softbody, const ArmatureComponent* armature) const
 	{
-		RayIntersectionResult result;
+		if (!skinned_position_cache_enabled)
+			return nullptr;
 
-		const XMVECTOR rayOrigin = XMLoadFloat3(&ray.origin);
-		const XMVECTOR rayDirection = XMVector3Normalize(XMLoadFloat3(&ray.direction));
+		// The bones are selected the same way as in the queries, soft body first:
+		const wi::vector<ShaderTransform>* boneData = nullptr;
+		if (softbody != nullptr && !softbody->boneData.empty())
+		{
+			boneData = &softbody->boneData;
+		}
+		else if (armature != nullptr && !armature->boneData.empty())
+		{
+			boneData = &armature->boneData;
+		}
+		if (boneData == nullptr || mesh.vertex_positions.empty())
+			return nullptr;
 
-		if ((filterMask & FILTER_COLLIDER) && collider_bvh.IsValid())
+		skinned_position_cache_locker.lock();
+		std::unique_ptr<SkinnedPositionCache>& entry = skinned_position_cache[meshID];
+		if (entry == nullptr)
 		{
-			collider_bvh.Intersects(ray, 0, [&](uint32_t collider_index) {
-				if (colliders.GetCount() <= collider_index)
-					return;
-				const ColliderComponent& collider = colliders_cpu[collider_index];
+			entry = std::make_unique<SkinnedPositionCache>();
+		}
+		SkinnedPositionCache* cache = entry.get();
+		skinned_position_cache_locker.unlock();
 
-				if ((collider.layerMask & layerMask) == 0)
-					return;
+		const uint64_t frame = skinned_position_cache_frame;
+		if (cache->frame.load(std::memory_order_acquire) == frame)
+			return cache;
 
-				float dist = 0;
-				XMFLOAT3 direction = {};
-				bool intersects = false;
+		// Only one thread fills the cache, the others don't wait for it, because they could be running inside the job system Wait() below:
+		bool expected = false;
+		if (!cache->busy.compare_exchange_strong(expected, true, std::memory_order_acquire))
+			return nullptr;
 
-				switch (collider.shape)
+		if (cache->frame.load(std::memory_order_relaxed) != frame)
+		{
+			// Bone matrices are converted once instead of for every vertex influence:
+			cache->bone_matrices.resize(boneData->size());
+			for (size_t i = 0; i < boneData->size(); ++i)
+			{
+				const XMFLOAT4X4 mat = (*boneData)[i].GetMatrix();
+				cache->bone_matrices[i] = XMMatrixTranspose(XMLoadFloat4x4(&mat));
+			}
+
+			// Same computation as SkinVertex(), so the results match the uncached queries:
+			const uint32_t vertex_count = (uint32_t)mesh.vertex_positions.size();
+			const uint32_t influence_div4 = mesh.GetBoneInfluenceDiv4();
+			cache->positions.resize(vertex_count);
+			wi::jobsystem::context ctx;
+			wi::jobsystem::Dispatch(ctx, vertex_count, 256, [&](wi::jobsystem::JobArgs args) {
+				const uint32_t index = args.jobIndex;
+				const XMVECTOR P = XMLoadFloat3(&mesh.vertex_positions[index]);
+				XMVECTOR skinnedP = XMVectorZero();
+				for (uint32_t influence = 0; influence < influence_div4; ++influence)
 				{
-				default:
-				case ColliderComponent::Shape::Sphere:
-					intersects = ray.intersects(collider.sphere, dist, direction);
-					break;
-				case ColliderComponent::Shape::Capsule:
-					intersects = ray.intersects(collider.capsule, dist, direction);
-					break;
-				case ColliderComponent::Shape::Plane:
-					intersects = ray.intersects(collider.plane, dist, direction);
-					break;
+					const XMUINT4& ind = influence == 0 ? mesh.vertex_boneindices[index] : mesh.vertex_boneindices2[index];
+					const XMFLOAT4& wei = influence == 0 ? mesh.vertex_boneweights[index] : mesh.vertex_boneweights2[index];
+					skinnedP += XMVector3Transform(P, cache->bone_matrices[ind.x]) * wei.x;
+					skinnedP += XMVector3Transform(P, cache->bone_matrices[ind.y]) * wei.y;
+					skinnedP += XMVector3Transform(P, cache->bone_matrices[ind.z]) * wei.z;
+					skinnedP += XMVector3Transform(P, cache->bone_matrices[ind.w]) * wei.w;
 				}
+				XMStoreFloat3(&cache->positions[index], skinnedP);
+			});
+			wi::jobsystem::Wait(ctx);
 
-				if (intersects)
+			// The mesh BVH is built from the bind pose, its copy is refitted to the skinned triangles:
+			if (mesh.bvh.IsValid())
+			{
+				const uint32_t leaf_count = (uint32_t)mesh.bvh_leaf_aabbs.size();
+				cache->bvh_leaf_aabbs.resize(leaf_count);
+				wi::jobsystem::Dispatch(ctx, leaf_count, 256, [&](wi::jobsystem::JobArgs args) {
+					const AABB& leaf = mesh.bvh_leaf_aabbs[args.jobIndex];
+					const uint32_t indexOffset = mesh.subsets[leaf.userdata].indexOffset + leaf.layerMask * 3;
+					const XMFLOAT3& p0 = cache->positions[mesh.indices[indexOffset + 0]];
+					const XMFLOAT3& p1 = cache->positions[mesh.indices[indexOffset + 1]];
+					const XMFLOAT3& p2 = cache->positions[mesh.indices[indexOffset + 2]];
+					AABB aabb = AABB(wi::math::Min(p0, wi::math::Min(p1, p2)), wi::math::Max(p0, wi::math::Max(p1, p2)));
+					aabb.layerMask = leaf.layerMask;
+					aabb.userdata = leaf.userdata;
+					cache->bvh_leaf_aabbs[args.jobIndex] = aabb;
+				});
+				wi::jobsystem::Wait(ctx);
+				cache->bvh = mesh.bvh;
+				cache->bvh.Update(cache->bvh_leaf_aabbs.data(), leaf_count);
+			}
+			else
+			{
+				cache->bvh_leaf_aabbs.clear();
+				cache->bvh = {};
+			}
+
+			cache->frame.store(frame, std::memory_order_release);
+		}
+
+		cache->busy.store(false, std::memory_order_release);
+		return cache;
+	}
+	// Skinned vertex position from the skinned position cache if it's available, otherwise it is computed with SkinVertex()
+	static inline XMVECTOR LoadSkinnedVertex(const Scene::SkinnedPositionCache* cache, const MeshComponent& mesh, const wi::vector<ShaderTransform>& boneData, uint32_t index)
+	{
+		if (cache != nullptr)
+			return XMLoadFloat3(&cache->positions[index]);
+		return SkinVertex(mesh, boneData, index);
+	}
+
+	// Objects that a scene query needs to test, in ascending object index order:
+	//	When the object BVH is valid, only the objects whose bounds can be touched by the query are returned, otherwise every object is a candidate
+	//	The caller still does the exact bounds test of every candidate, so the results are the same as testing all objects in order
+	//	The index buffers are reused on every thread, a thread can start a nested query while it waits for jobs inside a query, so every nesting level has its own buffer
+	static thread_local wi::vector<std::unique_ptr<wi::vector<uint32_t>>> object_candidate_buffers;
+	static thread_local size_t object_candidate_depth = 0;
+	struct ObjectCandidates
+	{
+		wi::vector<uint32_t>& indices;
+		uint32_t count = 0;
+		bool all = false;
+
+		ObjectCandidates() : indices(AcquireBuffer()) {}
+		~ObjectCandidates() { object_candidate_depth--; }
+		ObjectCandidates(const ObjectCandidates&) = delete;
+
+		static wi::vector<uint32_t>& AcquireBuffer()
+		{
+			if (object_candidate_depth == object_candidate_buffers.size())
+			{
+				object_candidate_buffers.push_back(std::make_unique<wi::vector<uint32_t>>());
+			}
+			return *object_candidate_buffers[object_candidate_depth++];
+		}
+
+		uint32_t operator[](uint32_t i) const { return all ? i : indices[i]; }
+	};
+	template<typename T>
+	static void CollectObjectCandidates(const Scene& scene, const T& primitive, ObjectCandidates& candidates)
+	{
+		const uint32_t object_count = (uint32_t)std::min(scene.objects.GetCount(), scene.aabb_objects.size());
+		candidates.indices.clear();
+		candidates.all = !scene.IsObjectBVHValid();
+		if (candidates.all)
+		{
+			candidates.count = object_count;
+			return;
+		}
+		scene.object_bvh.Intersects(primitive, 0, [&](uint32_t objectIndex) {
+			if (objectIndex < object_count)
+			{
+				candidates.indices.push_back(objectIndex);
+			}
+		});
+		std::sort(candidates.indices.begin(), candidates.indices.end());
+		candidates.count = (uint32_t)candidates.indices.size();
+	}
+	// Ray packet version: the BVH is traversed once for the packet, a node is opened if any of the rays hit it
+	static void CollectObjectCandidates(const Scene& scene, const Ray* rays, const uint32_t* ray_indices, uint32_t packet_count, ObjectCandidates& candidates)
+	{
+		if (packet_count == 1 || !scene.IsObjectBVHValid())
+		{
+			CollectObjectCandidates(scene, rays[ray_indices[0]], candidates);
+			return;
+		}
+		const uint32_t object_count = (uint32_t)std::min(scene.objects.GetCount(), scene.aabb_objects.size());
+		const wi::BVH& bvh = scene.object_bvh;
+		candidates.indices.clear();
+		candidates.all = false;
+		uint32_t stack[128];
+		uint32_t stack_count = 0;
+		stack[stack_count++] = 0;
+		while (stack_count > 0)
+		{
+			const wi::BVH::Node& node = bvh.nodes[stack[--stack_count]];
+			bool hit = false;
+			for (uint32_t i = 0; i < packet_count && !hit; ++i)
+			{
+				hit = node.aabb.intersects(rays[ray_indices[i]]);
+			}
+			if (!hit)
+				continue;
+			if (node.isLeaf())
+			{
+				for (uint32_t i = 0; i < node.count; ++i)
 				{
-					if (dist < result.distance)
+					const uint32_t objectIndex = bvh.leaf_indices[node.offset + i];
+					if (objectIndex < object_count)
 					{
-						result.distance = dist;
-						result.bary = {};
-						result.entity = colliders.GetEntity(collider_index);
-						result.normal = direction;
-						result.uv = {};
-						result.velocity = {};
-						XMStoreFloat3(&result.position, rayOrigin + rayDirection * dist);
-						result.subsetIndex = -1;
-						result.vertexID0 = 0;
-						result.vertexID1 = 0;
-						result.vertexID2 = 0;
+						candidates.indices.push_back(objectIndex);
 					}
 				}
-			});
+			}
+			else if (stack_count + 2 <= arraysize(stack))
+			{
+				stack[stack_count++] = node.left;
+				stack[stack_count++] = node.left + 1;
+			}
+			else
+			{
+				// The tree is too deep for the stack (it shouldn't happen with the SAH build), fall back to testing every object:
+				candidates.indices.clear();
+				candidates.all = true;
+				candidates.count = object_count;
+				return;
+			}
+		}
+		std::sort(candidates.indices.begin(), candidates.indices.end());
+		candidates.count = (uint32_t)candidates.indices.size();
+	}
+
+	// Rays are processed in small packets: each object's bounds are tested against every ray of the packet,
+	//	and the object matrix inverse and mesh lookups are shared by all rays that hit it.
+	//	Every ray still visits the colliders, objects and ragdolls in the same order and with the same math as a single ray,
+	//	so the results don't depend on how the rays were packed.
+	static constexpr uint32_t ray_packet_size = 64;
+	static void IntersectsRayPacket(
+		const Scene& scene,
+		const Ray* rays,
+		Scene::RayIntersectionResult* results,
+		const uint32_t* ray_indices,
+		uint32_t packet_count,
+		uint32_t filterMask,
+		uint32_t layerMask,
+		uint32_t lod
+	)
+	{
+		const wi::BVH& collider_bvh = scene.collider_bvh;
+		const auto& colliders = scene.colliders;
+		const auto& colliders_cpu = scene.colliders_cpu;
+		const auto& objects = scene.objects;
+		const auto& meshes = scene.meshes;
+		const auto& softbodies = scene.softbodies;
+		const auto& armatures = scene.armatures;
+		const auto& humanoids = scene.humanoids;
+		const auto& layers = scene.layers;
+		const auto& aabb_objects = scene.aabb_objects;
+		const auto& matrix_objects = scene.matrix_objects;
+		const auto& matrix_objects_prev = scene.matrix_objects_prev;
+
+		XMVECTOR rayOrigins[ray_packet_size];
+		XMVECTOR rayDirections[ray_packet_size];
+		for (uint32_t i = 0; i < packet_count; ++i)
+		{
+			const Ray& ray = rays[ray_indices[i]];
+			rayOrigins[i] = XMLoadFloat3(&ray.origin);
+			rayDirections[i] = XMVector3Normalize(XMLoadFloat3(&ray.direction));
+			results[ray_indices[i]] = {};
+		}
+
+		if ((filterMask & FILTER_COLLIDER) && collider_bvh.IsValid())
+		{
+			for (uint32_t i = 0; i < packet_count; ++i)
+			{
+				const Ray& ray = rays[ray_indices[i]];
+				Scene::RayIntersectionResult& result = results[ray_indices[i]];
+				const XMVECTOR rayOrigin = rayOrigins[i];
+				const XMVECTOR rayDirection = rayDirections[i];
+				collider_bvh.Intersects(ray, 0, [&](uint32_t collider_index) {
+					if (colliders.GetCount() <= collider_index)
+						return;
+					const ColliderComponent& collider = colliders_cpu[collider_index];
+
+					if ((collider.layerMask & layerMask) == 0)
+						return;
+
+					float dist = 0;
+					XMFLOAT3 direction = {};
+					bool intersects = false;
+
+					switch (collider.shape)
+					{
+					default:
+					case ColliderComponent::Shape::Sphere:
+						intersects = ray.intersects(collider.sphere, dist, direction);
+						break;
+					case ColliderComponent::Shape::Capsule:
+						intersects = ray.intersects(collider.capsule, dist, direction);
+						break;
+					case ColliderComponent::Shape::Plane:
+						intersects = ray.intersects(collider.plane, dist, direction);
+						break;
+					}
+
+					if (intersects)
+					{
+						if (dist < result.distance)
+						{
+							result.distance = dist;
+							result.bary = {};
+							result.entity = colliders.GetEntity(collider_index);
+							result.normal = direction;
+							result.uv = {};
+							result.velocity = {};
+							XMStoreFloat3(&result.position, rayOrigin + rayDirection * dist);
+							result.subsetIndex = -1;
+							result.vertexID0 = 0;
+							result.vertexID1 = 0;
+							result.vertexID2 = 0;
+						}
+					}
+				});
+			}
 		}
 
 		if (filterMask & FILTER_OBJECT_ALL)
 		{
-			const size_t objectCount = std::min(objects.GetCount(), aabb_objects.size());
-			for (size_t objectIndex = 0; objectIndex < objectCount; ++objectIndex)
+			ObjectCandidates candidates;
+			CollectObjectCandidates(scene, rays, ray_indices, packet_count, candidates);
+			for (uint32_t candidate = 0; candidate < candidates.count; ++candidate)
 			{
+				const uint32_t objectIndex = candidates[candidate];
 				const AABB& aabb = aabb_objects[objectIndex];
 				if ((layerMask & aabb.layerMask) == 0)
 					continue;
-				if (!ray.intersects(aabb))
+
+				uint32_t hits[ray_packet_size];
+				uint32_t hit_count = 0;
+				for (uint32_t i = 0; i < packet_count; ++i)
+				{
+					if (rays[ray_indices[i]].intersects(aabb))
+					{
+						hits[hit_count++] = i;
+					}
+				}
+				if (hit_count == 0)
 					continue;
 
 				const ObjectComponent& object = objects[objectIndex];
@@ -6547,187 +7463,309 @@ namespace wi::scene
 				const XMMATRIX objectMat = XMLoadFloat4x4(&matrix_objects[objectIndex]);
 				const XMMATRIX objectMatPrev = XMLoadFloat4x4(&matrix_objects_prev[objectIndex]);
 				const XMMATRIX objectMat_Inverse = XMMatrixInverse(nullptr, objectMat);
-				const XMVECTOR rayOrigin_local = XMVector3Transform(rayOrigin, objectMat_Inverse);
-				const XMVECTOR rayDirection_local = XMVector3Normalize(XMVector3TransformNormal(rayDirection, objectMat_Inverse));
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const Scene::SkinnedPositionCache* skinned = scene.GetSkinnedPositionCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& mesh_bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
 
-				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex)
+				for (uint32_t hit = 0; hit < hit_count; ++hit)
 				{
-					const uint32_t i0 = mesh->indices[indexOffset + triangleIndex * 3 + 0];
-					const uint32_t i1 = mesh->indices[indexOffset + triangleIndex * 3 + 1];
-					const uint32_t i2 = mesh->indices[indexOffset + triangleIndex * 3 + 2];
+					const uint32_t i = hits[hit];
+					const Ray& ray = rays[ray_indices[i]];
+					Scene::RayIntersectionResult& result = results[ray_indices[i]];
+					const XMVECTOR rayOrigin = rayOrigins[i];
+					const XMVECTOR rayOrigin_local = XMVector3Transform(rayOrigin, objectMat_Inverse);
+					const XMVECTOR rayDirection_local = XMVector3Normalize(XMVector3TransformNormal(rayDirections[i], objectMat_Inverse));
 
-					XMVECTOR p0;
-					XMVECTOR p1;
-					XMVECTOR p2;
-					if (softbody != nullptr && !softbody->boneData.empty())
+					auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex)
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
-					}
-					else if (armature != nullptr && !armature->boneData.empty())
-					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
-					}
-					else
-					{
-						p0 = XMLoadFloat3(&mesh->vertex_positions[i0]);
-						p1 = XMLoadFloat3(&mesh->vertex_positions[i1]);
-						p2 = XMLoadFloat3(&mesh->vertex_positions[i2]);
-					}
+						const uint32_t i0 = mesh->indices[indexOffset + triangleIndex * 3 + 0];
+						const uint32_t i1 = mesh->indices[indexOffset + triangleIndex * 3 + 1];
+						const uint32_t i2 = mesh->indices[indexOffset + triangleIndex * 3 + 2];
 
-					float distance;
-					XMFLOAT2 bary;
-					if (wi::math::RayTriangleIntersects(rayOrigin_local, rayDirection_local, p0, p1, p2, distance, bary))
-					{
-						const XMVECTOR pos_local = XMVectorAdd(rayOrigin_local, rayDirection_local * distance);
-						const XMVECTOR pos = XMVector3Transform(pos_local, objectMat);
-						distance = wi::math::Distance(pos, rayOrigin);
+						XMVECTOR p0;
+						XMVECTOR p1;
+						XMVECTOR p2;
+						if (softbody != nullptr && !softbody->boneData.empty())
+						{
+							p0 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i0);
+							p1 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i1);
+							p2 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i2);
+						}
+						else if (armature != nullptr && !armature->boneData.empty())
+						{
+							p0 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i0);
+							p1 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i1);
+							p2 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i2);
+						}
+						else
+						{
+							p0 = XMLoadFloat3(&mesh->vertex_positions[i0]);
+							p1 = XMLoadFloat3(&mesh->vertex_positions[i1]);
+							p2 = XMLoadFloat3(&mesh->vertex_positions[i2]);
+						}
 
-						// Note: we do the TMin, Tmax check here, in world space! We use the RayTriangleIntersects in local space, so we don't use those in there
-						if (distance < result.distance && distance >= ray.TMin && distance <= ray.TMax)
+						float distance;
+						XMFLOAT2 bary;
+						if (wi::math::RayTriangleIntersects(rayOrigin_local, rayDirection_local, p0, p1, p2, distance, bary))
 						{
-							XMVECTOR nor;
-							if (softbody != nullptr || mesh->vertex_normals.empty()) // Note: for soft body we compute it instead of loading the simulated normals
-							{
-								nor = XMVector3Cross(p2 - p1, p1 - p0);
-							}
-							else
-							{
-								nor = XMVectorBaryCentric(
-									XMLoadFloat3(&mesh->vertex_normals[i0]),
-									XMLoadFloat3(&mesh->vertex_normals[i1]),
-									XMLoadFloat3(&mesh->vertex_normals[i2]),
-									bary.x,
-									bary.y
-								);
-							}
-							nor = XMVector3Normalize(XMVector3TransformNormal(nor, objectMat));
-							const XMVECTOR vel = pos - XMVector3Transform(pos_local, objectMatPrev);
+							const XMVECTOR pos_local = XMVectorAdd(rayOrigin_local, rayDirection_local * distance);
+							const XMVECTOR pos = XMVector3Transform(pos_local, objectMat);
+							distance = wi::math::Distance(pos, rayOrigin);
 
-							result.uv = {};
-							if (!mesh->vertex_uvset_0.empty())
+							// Note: we do the TMin, Tmax check here, in world space! We use the RayTriangleIntersects in local space, so we don't use those in there
+							if (distance < result.distance && distance >= ray.TMin && distance <= ray.TMax)
 							{
-								XMVECTOR uv = XMVectorBaryCentric(
-									XMLoadFloat2(&mesh->vertex_uvset_0[i0]),
-									XMLoadFloat2(&mesh->vertex_uvset_0[i1]),
-									XMLoadFloat2(&mesh->vertex_uvset_0[i2]),
-									bary.x,
-									bary.y
-								);
-								result.uv.x = XMVectorGetX(uv);
-								result.uv.y = XMVectorGetY(uv);
+								XMVECTOR nor;
+								if (softbody != nullptr || mesh->vertex_normals.empty()) // Note: for soft body we compute it instead of loading the simulated normals
+								{
+									nor = XMVector3Cross(p2 - p1, p1 - p0);
+								}
+								else
+								{
+									nor = XMVectorBaryCentric(
+										XMLoadFloat3(&mesh->vertex_normals[i0]),
+										XMLoadFloat3(&mesh->vertex_normals[i1]),
+										XMLoadFloat3(&mesh->vertex_normals[i2]),
+										bary.x,
+										bary.y
+									);
+								}
+								nor = XMVector3Normalize(XMVector3TransformNormal(nor, objectMat));
+								const XMVECTOR vel = pos - XMVector3Transform(pos_local, objectMatPrev);
+
+								result.uv = {};
+								if (!mesh->vertex_uvset_0.empty())
+								{
+									XMVECTOR uv = XMVectorBaryCentric(
+										XMLoadFloat2(&mesh->vertex_uvset_0[i0]),
+										XMLoadFloat2(&mesh->vertex_uvset_0[i1]),
+										XMLoadFloat2(&mesh->vertex_uvset_0[i2]),
+										bary.x,
+										bary.y
+									);
+									result.uv.x = XMVectorGetX(uv);
+									result.uv.y = XMVectorGetY(uv);
+								}
+								if (!mesh->vertex_uvset_1.empty())
+								{
+									XMVECTOR uv = XMVectorBaryCentric(
+										XMLoadFloat2(&mesh->vertex_uvset_1[i0]),
+										XMLoadFloat2(&mesh->vertex_uvset_1[i1]),
+										XMLoadFloat2(&mesh->vertex_uvset_1[i2]),
+										bary.x,
+										bary.y
+									);
+									result.uv.z = XMVectorGetX(uv);
+									result.uv.w = XMVectorGetY(uv);
+								}
+
+								result.entity = entity;
+								XMStoreFloat3(&result.position, pos);
+								XMStoreFloat3(&result.normal, nor);
+								XMStoreFloat3(&result.velocity, vel);
+								result.distance = distance;
+								result.subsetIndex = (int)subsetIndex;
+								result.vertexID0 = (int)i0;
+								result.vertexID1 = (int)i1;
+								result.vertexID2 = (int)i2;
+								result.bary = bary;
 							}
-							if (!mesh->vertex_uvset_1.empty())
+						}
+					};
+
+					if (mesh_bvh.IsValid())
+					{
+						Ray ray_local = Ray(rayOrigin_local, rayDirection_local);
+
+						mesh_bvh.Intersects(ray_local, 0, [&](uint32_t index) {
+							const AABB& leaf = mesh->bvh_leaf_aabbs[index];
+							const uint32_t triangleIndex = leaf.layerMask;
+							const uint32_t subsetIndex = leaf.userdata;
+							const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
+							if (subset.indexCount == 0)
+								return;
+							const uint32_t indexOffset = subset.indexOffset;
+							intersect_triangle(subsetIndex, indexOffset, triangleIndex);
+						});
+					}
+					else
+					{
+						// Brute-force intersection test:
+						uint32_t first_subset = 0;
+						uint32_t last_subset = 0;
+						mesh->GetLODSubsetRange(lod, first_subset, last_subset);
+						for (uint32_t subsetIndex = first_subset; subsetIndex < last_subset; ++subsetIndex)
+						{
+							const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
+							if (subset.indexCount == 0)
+								continue;
+							const uint32_t indexOffset = subset.indexOffset;
+							const uint32_t triangleCount = subset.indexCount / 3;
+
+							for (uint32_t triangleIndex = 0; triangleIndex < triangleCount; ++triangleIndex)
 							{
-								XMVECTOR uv = XMVectorBaryCentric(
-									XMLoadFloat2(&mesh->vertex_uvset_1[i0]),
-									XMLoadFloat2(&mesh->vertex_uvset_1[i1]),
-									XMLoadFloat2(&mesh->vertex_uvset_1[i2]),
-									bary.x,
-									bary.y
-								);
-								result.uv.z = XMVectorGetX(uv);
-								result.uv.w = XMVectorGetY(uv);
+								intersect_triangle(subsetIndex, indexOffset, triangleIndex);
 							}
-
-							result.entity = entity;
-							XMStoreFloat3(&result.position, pos);
-							XMStoreFloat3(&result.normal, nor);
-							XMStoreFloat3(&result.velocity, vel);
-							result.distance = distance;
-							result.subsetIndex = (int)subsetIndex;
-							result.vertexID0 = (int)i0;
-							result.vertexID1 = (int)i1;
-							result.vertexID2 = (int)i2;
-							result.bary = bary;
 						}
 					}
-				};
+				}
+			}
+		}
 
-				if (mesh->bvh.IsValid())
+		if (filterMask & FILTER_RAGDOLL)
+		{
+			for (uint32_t i = 0; i < packet_count; ++i)
+			{
+				const Ray& ray = rays[ray_indices[i]];
+				Scene::RayIntersectionResult& result = results[ray_indices[i]];
+				const XMVECTOR rayOrigin = rayOrigins[i];
+				const XMVECTOR rayDirection = rayDirections[i];
+				for (size_t humanoid_index = 0; humanoid_index < humanoids.GetCount(); ++humanoid_index)
 				{
-					Ray ray_local = Ray(rayOrigin_local, rayDirection_local);
+					Entity entity = humanoids.GetEntity(humanoid_index);
+					const LayerComponent* layer = layers.GetComponent(entity);
+					if (layer != nullptr && (layer->GetLayerMask() & layerMask) == 0)
+						continue;
 
-					mesh->bvh.Intersects(ray_local, 0, [&](uint32_t index) {
-						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
-						const uint32_t triangleIndex = leaf.layerMask;
-						const uint32_t subsetIndex = leaf.userdata;
-						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
-						if (subset.indexCount == 0)
-							return;
-						const uint32_t indexOffset = subset.indexOffset;
-						intersect_triangle(subsetIndex, indexOffset, triangleIndex);
-					});
-				}
-				else
-				{
-					// Brute-force intersection test:
-					uint32_t first_subset = 0;
-					uint32_t last_subset = 0;
-					mesh->GetLODSubsetRange(lod, first_subset, last_subset);
-					for (uint32_t subsetIndex = first_subset; subsetIndex < last_subset; ++subsetIndex)
-					{
-						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
-						if (subset.indexCount == 0)
-							continue;
-						const uint32_t indexOffset = subset.indexOffset;
-						const uint32_t triangleCount = subset.indexCount / 3;
+					const HumanoidComponent& humanoid = humanoids[humanoid_index];
+					if (humanoid.IsIntersectionDisabled())
+						continue;
+					if (!humanoid.ragdoll_bounds.intersects(ray))
+						continue;
 
-						for (uint32_t triangleIndex = 0; triangleIndex < triangleCount; ++triangleIndex)
+					for (auto& bp : humanoid.ragdoll_bodyparts)
+					{
+						float dist = 0;
+						XMFLOAT3 direction = {};
+						if (ray.intersects(bp.capsule, dist, direction) && dist < result.distance)
 						{
-							intersect_triangle(subsetIndex, indexOffset, triangleIndex);
+							result.distance = dist;
+							result.bary = {};
+							result.entity = entity;
+							result.humanoid_bone = bp.bone;
+							result.normal = direction;
+							result.uv = {};
+							result.velocity = {};
+							XMStoreFloat3(&result.position, rayOrigin + rayDirection * dist);
+							result.subsetIndex = -1;
+							result.vertexID0 = 0;
+							result.vertexID1 = 0;
+							result.vertexID2 = 0;
 						}
 					}
 				}
+			}
+		}
 
+		for (uint32_t i = 0; i < packet_count; ++i)
+		{
+			const Ray& ray = rays[ray_indices[i]];
+			Scene::RayIntersectionResult& result = results[ray_indices[i]];
+			result.orientation = ray.GetPlacementOrientation(result.position, result.normal);
+		}
+	}
+	Scene::RayIntersectionResult Scene::Intersects(const Ray& ray, uint32_t filterMask, uint32_t layerMask, uint32_t lod) const
+	{
+		RayIntersectionResult result;
+		const uint32_t ray_index = 0;
+		IntersectsRayPacket(*this, &ray, &result, &ray_index, 1, filterMask, layerMask, lod);
+		return result;
+	}
+	void Scene::IntersectsBatch(const Ray* rays, RayIntersectionResult* results, size_t count, uint32_t filterMask, uint32_t layerMask, uint32_t lod) const
+	{
+		if (count == 0)
+			return;
+
+		// Sort the rays for coherence: by direction octant first, then by the Morton code of the origin within the bounds of all origins,
+		//	so that rays in the same packet hit similar objects and walk similar BVH paths
+		wi::vector<uint32_t> ray_indices(count);
+		if (count > ray_packet_size)
+		{
+			XMVECTOR originMin = XMVectorReplicate(std::numeric_limits<float>::max());
+			XMVECTOR originMax = XMVectorReplicate(std::numeric_limits<float>::lowest());
+			for (size_t i = 0; i < count; ++i)
+			{
+				const XMVECTOR origin = XMLoadFloat3(&rays[i].origin);
+				originMin = XMVectorMin(originMin, origin);
+				originMax = XMVectorMax(originMax, origin);
+			}
+			const XMVECTOR originScale = XMVectorReciprocal(XMVectorMax(XMVectorSubtract(originMax, originMin), XMVectorReplicate(std::numeric_limits<float>::epsilon())));
+
+			wi::vector<uint64_t> sort_keys(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const Ray& ray = rays[i];
+				const uint32_t octant = (ray.direction.x < 0 ? 1u : 0u) | (ray.direction.y < 0 ? 2u : 0u) | (ray.direction.z < 0 ? 4u : 0u);
+				XMFLOAT3 uvw;
+				XMStoreFloat3(&uvw, XMVectorSaturate(XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&ray.origin), originMin), originScale)));
+				const uint32_t morton = wi::math::morton3D(uvw.x, uvw.y, uvw.z);
+				sort_keys[i] = (uint64_t(octant) << 61ull) | (uint64_t(morton) << 31ull) | uint64_t(i); // the ray index fits in the lower 31 bits, because Dispatch uses 32-bit job indices anyway
+			}
+			std::sort(sort_keys.begin(), sort_keys.end());
+			for (size_t i = 0; i < count; ++i)
+			{
+				ray_indices[i] = uint32_t(sort_keys[i] & 0x7FFFFFFFull);
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				ray_indices[i] = uint32_t(i);
 			}
 		}
 
-		if (filterMask & FILTER_RAGDOLL)
+		const uint32_t packet_count = uint32_t((count + ray_packet_size - 1) / ray_packet_size);
+		if (packet_count == 1)
 		{
-			for (size_t i = 0; i < humanoids.GetCount(); ++i)
+			IntersectsRayPacket(*this, rays, results, ray_indices.data(), uint32_t(count), filterMask, layerMask, lod);
+			return;
+		}
+
+		// The skinned position caches are filled before the packets are dispatched, otherwise a packet that finds a cache
+		//	being filled by an other packet would fall back to uncached skinning, and rays of the same batch could see different data
+		//	Only the skinned meshes whose object bounds are hit by any ray of the batch are filled, the same ones that the packets would fill:
+		if (skinned_position_cache_enabled && (filterMask & FILTER_OBJECT_ALL))
+		{
+			ObjectCandidates candidates;
+			CollectObjectCandidates(*this, rays, ray_indices.data(), uint32_t(count), candidates);
+			for (uint32_t candidate = 0; candidate < candidates.count; ++candidate)
 			{
-				Entity entity = humanoids.GetEntity(i);
-				const LayerComponent* layer = layers.GetComponent(entity);
-				if (layer != nullptr && (layer->GetLayerMask() & layerMask) == 0)
+				const uint32_t objectIndex = candidates[candidate];
+				const ObjectComponent& object = objects[objectIndex];
+				if (object.meshID == INVALID_ENTITY)
 					continue;
-
-				const HumanoidComponent& humanoid = humanoids[i];
-				if (humanoid.IsIntersectionDisabled())
+				if ((filterMask & object.GetFilterMask()) == 0)
 					continue;
-				if (!humanoid.ragdoll_bounds.intersects(ray))
+				const AABB& aabb = aabb_objects[objectIndex];
+				if ((layerMask & aabb.layerMask) == 0)
 					continue;
-
-				for (auto& bp : humanoid.ragdoll_bodyparts)
+				const MeshComponent* mesh = meshes.GetComponent(object.meshID);
+				if (mesh == nullptr)
+					continue;
+				const SoftBodyPhysicsComponent* softbody = softbodies.GetComponent(object.meshID);
+				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				if (softbody == nullptr && armature == nullptr)
+					continue;
+				bool hit = false;
+				for (size_t i = 0; i < count && !hit; ++i)
 				{
-					float dist = 0;
-					XMFLOAT3 direction = {};
-					if (ray.intersects(bp.capsule, dist, direction) && dist < result.distance)
-					{
-						result.distance = dist;
-						result.bary = {};
-						result.entity = entity;
-						result.humanoid_bone = bp.bone;
-						result.normal = direction;
-						result.uv = {};
-						result.velocity = {};
-						XMStoreFloat3(&result.position, rayOrigin + rayDirection * dist);
-						result.subsetIndex = -1;
-						result.vertexID0 = 0;
-						result.vertexID1 = 0;
-						result.vertexID2 = 0;
-					}
+					hit = rays[i].intersects(aabb);
+				}
+				if (hit)
+				{
+					GetSkinnedPositionCache(object.meshID, *mesh, softbody, armature);
 				}
 			}
 		}
 
-		result.orientation = ray.GetPlacementOrientation(result.position, result.normal);
-
-		return result;
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, packet_count, 1, [&](wi::jobsystem::JobArgs args) {
+			const size_t offset = size_t(args.jobIndex) * ray_packet_size;
+			const uint32_t packet_ray_count = uint32_t(std::min(size_t(ray_packet_size), count - offset));
+			IntersectsRayPacket(*this, rays, results, ray_indices.data() + offset, packet_ray_count, filterMask, layerMask, lod);
+		});
+		wi::jobsystem::Wait(ctx);
 	}
 	void Scene::IntersectsAll(wi::vector<RayIntersectionResult>& results, const Ray& ray, uint32_t filterMask, uint32_t layerMask, uint32_t lod) const
 	{
@@ -6784,9 +7822,11 @@ namespace wi::scene
 
 		if (filterMask & FILTER_OBJECT_ALL)
 		{
-			const size_t objectCount = std::min(objects.GetCount(), aabb_objects.size());
-			for (size_t objectIndex = 0; objectIndex < objectCount; ++objectIndex)
+			ObjectCandidates candidates;
+			CollectObjectCandidates(*this, ray, candidates);
+			for (uint32_t candidate = 0; candidate < candidates.count; ++candidate)
 			{
+				const uint32_t objectIndex = candidates[candidate];
 				const AABB& aabb = aabb_objects[objectIndex];
 				if ((layerMask & aabb.layerMask) == 0)
 					continue;
@@ -6811,6 +7851,8 @@ namespace wi::scene
 				const XMVECTOR rayOrigin_local = XMVector3Transform(rayOrigin, objectMat_Inverse);
 				const XMVECTOR rayDirection_local = XMVector3Normalize(XMVector3TransformNormal(rayDirection, objectMat_Inverse));
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedPositionCache* skinned = GetSkinnedPositionCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& mesh_bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex)
 				{
@@ -6823,15 +7865,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i0);
+						p1 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i1);
+						p2 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i0);
+						p1 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i1);
+						p2 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i2);
 					}
 					else
 					{
@@ -6911,11 +7953,11 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (mesh_bvh.IsValid())
 				{
 					Ray ray_local = Ray(rayOrigin_local, rayDirection_local);
 
-					mesh->bvh.Intersects(ray_local, 0, [&](uint32_t index) {
+					mesh_bvh.Intersects(ray_local, 0, [&](uint32_t index) {
 						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
@@ -7039,9 +8081,11 @@ namespace wi::scene
 
 		if (filterMask & FILTER_OBJECT_ALL)
 		{
-			const size_t objectCount = std::min(objects.GetCount(), aabb_objects.size());
-			for (size_t objectIndex = 0; objectIndex < objectCount; ++objectIndex)
+			ObjectCandidates candidates;
+			CollectObjectCandidates(*this, ray, candidates);
+			for (uint32_t candidate = 0; candidate < candidates.count; ++candidate)
 			{
+				const uint32_t objectIndex = candidates[candidate];
 				const AABB& aabb = aabb_objects[objectIndex];
 				if ((layerMask & aabb.layerMask) == 0)
 					continue;
@@ -7066,6 +8110,8 @@ namespace wi::scene
 				const XMVECTOR rayOrigin_local = XMVector3Transform(rayOrigin, objectMat_Inverse);
 				const XMVECTOR rayDirection_local = XMVector3Normalize(XMVector3TransformNormal(rayDirection, objectMat_Inverse));
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedPositionCache* skinned = GetSkinnedPositionCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& mesh_bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex)
 				{
@@ -7078,15 +8124,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i0);
+						p1 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i1);
+						p2 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i0);
+						p1 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i1);
+						p2 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i2);
 					}
 					else
 					{
@@ -7113,11 +8159,11 @@ namespace wi::scene
 					return false;
 				};
 
-				if (mesh->bvh.IsValid())
+				if (mesh_bvh.IsValid())
 				{
 					Ray ray_local = Ray(rayOrigin_local, rayDirection_local);
 
-					mesh->bvh.IntersectsFirst(ray_local, [&](uint32_t index) {
+					mesh_bvh.IntersectsFirst(ray_local, [&](uint32_t index) {
 						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
@@ -7240,9 +8286,11 @@ namespace wi::scene
 
 		if (filterMask & FILTER_OBJECT_ALL)
 		{
-			const size_t objectCount = std::min(objects.GetCount(), aabb_objects.size());
-			for (size_t objectIndex = 0; objectIndex < objectCount; ++objectIndex)
+			ObjectCandidates candidates;
+			CollectObjectCandidates(*this, sphere, candidates);
+			for (uint32_t candidate = 0; candidate < candidates.count; ++candidate)
 			{
+				const uint32_t objectIndex = candidates[candidate];
 				const AABB& aabb = aabb_objects[objectIndex];
 				if ((layerMask & aabb.layerMask) == 0)
 					continue;
@@ -7265,6 +8313,8 @@ namespace wi::scene
 				const XMMATRIX objectMatPrev = XMLoadFloat4x4(&matrix_objects_prev[objectIndex]);
 				const XMMATRIX objectMatInverse = XMMatrixInverse(nullptr, objectMat);
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedPositionCache* skinned = GetSkinnedPositionCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& mesh_bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex, bool doubleSided)
 				{
@@ -7277,15 +8327,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i0);
+						p1 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i1);
+						p2 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i0);
+						p1 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i1);
+						p2 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i2);
 						p0 = XMVector3Transform(p0, objectMat);
 						p1 = XMVector3Transform(p1, objectMat);
 						p2 = XMVector3Transform(p2, objectMat);
@@ -7416,7 +8466,7 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (mesh_bvh.IsValid())
 				{
 					XMFLOAT3 center_local;
 					float radius_local;
@@ -7424,7 +8474,7 @@ namespace wi::scene
 					XMStoreFloat(&radius_local, XMVector3Length(XMVector3TransformNormal(XMLoadFloat(&sphere.radius), objectMatInverse)));
 					Sphere sphere_local = Sphere(center_local, radius_local);
 
-					mesh->bvh.Intersects(sphere_local, 0, [&](uint32_t index) {
+					mesh_bvh.Intersects(sphere_local, 0, [&](uint32_t index) {
 						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
@@ -7547,9 +8597,11 @@ namespace wi::scene
 
 		if (filterMask & FILTER_OBJECT_ALL)
 		{
-			const size_t objectCount = std::min(objects.GetCount(), aabb_objects.size());
-			for (size_t objectIndex = 0; objectIndex < objectCount; ++objectIndex)
+			ObjectCandidates candidates;
+			CollectObjectCandidates(*this, sphere, candidates);
+			for (uint32_t candidate = 0; candidate < candidates.count; ++candidate)
 			{
+				const uint32_t objectIndex = candidates[candidate];
 				const AABB& aabb = aabb_objects[objectIndex];
 				if ((layerMask & aabb.layerMask) == 0)
 					continue;
@@ -7572,6 +8624,8 @@ namespace wi::scene
 				const XMMATRIX objectMatPrev = XMLoadFloat4x4(&matrix_objects_prev[objectIndex]);
 				const XMMATRIX objectMatInverse = XMMatrixInverse(nullptr, objectMat);
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedPositionCache* skinned = GetSkinnedPositionCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& mesh_bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex, bool doubleSided)
 				{
@@ -7584,15 +8638,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i0);
+						p1 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i1);
+						p2 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i0);
+						p1 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i1);
+						p2 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i2);
 						p0 = XMVector3Transform(p0, objectMat);
 						p1 = XMVector3Transform(p1, objectMat);
 						p2 = XMVector3Transform(p2, objectMat);
@@ -7726,7 +8780,7 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (mesh_bvh.IsValid())
 				{
 					XMFLOAT3 center_local;
 					float radius_local;
@@ -7734,7 +8788,7 @@ namespace wi::scene
 					XMStoreFloat(&radius_local, XMVector3Length(XMVector3TransformNormal(XMLoadFloat(&sphere.radius), objectMatInverse)));
 					Sphere sphere_local = Sphere(center_local, radius_local);
 
-					mesh->bvh.Intersects(sphere_local, 0, [&](uint32_t index) {
+					mesh_bvh.Intersects(sphere_local, 0, [&](uint32_t index) {
 						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
@@ -7865,9 +8919,11 @@ namespace wi::scene
 
 		if (filterMask & FILTER_OBJECT_ALL)
 		{
-			const size_t objectCount = std::min(objects.GetCount(), aabb_objects.size());
-			for (size_t objectIndex = 0; objectIndex < objectCount; ++objectIndex)
+			ObjectCandidates candidates;
+			CollectObjectCandidates(*this, capsule_aabb, candidates);
+			for (uint32_t candidate = 0; candidate < candidates.count; ++candidate)
 			{
+				const uint32_t objectIndex = candidates[candidate];
 				const AABB& aabb = aabb_objects[objectIndex];
 				if ((layerMask & aabb.layerMask) == 0)
 					continue;
@@ -7890,6 +8946,8 @@ namespace wi::scene
 				const XMMATRIX objectMat = XMLoadFloat4x4(&matrix_objects[objectIndex]);
 				const XMMATRIX objectMatPrev = XMLoadFloat4x4(&matrix_objects_prev[objectIndex]);
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedPositionCache* skinned = GetSkinnedPositionCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& mesh_bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
 				const XMMATRIX objectMat_Inverse = XMMatrixInverse(nullptr, objectMat);
 				
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex, bool doubleSided)
@@ -7903,15 +8961,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i0);
+						p1 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i1);
+						p2 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i0);
+						p1 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i1);
+						p2 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i2);
 						p0 = XMVector3Transform(p0, objectMat);
 						p1 = XMVector3Transform(p1, objectMat);
 						p2 = XMVector3Transform(p2, objectMat);
@@ -8154,7 +9212,7 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (mesh_bvh.IsValid())
 				{
 					XMFLOAT3 base_local;
 					XMFLOAT3 tip_local;
@@ -8164,7 +9222,7 @@ namespace wi::scene
 					XMStoreFloat(&radius_local, XMVector3Length(XMVector3TransformNormal(XMLoadFloat(&capsule.radius), objectMat_Inverse)));
 					AABB capsule_local_aabb = Capsule(base_local, tip_local, radius_local).getAABB();
 
-					mesh->bvh.Intersects(capsule_local_aabb, 0, [&](uint32_t index){
+					mesh_bvh.Intersects(capsule_local_aabb, 0, [&](uint32_t index){
 						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
@@ -8294,9 +9352,11 @@ namespace wi::scene
 
 		if (filterMask & FILTER_OBJECT_ALL)
 		{
-			const size_t objectCount = std::min(objects.GetCount(), aabb_objects.size());
-			for (size_t objectIndex = 0; objectIndex < objectCount; ++objectIndex)
+			ObjectCandidates candidates;
+			CollectObjectCandidates(*this, capsule_aabb, candidates);
+			for (uint32_t candidate = 0; candidate < candidates.count; ++candidate)
 			{
+				const uint32_t objectIndex = candidates[candidate];
 				const AABB& aabb = aabb_objects[objectIndex];
 				if ((layerMask & aabb.layerMask) == 0)
 					continue;
@@ -8319,6 +9379,8 @@ namespace wi::scene
 				const XMMATRIX objectMat = XMLoadFloat4x4(&matrix_objects[objectIndex]);
 				const XMMATRIX objectMatPrev = XMLoadFloat4x4(&matrix_objects_prev[objectIndex]);
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedPositionCache* skinned = GetSkinnedPositionCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& mesh_bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
 				const XMMATRIX objectMat_Inverse = XMMatrixInverse(nullptr, objectMat);
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex, bool doubleSided)
@@ -8332,15 +9394,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i0);
+						p1 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i1);
+						p2 = LoadSkinnedVertex(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i0);
+						p1 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i1);
+						p2 = LoadSkinnedVertex(skinned, *mesh, armature->boneData, i2);
 						p0 = XMVector3Transform(p0, objectMat);
 						p1 = XMVector3Transform(p1, objectMat);
 						p2 = XMVector3Transform(p2, objectMat);
@@ -8587,7 +9649,7 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (mesh_bvh.IsValid())
 				{
 					XMFLOAT3 base_local;
 					XMFLOAT3 tip_local;
@@ -8597,7 +9659,7 @@ namespace wi::scene
 					XMStoreFloat(&radius_local, XMVector3Length(XMVector3TransformNormal(XMLoadFloat(&capsule.radius), objectMat_Inverse)));
 					AABB capsule_local_aabb = Capsule(base_local, tip_local, radius_local).getAABB();
 
-					mesh->bvh.Intersects(capsule_local_aabb, 0, [&](uint32_t index) {
+					mesh_bvh.Intersects(capsule_local_aabb, 0, [&](uint32_t index) {
 						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
@@ -9258,6 +10320,19 @@ namespace wi::scene
 
 								auto& animation_data = src_scene->animation_datas.Contains(sampler.data) ? *src_scene->animation_datas.GetComponent(sampler.data) : sampler.backwards_compatibility_data;
 								retarget_animation_data = animation_data;
+								if (retarget_animation_data.IsCompressed())
+								{
+									// The retargeted result is baked into regular keyframes:
+									const AnimationDataComponent* time_track_data = src_scene->animation_datas.GetComponent(animation_data.time_track);
+									if (time_track_data != nullptr)
+									{
+										retarget_animation_data.Decompress(*time_track_data);
+									}
+									else
+									{
+										wi::backlog::post("RetargetAnimation: the time track of a compressed animation data was not found, a channel will not be animated.", wi::backlog::LogLevel::Warning);
+									}
+								}
 
 								XMVECTOR S, R, T; // matrix decompose destinations
 
@@ -9325,6 +10400,183 @@ namespace wi::scene
 		return INVALID_ENTITY;
 	}
 
+	size_t Scene::CompressAnimation(Entity entity, float error_tolerance)
+	{
+		const AnimationComponent* animation = animations.GetComponent(entity);
+		if (animation == nullptr)
+			return 0;
+
+		// The animation datas are grouped by their keyframe times, every group will share one time track:
+		struct DataInfo
+		{
+			Entity data = INVALID_ENTITY;
+			size_t component_count = 0;
+			bool rotation = false;
+		};
+		struct Group
+		{
+			Entity times = INVALID_ENTITY; // the animation data that the keyframe times of the group are taken from
+			wi::vector<DataInfo> datas;
+		};
+		wi::vector<Group> groups;
+		wi::unordered_set<Entity> visited;
+		for (const AnimationComponent::AnimationChannel& channel : animation->channels)
+		{
+			if (channel.samplerIndex < 0 || channel.samplerIndex >= (int)animation->samplers.size())
+				continue;
+			const AnimationComponent::AnimationSampler& sampler = animation->samplers[channel.samplerIndex];
+			if (sampler.scene != nullptr)
+				continue; // data of an other scene is not modified
+			if (sampler.mode != AnimationComponent::AnimationSampler::Mode::LINEAR)
+				continue; // the key reduction is only correct for linear interpolation
+			const AnimationDataComponent* animationdata = animation_datas.GetComponent(sampler.data);
+			if (animationdata == nullptr || animationdata->IsCompressed() || animationdata->keyframe_times.empty())
+				continue;
+			if (!std::is_sorted(animationdata->keyframe_times.begin(), animationdata->keyframe_times.end()))
+				continue;
+
+			DataInfo info;
+			info.data = sampler.data;
+			info.rotation = channel.path == AnimationComponent::AnimationChannel::Path::ROTATION;
+			switch (channel.GetPathDataType())
+			{
+			case AnimationComponent::AnimationChannel::PathDataType::Float:
+				info.component_count = 1;
+				break;
+			case AnimationComponent::AnimationChannel::PathDataType::Float2:
+				info.component_count = 2;
+				break;
+			case AnimationComponent::AnimationChannel::PathDataType::Float3:
+				info.component_count = 3;
+				break;
+			case AnimationComponent::AnimationChannel::PathDataType::Float4:
+				info.component_count = 4;
+				break;
+			case AnimationComponent::AnimationChannel::PathDataType::Weights:
+				info.component_count = animationdata->keyframe_data.size() / animationdata->keyframe_times.size();
+				break;
+			default:
+				continue; // events use the keyframes themselves
+			}
+			if (info.component_count == 0 || animationdata->keyframe_data.size() != animationdata->keyframe_times.size() * info.component_count)
+				continue;
+			if (!visited.insert(sampler.data).second)
+				continue;
+
+			Group* group = nullptr;
+			for (Group& x : groups)
+			{
+				const wi::vector<float>& times = animation_datas.GetComponent(x.times)->keyframe_times;
+				if (times.size() == animationdata->keyframe_times.size() && std::equal(times.begin(), times.end(), animationdata->keyframe_times.begin()))
+				{
+					group = &x;
+					break;
+				}
+			}
+			if (group == nullptr)
+			{
+				group = &groups.emplace_back();
+				group->times = sampler.data;
+			}
+			group->datas.push_back(info);
+		}
+
+		// Checks whether the keyframes between left and right can be removed, because linear interpolation reproduces them within the error tolerance for every data in the group:
+		auto is_reducible = [&](const Group& group, const wi::vector<float>& times, uint32_t left, uint32_t right) {
+			const float span = times[right] - times[left];
+			if (span <= 0)
+				return false;
+			for (const DataInfo& info : group.datas)
+			{
+				const float* data = animation_datas.GetComponent(info.data)->keyframe_data.data();
+				for (uint32_t key = left + 1; key < right; ++key)
+				{
+					const float t = (times[key] - times[left]) / span;
+					if (info.rotation)
+					{
+						const XMVECTOR L = XMLoadFloat4((const XMFLOAT4*)data + left);
+						const XMVECTOR R = XMLoadFloat4((const XMFLOAT4*)data + right);
+						XMVECTOR Q = XMLoadFloat4((const XMFLOAT4*)data + key);
+						const XMVECTOR I = XMQuaternionNormalize(XMQuaternionSlerp(L, R, t));
+						Q = XMQuaternionNormalize(Q);
+						if (XMVectorGetX(XMQuaternionDot(I, Q)) < 0)
+						{
+							Q = XMVectorNegate(Q);
+						}
+						if (!XMVector4NearEqual(I, Q, XMVectorReplicate(error_tolerance)))
+							return false;
+					}
+					else
+					{
+						for (size_t c = 0; c < info.component_count; ++c)
+						{
+							const float value = wi::math::Lerp(data[left * info.component_count + c], data[right * info.component_count + c], t);
+							if (std::abs(value - data[key * info.component_count + c]) > error_tolerance)
+								return false;
+						}
+					}
+				}
+			}
+			return true;
+		};
+
+		// Limits the number of keyframes that one removal check tests, to bound the compression time
+		constexpr uint32_t max_span = 128;
+
+		size_t compressed_count = 0;
+		wi::vector<uint32_t> keys;
+		for (const Group& group : groups)
+		{
+			Entity time_track = CreateEntity();
+			animation_datas.Create(time_track); // creating can relocate the components, they are looked up by entity after this
+
+			// The animation datas can be shared by other animations, so the time track is not owned by this animation
+			//	It gets the same parent as the datas instead (for example the imported animation that created them), so it is removed together with them:
+			const HierarchyComponent* data_hierarchy = hierarchy.GetComponent(group.times);
+			if (data_hierarchy != nullptr && data_hierarchy->parentID != INVALID_ENTITY)
+			{
+				Component_Attach(time_track, data_hierarchy->parentID);
+			}
+
+			// Greedy error-bounded keyframe reduction, shared by every data of the group:
+			const wi::vector<float>& times = animation_datas.GetComponent(group.times)->keyframe_times;
+			const uint32_t count = (uint32_t)times.size();
+			keys.clear();
+			keys.push_back(0);
+			uint32_t left = 0;
+			while (left + 1 < count)
+			{
+				uint32_t right = left + 1;
+				while (right + 1 < count && right + 1 - left <= max_span && is_reducible(group, times, left, right + 1))
+				{
+					right++;
+				}
+				keys.push_back(right);
+				left = right;
+			}
+
+			AnimationDataComponent& time_track_data = *animation_datas.GetComponent(time_track);
+			time_track_data.keyframe_times.resize(keys.size());
+			for (size_t k = 0; k < keys.size(); ++k)
+			{
+				time_track_data.keyframe_times[k] = times[keys[k]];
+			}
+
+			for (const DataInfo& info : group.datas)
+			{
+				AnimationDataComponent& animationdata = *animation_datas.GetComponent(info.data);
+				animationdata.Compress(
+					time_track,
+					keys.data(),
+					keys.size(),
+					info.rotation ? AnimationDataComponent::Compression::SMALLEST_THREE : AnimationDataComponent::Compression::QUANTIZED
+				);
+				compressed_count++;
+			}
+		}
+		return compressed_count;
+	}
+
 	XMMATRIX Scene::GetRestPose(wi::ecs::Entity entity) const
 	{
 		if (entity != INVALID_ENTITY)
@@ -9386,6 +10638,7 @@ namespace wi::scene
 			if (child_transform != nullptr && parent_transform != nullptr)
 			{
 				child_transform->UpdateTransform_Parented(*parent_transform);
+				child_transform->SetDirty();
 			}
 			RefreshHierarchyTopdownFromParent(child);
 		}
@@ -9708,6 +10961,7 @@ namespace wi::scene
 		M = XMMatrixScalingFromVector(S) * XMMatrixRotationQuaternion(R) * XMMatrixTranslationFromVector(T);
 
 		XMStoreFloat4x4(&transform.world, M);
+		transform.SetDirty(); // the world matrix doesn't match the local space, so it will be restored next frame
 
 #if 0
 		// Debug axis:
@@ -24,7 +24,10 @@ namespace wi::scene
 {
 	struct Scene
 	{
-		virtual ~Scene() = default;
+		virtual ~Scene()
+		{
+			wi::jobsystem::Wait(object_bvh_workload); // background object BVH build must not outlive the scene
+		}
 
 		wi::ecs::ComponentLibrary componentLibrary;
 
@@ -45,7 +48,7 @@ namespace wi::scene
 		wi::ecs::ComponentManager<ForceFieldComponent>& forces = componentLibrary.Register<ForceFieldComponent>("wi::scene::Scene::forces", 1); // version = 1
 		wi::ecs::ComponentManager<DecalComponent>& decals = componentLibrary.Register<DecalComponent>("wi::scene::Scene::decals", 1); // version = 1
 		wi::ecs::ComponentManager<AnimationComponent>& animations = componentLibrary.Register<AnimationComponent>("wi::scene::Scene::animations", 2); // version = 2
-		wi::ecs::ComponentManager<AnimationDataComponent>& animation_datas = componentLibrary.Register<AnimationDataComponent>("wi::scene::Scene::animation_datas");
+		wi::ecs::ComponentManager<AnimationDataComponent>& animation_datas = componentLibrary.Register<AnimationDataComponent>("wi::scene::Scene::animation_datas", 1); // version = 1
 		wi::ecs::ComponentManager<EmittedParticleSystem>& emitters = componentLibrary.Register<EmittedParticleSystem>("wi::scene::Scene::emitters", 3); // version = 3
 		wi::ecs::ComponentManager<HairParticleSystem>& hairs = componentLibrary.Register<HairParticleSystem>("wi::scene::Scene::hairs", 3); // version = 3
 		wi::ecs::ComponentManager<WeatherComponent>& weathers = componentLibrary.Register<WeatherComponent>("wi::scene::Scene::weathers", 6); // version = 6
@@ -67,6 +70,13 @@ namespace wi::scene
 		wi::ecs::ComponentManager<SplineComponent>& splines = componentLibrary.Register<SplineComponent>("wi::scene::Scene::splines", 4); // version = 4
 		wi::ecs::ComponentManager<wi::GaussianSplatModel>& gaussian_splats = componentLibrary.Register<wi::GaussianSplatModel>("wi::scene::Scene::gaussian_splats");
 
+		// Cached component joins used by the scene systems, these are rebuilt automatically when the participating component managers change:
+		wi::ecs::Query<CameraComponent, wi::ecs::Optional<TransformComponent>> camera_query{ cameras, transforms };
+		wi::ecs::Query<DecalComponent, TransformComponent, MaterialComponent, wi::ecs::Optional<LayerComponent>> decal_query{ decals, transforms, materials, layers };
+		wi::ecs::Query<EnvironmentProbeComponent, TransformComponent, wi::ecs::Optional<LayerComponent>> probe_query{ probes, transforms, layers };
+		wi::ecs::Query<ForceFieldComponent, TransformComponent> force_query{ forces, transforms };
+		wi::ecs::Query<LightComponent, TransformComponent, wi::ecs::Optional<LayerComponent>, wi::ecs::Optional<MaterialComponent>, wi::ecs::Optional<VideoComponent>> light_query{ lights, transforms, layers, materials, videos };
+
 		// Non-serialized attributes:
 		float dt = 0;
 		enum FLAGS
@@ -99,6 +109,36 @@ namespace wi::scene
 		wi::vector<wi::primitive::Sphere> character_dedicated_shadows;
 		wi::unordered_map<wi::ecs::Entity, wi::vector<wi::ecs::Entity>> topdown_hierarchy; // managed by BuildTopDownHierarchy() in every Update(), allows parent->children traversal
 		wi::jobsystem::context topdown_hierarchy_workload;
+
+		// Hierarchy sorted by depth, managed by RunHierarchyUpdateSystem(), rebuilt only when the hierarchy changes:
+		struct HierarchyNode
+		{
+			uint32_t transform_index = ~0u; // transform of the node, or ~0u
+			uint32_t layer_index = ~0u; // layer of the node, or ~0u
+			uint32_t parent_node = ~0u; // index of parent in hierarchy_nodes, or ~0u if the parent is not attached to anything
+			uint32_t parent_layer_index = ~0u; // layer of the parent when parent_node is ~0u
+			uint32_t ancestor_transform_index = ~0u; // transform of the closest ancestor that has one, or ~0u
+			uint32_t ancestor_is_root = 0; // the closest ancestor with transform is not attached, so its local matrix is its world matrix
+		};
+		wi::vector<HierarchyNode> hierarchy_nodes; // parents are always before children
+		wi::vector<uint32_t> hierarchy_level_offsets; // start of every depth level in hierarchy_nodes, plus the end
+		wi::vector<uint32_t> hierarchy_layer_masks; // accumulated layer masks of hierarchy_nodes
+		wi::vector<wi::ecs::Entity> hierarchy_parents; // parentID of every hierarchy component when hierarchy_nodes was built
+		uint64_t hierarchy_generation = 0;
+		uint64_t hierarchy_transforms_generation = 0;
+		uint64_t hierarchy_layers_generation = 0;
+		wi::vector<uint8_t> hierarchy_changed; // whether the world matrix of hierarchy_nodes was recomputed in the current pass
+		void BuildHierarchyNodes();
+
+		// Transform change tracking for the current Update():
+		//	A transform counts as changed if it was dirty when the transform system ran, or its world matrix was recomputed by the hierarchy
+		//	Systems that write the world matrix directly after the hierarchy update should call SetDirty() so that it will be restored from local space in the next frame
+		wi::vector<uint8_t> transforms_changed; // per transform index, reset at the start of every Update()
+		std::atomic<uint32_t> transform_update_count{ 0 }; // number of world matrices recomputed by the transform and hierarchy systems in the last Update()
+		inline bool IsTransformChanged(size_t transform_index) const
+		{
+			return (transform_index < transforms_changed.size() && transforms_changed[transform_index]) || transforms[transform_index].IsDirty();
+		}
 		uint32_t cpu_gpu_mapped_resource_index = 0;
 
 		// AABB culling streams:
@@ -108,6 +148,71 @@ namespace wi::scene
 		wi::vector<wi::primitive::AABB> aabb_decals;
 		wi::vector<wi::primitive::AABB> aabb_fonts;
 
+		// Object AABBs are only recomputed when their transform or mesh bounds changed:
+		struct ObjectBoundsCache
+		{
+			wi::primitive::AABB mesh_aabb; // the mesh bounds that were transformed
+			wi::primitive::AABB aabb; // the transformed mesh bounds
+		};
+		wi::vector<ObjectBoundsCache> object_bounds_cache;
+		uint64_t object_bounds_cache_generation = 0;
+
+		// Top-level BVH of aabb_objects (leaf index = object index), used for hierarchical culling and by the Intersects() queries:
+		//	It is refitted in Update() when object bounds changed, and rebuilt in the background when objects were added or removed
+		//	The background build works on a copy of the bounds and never blocks Update(), until it finishes, object_bvh is not valid
+		wi::BVH object_bvh;
+		wi::BVH object_bvh_next;
+		wi::vector<wi::primitive::AABB> object_bvh_next_aabbs; // copy of aabb_objects for the background build
+		uint64_t object_bvh_generation = ~0ull; // objects generation that object_bvh was built for
+		uint64_t object_bvh_next_generation = ~0ull; // objects generation of the background build in progress, ~0ull if there is none
+		uint32_t object_bvh_refit_count = 0; // refits since the last build, the tree is rebuilt periodically because refitting degrades it
+		std::atomic_bool object_bvh_refit_needed{ false }; // set by RunObjectUpdateSystem() when any object bounds changed
+		bool object_bvh_valid = false; // whether object_bvh matches aabb_objects in the current frame
+		wi::jobsystem::context object_bvh_workload;
+		void UpdateObjectBVH();
+		inline bool IsObjectBVHValid() const { return object_bvh_valid; }
+
+		// Skinned vertex positions for the Intersects() queries, enabled with skinned_position_cache_enabled:
+		//	The first query that reaches a skinned or soft body mesh in a frame skins all of its vertices on the job system and refits a copy of the mesh BVH to them
+		//	Later queries in the same frame reuse these instead of skinning the vertices of every tested triangle again
+		//	A query that finds the mesh being cached by an other thread doesn't wait for it, but skins the vertices itself like without the cache
+		struct SkinnedPositionCache
+		{
+			std::atomic<uint64_t> frame{ ~0ull }; // skinned_position_cache_frame that the data was computed for
+			std::atomic_bool busy{ false };
+			wi::vector<XMMATRIX> bone_matrices;
+			wi::vector<XMFLOAT3> positions; // same space as the SkinVertex() result
+			wi::vector<wi::primitive::AABB> bvh_leaf_aabbs;
+			wi::BVH bvh; // mesh BVH refitted to the skinned positions, not valid if the mesh has no BVH
+		};
+		mutable wi::unordered_map<wi::ecs::Entity, std::unique_ptr<SkinnedPositionCache>> skinned_position_cache; // key: mesh entity
+		mutable wi::SpinLock skinned_position_cache_locker;
+		uint64_t skinned_position_cache_frame = 0; // incremented at the end of every Update()
+		bool skinned_position_cache_enabled = false;
+		// Returns the skinned positions of the mesh for the current frame, or nullptr if they are not available (not skinned, cache disabled or busy)
+		const SkinnedPositionCache* GetSkinnedPositionCache(wi::ecs::Entity meshID, const MeshComponent& mesh, const SoftBodyPhysicsComponent* softbody, const ArmatureComponent* armature) const;
+
+		// The expression and IK systems process the items that don't share any data in parallel batches
+		//	When this is false, every item is processed in a single batch in the serial order, this can be used to validate the results of the batched processing
+		bool character_systems_batching_enabled = true;
+
+		// Bounds of objects in structure of arrays layout (indexed by object index), written by RunObjectUpdateSystem() when object_streams_enabled is true:
+		//	The same data as aabb_objects, but the linear frustum culling can test 4 objects at once with SIMD without reading any other data
+		enum OBJECT_STREAM
+		{
+			OBJECT_STREAM_MIN_X,
+			OBJECT_STREAM_MIN_Y,
+			OBJECT_STREAM_MIN_Z,
+			OBJECT_STREAM_MAX_X,
+			OBJECT_STREAM_MAX_Y,
+			OBJECT_STREAM_MAX_Z,
+			OBJECT_STREAM_LAYERMASK,
+		};
+		wi::ecs::ComponentStream<float, float, float, float, float, float, uint32_t> object_streams;
+		bool object_streams_enabled = false;
+		// Returns true if the object_streams were written together with aabb_objects in the last RunObjectUpdateSystem()
+		inline bool IsObjectStreamsValid() const { return object_streams_enabled && object_streams.GetCount() == aabb_objects.size(); }
+
 		// Separate stream of world matrices:
 		wi::vector<XMFLOAT4X4> matrix_objects;
 		wi::vector<XMFLOAT4X4> matrix_objects_prev;
@@ -558,6 +663,16 @@ namespace wi::scene
 		//	lod				:	specify min level of detail for meshes
 		RayIntersectionResult Intersects(const wi::primitive::Ray& ray, uint32_t filterMask = wi::enums::FILTER_OPAQUE, uint32_t layerMask = ~0, uint32_t lod = 0) const;
 
+		// Finds the closest intersection for many rays at once, the results are identical to calling Intersects() for each ray
+		//	The rays are sorted for coherence and processed in packets that are distributed over the job system
+		//	rays			:	array of rays to trace
+		//	results			:	array of results, written at the same index as the corresponding ray
+		//	count			:	number of elements in rays and results arrays
+		//	filterMask		:	filter based on type
+		//	layerMask		:	filter based on layer
+		//	lod				:	specify min level of detail for meshes
+		void IntersectsBatch(const wi::primitive::Ray* rays, RayIntersectionResult* results, size_t count, uint32_t filterMask = wi::enums::FILTER_OPAQUE, uint32_t layerMask = ~0, uint32_t lod = 0) const;
+
 		// Given a ray, finds the first intersection point against all mesh instances or colliders
 		//	returns true immediately if intersection was found, false otherwise
 		//	ray				:	the incoming ray that will be traced
@@ -610,6 +725,18 @@ namespace wi::scene
 		//	returns entity ID of the new animation or INVALID_ENTITY if retargeting was not successful
 		wi::ecs::Entity RetargetAnimation(wi::ecs::Entity dst, wi::ecs::Entity src, bool bake_data, const Scene* src_scene = nullptr);
 
+		// Compresses the animation datas of an animation to reduce memory usage:
+		//	Keyframes that linear interpolation can reproduce within the error tolerance are removed, the datas with the same keyframe times share one time track
+		//	Rotations are quantized with the smallest three encoding, other values are quantized to 16 bits
+		//	Only LINEAR samplers are compressed, STEP and CUBICSPLINE samplers, events and datas of other scenes are not modified
+		//	The compressed datas can't be edited (retargeting with baking decompresses them), so this should be the last step of processing an animation
+		//	The time tracks are attached to the parent of the datas (if they have one), not to the animation, because the datas can be shared by other animations
+		//	entity			:	the animation entity
+		//	error_tolerance	:	the largest allowed difference of a value component (rotations: quaternion component) caused by keyframe removal
+		//
+		//	returns the number of animation datas that were compressed
+		size_t CompressAnimation(wi::ecs::Entity entity, float error_tolerance = 0.0005f);
+
 		// If you don't know which armature the bone is contained in, this function can be used to find the first such armature and return the bone's rest matrix
 		//	If not found, and entity has a transform, it returns transform matrix
 		//	Otherwise, returns identity matrix
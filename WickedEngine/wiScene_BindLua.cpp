@@ -5813,6 +5813,7 @@ Luna<ObjectComponent_BindLua>::FunctionType ObjectComponent_BindLua::methods[] =
 	lunamethod(ObjectComponent_BindLua, IsNotVisibleInMainCamera),
 	lunamethod(ObjectComponent_BindLua, IsNotVisibleInReflections),
 	lunamethod(ObjectComponent_BindLua, IsWetmapEnabled),
+	lunamethod(ObjectComponent_BindLua, IsOccluder),
 	lunamethod(ObjectComponent_BindLua, IsRenderable),
 
 	lunamethod(ObjectComponent_BindLua, SetMeshID),
@@ -5830,6 +5831,7 @@ Luna<ObjectComponent_BindLua>::FunctionType ObjectComponent_BindLua::methods[] =
 	lunamethod(ObjectComponent_BindLua, SetNotVisibleInMainCamera),
 	lunamethod(ObjectComponent_BindLua, SetNotVisibleInReflections),
 	lunamethod(ObjectComponent_BindLua, SetWetmapEnabled),
+	lunamethod(ObjectComponent_BindLua, SetOccluder),
 	lunamethod(ObjectComponent_BindLua, SetRenderable),
 	{ NULL, NULL }
 };
@@ -5908,6 +5910,11 @@ int ObjectComponent_BindLua::IsWetmapEnabled(lua_State* L)
 	wi::lua::SSetBool(L, component->IsWetmapEnabled());
 	return 1;
 }
+int ObjectComponent_BindLua::IsOccluder(lua_State* L)
+{
+	wi::lua::SSetBool(L, component->IsOccluder());
+	return 1;
+}
 int ObjectComponent_BindLua::IsRenderable(lua_State* L)
 {
 	wi::lua::SSetBool(L, component->IsRenderable());
@@ -6172,6 +6179,21 @@ int ObjectComponent_BindLua::SetWetmapEnabled(lua_State* L)
 
 	return 0;
 }
+int ObjectComponent_BindLua::SetOccluder(lua_State* L)
+{
+	int argc = wi::lua::SGetArgCount(L);
+	if (argc > 0)
+	{
+		bool value = wi::lua::SGetBool(L, 1);
+		component->SetOccluder(value);
+	}
+	else
+	{
+		wi::lua::SError(L, "SetOccluder(bool value) not enough arguments!");
+	}
+
+	return 0;
+}
 int ObjectComponent_BindLua::SetRenderable(lua_State* L)
 {
 	int argc = wi::lua::SGetArgCount(L);
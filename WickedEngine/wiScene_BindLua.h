@@ -876,6 +876,7 @@ namespace wi::lua::scene
 		int IsNotVisibleInMainCamera(lua_State* L);
 		int IsNotVisibleInReflections(lua_State* L);
 		int IsWetmapEnabled(lua_State* L);
+		int IsOccluder(lua_State* L);
 		int IsRenderable(lua_State* L);
 
 		int SetMeshID(lua_State* L);
@@ -894,6 +895,7 @@ namespace wi::lua::scene
 		int SetNotVisibleInMainCamera(lua_State* L);
 		int SetNotVisibleInReflections(lua_State* L);
 		int SetWetmapEnabled(lua_State* L);
+		int SetOccluder(lua_State* L);
 		int SetRenderable(lua_State* L);
 	};
 
@@ -1445,7 +1445,7 @@ namespace wi::scene
 				bvh_leaf_aabbs.push_back(aabb);
 			}
 		}
-		bvh.Build(bvh_leaf_aabbs.data(), (uint32_t)bvh_leaf_aabbs.size());
+		bvh.Build(bvh_leaf_aabbs.data(), (uint32_t)bvh_leaf_aabbs.size(), wi::BVH::BUILD_MODE::SAH); // mesh BVH is static and mostly used for ray queries, so it's worth a better build
 	}
 	void MeshComponent::ComputeNormals(COMPUTE_NORMALS compute)
 	{
@@ -2196,6 +2196,185 @@ namespace wi::scene
 		return ComputeTextureMemorySizeInBytes(texture.desc);
 	}
 
+	void AnimationDataComponent::UpdateKeyframeInfo()
+	{
+		keyframe_times_sorted = std::is_sorted(keyframe_times.begin(), keyframe_times.end());
+		time_first = FLT_MAX;
+		time_last = -FLT_MAX;
+		if (keyframe_times_sorted && !keyframe_times.empty())
+		{
+			time_first = keyframe_times.front();
+			time_last = keyframe_times.back();
+		}
+		else
+		{
+			for (float time : keyframe_times)
+			{
+				time_first = std::min(time_first, time);
+				time_last = std::max(time_last, time);
+			}
+		}
+		keyframe_info_count = keyframe_times.size();
+		keyframe_info_dirty = false;
+	}
+	// Smallest three quaternion encoding: the components other than the largest one are in the range [-1/sqrt(2), 1/sqrt(2)]
+	static constexpr float smallest_three_range = 0.70710678f;
+	static constexpr float smallest_three_scale = smallest_three_range * 2 / 32767.0f;
+	void AnimationDataComponent::Compress(wi::ecs::Entity time_track_entity, const uint32_t* keys, size_t key_count, Compression mode)
+	{
+		assert(!IsCompressed());
+		assert(!keyframe_times.empty() && keyframe_data.size() % keyframe_times.size() == 0);
+		const size_t raw_component_count = keyframe_data.size() / keyframe_times.size();
+
+		compression = mode;
+		time_track = time_track_entity;
+		compressed_min.clear();
+		compressed_scale.clear();
+		compressed_values.clear();
+
+		if (compression == Compression::SMALLEST_THREE)
+		{
+			assert(raw_component_count == 4);
+			component_count = 3;
+			compressed_values.resize(key_count * component_count + 4);
+			for (size_t k = 0; k < key_count; ++k)
+			{
+				XMFLOAT4 q;
+				XMStoreFloat4(&q, XMQuaternionNormalize(XMLoadFloat4((const XMFLOAT4*)keyframe_data.data() + keys[k])));
+				const float components[] = { q.x, q.y, q.z, q.w };
+				uint32_t largest = 0;
+				for (uint32_t c = 1; c < 4; ++c)
+				{
+					if (std::abs(components[c]) > std::abs(components[largest]))
+					{
+						largest = c;
+					}
+				}
+				// q and -q are the same rotation, so the largest component is made positive and it can be reconstructed from the others:
+				const float sign = components[largest] < 0 ? -1.0f : 1.0f;
+				uint16_t* values = compressed_values.data() + k * component_count;
+				uint32_t value_index = 0;
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					if (c == largest)
+						continue;
+					const float value = (components[c] * sign + smallest_three_range) / smallest_three_scale;
+					values[value_index++] = (uint16_t)clamp(int(std::round(value)), 0, 32767);
+				}
+				values[0] |= uint16_t((largest & 1) << 15);
+				values[1] |= uint16_t((largest >> 1) << 15);
+			}
+		}
+		else
+		{
+			component_count = (uint32_t)raw_component_count;
+			const size_t padded_component_count = align(raw_component_count, size_t(4));
+			compressed_min.resize(padded_component_count);
+			compressed_scale.resize(padded_component_count);
+			for (size_t c = 0; c < raw_component_count; ++c)
+			{
+				float value_min = FLT_MAX;
+				float value_max = -FLT_MAX;
+				for (size_t k = 0; k < key_count; ++k)
+				{
+					const float value = keyframe_data[keys[k] * raw_component_count + c];
+					value_min = std::min(value_min, value);
+					value_max = std::max(value_max, value);
+				}
+				compressed_min[c] = value_min;
+				compressed_scale[c] = (value_max - value_min) / 65535.0f;
+			}
+			compressed_values.resize(key_count * component_count + 4);
+			for (size_t k = 0; k < key_count; ++k)
+			{
+				for (size_t c = 0; c < raw_component_count; ++c)
+				{
+					if (compressed_scale[c] > 0)
+					{
+						const float value = (keyframe_data[keys[k] * raw_component_count + c] - compressed_min[c]) / compressed_scale[c];
+						compressed_values[k * component_count + c] = (uint16_t)clamp(int(std::round(value)), 0, 65535);
+					}
+				}
+			}
+		}
+
+		keyframe_times.clear();
+		keyframe_times.shrink_to_fit();
+		keyframe_data.clear();
+		keyframe_data.shrink_to_fit();
+		SetKeyframeInfoDirty();
+		_flags |= COMPRESSED;
+	}
+	void AnimationDataComponent::Decompress(const AnimationDataComponent& time_track_data)
+	{
+		assert(IsCompressed());
+		const size_t key_count = time_track_data.keyframe_times.size();
+		const size_t raw_component_count = compression == Compression::SMALLEST_THREE ? 4 : component_count;
+		keyframe_times = time_track_data.keyframe_times;
+		keyframe_data.resize(key_count * raw_component_count);
+		for (size_t k = 0; k < key_count; ++k)
+		{
+			for (size_t c = 0; c < raw_component_count; c += 4)
+			{
+				XMFLOAT4 values;
+				XMStoreFloat4(&values, DecompressKeyframe(k, c));
+				std::memcpy(keyframe_data.data() + k * raw_component_count + c, &values, std::min(size_t(4), raw_component_count - c) * sizeof(float));
+			}
+		}
+
+		time_track = wi::ecs::INVALID_ENTITY;
+		component_count = 0;
+		compressed_values.clear();
+		compressed_values.shrink_to_fit();
+		compressed_min.clear();
+		compressed_min.shrink_to_fit();
+		compressed_scale.clear();
+		compressed_scale.shrink_to_fit();
+		SetKeyframeInfoDirty();
+		_flags &= ~COMPRESSED;
+	}
+	XMVECTOR AnimationDataComponent::DecompressKeyframe(size_t key, size_t component_offset) const
+	{
+		assert(IsCompressed());
+		if (compression == Compression::SMALLEST_THREE)
+		{
+			assert(compressed_values.size() >= key * 3 + 3);
+			const uint16_t* values = compressed_values.data() + key * 3;
+			const uint32_t largest = uint32_t(values[0] >> 15) | (uint32_t(values[1] >> 15) << 1);
+			XMVECTOR V = XMVectorAndInt(XMVectorSetInt(values[0], values[1], values[2], 0), XMVectorSetInt(0x7FFF, 0x7FFF, 0x7FFF, 0));
+			V = XMVectorMultiplyAdd(XMConvertVectorUIntToFloat(V, 0), XMVectorReplicate(smallest_three_scale), XMVectorReplicate(-smallest_three_range));
+			const XMVECTOR W = XMVectorSqrt(XMVectorMax(XMVectorZero(), XMVectorSubtract(XMVectorSplatOne(), XMVector3Dot(V, V))));
+			switch (largest)
+			{
+			case 0:
+				return XMVectorPermute<XM_PERMUTE_1X, XM_PERMUTE_0X, XM_PERMUTE_0Y, XM_PERMUTE_0Z>(V, W);
+			case 1:
+				return XMVectorPermute<XM_PERMUTE_0X, XM_PERMUTE_1X, XM_PERMUTE_0Y, XM_PERMUTE_0Z>(V, W);
+			case 2:
+				return XMVectorPermute<XM_PERMUTE_0X, XM_PERMUTE_0Y, XM_PERMUTE_1X, XM_PERMUTE_0Z>(V, W);
+			default:
+				return XMVectorPermute<XM_PERMUTE_0X, XM_PERMUTE_0Y, XM_PERMUTE_0Z, XM_PERMUTE_1X>(V, W);
+			}
+		}
+		assert(component_offset % 4 == 0);
+		assert(compressed_values.size() >= key * component_count + component_offset + 4);
+		assert(compressed_min.size() >= component_offset + 4);
+		const XMVECTOR V = PackedVector::XMLoadUShort4((const PackedVector::XMUSHORT4*)(compressed_values.data() + key * component_count + component_offset));
+		const XMVECTOR S = XMLoadFloat4((const XMFLOAT4*)(compressed_scale.data() + component_offset));
+		const XMVECTOR M = XMLoadFloat4((const XMFLOAT4*)(compressed_min.data() + component_offset));
+		return XMVectorMultiplyAdd(V, S, M);
+	}
+	size_t AnimationDataComponent::GetMemorySizeInBytes() const
+	{
+		size_t size = 0;
+		size += keyframe_times.size() * sizeof(float);
+		size += keyframe_data.size() * sizeof(float);
+		size += compressed_values.size() * sizeof(uint16_t);
+		size += compressed_min.size() * sizeof(float);
+		size += compressed_scale.size() * sizeof(float);
+		return size;
+	}
+
 	AnimationComponent::AnimationChannel::PathDataType AnimationComponent::AnimationChannel::GetPathDataType() const
 	{
 		switch (path)
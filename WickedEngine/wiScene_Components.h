@@ -1160,6 +1160,7 @@ namespace wi::scene
 			NOT_VISIBLE_IN_MAIN_CAMERA = 1 << 8,
 			NOT_VISIBLE_IN_REFLECTIONS = 1 << 9,
 			WETMAP_ENABLED = 1 << 10,
+			OCCLUDER = 1 << 11,
 		};
 		uint32_t _flags = RENDERABLE | CAST_SHADOW;
 
@@ -1215,6 +1216,8 @@ namespace wi::scene
 		// With this you can disable object rendering for reflections
 		constexpr void SetNotVisibleInReflections(bool value) { set_flag(_flags, NOT_VISIBLE_IN_REFLECTIONS, value); }
 		constexpr void SetWetmapEnabled(bool value) { set_flag(_flags, WETMAP_ENABLED, value); }
+		// Occluder object is always used in CPU software occlusion culling, even if it's not renderable, so it can be a dedicated low-poly proxy
+		constexpr void SetOccluder(bool value) { set_flag(_flags, OCCLUDER, value); }
 
 		constexpr bool IsRenderable() const { return (_flags & RENDERABLE) && (GetTransparency() < 0.99f); }
 		constexpr bool IsCastingShadow() const { return _flags & CAST_SHADOW; }
@@ -1226,6 +1229,7 @@ namespace wi::scene
 		constexpr bool IsNotVisibleInMainCamera() const { return _flags & NOT_VISIBLE_IN_MAIN_CAMERA; }
 		constexpr bool IsNotVisibleInReflections() const { return _flags & NOT_VISIBLE_IN_REFLECTIONS; }
 		constexpr bool IsWetmapEnabled() const { return _flags & WETMAP_ENABLED; }
+		constexpr bool IsOccluder() const { return _flags & OCCLUDER; }
 
 		constexpr float GetTransparency() const { return 1 - color.w; }
 		constexpr uint32_t GetFilterMask() const { return filterMask | filterMaskDynamic; }
@@ -1638,12 +1642,57 @@ namespace wi::scene
 		enum FLAGS
 		{
 			EMPTY = 0,
+			COMPRESSED = 1 << 0,
 		};
 		uint32_t _flags = EMPTY;
 
 		wi::vector<float> keyframe_times;
 		wi::vector<float> keyframe_data;
 
+		// Compressed representation, created by Scene::CompressAnimation()
+		//	When compressed, keyframe_times and keyframe_data are empty, the keyframe times are in the time_track animation data instead
+		enum class Compression
+		{
+			QUANTIZED,		// every component is quantized to 16 bits in the range of [compressed_min, compressed_min + compressed_scale * 65535]
+			SMALLEST_THREE,	// rotation quaternion: the three smallest components quantized to 15 bits, the index of the largest component is in the top bits of the first two
+		} compression = Compression::QUANTIZED;
+		wi::ecs::Entity time_track = wi::ecs::INVALID_ENTITY; // animation data that holds the keyframe times, shared by the compressed datas of the same clip
+		uint32_t component_count = 0; // number of values per keyframe
+		wi::vector<uint16_t> compressed_values; // keyframe values, padded with 4 values at the end to allow reading 4 values for any component
+		wi::vector<float> compressed_min; // per component, padded to a multiple of 4 components
+		wi::vector<float> compressed_scale; // per component, padded to a multiple of 4 components
+
+		constexpr bool IsCompressed() const { return _flags & COMPRESSED; }
+
+		// Replaces the keyframe times and data with the compressed representation, this is used by Scene::CompressAnimation()
+		//	time_track_entity : animation data that holds the keyframe times of the kept keyframes
+		//	keys : indices of the kept keyframes
+		//	mode : SMALLEST_THREE can only be used for quaternions
+		void Compress(wi::ecs::Entity time_track_entity, const uint32_t* keys, size_t key_count, Compression mode);
+
+		// Replaces the compressed representation with regular keyframe times and data
+		//	time_track_data : the animation data component of the time_track entity
+		void Decompress(const AnimationDataComponent& time_track_data);
+
+		// Decompresses 4 components of a compressed keyframe
+		//	key : keyframe index in the time track
+		//	component_offset : index of the first component, must be a multiple of 4 (only for QUANTIZED, for more than 4 components)
+		XMVECTOR DecompressKeyframe(size_t key, size_t component_offset = 0) const;
+
+		size_t GetMemorySizeInBytes() const;
+
+		// Non-serialized attributes:
+		//	Keyframe time information that the animation system caches, call SetKeyframeInfoDirty() after modifying keyframe_times
+		float time_first = 0;
+		float time_last = 0;
+		bool keyframe_times_sorted = false; // if sorted, keyframes are searched with binary search instead of linear search
+		bool keyframe_info_dirty = true;
+		size_t keyframe_info_count = ~0ull; // the number of keyframes when the info was updated, the info is also invalid if this doesn't match
+
+		bool IsKeyframeInfoValid() const { return !keyframe_info_dirty && keyframe_info_count == keyframe_times.size(); }
+		void SetKeyframeInfoDirty() { keyframe_info_dirty = true; }
+		void UpdateKeyframeInfo();
+
 		void Serialize(wi::Archive& archive, wi::ecs::EntitySerializer& seri);
 	};
 
@@ -1740,6 +1789,7 @@ namespace wi::scene
 
 			// Non-serialized attributes:
 			mutable int next_event = 0;
+			mutable int keyframe_cursor = 0; // keyframe search continues from here, so playback in order doesn't need to search the whole timeline
 		};
 		struct AnimationSampler
 		{
@@ -1604,12 +1604,35 @@ namespace wi::scene
 			archive >> _flags;
 			archive >> keyframe_times;
 			archive >> keyframe_data;
+			SetKeyframeInfoDirty();
+
+			if (seri.GetVersion() >= 1 && IsCompressed())
+			{
+				uint32_t value = 0;
+				archive >> value;
+				compression = (Compression)value;
+				SerializeEntity(archive, time_track, seri);
+				archive >> component_count;
+				archive >> compressed_values;
+				archive >> compressed_min;
+				archive >> compressed_scale;
+			}
 		}
 		else
 		{
 			archive << _flags;
 			archive << keyframe_times;
 			archive << keyframe_data;
+
+			if (seri.GetVersion() >= 1 && IsCompressed())
+			{
+				archive << (uint32_t)compression;
+				SerializeEntity(archive, time_track, seri);
+				archive << component_count;
+				archive << compressed_values;
+				archive << compressed_min;
+				archive << compressed_scale;
+			}
 		}
 	}
 	void WeatherComponent::Serialize(wi::Archive& archive, EntitySerializer& seri)
@@ -2699,11 +2722,27 @@ namespace wi::scene
 		// With this we will ensure that serialized entities are unique and persistent across the scene:
 		EntitySerializer seri;
 		seri.ctx.priority = wi::jobsystem::Priority::Low; // serialization tasks will be low priority to not block rendering if scene loading is asynchronous
+		seri.allow_chunks = true; // component managers are stored in separate chunks, so they can be loaded in parallel
 
 		if(archive.GetVersion() >= 84)
 		{
 			// New scene serialization path with component library:
 			componentLibrary.Serialize(archive, seri);
+
+			if (!seri.component_timings.empty())
+			{
+				// Report per component manager timings, slowest first:
+				std::sort(seri.component_timings.begin(), seri.component_timings.end(), [](const EntitySerializer::ComponentTiming& a, const EntitySerializer::ComponentTiming& b) {
+					return a.read_milliseconds + a.serialize_milliseconds > b.read_milliseconds + b.serialize_milliseconds;
+				});
+				wilog("Scene::Serialize component managers (%s):", seri.allow_parallel ? "parallel" : "serial");
+				for (const EntitySerializer::ComponentTiming& timing : seri.component_timings)
+				{
+					if (timing.read_milliseconds + timing.serialize_milliseconds < 0.01)
+						continue;
+					wilog("\t%s: read %.2f ms, deserialize %.2f ms", timing.name.c_str(), timing.read_milliseconds, timing.serialize_milliseconds);
+				}
+			}
 		}
 		else
 		{
@@ -4,8 +4,10 @@
 #include "wiHelper.h"
 #include "wiArchive.h"
 #include "wiUnorderedSet.h"
+#include "wiTimer.h"
 
 #include <mutex>
+#include <atomic>
 
 #ifdef PLATFORM_WINDOWS_DESKTOP
 #define SHADERCOMPILER_ENABLED
@@ -52,11 +54,110 @@ using namespace wi::graphics;
 
 namespace wi::shadercompiler
 {
+	static std::string shader_cache_directory;
+	static constexpr uint64_t shader_cache_version = 1; // increment this if the cache entry format changes
+	static std::atomic<uint32_t> shader_cache_hits{ 0 };
+	static std::atomic<uint32_t> shader_cache_misses{ 0 };
+
+	// The shader cache key is accumulated from everything that can change the compiled shader binary
+	struct ShaderCacheKey
+	{
+		uint64_t hash = shader_cache_version;
+
+		void Add(const void* data, size_t size)
+		{
+			hash = wi::helper::data_hash(&size, sizeof(size), hash);
+			hash = wi::helper::data_hash(data, size, hash);
+		}
+		void Add(const std::string& str)
+		{
+			Add(str.data(), str.size());
+		}
+		void Add(const std::wstring& str)
+		{
+			Add(str.data(), str.size() * sizeof(wchar_t));
+		}
+		// The #line directives are skipped, because they contain absolute file paths that would make the key different in every build tree
+		void AddPreprocessedSource(const char* text, size_t length)
+		{
+			std::string filtered;
+			filtered.reserve(length);
+			const char* end = text + length;
+			while (text < end)
+			{
+				const char* line_end = (const char*)std::memchr(text, '\n', size_t(end - text));
+				line_end = line_end == nullptr ? end : line_end + 1;
+				if (size_t(line_end - text) < 5 || std::strncmp(text, "#line", 5) != 0)
+				{
+					filtered.append(text, line_end);
+				}
+				text = line_end;
+			}
+			Add(filtered);
+		}
+	};
+	static std::string GetShaderCacheFileName(uint64_t key)
+	{
+		char filename[32] = {};
+		snprintf(filename, arraysize(filename), "%016llx.wishadercache", (unsigned long long)key);
+		return shader_cache_directory + filename;
+	}
+
+	// Returns false if the entry doesn't exist or it is not valid
+	static bool ShaderCacheRead(uint64_t key, CompilerOutput& output)
+	{
+		wi::helper::MappedFile mapping;
+		if (wi::helper::FileMap(GetShaderCacheFileName(key), mapping) && mapping.size > 16)
+		{
+			wi::Archive archive(mapping.data, mapping.size, false);
+			if (archive.IsOpen())
+			{
+				uint64_t entry_key = 0;
+				archive >> entry_key;
+				if (entry_key == key)
+				{
+					archive >> output.shaderhash;
+					const uint8_t* data = nullptr;
+					size_t size = 0;
+					archive.MapVector(data, size);
+					if (size > 0 && size <= mapping.size && archive.GetPos() <= mapping.size)
+					{
+						// the file mapping is closed after this, so the data is copied to keep the shader pointer valid
+						auto internal_state = wi::allocator::make_shared<wi::vector<uint8_t>>(data, data + size);
+						output.internal_state = internal_state;
+						output.shaderdata = internal_state->data();
+						output.shadersize = internal_state->size();
+						shader_cache_hits.fetch_add(1);
+						return true;
+					}
+				}
+			}
+		}
+		output.shaderhash.clear();
+		shader_cache_misses.fetch_add(1);
+		return false;
+	}
+
+	static void ShaderCacheWrite(uint64_t key, const CompilerOutput& output)
+	{
+		wi::Archive archive;
+		archive << key;
+		archive << output.shaderhash;
+		archive.WriteVector(output.shaderdata, output.shadersize);
+
+		if (!wi::helper::DirectoryExists(shader_cache_directory))
+		{
+			wi::helper::DirectoryCreate(shader_cache_directory);
+		}
+		const std::string filename = GetShaderCacheFileName(key);
+		wi::helper::FileWriteAtomic(filename, archive.GetData(), archive.GetPos());
+	}
 
 #ifdef SHADERCOMPILER_ENABLED_DXCOMPILER
 	struct InternalState_DXC
 	{
 		DxcCreateInstanceProc DxcCreateInstance = nullptr;
+		std::string version; // part of the shader cache key
 
 		InternalState_DXC(const std::string& modifier = "")
 		{
@@ -89,6 +190,19 @@ namespace wi::shadercompiler
 					hr = info->GetVersion(&major, &minor);
 					assert(SUCCEEDED(hr));
 					wi::backlog::post("wi::shadercompiler: loaded " + library + " (version: " + std::to_string(major) + "." + std::to_string(minor) + ")");
+
+					version = library + " " + std::to_string(major) + "." + std::to_string(minor);
+					ComPtr<IDxcVersionInfo2> info2;
+					if (SUCCEEDED(dxcCompiler->QueryInterface(IID_PPV_ARGS(&info2))))
+					{
+						uint32_t commit_count = 0;
+						char* commit_hash = nullptr;
+						if (SUCCEEDED(info2->GetCommitInfo(&commit_count, &commit_hash)) && commit_hash != nullptr)
+						{
+							version += " " + std::to_string(commit_count) + " " + commit_hash;
+							CoTaskMemFree(commit_hash);
+						}
+					}
 				}
 			}
 			else
@@ -548,14 +662,72 @@ namespace wi::shadercompiler
 			}
 		}
 #endif
+		// Shader cache: the source is preprocessed first to compute the key, the include handler also records the dependencies here
+		uint64_t cache_key = 0;
+		bool cache_hit = false;
+		if (!shader_cache_directory.empty())
+		{
+			wi::vector<const wchar_t*> args_preprocess = args_raw;
+			args_preprocess.push_back(L"-P");
+			ComPtr<IDxcResult> pPreprocessResults;
+			HRESULT hrStatus = E_FAIL;
+			ComPtr<IDxcBlobUtf8> pPreprocessed = nullptr;
+			hr = dxcCompiler->Compile(
+				&Source,
+				args_preprocess.data(),
+				(uint32_t)args_preprocess.size(),
+				&includehandler,
+				IID_PPV_ARGS(&pPreprocessResults)
+			);
+			if (
+				SUCCEEDED(hr) &&
+				SUCCEEDED(pPreprocessResults->GetStatus(&hrStatus)) &&
+				SUCCEEDED(hrStatus) &&
+				SUCCEEDED(pPreprocessResults->GetOutput(DXC_OUT_HLSL, IID_PPV_ARGS(&pPreprocessed), nullptr)) &&
+				pPreprocessed != nullptr
+				)
+			{
+				ShaderCacheKey key;
+				key.Add(compiler_internal.version);
+				for (size_t i = 0; i < args.size(); ++i)
+				{
+					if (args[i] == L"-I")
+					{
+						// include directories only change where files are found, the preprocessed source covers their contents
+						i++;
+						continue;
+					}
+					key.Add(args[i]);
+				}
+				if (has_flag(input.flags, Flags::KEEP_DEBUG_INFORMATION))
+				{
+					// debug information contains the file paths, so they must be part of the key
+					key.Add(pPreprocessed->GetStringPointer(), pPreprocessed->GetStringLength());
+				}
+				else
+				{
+					key.AddPreprocessedSource(pPreprocessed->GetStringPointer(), pPreprocessed->GetStringLength());
+				}
+				cache_key = key.hash;
+				cache_hit = ShaderCacheRead(cache_key, output);
+			}
+			if (!cache_hit)
+			{
+				output.dependencies.clear(); // they will be recorded again by compiling
+			}
+		}
+
 		ComPtr<IDxcResult> pResults;
-		hr = dxcCompiler->Compile(
-			&Source,						// Source buffer.
-			args_raw.data(),			// Array of pointers to arguments.
-			(uint32_t)args.size(),		// Number of arguments.
-			&includehandler,		// User-provided interface to handle #include directives (optional).
-			IID_PPV_ARGS(&pResults)	// Compiler output status, buffer, and errors.
-		);
+		if (!cache_hit)
+		{
+			hr = dxcCompiler->Compile(
+				&Source,						// Source buffer.
+				args_raw.data(),			// Array of pointers to arguments.
+				(uint32_t)args.size(),		// Number of arguments.
+				&includehandler,		// User-provided interface to handle #include directives (optional).
+				IID_PPV_ARGS(&pResults)	// Compiler output status, buffer, and errors.
+			);
+		}
 #ifndef _WIN32
 		{
 			std::scoped_lock lock(locale_mut);
@@ -565,6 +737,12 @@ namespace wi::shadercompiler
 			}
 		}
 #endif
+		if (cache_hit)
+		{
+			output.dependencies.push_back(input.shadersourcefilename);
+			output.cache_hit = true;
+			return;
+		}
 		assert(SUCCEEDED(hr));
 
 		ComPtr<IDxcBlobUtf8> pErrors = nullptr;
@@ -854,6 +1032,11 @@ namespace wi::shadercompiler
 				}
 			}
 		}
+
+		if (cache_key != 0 && output.IsValid())
+		{
+			ShaderCacheWrite(cache_key, output);
+		}
 	}
 #endif // SHADERCOMPILER_ENABLED_DXCOMPILER
 
@@ -862,6 +1045,8 @@ namespace wi::shadercompiler
 	{
 		using PFN_D3DCOMPILE = decltype(&D3DCompile);
 		PFN_D3DCOMPILE D3DCompile = nullptr;
+		using PFN_D3DPREPROCESS = decltype(&D3DPreprocess);
+		PFN_D3DPREPROCESS D3DPreprocess = nullptr;
 
 		InternalState_D3DCompiler()
 		{
@@ -874,6 +1059,7 @@ namespace wi::shadercompiler
 			if (d3dcompiler != nullptr)
 			{
 				D3DCompile = (PFN_D3DCOMPILE)wiGetProcAddress(d3dcompiler, "D3DCompile");
+				D3DPreprocess = (PFN_D3DPREPROCESS)wiGetProcAddress(d3dcompiler, "D3DPreprocess");
 				if (D3DCompile != nullptr)
 				{
 					wi::backlog::post("wi::shadercompiler: loaded d3dcompiler_47.dll");
@@ -982,6 +1168,39 @@ namespace wi::shadercompiler
 		}
 
 
+		// Shader cache: the source is preprocessed first to compute the key, the include handler also records the dependencies here
+		uint64_t cache_key = 0;
+		if (!shader_cache_directory.empty() && d3d_compiler().D3DPreprocess != nullptr)
+		{
+			ComPtr<ID3DBlob> preprocessed;
+			HRESULT hr = d3d_compiler().D3DPreprocess(
+				shadersourcedata.data(),
+				shadersourcedata.size(),
+				input.shadersourcefilename.c_str(),
+				defines,
+				&includehandler,
+				&preprocessed,
+				nullptr
+			);
+			if (SUCCEEDED(hr) && preprocessed != nullptr)
+			{
+				ShaderCacheKey key;
+				key.Add(std::string("d3dcompiler_47"));
+				key.Add(std::string(target));
+				key.Add(input.entrypoint);
+				key.Add(&Flags1, sizeof(Flags1));
+				key.AddPreprocessedSource((const char*)preprocessed->GetBufferPointer(), preprocessed->GetBufferSize());
+				cache_key = key.hash;
+				if (ShaderCacheRead(cache_key, output))
+				{
+					output.dependencies.push_back(input.shadersourcefilename);
+					output.cache_hit = true;
+					return;
+				}
+			}
+			output.dependencies.clear(); // they will be recorded again by compiling
+		}
+
 		ComPtr<ID3DBlob> code;
 		ComPtr<ID3DBlob> errors;
 		HRESULT hr = d3d_compiler().D3DCompile(
@@ -1013,6 +1232,11 @@ namespace wi::shadercompiler
 			auto internal_state = wi::allocator::make_shared<ComPtr<ID3D10Blob>>();
 			*internal_state = code;
 			output.internal_state = internal_state;
+
+			if (cache_key != 0)
+			{
+				ShaderCacheWrite(cache_key, output);
+			}
 		}
 	}
 #endif // SHADERCOMPILER_ENABLED_D3DCOMPILER
@@ -1020,6 +1244,7 @@ namespace wi::shadercompiler
 	void Compile(const CompilerInput& input, CompilerOutput& output)
 	{
 		output = CompilerOutput();
+		wi::Timer timer;
 
 #ifdef SHADERCOMPILER_ENABLED
 		switch (input.format)
@@ -1050,6 +1275,33 @@ namespace wi::shadercompiler
 
 		}
 #endif // SHADERCOMPILER_ENABLED
+
+		output.compile_time = timer.elapsed_milliseconds();
+	}
+
+	void SetShaderCacheDirectory(const std::string& directory)
+	{
+		shader_cache_directory = directory;
+		if (!shader_cache_directory.empty() && shader_cache_directory.back() != '/' && shader_cache_directory.back() != '\\')
+		{
+			shader_cache_directory += "/";
+		}
+	}
+	const std::string& GetShaderCacheDirectory()
+	{
+		return shader_cache_directory;
+	}
+	ShaderCacheStats GetShaderCacheStats()
+	{
+		ShaderCacheStats stats;
+		stats.hits = shader_cache_hits.load();
+		stats.misses = shader_cache_misses.load();
+		return stats;
+	}
+	void ResetShaderCacheStats()
+	{
+		shader_cache_hits.store(0);
+		shader_cache_misses.store(0);
 	}
 
 	constexpr const char* shadermetaextension = "wishadermeta";
@@ -38,9 +38,27 @@ namespace wi::shadercompiler
 		wi::vector<uint8_t> shaderhash;
 		std::string error_message;
 		wi::vector<std::string> dependencies;
+		bool cache_hit = false; // true if the shader binary was taken from the shader cache instead of compiling
+		double compile_time = 0; // time spent in Compile() in milliseconds, this includes preprocessing for the shader cache
 	};
 	void Compile(const CompilerInput& input, CompilerOutput& output);
 
+	// Shader cache: compiled shader binaries are stored in a local directory, keyed by content instead of file timestamps
+	//	The key is the hash of the preprocessed source (so every included file is part of it), defines, target, compile flags and compiler version
+	//	Shaders that are outdated by timestamp (for example after switching branches) but produce the same output are taken from the cache without compiling
+	//	The directory can be shared by multiple build trees, and it can be deleted any time to clear the cache
+	//	directory: empty string disables the cache (default)
+	void SetShaderCacheDirectory(const std::string& directory);
+	const std::string& GetShaderCacheDirectory();
+
+	struct ShaderCacheStats
+	{
+		uint32_t hits = 0;		// number of compilations that used a cache entry
+		uint32_t misses = 0;	// number of compilations that didn't find a cache entry
+	};
+	ShaderCacheStats GetShaderCacheStats();
+	void ResetShaderCacheStats();
+
 	bool SaveShaderAndMetadata(const std::string& shaderfilename, const CompilerOutput& output);
 	bool IsShaderOutdated(const std::string& shaderfilename);
 